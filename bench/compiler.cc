@@ -0,0 +1,124 @@
+// Compiles synthetic programs in-process at growing sizes and reports the
+// throughput of each phase. Doubling the scale should double the time of every
+// phase; a larger growth points at super-linear behaviour.
+//
+// Usage: mini-bench-compiler [MAX_SCALE] [ITERATIONS]
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <streambuf>
+#include <string>
+
+#include "codegen/codegen.h"
+#include "context.h"
+#include "fmt/format.h"
+#include "lexer.h"
+#include "synth.h"
+
+namespace {
+
+// Discards everything written to it.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override {
+        return n;
+    }
+};
+
+struct Workload {
+    const char *name;
+    size_t base;
+    std::string (*generate)(size_t);
+};
+
+const Workload workloads[] = {
+    {"functions", 250, mini::bench::GenerateProgram},
+    {"nesting", 128,
+     [](size_t depth) {
+         return mini::bench::GenerateNestedProgram(
+             mini::bench::Nesting::Paren, depth);
+     }},
+    {"calls", 128,
+     [](size_t depth) {
+         return mini::bench::GenerateNestedProgram(
+             mini::bench::Nesting::Call, depth);
+     }},
+    {"literals", 1000, mini::bench::GenerateLiteralProgram},
+    {"strings", 1000, mini::bench::GenerateStringProgram},
+    {"chains", 128, mini::bench::GenerateChainProgram},
+};
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    size_t max_scale = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8;
+    size_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 3;
+
+    fmt::print("{:<10} {:>5} {:>8} {:>8} {:<14} {:>9} {:>12} {:>12} {:>7}\n",
+               "workload", "scale", "lines", "tokens", "phase", "ms",
+               "lines/sec", "tokens/sec", "growth");
+    for (const auto &workload : workloads) {
+        std::map<std::string, double> prev_ms;
+        for (size_t scale = 1; scale <= max_scale; scale *= 2) {
+            auto source = workload.generate(workload.base * scale);
+
+            size_t lines, tokens;
+            {
+                mini::Context ctx;
+                auto id = ctx.input_cache().Cache("<synth>",
+                                                  std::string(source));
+                lines = ctx.input_cache().Fetch(id).LineCount();
+                auto res = mini::Lex(ctx, id);
+                if (!res) {
+                    fmt::print(stderr, "failed to lex {} program\n",
+                               workload.name);
+                    return EXIT_FAILURE;
+                }
+                tokens = res->size();
+            }
+
+            // Best time of each phase over all iterations.
+            std::vector<std::pair<std::string, double>> best_ms;
+            for (size_t i = 0; i < iterations; i++) {
+                mini::Context ctx;
+                ctx.pass_timer().Enable();
+                auto id = ctx.input_cache().Cache("<synth>",
+                                                  std::string(source));
+                NullBuffer null;
+                std::ostream os(&null);
+                if (!mini::CodeGen(ctx, os, id)) {
+                    fmt::print(stderr, "failed to compile {} program\n",
+                               workload.name);
+                    return EXIT_FAILURE;
+                }
+                const auto &records = ctx.pass_timer().records();
+                for (size_t j = 0; j < records.size(); j++) {
+                    double ms = records[j].wall_ns / 1e6;
+                    if (i == 0) {
+                        best_ms.emplace_back(records[j].name, ms);
+                    } else {
+                        best_ms[j].second = std::min(best_ms[j].second, ms);
+                    }
+                }
+            }
+
+            for (const auto &[phase, ms] : best_ms) {
+                auto prev = prev_ms.find(phase);
+                std::string growth =
+                    prev == prev_ms.end() || prev->second == 0
+                        ? "-"
+                        : fmt::format("x{:.2f}", ms / prev->second);
+                double sec = std::max(ms / 1e3, 1e-9);
+                fmt::print(
+                    "{:<10} {:>5} {:>8} {:>8} {:<14} {:>9.3f} {:>12.0f} "
+                    "{:>12.0f} {:>7}\n",
+                    workload.name, scale, lines, tokens, phase, ms,
+                    lines / sec, tokens / sec, growth);
+                prev_ms[phase] = ms;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+// Measures throughput of the lexer on a synthetic program.
+//
+// Usage: mini-bench-lexer [FUNCTIONS] [ITERATIONS]
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "context.h"
+#include "fmt/format.h"
+#include "lexer.h"
+#include "synth.h"
+
+int main(int argc, char *argv[]) {
+    size_t functions = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    size_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+
+    auto source = mini::bench::GenerateProgram(functions);
+
+    mini::Context ctx;
+    auto id = ctx.input_cache().Cache("<synth>", std::move(source));
+    auto bytes = ctx.input_cache().Fetch(id).contents().size();
+
+    size_t tokens = 0;
+    double best = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        auto res = mini::Lex(ctx, id);
+        auto end = std::chrono::steady_clock::now();
+        if (!res) {
+            fmt::print(stderr, "failed to lex synthetic program\n");
+            return EXIT_FAILURE;
+        }
+        tokens = res->size();
+        double sec = std::chrono::duration<double>(end - start).count();
+        if (i == 0 || sec < best) best = sec;
+    }
+
+    fmt::print("bytes:      {}\n", bytes);
+    fmt::print("tokens:     {}\n", tokens);
+    fmt::print("best time:  {:.3f} ms\n", best * 1e3);
+    fmt::print("tokens/sec: {:.0f}\n", tokens / best);
+    fmt::print("MB/sec:     {:.1f}\n", bytes / best / 1e6);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+// Measures how the parser scales with the nesting depth of expressions.
+// Time per level should stay flat as the depth doubles.
+//
+// Usage: mini-bench-parser [MAX_DEPTH] [ITERATIONS]
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "context.h"
+#include "fmt/format.h"
+#include "parser/parser.h"
+#include "synth.h"
+
+int main(int argc, char *argv[]) {
+    size_t max_depth = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4096;
+    size_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+
+    const std::pair<mini::bench::Nesting, const char *> nestings[] = {
+        {mini::bench::Nesting::Paren, "paren"},
+        {mini::bench::Nesting::Assign, "assign"},
+        {mini::bench::Nesting::Chain, "chain"},
+        {mini::bench::Nesting::Call, "call"},
+    };
+
+    fmt::print("{:<8} {:>8} {:>12} {:>12}\n", "nesting", "depth", "time (ms)",
+               "ns/level");
+    for (const auto &[nesting, name] : nestings) {
+        for (size_t depth = 256; depth <= max_depth; depth *= 2) {
+            mini::Context ctx;
+            auto id = ctx.input_cache().Cache(
+                "<synth>", mini::bench::GenerateNestedProgram(nesting, depth));
+
+            double best = 0;
+            for (size_t i = 0; i < iterations; i++) {
+                auto start = std::chrono::steady_clock::now();
+                auto res = mini::Parse(ctx, id);
+                auto end = std::chrono::steady_clock::now();
+                if (!res) {
+                    fmt::print(stderr, "failed to parse synthetic program\n");
+                    return EXIT_FAILURE;
+                }
+                double sec = std::chrono::duration<double>(end - start).count();
+                if (i == 0 || sec < best) best = sec;
+            }
+            fmt::print("{:<8} {:>8} {:>12.3f} {:>12.1f}\n", name, depth,
+                       best * 1e3, best * 1e9 / depth);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+#ifndef MINI_BENCH_SYNTH_H_
+#define MINI_BENCH_SYNTH_H_
+
+#include <cstddef>
+#include <string>
+
+#include "fmt/format.h"
+
+namespace mini {
+namespace bench {
+
+// Generates a valid mini program containing `functions` functions. Each
+// function exercises structs, loops, conditions, calls, string literals and
+// comments so that every phase of the compiler has some work to do.
+inline std::string GenerateProgram(size_t functions) {
+    std::string out;
+    out += "function printf(fmt: *char, ...) -> isize;\n\n";
+    out += "struct point {\n    x: usize,\n    y: usize,\n}\n\n";
+    for (size_t i = 0; i < functions; i++) {
+        out += fmt::format(
+            "// function number {0}\n"
+            "function f{0}(a: usize, b: usize) -> usize {{\n"
+            "    let p: point = point {{ x: a, y: b }};\n"
+            "    let sum: usize = 0;\n"
+            "    let i: usize = 0;\n"
+            "    /* loop over a small range */\n"
+            "    while (i < {1}) {{\n"
+            "        if (i % 3 == 0 && p.x >= 1) {{\n"
+            "            sum = sum + p.x * i + (p.y << 1);\n"
+            "        }} else {{\n"
+            "            sum = sum + (i ^ {0}) - (p.y & 7);\n"
+            "        }}\n"
+            "        i = i + 1;\n"
+            "    }}\n",
+            i, i % 17 + 1);
+        if (i != 0) {
+            out += fmt::format("    sum = sum + f{}(a, b) % 13;\n", i - 1);
+        }
+        out += "    return sum;\n}\n\n";
+    }
+    out += "function main() -> usize {\n";
+    if (functions) {
+        out += fmt::format("    let r: usize = f{}(1, 2);\n", functions - 1);
+        out += "    printf(\"%ld\\n\", r);\n";
+    }
+    out += "    return 0;\n}\n";
+    return out;
+}
+
+enum class Nesting {
+    Paren,   // ((((x + 1) + 1) + 1) + 1)
+    Assign,  // x = x = x = x = 1
+    Chain,   // x + x * x - x + x * x
+    Call,    // id(id(id(id(x))))
+};
+
+// Generates a program whose only statement is an expression nested `depth`
+// levels in the given way.
+inline std::string GenerateNestedProgram(Nesting nesting, size_t depth) {
+    std::string expr;
+    if (nesting == Nesting::Paren) {
+        expr = "x = " + std::string(depth, '(') + "x";
+        for (size_t i = 0; i < depth; i++) expr += " + 1)";
+    } else if (nesting == Nesting::Assign) {
+        for (size_t i = 0; i < depth; i++) expr += "x = ";
+        expr += "1";
+    } else if (nesting == Nesting::Chain) {
+        expr = "x = x";
+        for (size_t i = 0; i < depth; i++) expr += i % 2 ? " * x" : " + x";
+    } else {
+        expr = "x = ";
+        for (size_t i = 0; i < depth; i++) expr += "id(";
+        expr += "x" + std::string(depth, ')');
+    }
+    return "function id(v: usize) -> usize {\n"
+           "    return v;\n"
+           "}\n\n"
+           "function main() -> usize {\n"
+           "    let x: usize = 0;\n"
+           "    " +
+           expr +
+           ";\n"
+           "    return x;\n"
+           "}\n";
+}
+
+// Generates a program initialising an array literal of `elements` elements
+// and a struct literal with a field for every tenth of them.
+inline std::string GenerateLiteralProgram(size_t elements) {
+    size_t fields = elements / 10 + 1;
+    std::string out = "struct big {\n";
+    for (size_t i = 0; i < fields; i++) {
+        out += fmt::format("    f{}: usize,\n", i);
+    }
+    out += "}\n\nfunction main() -> usize {\n";
+    out += fmt::format("    let a: (usize)[{}] = {{ ", elements);
+    for (size_t i = 0; i < elements; i++) {
+        out += fmt::format(i ? ", {}" : "{}", i % 251);
+    }
+    out += " };\n    let b: big = big { ";
+    for (size_t i = 0; i < fields; i++) {
+        out += fmt::format(i ? ", f{0}: {0}" : "f{0}: {0}", i);
+    }
+    out += " };\n    return a[0] + b.f0;\n}\n";
+    return out;
+}
+
+// Generates a program with `strings` distinct string literals.
+inline std::string GenerateStringProgram(size_t strings) {
+    std::string out = "function main() -> usize {\n    let s: *char;\n";
+    for (size_t i = 0; i < strings; i++) {
+        out += fmt::format("    s = \"string literal number {}\\n\";\n", i);
+    }
+    out += "    return *s as usize;\n}\n";
+    return out;
+}
+
+// Generates a loop whose body is a chain of `length` if-else statements,
+// followed by `length` small loops.
+inline std::string GenerateChainProgram(size_t length) {
+    std::string out = "function main() -> usize {\n";
+    out += "    let x: usize = 0, y: usize = 0;\n";
+    out += fmt::format("    while (x < {}) {{\n        ", length);
+    for (size_t i = 0; i < length; i++) {
+        out += fmt::format("if (x == {}) {{ y = y + {}; }} else ", i, i % 7);
+    }
+    out += "{ y = y + 1; }\n        x = x + 1;\n    }\n";
+    for (size_t i = 0; i < length; i++) {
+        out += fmt::format("    while (y > {0}) {{ y = y - 1; }}\n", i);
+    }
+    out += "    return y;\n}\n";
+    return out;
+}
+
+}  // namespace bench
+}  // namespace mini
+
+#endif  // MINI_BENCH_SYNTH_H_
@@ -0,0 +1,56 @@
+#include "arena.h"
+
+#include <cstdlib>
+
+#include "panic.h"
+
+namespace mini {
+
+namespace {
+
+constexpr size_t block_size = 64 * 1024;
+
+thread_local Arena *curr_arenas[2] = {nullptr, nullptr};
+
+}  // namespace
+
+Arena::~Arena() {
+    for (void *block : blocks_) std::free(block);
+}
+
+void *Arena::AllocateSlow(size_t size, size_t align) {
+    // Large objects get a block of its own so the current block is not wasted.
+    size_t reserve = size + align > block_size / 4 ? size + align : block_size;
+    void *block = std::malloc(reserve);
+    if (!block) FatalError("arena `{}` out of memory", name_);
+    blocks_.push_back(block);
+    bytes_reserved_ += reserve;
+
+    uintptr_t begin = reinterpret_cast<uintptr_t>(block);
+    uintptr_t p = (begin + align - 1) & ~(align - 1);
+    if (reserve == block_size) {
+        curr_ = p + size;
+        end_ = begin + reserve;
+    }
+    bytes_allocated_ += size;
+    return reinterpret_cast<void *>(p);
+}
+
+Arena &CurrentArena(ArenaKind kind) {
+    Arena *&arena = curr_arenas[static_cast<size_t>(kind)];
+    if (!arena) {
+        // Objects allocated outside of compilation live until the thread exits.
+        thread_local Arena fallback_ast("ast"), fallback_hir("hir");
+        return kind == ArenaKind::Ast ? fallback_ast : fallback_hir;
+    }
+    return *arena;
+}
+
+ArenaScope::ArenaScope(ArenaKind kind, Arena &arena)
+    : kind_(kind), prev_(curr_arenas[static_cast<size_t>(kind)]) {
+    curr_arenas[static_cast<size_t>(kind)] = &arena;
+}
+
+ArenaScope::~ArenaScope() { curr_arenas[static_cast<size_t>(kind_)] = prev_; }
+
+}  // namespace mini
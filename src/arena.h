@@ -0,0 +1,100 @@
+#ifndef MINI_ARENA_H_
+#define MINI_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mini {
+
+// A bump allocator which owns every object allocated from it.
+//
+// Memory is handed out from large blocks and never returned one by one: all
+// blocks are released together when the arena is destroyed.
+class Arena {
+public:
+    explicit Arena(std::string &&name) : name_(std::move(name)) {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+    ~Arena();
+    inline const std::string &name() const { return name_; }
+    inline size_t bytes_allocated() const { return bytes_allocated_; }
+    inline size_t bytes_reserved() const { return bytes_reserved_; }
+    inline size_t block_count() const { return blocks_.size(); }
+
+    inline void *Allocate(size_t size, size_t align) {
+        uintptr_t p = (curr_ + align - 1) & ~(align - 1);
+        if (p + size > end_) return AllocateSlow(size, align);
+        curr_ = p + size;
+        bytes_allocated_ += size;
+        return reinterpret_cast<void *>(p);
+    }
+
+private:
+    void *AllocateSlow(size_t size, size_t align);
+
+    const std::string name_;
+    std::vector<void *> blocks_;
+    uintptr_t curr_ = 0;
+    uintptr_t end_ = 0;
+    size_t bytes_allocated_ = 0;
+    size_t bytes_reserved_ = 0;
+};
+
+enum class ArenaKind {
+    Ast,
+    Hir,
+};
+
+// Returns the arena nodes of `kind` are currently allocated from. Outside of
+// any `ArenaScope`, a thread local arena which is never freed is returned.
+Arena &CurrentArena(ArenaKind kind);
+
+// Makes `arena` the current arena of `kind` while this object is alive.
+class ArenaScope {
+public:
+    ArenaScope(ArenaKind kind, Arena &arena);
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+    ~ArenaScope();
+
+private:
+    const ArenaKind kind_;
+    Arena *const prev_;
+};
+
+// Standard allocator over an arena, used to place shared objects in it.
+// `deallocate` does nothing; memory is freed with the arena.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena &arena) : arena_(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena_(&other.arena()) {}
+    inline Arena &arena() const { return *arena_; }
+
+    inline T *allocate(size_t n) {
+        return static_cast<T *>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+    inline void deallocate(T *, size_t) {}
+
+    template <typename U>
+    inline bool operator==(const ArenaAllocator<U> &other) const {
+        return arena_ == &other.arena();
+    }
+    template <typename U>
+    inline bool operator!=(const ArenaAllocator<U> &other) const {
+        return arena_ != &other.arena();
+    }
+
+private:
+    Arena *arena_;
+};
+
+}  // namespace mini
+
+#endif  // MINI_ARENA_H_
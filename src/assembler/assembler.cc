@@ -0,0 +1,351 @@
+#include "assembler.h"
+
+#include <elf.h>
+
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../panic.h"
+#include "encoder.h"
+
+namespace mini {
+
+namespace assembler {
+
+namespace {
+
+constexpr std::string_view reg_names[16][4] = {
+    {"al", "ax", "eax", "rax"},     {"cl", "cx", "ecx", "rcx"},
+    {"dl", "dx", "edx", "rdx"},     {"bl", "bx", "ebx", "rbx"},
+    {"spl", "sp", "esp", "rsp"},    {"bpl", "bp", "ebp", "rbp"},
+    {"sil", "si", "esi", "rsi"},    {"dil", "di", "edi", "rdi"},
+    {"r8b", "r8w", "r8d", "r8"},    {"r9b", "r9w", "r9d", "r9"},
+    {"r10b", "r10w", "r10d", "r10"}, {"r11b", "r11w", "r11d", "r11"},
+    {"r12b", "r12w", "r12d", "r12"}, {"r13b", "r13w", "r13d", "r13"},
+    {"r14b", "r14w", "r14d", "r14"}, {"r15b", "r15w", "r15d", "r15"},
+};
+
+const std::unordered_map<std::string_view, Reg> &RegTable() {
+    static const auto table = [] {
+        std::unordered_map<std::string_view, Reg> table;
+        for (uint8_t num = 0; num < 16; num++) {
+            for (uint8_t i = 0; i < 4; i++) {
+                table.emplace(reg_names[num][i], Reg{num, uint8_t(1 << i), false});
+            }
+        }
+        table.emplace("ah", Reg{4, 1, true});
+        table.emplace("ch", Reg{5, 1, true});
+        table.emplace("dh", Reg{6, 1, true});
+        table.emplace("bh", Reg{7, 1, true});
+        return table;
+    }();
+    return table;
+}
+
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+std::string_view Trim(std::string_view s) {
+    while (!s.empty() && IsSpace(s.front())) s.remove_prefix(1);
+    while (!s.empty() && IsSpace(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+bool IsLocalLabel(std::string_view name) {
+    return name.size() >= 2 && name[0] == '.' && name[1] == 'L';
+}
+
+// Parses decimal or hexadecimal integer, optionally negated. Values are
+// wrapped in 64-bit as gas does.
+bool ParseInt(std::string_view s, int64_t &value) {
+    bool neg = !s.empty() && s.front() == '-';
+    if (neg) s.remove_prefix(1);
+    int base = 10;
+    if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        s.remove_prefix(2);
+        base = 16;
+    }
+    uint64_t abs;
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), abs, base);
+    if (ec != std::errc() || ptr != s.data() + s.size()) return false;
+    value = int64_t(neg ? -abs : abs);
+    return true;
+}
+
+bool ParseReg(std::string_view s, Reg &reg) {
+    if (s.empty() || s.front() != '%') return false;
+    auto &table = RegTable();
+    auto it = table.find(s.substr(1));
+    if (it == table.end()) return false;
+    reg = it->second;
+    return true;
+}
+
+bool ParseOperand(std::string_view s, Operand &op) {
+    op = Operand{};
+    if (s.empty()) return false;
+    if (s.front() == '%') {
+        op.kind = Operand::Register;
+        return ParseReg(s, op.reg);
+    } else if (s.front() == '$') {
+        op.kind = Operand::Immediate;
+        return ParseInt(Trim(s.substr(1)), op.value);
+    }
+
+    auto lparen = s.find('(');
+    if (lparen == std::string_view::npos) {
+        // Calls to any global symbol go through PLT, so `@PLT` changes
+        // nothing.
+        if (s.size() > 4 && s.substr(s.size() - 4) == "@PLT") {
+            s.remove_suffix(4);
+        }
+        op.kind = Operand::Label;
+        op.symbol = s;
+        return true;
+    }
+
+    op.kind = Operand::Memory;
+    auto disp = Trim(s.substr(0, lparen));
+    auto base = s.substr(lparen + 1);
+    if (base.empty() || base.back() != ')') return false;
+    base = Trim(base.substr(0, base.size() - 1));
+
+    // (base, index, scale), where scale is 1, 2, 4 or 8.
+    auto comma = base.find(',');
+    if (comma != std::string_view::npos) {
+        auto rest = base.substr(comma + 1);
+        base = Trim(base.substr(0, comma));
+        auto scale_comma = rest.find(',');
+        int64_t scale = 1;
+        if (scale_comma != std::string_view::npos) {
+            if (!ParseInt(Trim(rest.substr(scale_comma + 1)), scale)) {
+                return false;
+            }
+            rest = rest.substr(0, scale_comma);
+        }
+        if (scale != 1 && scale != 2 && scale != 4 && scale != 8) return false;
+        if (!ParseReg(Trim(rest), op.index)) return false;
+        op.has_index = true;
+        op.scale = uint8_t(scale);
+    }
+    if (base == "%rip" && !op.has_index) {
+        op.rip = true;
+    } else if (!ParseReg(base, op.reg)) {
+        return false;
+    }
+    if (disp.empty()) {
+        op.value = 0;
+    } else if (disp.front() == '-' || ('0' <= disp.front() &&
+                                       disp.front() <= '9')) {
+        return ParseInt(disp, op.value);
+    } else {
+        op.symbol = disp;
+    }
+    return true;
+}
+
+struct Label {
+    SectionKind section;
+    uint64_t value;
+};
+
+// A reference to a symbol, to be resolved after all labels are defined.
+struct Fixup {
+    SectionKind section;
+    uint64_t offset;
+    uint64_t end;  // End of the instruction, which the offset is relative to.
+    std::string_view symbol;
+    bool branch;
+};
+
+class Assembler {
+public:
+    void Line(std::string_view line);
+    ObjectFile Finish();
+
+private:
+    void Directive(std::string_view name, std::string_view args,
+                   std::string_view line);
+    void DefineLabel(std::string_view name, std::string_view line);
+    size_t SymbolIndex(std::string_view name);
+
+    ObjectFile obj_;
+    SectionKind curr_ = SectionKind::Text;
+    // Names are views of the source, which outlives the assembler.
+    std::unordered_map<std::string_view, Label> labels_;
+    std::unordered_map<std::string_view, size_t> symbols_;
+    std::vector<Fixup> fixups_;
+    std::vector<Operand> ops_;
+};
+
+void Assembler::Line(std::string_view line) {
+    auto text = Trim(line);
+    if (text.empty()) return;
+
+    if (text.back() == ':') {
+        DefineLabel(Trim(text.substr(0, text.size() - 1)), line);
+        return;
+    }
+
+    auto space = text.find_first_of(" \t");
+    auto name = text.substr(0, space);
+    auto rest = space == std::string_view::npos ? std::string_view()
+                                                : Trim(text.substr(space));
+    if (name.front() == '.') {
+        Directive(name, rest, line);
+        return;
+    }
+
+    ops_.clear();
+    while (!rest.empty()) {
+        // Commas inside parentheses separate base and index of memory.
+        auto comma = rest.find(',');
+        auto rparen = rest.find(')');
+        if (rest.find('(') < comma && rparen != std::string_view::npos) {
+            comma = rest.find(',', rparen);
+        }
+        ops_.emplace_back();
+        if (!ParseOperand(Trim(rest.substr(0, comma)), ops_.back())) {
+            FatalError("invalid operand in `{}`", Trim(line));
+        }
+        if (comma == std::string_view::npos) break;
+        rest = rest.substr(comma + 1);
+    }
+
+    auto &bytes = obj_.section(curr_).bytes;
+    Encoder encoder(bytes);
+    if (!encoder.Encode(name, ops_)) {
+        FatalError("cannot assemble `{}`", Trim(line));
+    }
+    if (auto &ref = encoder.symbol_ref()) {
+        fixups_.push_back(
+            {curr_, ref->offset, bytes.size(), ref->symbol, ref->branch});
+    }
+}
+
+void Assembler::Directive(std::string_view name, std::string_view args,
+                          std::string_view line) {
+    if (name == ".text") {
+        curr_ = SectionKind::Text;
+    } else if (name == ".section") {
+        if (args == ".text") {
+            curr_ = SectionKind::Text;
+        } else if (args == ".rodata") {
+            curr_ = SectionKind::Rodata;
+        } else {
+            FatalError("unknown section in `{}`", Trim(line));
+        }
+    } else if (name == ".global" || name == ".globl") {
+        obj_.symbols[SymbolIndex(args)].global = true;
+    } else if (name == ".type") {
+        auto comma = args.find(',');
+        if (comma == std::string_view::npos ||
+            Trim(args.substr(comma + 1)) != "@function") {
+            FatalError("unknown symbol type in `{}`", Trim(line));
+        }
+        obj_.symbols[SymbolIndex(Trim(args.substr(0, comma)))].function = true;
+    } else if (name == ".byte") {
+        auto &bytes = obj_.section(curr_).bytes;
+        while (!args.empty()) {
+            auto comma = args.find(',');
+            int64_t value;
+            if (!ParseInt(Trim(args.substr(0, comma)), value) ||
+                value < -128 || 255 < value) {
+                FatalError("invalid byte in `{}`", Trim(line));
+            }
+            bytes.push_back(uint8_t(value));
+            if (comma == std::string_view::npos) break;
+            args = Trim(args.substr(comma + 1));
+        }
+    } else {
+        FatalError("unknown directive in `{}`", Trim(line));
+    }
+}
+
+void Assembler::DefineLabel(std::string_view name, std::string_view line) {
+    uint64_t value = obj_.section(curr_).bytes.size();
+    if (IsLocalLabel(name)) {
+        if (!labels_.emplace(name, Label{curr_, value}).second) {
+            FatalError("label redefined in `{}`", Trim(line));
+        }
+        return;
+    }
+    auto &symbol = obj_.symbols[SymbolIndex(name)];
+    if (symbol.defined) FatalError("symbol redefined in `{}`", Trim(line));
+    symbol.defined = true;
+    symbol.section = curr_;
+    symbol.value = value;
+}
+
+size_t Assembler::SymbolIndex(std::string_view name) {
+    auto [it, inserted] = symbols_.emplace(name, obj_.symbols.size());
+    if (inserted) obj_.symbols.push_back(Symbol{std::string(name)});
+    return it->second;
+}
+
+ObjectFile Assembler::Finish() {
+    for (const auto &fixup : fixups_) {
+        auto &section = obj_.section(fixup.section);
+        uint8_t *field = section.bytes.data() + fixup.offset;
+        int32_t disp;
+        std::memcpy(&disp, field, sizeof(disp));
+        int64_t addend = disp + int64_t(fixup.offset) - int64_t(fixup.end);
+
+        // Where the target is known here, namely labels and symbols which
+        // are not visible from other objects.
+        std::optional<Label> target;
+        if (IsLocalLabel(fixup.symbol)) {
+            auto it = labels_.find(fixup.symbol);
+            if (it == labels_.end()) {
+                FatalError("undefined label `{}`", fixup.symbol);
+            }
+            target = it->second;
+        } else {
+            const auto &symbol = obj_.symbols[SymbolIndex(fixup.symbol)];
+            if (symbol.defined && !symbol.global) {
+                target = Label{symbol.section, symbol.value};
+            }
+        }
+
+        if (target && target->section == fixup.section) {
+            int64_t rel = int64_t(target->value) - int64_t(fixup.offset) + addend;
+            disp = int32_t(rel);
+            std::memcpy(field, &disp, sizeof(disp));
+            continue;
+        }
+
+        std::memset(field, 0, sizeof(disp));
+        if (target) {
+            section.relocs.push_back({fixup.offset, R_X86_64_PC32, true,
+                                      target->section, 0,
+                                      int64_t(target->value) + addend});
+        } else {
+            uint32_t type = fixup.branch ? R_X86_64_PLT32 : R_X86_64_PC32;
+            section.relocs.push_back({fixup.offset, type, false,
+                                      SectionKind::Text,
+                                      SymbolIndex(fixup.symbol), addend});
+        }
+    }
+
+    return std::move(obj_);
+}
+
+}  // namespace
+
+ObjectFile Assemble(std::string_view source) {
+    Assembler assembler;
+    while (!source.empty()) {
+        auto newline = source.find('\n');
+        assembler.Line(source.substr(0, newline));
+        if (newline == std::string_view::npos) break;
+        source.remove_prefix(newline + 1);
+    }
+    return assembler.Finish();
+}
+
+}  // namespace assembler
+
+}  // namespace mini
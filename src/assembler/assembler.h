@@ -0,0 +1,23 @@
+#ifndef MINI_ASSEMBLER_ASSEMBLER_H_
+#define MINI_ASSEMBLER_ASSEMBLER_H_
+
+#include <string_view>
+
+#include "object.h"
+
+namespace mini {
+
+namespace assembler {
+
+// Assembles x86-64 assembly in AT&T syntax, in the subset codegen emits.
+//
+// Jumps to local labels are resolved here; references to other symbols and
+// across sections are left to the linker as relocations. Anything this can't
+// assemble is a bug of codegen, so it's a fatal error.
+ObjectFile Assemble(std::string_view source);
+
+}  // namespace assembler
+
+}  // namespace mini
+
+#endif  // MINI_ASSEMBLER_ASSEMBLER_H_
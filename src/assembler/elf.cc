@@ -0,0 +1,201 @@
+#include "elf.h"
+
+#include <elf.h>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mini {
+
+namespace assembler {
+
+namespace {
+
+// Contents of .strtab and .shstrtab.
+class StringTable {
+public:
+    StringTable() : data_(1, '\0') {}
+
+    uint32_t Add(std::string_view s) {
+        uint32_t offset = data_.size();
+        data_.append(s);
+        data_.push_back('\0');
+        return offset;
+    }
+    inline const std::string &data() const { return data_; }
+
+private:
+    std::string data_;
+};
+
+// Indices of sections in the output, in this order.
+enum SectionIndex : uint16_t {
+    Null,
+    Text,
+    RelaText,
+    Rodata,
+    RelaRodata,
+    NoteGNUStack,
+    Symtab,
+    Strtab,
+    Shstrtab,
+    SectionCount,
+};
+
+constexpr std::string_view section_names[SectionCount] = {
+    "", ".text", ".rela.text", ".rodata",
+    ".rela.rodata", ".note.GNU-stack", ".symtab", ".strtab",
+    ".shstrtab",
+};
+
+uint16_t IndexOf(SectionKind kind) {
+    return kind == SectionKind::Text ? Text : Rodata;
+}
+
+class ElfWriter {
+public:
+    explicit ElfWriter(const ObjectFile &obj) : obj_(obj) {
+        for (uint16_t i = Text; i < SectionCount; i++) {
+            headers_[i].sh_name = shstrtab_.Add(section_names[i]);
+        }
+    }
+    void Write(std::ostream &os);
+
+private:
+    void BuildSymtab();
+    std::string Rela(const Section &section) const;
+    void AddSection(SectionIndex index, uint32_t type, uint64_t flags,
+                    std::string_view data, uint64_t align, uint32_t link = 0,
+                    uint32_t info = 0, uint64_t entsize = 0);
+
+    const ObjectFile &obj_;
+    std::string body_;
+    Elf64_Shdr headers_[SectionCount] = {};
+    StringTable shstrtab_;
+    StringTable strtab_;
+    std::string symtab_;
+    std::vector<uint32_t> symbol_map_;  // Index in ObjectFile to in .symtab.
+    uint32_t first_global_ = 0;
+};
+
+void ElfWriter::Write(std::ostream &os) {
+    BuildSymtab();
+
+    auto view = [](const std::vector<uint8_t> &bytes) {
+        return std::string_view(reinterpret_cast<const char *>(bytes.data()),
+                                bytes.size());
+    };
+    AddSection(Text, SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR,
+               view(obj_.text.bytes), 1);
+    AddSection(RelaText, SHT_RELA, SHF_INFO_LINK, Rela(obj_.text), 8, Symtab,
+               Text, sizeof(Elf64_Rela));
+    AddSection(Rodata, SHT_PROGBITS, SHF_ALLOC, view(obj_.rodata.bytes), 1);
+    AddSection(RelaRodata, SHT_RELA, SHF_INFO_LINK, Rela(obj_.rodata), 8,
+               Symtab, Rodata, sizeof(Elf64_Rela));
+    // The stack needs not to be executable.
+    AddSection(NoteGNUStack, SHT_PROGBITS, 0, "", 1);
+    AddSection(Symtab, SHT_SYMTAB, 0, symtab_, 8, Strtab, first_global_,
+               sizeof(Elf64_Sym));
+    AddSection(Strtab, SHT_STRTAB, 0, strtab_.data(), 1);
+    AddSection(Shstrtab, SHT_STRTAB, 0, shstrtab_.data(), 1);
+
+    while (body_.size() % 8 != 0) body_.push_back('\0');
+    Elf64_Ehdr ehdr = {};
+    std::memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    ehdr.e_type = ET_REL;
+    ehdr.e_machine = EM_X86_64;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_shoff = sizeof(Elf64_Ehdr) + body_.size();
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = SectionCount;
+    ehdr.e_shstrndx = Shstrtab;
+
+    os.write(reinterpret_cast<const char *>(&ehdr), sizeof(ehdr));
+    os.write(body_.data(), body_.size());
+    os.write(reinterpret_cast<const char *>(headers_), sizeof(headers_));
+}
+
+// Locals precede globals in .symtab: first section symbols so that
+// relocations can refer to sections, then local symbols, then globals.
+// Referenced but not defined symbols are globals defined elsewhere.
+void ElfWriter::BuildSymtab() {
+    auto add = [&](uint32_t name, unsigned char info, uint16_t shndx,
+                   uint64_t value) {
+        Elf64_Sym sym = {};
+        sym.st_name = name;
+        sym.st_info = info;
+        sym.st_shndx = shndx;
+        sym.st_value = value;
+        symtab_.append(reinterpret_cast<const char *>(&sym), sizeof(sym));
+        return uint32_t(symtab_.size() / sizeof(sym) - 1);
+    };
+
+    add(0, 0, SHN_UNDEF, 0);
+    add(0, ELF64_ST_INFO(STB_LOCAL, STT_SECTION), Text, 0);
+    add(0, ELF64_ST_INFO(STB_LOCAL, STT_SECTION), Rodata, 0);
+
+    symbol_map_.resize(obj_.symbols.size());
+    for (bool global : {false, true}) {
+        if (global) first_global_ = symtab_.size() / sizeof(Elf64_Sym);
+        for (size_t i = 0; i < obj_.symbols.size(); i++) {
+            const auto &symbol = obj_.symbols[i];
+            if ((symbol.global || !symbol.defined) != global) continue;
+            auto bind = global ? STB_GLOBAL : STB_LOCAL;
+            auto type = symbol.function ? STT_FUNC : STT_NOTYPE;
+            uint16_t shndx =
+                symbol.defined ? IndexOf(symbol.section) : uint16_t(SHN_UNDEF);
+            symbol_map_[i] = add(strtab_.Add(symbol.name),
+                                 ELF64_ST_INFO(bind, type), shndx,
+                                 symbol.defined ? symbol.value : 0);
+        }
+    }
+}
+
+std::string ElfWriter::Rela(const Section &section) const {
+    std::string data;
+    for (const auto &reloc : section.relocs) {
+        // Section symbols are right after the null symbol.
+        uint32_t sym = reloc.to_section
+                           ? (reloc.section == SectionKind::Text ? 1 : 2)
+                           : symbol_map_[reloc.symbol];
+        Elf64_Rela rela = {};
+        rela.r_offset = reloc.offset;
+        rela.r_info = ELF64_R_INFO(sym, reloc.type);
+        rela.r_addend = reloc.addend;
+        data.append(reinterpret_cast<const char *>(&rela), sizeof(rela));
+    }
+    return data;
+}
+
+void ElfWriter::AddSection(SectionIndex index, uint32_t type, uint64_t flags,
+                           std::string_view data, uint64_t align, uint32_t link,
+                           uint32_t info, uint64_t entsize) {
+    while (body_.size() % align != 0) body_.push_back('\0');
+    auto &shdr = headers_[index];
+    shdr.sh_type = type;
+    shdr.sh_flags = flags;
+    shdr.sh_offset = sizeof(Elf64_Ehdr) + body_.size();
+    shdr.sh_size = data.size();
+    shdr.sh_link = link;
+    shdr.sh_info = info;
+    shdr.sh_addralign = align;
+    shdr.sh_entsize = entsize;
+    body_.append(data);
+}
+
+}  // namespace
+
+void WriteElf(const ObjectFile &obj, std::ostream &os) {
+    ElfWriter(obj).Write(os);
+}
+
+}  // namespace assembler
+
+}  // namespace mini
@@ -0,0 +1,19 @@
+#ifndef MINI_ASSEMBLER_ELF_H_
+#define MINI_ASSEMBLER_ELF_H_
+
+#include <ostream>
+
+#include "object.h"
+
+namespace mini {
+
+namespace assembler {
+
+// Writes `obj` as an ELF64 relocatable object for x86-64.
+void WriteElf(const ObjectFile &obj, std::ostream &os);
+
+}  // namespace assembler
+
+}  // namespace mini
+
+#endif  // MINI_ASSEMBLER_ELF_H_
@@ -0,0 +1,472 @@
+#include "encoder.h"
+
+#include <unordered_map>
+
+namespace mini {
+
+namespace assembler {
+
+namespace {
+
+enum class Kind {
+    Alu,     // add, or, and, sub, xor and cmp; `arg` is the opcode extension.
+    Test,
+    Mov,
+    Lea,
+    Push,
+    Pop,
+    Unary,   // not, neg, mul, imul, div and idiv; `arg` is the extension.
+             // imul also takes two or three operands.
+    Shift,   // `arg` is the opcode extension.
+    Setcc,   // `arg` is the condition code.
+    Jcc,     // `arg` is the condition code.
+    Jmp,
+    Call,
+    Fixed,   // No operand; `bytes` is the whole encoding.
+};
+
+struct Instruction {
+    Kind kind;
+    uint8_t arg = 0;
+    std::string_view bytes = {};
+};
+
+// Instructions by mnemonic without size suffix.
+const std::unordered_map<std::string_view, Instruction> instructions = {
+    {"add", {Kind::Alu, 0}},
+    {"or", {Kind::Alu, 1}},
+    {"and", {Kind::Alu, 4}},
+    {"sub", {Kind::Alu, 5}},
+    {"xor", {Kind::Alu, 6}},
+    {"cmp", {Kind::Alu, 7}},
+    {"test", {Kind::Test}},
+    {"mov", {Kind::Mov}},
+    {"lea", {Kind::Lea}},
+    {"push", {Kind::Push}},
+    {"pop", {Kind::Pop}},
+    {"not", {Kind::Unary, 2}},
+    {"neg", {Kind::Unary, 3}},
+    {"mul", {Kind::Unary, 4}},
+    {"imul", {Kind::Unary, 5}},
+    {"div", {Kind::Unary, 6}},
+    {"idiv", {Kind::Unary, 7}},
+    {"shl", {Kind::Shift, 4}},
+    {"sal", {Kind::Shift, 4}},
+    {"shr", {Kind::Shift, 5}},
+    {"sar", {Kind::Shift, 7}},
+    {"sete", {Kind::Setcc, 0x4}},
+    {"setne", {Kind::Setcc, 0x5}},
+    {"setb", {Kind::Setcc, 0x2}},
+    {"setae", {Kind::Setcc, 0x3}},
+    {"setbe", {Kind::Setcc, 0x6}},
+    {"seta", {Kind::Setcc, 0x7}},
+    {"setl", {Kind::Setcc, 0xc}},
+    {"setge", {Kind::Setcc, 0xd}},
+    {"setle", {Kind::Setcc, 0xe}},
+    {"setg", {Kind::Setcc, 0xf}},
+    {"je", {Kind::Jcc, 0x4}},
+    {"jne", {Kind::Jcc, 0x5}},
+    {"jb", {Kind::Jcc, 0x2}},
+    {"jae", {Kind::Jcc, 0x3}},
+    {"jbe", {Kind::Jcc, 0x6}},
+    {"ja", {Kind::Jcc, 0x7}},
+    {"jl", {Kind::Jcc, 0xc}},
+    {"jge", {Kind::Jcc, 0xd}},
+    {"jle", {Kind::Jcc, 0xe}},
+    {"jg", {Kind::Jcc, 0xf}},
+    {"jmp", {Kind::Jmp}},
+    {"call", {Kind::Call}},
+    {"ret", {Kind::Fixed, 0, "\xc3"}},
+    {"cqo", {Kind::Fixed, 0, "\x48\x99"}},
+    {"cdq", {Kind::Fixed, 0, "\x99"}},
+    {"cwd", {Kind::Fixed, 0, "\x66\x99"}},
+    {"syscall", {Kind::Fixed, 0, "\x0f\x05"}},
+};
+
+uint8_t SuffixSize(char suffix) {
+    switch (suffix) {
+        case 'b':
+            return 1;
+        case 'w':
+            return 2;
+        case 'l':
+            return 4;
+        case 'q':
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+bool FitsInt8(int64_t value) { return -128 <= value && value <= 127; }
+
+bool FitsInt32(int64_t value) {
+    return INT32_MIN <= value && value <= INT32_MAX;
+}
+
+// Truncates an immediate to `size` bytes and sign-extends it back, as the
+// processor sees it. Returns false if it doesn't fit in either signed or
+// unsigned `size` bytes. 8-byte operands only take sign-extended 4 bytes.
+bool NormalizeImm(int64_t &value, uint8_t size) {
+    if (size == 8) return FitsInt32(value);
+    int bits = size * 8;
+    int64_t min = -(int64_t(1) << (bits - 1));
+    int64_t max = (int64_t(1) << bits) - 1;
+    if (value < min || max < value) return false;
+    uint64_t mask = (uint64_t(1) << bits) - 1;
+    uint64_t sign = uint64_t(1) << (bits - 1);
+    value = int64_t(((uint64_t(value) & mask) ^ sign) - sign);
+    return true;
+}
+
+bool IsReg(const Operand &op, uint8_t size) {
+    return op.kind == Operand::Register && op.reg.size == size;
+}
+
+bool IsRM(const Operand &op, uint8_t size) {
+    return IsReg(op, size) || op.kind == Operand::Memory;
+}
+
+bool IsCL(const Operand &op) {
+    return IsReg(op, 1) && op.reg.num == 1 && !op.reg.high;
+}
+
+// Byte registers %spl, %bpl, %sil and %dil are only reachable with REX, and
+// %ah, %ch, %dh and %bh only without it.
+bool NeedsRex(const Reg &reg) {
+    return reg.size == 1 && !reg.high && 4 <= reg.num && reg.num < 8;
+}
+
+}  // namespace
+
+bool Encoder::Encode(std::string_view mnemonic,
+                     const std::vector<Operand> &ops) {
+    symbol_ref_.reset();
+
+    // movzbq, movswl, movslq and so on.
+    if (mnemonic.size() == 6 &&
+        (mnemonic.substr(0, 4) == "movz" || mnemonic.substr(0, 4) == "movs")) {
+        bool sign = mnemonic[3] == 's';
+        uint8_t from = SuffixSize(mnemonic[4]);
+        uint8_t to = SuffixSize(mnemonic[5]);
+        if (from == 0 || to <= from || ops.size() != 2) return false;
+        if (!IsRM(ops[0], from) || !IsReg(ops[1], to)) return false;
+        if (from == 4) {
+            if (!sign || to != 8) return false;
+            return EncodeRM(8, {0x63}, ops[1].reg.num, &ops[1].reg, ops[0]);
+        }
+        uint8_t opcode = (sign ? 0xbe : 0xb6) + (from == 2 ? 1 : 0);
+        return EncodeRM(to, {0x0f, opcode}, ops[1].reg.num, &ops[1].reg,
+                        ops[0]);
+    }
+
+    // Most mnemonics have size suffix, so try without it first. No mnemonic
+    // in the table is another one followed by a suffix.
+    uint8_t size = mnemonic.empty() ? 0 : SuffixSize(mnemonic.back());
+    auto it = instructions.end();
+    if (size != 0) {
+        it = instructions.find(mnemonic.substr(0, mnemonic.size() - 1));
+    }
+    if (it == instructions.end()) {
+        size = 0;
+        it = instructions.find(mnemonic);
+    }
+    if (it == instructions.end()) return false;
+    const auto &inst = it->second;
+
+    // Without suffix, the size is taken from register operands.
+    if (size == 0) {
+        for (const auto &op : ops) {
+            if (op.kind == Operand::Register) size = op.reg.size;
+        }
+    }
+
+    switch (inst.kind) {
+        case Kind::Alu:
+        case Kind::Test: {
+            if (ops.size() != 2 || size == 0) return false;
+            const auto &src = ops[0], &dst = ops[1];
+            bool test = inst.kind == Kind::Test;
+            if (src.kind == Operand::Immediate) {
+                if (!IsRM(dst, size)) return false;
+                int64_t imm = src.value;
+                if (!NormalizeImm(imm, size)) return false;
+                if (size == 1) {
+                    if (!EncodeRM(1, {uint8_t(test ? 0xf6 : 0x80)},
+                                  test ? 0 : inst.arg, nullptr, dst))
+                        return false;
+                    EmitImm(imm, 1);
+                } else if (!test && FitsInt8(imm)) {
+                    if (!EncodeRM(size, {0x83}, inst.arg, nullptr, dst))
+                        return false;
+                    EmitImm(imm, 1);
+                } else {
+                    if (!EncodeRM(size, {uint8_t(test ? 0xf7 : 0x81)},
+                                  test ? 0 : inst.arg, nullptr, dst))
+                        return false;
+                    EmitImm(imm, size == 2 ? 2 : 4);
+                }
+                return true;
+            }
+            uint8_t base = test ? 0x84 : inst.arg * 8;
+            uint8_t wide = size == 1 ? 0 : 1;
+            if (IsReg(src, size) && IsRM(dst, size)) {
+                return EncodeRM(size, {uint8_t(base + wide)}, src.reg.num,
+                                &src.reg, dst);
+            } else if (IsRM(src, size) && IsReg(dst, size)) {
+                // test is commutative, so it has no opcode of this direction.
+                uint8_t opcode = test ? base + wide : base + 2 + wide;
+                return EncodeRM(size, {opcode}, dst.reg.num, &dst.reg, src);
+            }
+            return false;
+        }
+        case Kind::Mov: {
+            if (ops.size() != 2 || size == 0) return false;
+            const auto &src = ops[0], &dst = ops[1];
+            uint8_t wide = size == 1 ? 0 : 1;
+            if (src.kind == Operand::Immediate) {
+                int64_t imm = src.value;
+                if (size == 8 && IsReg(dst, 8) && !FitsInt32(imm)) {
+                    // movabs, the only instruction takes 8-byte immediate.
+                    if (!EncodeOpReg(8, 0xb8, dst.reg)) return false;
+                    EmitImm(imm, 8);
+                    return true;
+                }
+                if (!NormalizeImm(imm, size)) return false;
+                if (IsReg(dst, size) && size != 8) {
+                    if (!EncodeOpReg(size, wide ? 0xb8 : 0xb0, dst.reg))
+                        return false;
+                    EmitImm(imm, size);
+                    return true;
+                } else if (IsRM(dst, size)) {
+                    if (!EncodeRM(size, {uint8_t(0xc6 + wide)}, 0, nullptr,
+                                  dst))
+                        return false;
+                    EmitImm(imm, size == 8 ? 4 : size);
+                    return true;
+                }
+                return false;
+            } else if (IsReg(src, size) && IsRM(dst, size)) {
+                return EncodeRM(size, {uint8_t(0x88 + wide)}, src.reg.num,
+                                &src.reg, dst);
+            } else if (IsRM(src, size) && IsReg(dst, size)) {
+                return EncodeRM(size, {uint8_t(0x8a + wide)}, dst.reg.num,
+                                &dst.reg, src);
+            }
+            return false;
+        }
+        case Kind::Lea: {
+            if (ops.size() != 2 || ops[0].kind != Operand::Memory ||
+                !IsReg(ops[1], size) || size == 1)
+                return false;
+            return EncodeRM(size, {0x8d}, ops[1].reg.num, &ops[1].reg, ops[0]);
+        }
+        case Kind::Push:
+        case Kind::Pop: {
+            // Operand size is 8 bytes by default, so REX.W is not needed.
+            if (ops.size() != 1 || (size != 8 && size != 0)) return false;
+            const auto &op = ops[0];
+            bool push = inst.kind == Kind::Push;
+            if (IsReg(op, 8)) {
+                return EncodeOpReg(0, push ? 0x50 : 0x58, op.reg);
+            } else if (op.kind == Operand::Memory) {
+                return push ? EncodeRM(0, {0xff}, 6, nullptr, op)
+                            : EncodeRM(0, {0x8f}, 0, nullptr, op);
+            } else if (push && op.kind == Operand::Immediate) {
+                if (FitsInt8(op.value)) {
+                    out_.push_back(0x6a);
+                    EmitImm(op.value, 1);
+                    return true;
+                } else if (FitsInt32(op.value)) {
+                    out_.push_back(0x68);
+                    EmitImm(op.value, 4);
+                    return true;
+                }
+            }
+            return false;
+        }
+        case Kind::Unary: {
+            if (mnemonic.substr(0, 4) == "imul" && ops.size() >= 2) {
+                // imul with two or three operands truncates the product to
+                // the size of the destination.
+                const auto &dst = ops.back();
+                const auto &src = ops.size() == 3 ? ops[1] : dst;
+                if (size < 2 || !IsReg(dst, size) || !IsRM(src, size))
+                    return false;
+                if (ops[0].kind != Operand::Immediate) {
+                    if (ops.size() != 2 || !IsRM(ops[0], size)) return false;
+                    return EncodeRM(size, {0x0f, 0xaf}, dst.reg.num, &dst.reg,
+                                    ops[0]);
+                }
+                int64_t imm = ops[0].value;
+                if (!NormalizeImm(imm, size)) return false;
+                if (FitsInt8(imm)) {
+                    if (!EncodeRM(size, {0x6b}, dst.reg.num, &dst.reg, src))
+                        return false;
+                    EmitImm(imm, 1);
+                } else {
+                    if (!EncodeRM(size, {0x69}, dst.reg.num, &dst.reg, src))
+                        return false;
+                    EmitImm(imm, size == 2 ? 2 : 4);
+                }
+                return true;
+            }
+            if (ops.size() != 1 || size == 0 || !IsRM(ops[0], size))
+                return false;
+            return EncodeRM(size, {uint8_t(size == 1 ? 0xf6 : 0xf7)}, inst.arg,
+                            nullptr, ops[0]);
+        }
+        case Kind::Shift: {
+            if (ops.empty() || ops.size() > 2 || size == 0) return false;
+            const auto &dst = ops.back();
+            if (!IsRM(dst, size)) return false;
+            uint8_t wide = size == 1 ? 0 : 1;
+            if (ops.size() == 1 ||
+                (ops[0].kind == Operand::Immediate && ops[0].value == 1)) {
+                return EncodeRM(size, {uint8_t(0xd0 + wide)}, inst.arg,
+                                nullptr, dst);
+            } else if (IsCL(ops[0])) {
+                return EncodeRM(size, {uint8_t(0xd2 + wide)}, inst.arg,
+                                nullptr, dst);
+            } else if (ops[0].kind == Operand::Immediate &&
+                       0 <= ops[0].value && ops[0].value < 256) {
+                if (!EncodeRM(size, {uint8_t(0xc0 + wide)}, inst.arg, nullptr,
+                              dst))
+                    return false;
+                EmitImm(ops[0].value, 1);
+                return true;
+            }
+            return false;
+        }
+        case Kind::Setcc: {
+            if (ops.size() != 1 || !IsRM(ops[0], 1)) return false;
+            return EncodeRM(0, {0x0f, uint8_t(0x90 + inst.arg)}, 0, nullptr,
+                            ops[0]);
+        }
+        case Kind::Jcc: {
+            if (ops.size() != 1 || size != 0) return false;
+            return EncodeRel32({0x0f, uint8_t(0x80 + inst.arg)}, ops[0]);
+        }
+        case Kind::Jmp:
+        case Kind::Call: {
+            if (ops.size() != 1 || (size != 0 && size != 8)) return false;
+            return EncodeRel32({uint8_t(inst.kind == Kind::Jmp ? 0xe9 : 0xe8)},
+                               ops[0]);
+        }
+        case Kind::Fixed: {
+            // retq is the only one which is written with suffix.
+            if (!ops.empty() || (size != 0 && mnemonic != "retq"))
+                return false;
+            for (char c : inst.bytes) out_.push_back(uint8_t(c));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Encodes prefixes, `opcode` and ModRM with operands, without immediate.
+// `reg_field` is the register in the reg field of ModRM, or the opcode
+// extension if `reg` is null. With `size` of 0, the operand size is the default
+// of the instruction and no prefix is emitted for it.
+bool Encoder::EncodeRM(uint8_t size, std::initializer_list<uint8_t> opcode,
+                       uint8_t reg_field, const Reg *reg, const Operand &rm) {
+    uint8_t rex = size == 8 ? 0x08 : 0;
+    bool need_rex = false, deny_rex = false;
+    if (reg) {
+        if (reg->num >= 8) rex |= 0x04;
+        need_rex |= NeedsRex(*reg);
+        deny_rex |= reg->high;
+    }
+    if (rm.kind == Operand::Register) {
+        if (rm.reg.num >= 8) rex |= 0x01;
+        need_rex |= NeedsRex(rm.reg);
+        deny_rex |= rm.reg.high;
+    } else if (rm.kind == Operand::Memory) {
+        if (!rm.rip && rm.reg.size != 8) return false;
+        if (!rm.rip && rm.reg.num >= 8) rex |= 0x01;
+        if (rm.has_index) {
+            // %rsp can't be an index, as it means no index in SIB.
+            if (rm.index.size != 8 || rm.index.num == 4) return false;
+            if (rm.index.num >= 8) rex |= 0x02;
+        }
+    } else {
+        return false;
+    }
+    if ((rex || need_rex) && deny_rex) return false;
+
+    if (size == 2) out_.push_back(0x66);
+    if (rex || need_rex) out_.push_back(0x40 | rex);
+    out_.insert(out_.end(), opcode.begin(), opcode.end());
+
+    uint8_t reg_bits = (reg_field & 7) << 3;
+    if (rm.kind == Operand::Register) {
+        out_.push_back(0xc0 | reg_bits | (rm.reg.num & 7));
+        return true;
+    }
+
+    if (rm.rip) {
+        out_.push_back(reg_bits | 0x05);
+        if (!rm.symbol.empty()) {
+            symbol_ref_ = SymbolRef{out_.size(), rm.symbol, false};
+        }
+        if (!FitsInt32(rm.value)) return false;
+        EmitImm(rm.value, 4);
+        return true;
+    }
+
+    // Base of %rsp or %r12 needs SIB, and of %rbp or %r13 can't omit
+    // displacement.
+    uint8_t base = rm.reg.num & 7;
+    uint8_t mod;
+    if (rm.value == 0 && base != 5) {
+        mod = 0x00;
+    } else if (FitsInt8(rm.value)) {
+        mod = 0x40;
+    } else if (FitsInt32(rm.value)) {
+        mod = 0x80;
+    } else {
+        return false;
+    }
+    if (rm.has_index) {
+        static constexpr uint8_t scale_bits[9] = {0, 0, 1, 0, 2, 0, 0, 0, 3};
+        out_.push_back(mod | reg_bits | 0x04);
+        out_.push_back(scale_bits[rm.scale] << 6 | (rm.index.num & 7) << 3 |
+                       base);
+    } else {
+        out_.push_back(mod | reg_bits | base);
+        if (base == 4) out_.push_back(0x24);
+    }
+    if (mod == 0x40) EmitImm(rm.value, 1);
+    if (mod == 0x80) EmitImm(rm.value, 4);
+    return true;
+}
+
+// Encodes an instruction whose register is in the low bits of `opcode`.
+bool Encoder::EncodeOpReg(uint8_t size, uint8_t opcode, const Reg &reg) {
+    uint8_t rex = (size == 8 ? 0x08 : 0) | (reg.num >= 8 ? 0x01 : 0);
+    bool need_rex = NeedsRex(reg);
+    if ((rex || need_rex) && reg.high) return false;
+    if (size == 2) out_.push_back(0x66);
+    if (rex || need_rex) out_.push_back(0x40 | rex);
+    out_.push_back(opcode + (reg.num & 7));
+    return true;
+}
+
+bool Encoder::EncodeRel32(std::initializer_list<uint8_t> opcode,
+                          const Operand &target) {
+    if (target.kind != Operand::Label) return false;
+    out_.insert(out_.end(), opcode.begin(), opcode.end());
+    symbol_ref_ = SymbolRef{out_.size(), target.symbol, true};
+    EmitImm(0, 4);
+    return true;
+}
+
+void Encoder::EmitImm(int64_t value, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++) {
+        out_.push_back(uint8_t(uint64_t(value) >> (i * 8)));
+    }
+}
+
+}  // namespace assembler
+
+}  // namespace mini
@@ -0,0 +1,78 @@
+#ifndef MINI_ASSEMBLER_ENCODER_H_
+#define MINI_ASSEMBLER_ENCODER_H_
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace mini {
+
+namespace assembler {
+
+// A general purpose register of x86-64, as it's encoded.
+struct Reg {
+    uint8_t num;   // 0 to 15, in the order of encoding.
+    uint8_t size;  // 1, 2, 4 or 8.
+    bool high;     // One of %ah, %ch, %dh and %bh; `num` is 4 to 7.
+};
+
+// An operand of instruction in AT&T syntax.
+struct Operand {
+    enum Kind {
+        Register,   // %rax
+        Immediate,  // $42
+        Memory,     // -8(%rbp), .L.0(%rip), (%rax,%rcx,4)
+        Label,      // main, .L.END.0
+    };
+
+    Kind kind;
+    Reg reg;                  // Register, or the base of Memory.
+    bool has_index;           // Memory has an index register.
+    Reg index;                // The index of Memory.
+    uint8_t scale;            // 1, 2, 4 or 8, by which the index is scaled.
+    bool rip;                 // Memory is relative to %rip.
+    int64_t value;            // Immediate, or the displacement of Memory.
+    std::string_view symbol;  // Label, or the displacement of Memory.
+};
+
+// A 32-bit field of encoded instruction which refers to a symbol, relative to
+// the end of the instruction.
+struct SymbolRef {
+    uint64_t offset;
+    std::string_view symbol;
+    bool branch;  // Target of jmp, jcc or call rather than data.
+};
+
+// Encodes instructions into machine code.
+class Encoder {
+public:
+    explicit Encoder(std::vector<uint8_t> &out) : out_(out) {}
+
+    // Appends the encoding of an instruction to the output. Returns false if
+    // the instruction is unknown or its operands are not valid for it.
+    bool Encode(std::string_view mnemonic, const std::vector<Operand> &ops);
+
+    // Reference to a symbol in the last encoded instruction, if any.
+    inline const std::optional<SymbolRef> &symbol_ref() const {
+        return symbol_ref_;
+    }
+
+private:
+    bool EncodeRM(uint8_t size, std::initializer_list<uint8_t> opcode,
+                  uint8_t reg_field, const Reg *reg, const Operand &rm);
+    bool EncodeOpReg(uint8_t size, uint8_t opcode, const Reg &reg);
+    bool EncodeRel32(std::initializer_list<uint8_t> opcode,
+                     const Operand &target);
+    void EmitImm(int64_t value, uint8_t size);
+
+    std::vector<uint8_t> &out_;
+    std::optional<SymbolRef> symbol_ref_;
+};
+
+}  // namespace assembler
+
+}  // namespace mini
+
+#endif  // MINI_ASSEMBLER_ENCODER_H_
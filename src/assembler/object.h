@@ -0,0 +1,66 @@
+#ifndef MINI_ASSEMBLER_OBJECT_H_
+#define MINI_ASSEMBLER_OBJECT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mini {
+
+namespace assembler {
+
+// Sections of a relocatable object which codegen emits into.
+enum class SectionKind : uint8_t {
+    Text,
+    Rodata,
+};
+
+// A place in a section which the linker must fill in.
+struct Relocation {
+    uint64_t offset;
+    uint32_t type;  // One of R_X86_64_*.
+
+    // Index of the target in `ObjectFile::symbols`, or the section itself
+    // when `to_section` is set.
+    bool to_section;
+    SectionKind section;
+    size_t symbol;
+
+    int64_t addend;
+};
+
+struct Section {
+    std::vector<uint8_t> bytes;
+    std::vector<Relocation> relocs;
+};
+
+// A symbol visible to the linker. Local labels, those start with `.L`, are
+// resolved by the assembler and never become a symbol.
+struct Symbol {
+    std::string name;
+    bool defined = false;
+    SectionKind section = SectionKind::Text;
+    uint64_t value = 0;
+    bool global = false;
+    bool function = false;
+};
+
+// Result of assembling, independent of the format of object file.
+struct ObjectFile {
+    Section text;
+    Section rodata;
+    std::vector<Symbol> symbols;
+
+    inline Section &section(SectionKind kind) {
+        return kind == SectionKind::Text ? text : rodata;
+    }
+    inline const Section &section(SectionKind kind) const {
+        return kind == SectionKind::Text ? text : rodata;
+    }
+};
+
+}  // namespace assembler
+
+}  // namespace mini
+
+#endif  // MINI_ASSEMBLER_OBJECT_H_
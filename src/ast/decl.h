@@ -6,6 +6,7 @@
 #include <string>
 #include <variant>
 
+#include "../symbol.h"
 #include "expr.h"
 #include "node.h"
 #include "stmt.h"
@@ -33,27 +34,44 @@ public:
     virtual void Accept(DeclarationVisitor& visitor) const = 0;
 };
 
+// `inline` or `noinline` before `function`.
+class FunctionDeclarationInline : public Node {
+public:
+    enum Kind {
+        Inline,    // "inline"
+        NoInline,  // "noinline"
+    };
+    FunctionDeclarationInline(Kind kind, Span span)
+        : kind_(kind), span_(span) {}
+    inline Span span() const override { return span_; }
+    inline Kind kind() const { return kind_; }
+
+private:
+    Kind kind_;
+    Span span_;
+};
+
 class FunctionDeclarationName : public Node {
 public:
-    FunctionDeclarationName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    FunctionDeclarationName(Symbol name, Span span)
+        : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
 class FunctionDeclarationParamName : public Node {
 public:
-    FunctionDeclarationParamName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    FunctionDeclarationParamName(Symbol name, Span span)
+        : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
@@ -118,7 +136,8 @@ private:
 
 class FunctionDeclaration : public Declaration {
 public:
-    FunctionDeclaration(Function function_kw, FunctionDeclarationName&& name,
+    FunctionDeclaration(std::optional<FunctionDeclarationInline> inline_attr,
+                        Function function_kw, FunctionDeclarationName&& name,
                         LParen lparen,
                         std::vector<FunctionDeclarationParam>&& params,
                         std::optional<FunctionDeclarationVariadic> variadic,
@@ -132,12 +151,17 @@ public:
           variadic_(variadic),
           rparen_(rparen),
           ret_(std::move(ret)),
-          body_(std::move(body)) {}
+          body_(std::move(body)),
+          inline_attr_(inline_attr) {}
     inline void Accept(DeclarationVisitor& visitor) const override {
         visitor.Visit(*this);
     }
     inline Span span() const override {
-        return function_kw_.span() + body_.span();
+        auto begin = inline_attr_ ? inline_attr_->span() : function_kw_.span();
+        return begin + body_.span();
+    }
+    inline std::optional<FunctionDeclarationInline> inline_attr() const {
+        return inline_attr_;
     }
     inline Function function_kw() const { return function_kw_; }
     inline const FunctionDeclarationName& name() const { return name_; }
@@ -161,29 +185,29 @@ private:
     RParen rparen_;
     std::optional<FunctionDeclarationReturn> ret_;
     FunctionDeclarationBody body_;
+    std::optional<FunctionDeclarationInline> inline_attr_;
 };
 
 class StructDeclarationName : public Node {
 public:
-    StructDeclarationName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    StructDeclarationName(Symbol name, Span span) : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
 class StructDeclarationFieldName : public Node {
 public:
-    StructDeclarationFieldName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    StructDeclarationFieldName(Symbol name, Span span)
+        : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
@@ -237,25 +261,24 @@ private:
 
 class EnumDeclarationName : public Node {
 public:
-    EnumDeclarationName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    EnumDeclarationName(Symbol name, Span span) : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
 class EnumDeclarationFieldName : public Node {
 public:
-    EnumDeclarationFieldName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    EnumDeclarationFieldName(Symbol name, Span span)
+        : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "../symbol.h"
 #include "node.h"
 #include "type.h"
 
@@ -195,13 +196,12 @@ private:
 
 class AccessExpressionField : public Node {
 public:
-    AccessExpressionField(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    AccessExpressionField(Symbol name, Span span) : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
@@ -281,25 +281,25 @@ private:
 
 class EnumSelectExpressionDst : public Node {
 public:
-    EnumSelectExpressionDst(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    EnumSelectExpressionDst(Symbol name, Span span)
+        : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
 class EnumSelectExpressionSrc : public Node {
 public:
-    EnumSelectExpressionSrc(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    EnumSelectExpressionSrc(Symbol name, Span span)
+        : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
@@ -326,16 +326,15 @@ private:
 
 class VariableExpression : public Expression {
 public:
-    VariableExpression(std::string&& value, Span span)
-        : value_(std::move(value)), span_(span) {}
+    VariableExpression(Symbol value, Span span) : value_(value), span_(span) {}
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
     inline Span span() const override { return span_; }
-    inline const std::string& value() const { return value_; }
+    inline Symbol value() const { return value_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -410,25 +409,24 @@ private:
 
 class StructExpressionName : public Node {
 public:
-    StructExpressionName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    StructExpressionName(Symbol name, Span span) : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
 class StructExpressionInitName : public Node {
 public:
-    StructExpressionInitName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    StructExpressionInitName(Symbol name, Span span)
+        : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
@@ -1,6 +1,9 @@
 #ifndef MINI_AST_NODE_H_
 #define MINI_AST_NODE_H_
 
+#include <cstddef>
+
+#include "../arena.h"
 #include "../span.h"
 
 namespace mini {
@@ -19,6 +22,13 @@ namespace ast {
 
 class Node {
 public:
+    // Nodes live in the current ast arena and are freed along with it.
+    static void *operator new(size_t size) {
+        return CurrentArena(ArenaKind::Ast)
+            .Allocate(size, alignof(std::max_align_t));
+    }
+    static void operator delete(void *) {}
+
     virtual ~Node() {}
     virtual Span span() const = 0;
 };
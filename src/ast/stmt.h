@@ -7,6 +7,7 @@
 #include <variant>
 #include <vector>
 
+#include "../symbol.h"
 #include "node.h"
 #include "type.h"
 
@@ -193,13 +194,12 @@ private:
 
 class VariableName : public Node {
 public:
-    VariableName(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    VariableName(Symbol name, Span span) : name_(name), span_(span) {}
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 
+#include "../symbol.h"
 #include "node.h"
 
 namespace mini {
@@ -111,16 +112,15 @@ private:
 
 class NameType : public Type {
 public:
-    NameType(std::string&& name, Span span)
-        : name_(std::move(name)), span_(span) {}
+    NameType(Symbol name, Span span) : name_(name), span_(span) {}
     inline void Accept(TypeVisitor& visitor) const override {
         visitor.Visit(*this);
     }
     inline Span span() const override { return span_; }
-    inline const std::string& name() const { return name_; }
+    inline Symbol name() const { return name_; }
 
 private:
-    std::string name_;
+    Symbol name_;
     Span span_;
 };
 
@@ -0,0 +1,214 @@
+#include "cache.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace fs = std::filesystem;
+
+namespace mini {
+
+namespace {
+
+// 64-bit FNV-1a. Two lanes with different seeds make a 128-bit key.
+uint64_t Fnv1a(uint64_t hash, std::string_view data) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+// Identifies the build of this compiler, so that objects of an old compiler
+// are never used by new one.
+std::string CompilerId() {
+    struct stat st;
+    if (stat("/proc/self/exe", &st) != 0) return __DATE__ " " __TIME__;
+    return fmt::format("{}:{}:{}.{}", st.st_ino, st.st_size, st.st_mtim.tv_sec,
+                       st.st_mtim.tv_nsec);
+}
+
+bool ReadStats(int fd, CacheStats &stats) {
+    char buf[64] = {};
+    if (pread(fd, buf, sizeof(buf) - 1, 0) < 0) return false;
+    unsigned long long hits = 0, misses = 0;
+    if (sscanf(buf, "%llu %llu", &hits, &misses) == 2) {
+        stats.hits = hits;
+        stats.misses = misses;
+    }
+    return true;
+}
+
+}  // namespace
+
+ObjectCache::ObjectCache(std::string &&dir, uint64_t max_size)
+    : dir_(std::move(dir)), max_size_(max_size), compiler_id_(CompilerId()) {}
+
+std::string ObjectCache::DefaultDir() {
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return fmt::format("{}/mini", xdg);
+    }
+    const char *home = std::getenv("HOME");
+    return fmt::format("{}/.cache/mini", home ? home : ".");
+}
+
+std::string ObjectCache::Key(std::string_view source,
+                             std::string_view flags) const {
+    uint64_t lanes[2] = {0xcbf29ce484222325, 0x84222325cbf29ce4};
+    for (auto &hash : lanes) {
+        for (auto part : {std::string_view(compiler_id_), flags, source}) {
+            hash = Fnv1a(hash, part);
+            hash = Fnv1a(hash, std::string_view("\0", 1));
+        }
+    }
+    return fmt::format("{:016x}{:016x}", lanes[0], lanes[1]);
+}
+
+bool ObjectCache::Fetch(const std::string &key, const std::string &path,
+                        bool link) {
+    auto object = ObjectPath(key);
+    std::error_code ec;
+    if (!fs::exists(object, ec)) {
+        misses_++;
+        return false;
+    }
+
+    bool done = false;
+    if (link) {
+        fs::remove(path, ec);
+        fs::create_hard_link(object, path, ec);
+        done = !ec;
+    }
+    if (!done) {
+        std::ifstream in(object, std::ios::binary);
+        std::ofstream out(path, std::ios::binary);
+        if (!in || !(out << in.rdbuf())) {
+            misses_++;
+            return false;
+        }
+    }
+
+    // Used objects are kept longer.
+    fs::last_write_time(object, fs::file_time_type::clock::now(), ec);
+    hits_++;
+    return true;
+}
+
+void ObjectCache::Store(const std::string &key, std::string_view object) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) return;
+
+    // Written aside and renamed so that nobody sees a partial object.
+    auto path = ObjectPath(key);
+    auto tmp = fmt::format(
+        "{}.tmp.{}.{}", path, getpid(),
+        std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write(object.data(), object.size());
+        if (!out) {
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return;
+    }
+    stored_ = true;
+}
+
+void ObjectCache::Finish() {
+    std::error_code ec;
+    if (stored_) {
+        struct Entry {
+            fs::path path;
+            uint64_t size;
+            fs::file_time_type time;
+        };
+        std::vector<Entry> entries;
+        uint64_t total = 0;
+        for (auto it = fs::directory_iterator(dir_, ec);
+             !ec && it != fs::directory_iterator(); it.increment(ec)) {
+            if (it->path().extension() != ".o") continue;
+            std::error_code size_ec, time_ec;
+            auto size = it->file_size(size_ec);
+            auto time = it->last_write_time(time_ec);
+            if (size_ec || time_ec) continue;
+            entries.push_back({it->path(), size, time});
+            total += size;
+        }
+
+        // Evict down to 90% of the cap, so that eviction doesn't run for
+        // every new object once the cache is full.
+        if (total > max_size_) {
+            std::sort(entries.begin(), entries.end(),
+                      [](const Entry &lhs, const Entry &rhs) {
+                          return lhs.time < rhs.time;
+                      });
+            for (const auto &entry : entries) {
+                if (total <= max_size_ / 10 * 9) break;
+                if (fs::remove(entry.path, ec)) total -= entry.size;
+            }
+        }
+    }
+
+    if (hits_ == 0 && misses_ == 0) return;
+    fs::create_directories(dir_, ec);
+    int fd = open((dir_ + "/stats").c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1) return;
+    CacheStats stats;
+    if (flock(fd, LOCK_EX) == 0 && ReadStats(fd, stats)) {
+        auto line = fmt::format("{} {}\n", stats.hits + hits_,
+                                stats.misses + misses_);
+        if (ftruncate(fd, 0) == 0) {
+            [[maybe_unused]] auto written =
+                pwrite(fd, line.data(), line.size(), 0);
+        }
+    }
+    close(fd);
+}
+
+CacheStats ObjectCache::TotalStats() const {
+    CacheStats stats;
+    int fd = open((dir_ + "/stats").c_str(), O_RDONLY);
+    if (fd == -1) return stats;
+    if (flock(fd, LOCK_SH) == 0) ReadStats(fd, stats);
+    close(fd);
+    return stats;
+}
+
+void ObjectCache::Usage(size_t &objects, uint64_t &bytes) const {
+    objects = 0;
+    bytes = 0;
+    std::error_code ec;
+    for (auto it = fs::directory_iterator(dir_, ec);
+         !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        if (it->path().extension() != ".o") continue;
+        std::error_code size_ec;
+        auto size = it->file_size(size_ec);
+        if (size_ec) continue;
+        objects++;
+        bytes += size;
+    }
+}
+
+std::string ObjectCache::ObjectPath(const std::string &key) const {
+    return fmt::format("{}/{}.o", dir_, key);
+}
+
+}  // namespace mini
@@ -0,0 +1,70 @@
+#ifndef MINI_CACHE_H_
+#define MINI_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace mini {
+
+// Hits and misses of the object cache.
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+// Object files stored under a directory, addressed by a hash of everything
+// which determines them: the source, the compiler and its flags.
+//
+// The cache is only an optimization, so failing to read or write it never
+// fails compilation; it's just a miss. Lookups and stores may run from
+// several threads at once.
+class ObjectCache {
+public:
+    ObjectCache(std::string &&dir, uint64_t max_size);
+
+    // `$XDG_CACHE_HOME/mini`, or `$HOME/.cache/mini` without it.
+    static std::string DefaultDir();
+
+    inline const std::string &dir() const { return dir_; }
+    inline uint64_t max_size() const { return max_size_; }
+
+    // Returns the key of an object compiled from `source` with `flags`.
+    std::string Key(std::string_view source, std::string_view flags) const;
+
+    // Places the object of `key` at `path`, by hardlink if `link` and possible,
+    // otherwise by copy. Returns false and counts a miss if it's not cached.
+    bool Fetch(const std::string &key, const std::string &path, bool link);
+
+    // Stores `object` as `key`.
+    void Store(const std::string &key, std::string_view object);
+
+    // Removes least recently used objects until the total size is under the
+    // cap, and adds hits and misses of this run to the persistent counts.
+    void Finish();
+
+    // Hits and misses of this run.
+    inline CacheStats stats() const { return {hits_, misses_}; }
+
+    // Persistent counts of all runs, with the number and total size of
+    // stored objects.
+    CacheStats TotalStats() const;
+    void Usage(size_t &objects, uint64_t &bytes) const;
+
+private:
+    std::string ObjectPath(const std::string &key) const;
+
+    const std::string dir_;
+    const uint64_t max_size_;
+    std::string compiler_id_;
+    std::atomic<size_t> hits_ = 0;
+    std::atomic<size_t> misses_ = 0;
+    std::atomic<bool> stored_ = false;
+};
+
+}  // namespace mini
+
+#endif  // MINI_CACHE_H_
@@ -2,416 +2,130 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <string>
+#include <string_view>
 
 #include "context.h"
 #include "fmt/format.h"
 
 namespace mini {
 
-std::string Register::ToByteName() const {
-    switch (kind_) {
-        case AX:
-            return "%al";
-        case BX:
-            return "%bl";
-        case CX:
-            return "%cl";
-        case DX:
-            return "%dl";
-        case SI:
-            return "%sil";
-        case DI:
-            return "%dil";
-        case BP:
-            return "%bpl";
-        case SP:
-            return "%spl";
-        case R8:
-            return "%r8b";
-        case R9:
-            return "%r9b";
-        case R10:
-            return "%r10b";
-        case R11:
-            return "%r11b";
-        case R12:
-            return "%r12b";
-        case R13:
-            return "%r13b";
-        case R14:
-            return "%r14b";
-        case R15:
-            return "%r15b";
+namespace {
+
+// Names of each register, indexed by `Register::Kind` and then by size.
+constexpr std::string_view reg_names[16][4] = {
+    {"%al", "%ax", "%eax", "%rax"},
+    {"%bl", "%bx", "%ebx", "%rbx"},
+    {"%cl", "%cx", "%ecx", "%rcx"},
+    {"%dl", "%dx", "%edx", "%rdx"},
+    {"%sil", "%si", "%esi", "%rsi"},
+    {"%dil", "%di", "%edi", "%rdi"},
+    {"%bpl", "%bp", "%ebp", "%rbp"},
+    {"%spl", "%sp", "%esp", "%rsp"},
+    {"%r8b", "%r8w", "%r8d", "%r8"},
+    {"%r9b", "%r9w", "%r9d", "%r9"},
+    {"%r10b", "%r10w", "%r10d", "%r10"},
+    {"%r11b", "%r11w", "%r11d", "%r11"},
+    {"%r12b", "%r12w", "%r12d", "%r12"},
+    {"%r13b", "%r13w", "%r13d", "%r13"},
+    {"%r14b", "%r14w", "%r14d", "%r14"},
+    {"%r15b", "%r15w", "%r15d", "%r15"},
+};
+
+// Mnemonics of each instruction, indexed by size.
+using Mnemonics = std::string_view[4];
+constexpr Mnemonics add_names = {"addb", "addw", "addl", "addq"};
+constexpr Mnemonics sub_names = {"subb", "subw", "subl", "subq"};
+constexpr Mnemonics imul_names = {"imulb", "imulw", "imull", "imulq"};
+constexpr Mnemonics mul_names = {"mulb", "mulw", "mull", "mulq"};
+constexpr Mnemonics idiv_names = {"idivb", "idivw", "idivl", "idivq"};
+constexpr Mnemonics div_names = {"divb", "divw", "divl", "divq"};
+constexpr Mnemonics and_names = {"andb", "andw", "andl", "andq"};
+constexpr Mnemonics or_names = {"orb", "orw", "orl", "orq"};
+constexpr Mnemonics xor_names = {"xorb", "xorw", "xorl", "xorq"};
+constexpr Mnemonics cmp_names = {"cmpb", "cmpw", "cmpl", "cmpq"};
+constexpr Mnemonics not_names = {"notb", "notw", "notl", "notq"};
+constexpr Mnemonics neg_names = {"negb", "negw", "negl", "negq"};
+constexpr Mnemonics sal_names = {"salb", "salw", "sall", "salq"};
+constexpr Mnemonics shl_names = {"shlb", "shlw", "shll", "shlq"};
+constexpr Mnemonics sar_names = {"sarb", "sarw", "sarl", "sarq"};
+constexpr Mnemonics shr_names = {"shrb", "shrw", "shrl", "shrq"};
+
+// Returns the index of `size` in the tables above.
+size_t SizeIndex(uint8_t size) {
+    switch (size) {
+        case 1:
+            return 0;
+        case 2:
+            return 1;
+        case 4:
+            return 2;
+        case 8:
+            return 3;
         default:
-            FatalError("unreachable");
+            FatalError("invalid size: {}", size);
     }
 }
 
-std::string Register::ToWordName() const {
-    switch (kind_) {
-        case AX:
-            return "%ax";
-        case BX:
-            return "%bx";
-        case CX:
-            return "%cx";
-        case DX:
-            return "%dx";
-        case SI:
-            return "%si";
-        case DI:
-            return "%di";
-        case BP:
-            return "%bp";
-        case SP:
-            return "%sp";
-        case R8:
-            return "%r8w";
-        case R9:
-            return "%r9w";
-        case R10:
-            return "%r10w";
-        case R11:
-            return "%r11w";
-        case R12:
-            return "%r12w";
-        case R13:
-            return "%r13w";
-        case R14:
-            return "%r14w";
-        case R15:
-            return "%r15w";
-        default:
-            FatalError("unreachable");
-    }
-}
+}  // namespace
 
-std::string Register::ToLongName() const {
-    switch (kind_) {
-        case AX:
-            return "%eax";
-        case BX:
-            return "%ebx";
-        case CX:
-            return "%ecx";
-        case DX:
-            return "%edx";
-        case SI:
-            return "%esi";
-        case DI:
-            return "%edi";
-        case BP:
-            return "%ebp";
-        case SP:
-            return "%esp";
-        case R8:
-            return "%r8d";
-        case R9:
-            return "%r9d";
-        case R10:
-            return "%r10d";
-        case R11:
-            return "%r11d";
-        case R12:
-            return "%r12d";
-        case R13:
-            return "%r13d";
-        case R14:
-            return "%r14d";
-        case R15:
-            return "%r15d";
-        default:
-            FatalError("unreachable");
-    }
+bool Register::IsCalleeSaved() const {
+    return kind_ == BX || kind_ == BP || kind_ == SP || kind_ == R12 ||
+           kind_ == R13 || kind_ == R14 || kind_ == R15;
 }
 
-std::string Register::ToQuadName() const {
-    switch (kind_) {
-        case AX:
-            return "%rax";
-        case BX:
-            return "%rbx";
-        case CX:
-            return "%rcx";
-        case DX:
-            return "%rdx";
-        case SI:
-            return "%rsi";
-        case DI:
-            return "%rdi";
-        case BP:
-            return "%rbp";
-        case SP:
-            return "%rsp";
-        case R8:
-            return "%r8";
-        case R9:
-            return "%r9";
-        case R10:
-            return "%r10";
-        case R11:
-            return "%r11";
-        case R12:
-            return "%r12";
-        case R13:
-            return "%r13";
-        case R14:
-            return "%r14";
-        case R15:
-            return "%r15";
-        default:
-            FatalError("unreachable");
-    }
-}
+std::string_view Register::ToByteName() const { return reg_names[kind_][0]; }
 
-std::string Register::ToNameBySize(uint8_t size) const {
-    if (size == 1) {
-        return ToByteName();
-    } else if (size == 2) {
-        return ToWordName();
-    } else if (size == 4) {
-        return ToLongName();
-    } else if (size == 8) {
-        return ToQuadName();
-    } else {
-        FatalError("invalid size: {}", size);
-    }
-}
+std::string_view Register::ToWordName() const { return reg_names[kind_][1]; }
 
-std::string IndexableAsmRegPtr::ToAsmRepr(int64_t offset, uint8_t size) const {
-    return fmt::format("{}({})", init_offset_ + offset,
-                       reg_.ToNameBySize(size));
-}
+std::string_view Register::ToLongName() const { return reg_names[kind_][2]; }
 
-std::string AsmAdd(uint8_t size) {
-    if (size == 1) {
-        return "addb";
-    } else if (size == 2) {
-        return "addw";
-    } else if (size == 4) {
-        return "addl";
-    } else if (size == 8) {
-        return "addq";
-    } else {
-        FatalError("invalid size");
-    }
-}
+std::string_view Register::ToQuadName() const { return reg_names[kind_][3]; }
 
-std::string AsmSub(uint8_t size) {
-    if (size == 1) {
-        return "subb";
-    } else if (size == 2) {
-        return "subw";
-    } else if (size == 4) {
-        return "subl";
-    } else if (size == 8) {
-        return "subq";
-    } else {
-        FatalError("invalid size");
-    }
+std::string_view Register::ToNameBySize(uint8_t size) const {
+    return reg_names[kind_][SizeIndex(size)];
 }
 
-std::string AsmMul(bool is_signed, uint8_t size) {
-    if (is_signed) {
-        if (size == 1) {
-            return "imulb";
-        } else if (size == 2) {
-            return "imulw";
-        } else if (size == 4) {
-            return "imull";
-        } else if (size == 8) {
-            return "imulq";
-        } else {
-            FatalError("invalid size");
-        }
-    } else {
-        if (size == 1) {
-            return "mulb";
-        } else if (size == 2) {
-            return "mulw";
-        } else if (size == 4) {
-            return "mull";
-        } else if (size == 8) {
-            return "mulq";
-        } else {
-            FatalError("invalid size");
-        }
-    }
+AsmPtrRepr IndexableAsmRegPtr::ToAsmRepr(int64_t offset, uint8_t size) const {
+    return AsmPtrRepr{init_offset_ + offset, reg_.ToNameBySize(size)};
 }
 
-std::string AsmDiv(bool is_signed, uint8_t size) {
-    if (is_signed) {
-        if (size == 1) {
-            return "idivb";
-        } else if (size == 2) {
-            return "idivw";
-        } else if (size == 4) {
-            return "idivl";
-        } else if (size == 8) {
-            return "idivq";
-        } else {
-            FatalError("invalid size");
-        }
-    } else {
-        if (size == 1) {
-            return "divb";
-        } else if (size == 2) {
-            return "divw";
-        } else if (size == 4) {
-            return "divl";
-        } else if (size == 8) {
-            return "divq";
-        } else {
-            FatalError("invalid size");
-        }
-    }
-}
+std::string_view AsmAdd(uint8_t size) { return add_names[SizeIndex(size)]; }
 
-std::string AsmAnd(uint8_t size) {
-    if (size == 1) {
-        return "andb";
-    } else if (size == 2) {
-        return "andw";
-    } else if (size == 4) {
-        return "andl";
-    } else if (size == 8) {
-        return "andq";
-    } else {
-        FatalError("invalid size");
-    }
-}
+std::string_view AsmSub(uint8_t size) { return sub_names[SizeIndex(size)]; }
 
-std::string AsmOr(uint8_t size) {
-    if (size == 1) {
-        return "orb";
-    } else if (size == 2) {
-        return "orw";
-    } else if (size == 4) {
-        return "orl";
-    } else if (size == 8) {
-        return "orq";
-    } else {
-        FatalError("invalid size");
-    }
+std::string_view AsmMul(bool is_signed, uint8_t size) {
+    return is_signed ? imul_names[SizeIndex(size)] : mul_names[SizeIndex(size)];
 }
 
-std::string AsmXor(uint8_t size) {
-    if (size == 1) {
-        return "xorb";
-    } else if (size == 2) {
-        return "xorw";
-    } else if (size == 4) {
-        return "xorl";
-    } else if (size == 8) {
-        return "xorq";
-    } else {
-        FatalError("invalid size");
-    }
+std::string_view AsmDiv(bool is_signed, uint8_t size) {
+    return is_signed ? idiv_names[SizeIndex(size)] : div_names[SizeIndex(size)];
 }
 
-std::string AsmCmp(uint8_t size) {
-    if (size == 1) {
-        return "cmpb";
-    } else if (size == 2) {
-        return "cmpw";
-    } else if (size == 4) {
-        return "cmpl";
-    } else if (size == 8) {
-        return "cmpq";
-    } else {
-        FatalError("invalid size");
-    }
-}
+std::string_view AsmAnd(uint8_t size) { return and_names[SizeIndex(size)]; }
 
-std::string AsmNot(uint8_t size) {
-    if (size == 1) {
-        return "notb";
-    } else if (size == 2) {
-        return "notw";
-    } else if (size == 4) {
-        return "notl";
-    } else if (size == 8) {
-        return "notq";
-    } else {
-        FatalError("invalid size");
-    }
-}
+std::string_view AsmOr(uint8_t size) { return or_names[SizeIndex(size)]; }
 
-std::string AsmNeg(uint8_t size) {
-    if (size == 1) {
-        return "negb";
-    } else if (size == 2) {
-        return "negw";
-    } else if (size == 4) {
-        return "negl";
-    } else if (size == 8) {
-        return "negq";
-    } else {
-        FatalError("invalid size");
-    }
-}
+std::string_view AsmXor(uint8_t size) { return xor_names[SizeIndex(size)]; }
 
-std::string AsmLShift(bool is_signed, uint8_t size) {
-    if (is_signed) {
-        if (size == 1) {
-            return "salb";
-        } else if (size == 2) {
-            return "salw";
-        } else if (size == 4) {
-            return "sall";
-        } else if (size == 8) {
-            return "salq";
-        } else {
-            FatalError("invalid size");
-        }
-    } else {
-        if (size == 1) {
-            return "shlb";
-        } else if (size == 2) {
-            return "shlw";
-        } else if (size == 4) {
-            return "shll";
-        } else if (size == 8) {
-            return "shlq";
-        } else {
-            FatalError("invalid size");
-        }
-    }
+std::string_view AsmCmp(uint8_t size) { return cmp_names[SizeIndex(size)]; }
+
+std::string_view AsmNot(uint8_t size) { return not_names[SizeIndex(size)]; }
+
+std::string_view AsmNeg(uint8_t size) { return neg_names[SizeIndex(size)]; }
+
+std::string_view AsmLShift(bool is_signed, uint8_t size) {
+    return is_signed ? sal_names[SizeIndex(size)] : shl_names[SizeIndex(size)];
 }
 
-std::string AsmRShift(bool is_signed, uint8_t size) {
-    if (is_signed) {
-        if (size == 1) {
-            return "sarb";
-        } else if (size == 2) {
-            return "sarw";
-        } else if (size == 4) {
-            return "sarl";
-        } else if (size == 8) {
-            return "sarq";
-        } else {
-            FatalError("invalid size");
-        }
-    } else {
-        if (size == 1) {
-            return "shrb";
-        } else if (size == 2) {
-            return "shrw";
-        } else if (size == 4) {
-            return "shrl";
-        } else if (size == 8) {
-            return "shrq";
-        } else {
-            FatalError("invalid size");
-        }
-    }
+std::string_view AsmRShift(bool is_signed, uint8_t size) {
+    return is_signed ? sar_names[SizeIndex(size)] : shr_names[SizeIndex(size)];
 }
 
 void CopyBytes(CodeGenContext& ctx, const IndexableAsmRegPtr& src,
                const IndexableAsmRegPtr& dst, uint64_t size) {
-    static uint8_t sizes[4] = {8, 4, 2, 1};
-    static std::string moves[4] = {"movq", "movl", "movw", "movb"};
+    static constexpr uint8_t sizes[4] = {8, 4, 2, 1};
+    static constexpr std::string_view moves[4] = {"movq", "movl", "movw",
+                                                  "movb"};
     int64_t offset = 0;
     while (size != 0) {
         // TODO:
@@ -436,4 +150,53 @@ void CopyBytes(CodeGenContext& ctx, const IndexableAsmRegPtr& src,
     }
 }
 
+void MulByConst(CodeGenContext& ctx, Register reg, Register scratch,
+                uint8_t size, uint64_t factor) {
+    auto& printer = ctx.printer();
+    auto name = reg.ToNameBySize(size);
+    auto truncate = [&](uint64_t n) { return size == 4 ? uint32_t(n) : n; };
+    auto shift = [&](int count) {
+        if (count == 0) return;
+        printer.PrintLn("    {} ${}, {}", AsmLShift(false, size), count, name);
+    };
+
+    factor = truncate(factor);
+    if (factor == 0) {
+        printer.PrintLn("    xorl {0}, {0}", reg.ToLongName());
+        return;
+    }
+
+    // 2^n, and 3, 5 or 9 times 2^n by lea whose index is scaled.
+    int count = __builtin_ctzll(factor);
+    uint64_t odd = factor >> count;
+    if (odd == 1) {
+        shift(count);
+        return;
+    } else if (odd == 3 || odd == 5 || odd == 9) {
+        auto quad = reg.ToQuadName();
+        printer.PrintLn("    lea{} ({}, {}, {}), {}", size == 8 ? 'q' : 'l',
+                        quad, quad, odd - 1, name);
+        shift(count);
+        return;
+    }
+
+    // -2^n.
+    uint64_t neg = truncate(-factor);
+    if ((neg & (neg - 1)) == 0) {
+        shift(__builtin_ctzll(neg));
+        printer.PrintLn("    {} {}", AsmNeg(size), name);
+        return;
+    }
+
+    int64_t imm = size == 4 ? int32_t(factor) : int64_t(factor);
+    if (INT32_MIN <= imm && imm <= INT32_MAX) {
+        printer.PrintLn("    {} ${}, {}, {}", AsmMul(true, size), imm, name,
+                        name);
+    } else {
+        printer.PrintLn("    movq ${}, {}", imm, scratch.ToQuadName());
+        printer.PrintLn("    {} {}, {}", AsmMul(true, size),
+                        scratch.ToNameBySize(size), name);
+    }
+}
+
 }  // namespace mini
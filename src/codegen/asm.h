@@ -2,9 +2,10 @@
 #define MINI_CODEGEN_ASM_H_
 
 #include <cstdint>
-#include <string>
+#include <string_view>
 
 #include "../panic.h"
+#include "fmt/format.h"
 
 namespace mini {
 
@@ -31,50 +32,83 @@ public:
     };
 
     Register(Kind kind) : kind_(kind) {}
+    inline Kind kind() const { return kind_; }
+    inline bool operator==(Register rhs) const { return kind_ == rhs.kind_; }
+    inline bool operator!=(Register rhs) const { return kind_ != rhs.kind_; }
+
+    // Returns true if callee must preserve this register.
+    bool IsCalleeSaved() const;
 
     // Returns the representation of this register in 1-byte.
-    std::string ToByteName() const;
+    std::string_view ToByteName() const;
 
     // Returns the representation of this register in 2-byte.
-    std::string ToWordName() const;
+    std::string_view ToWordName() const;
 
     // Returns the representation of this register in 4-byte.
-    std::string ToLongName() const;
+    std::string_view ToLongName() const;
 
     // Returns the representation of this register in 8-byte.
-    std::string ToQuadName() const;
+    std::string_view ToQuadName() const;
 
     // Returns the representation of this register in `size`-byte.
-    std::string ToNameBySize(uint8_t size) const;
+    std::string_view ToNameBySize(uint8_t size) const;
 
 private:
     Kind kind_;
 };
 
+// A memory operand `offset(reg)`, formatted without building a string.
+struct AsmPtrRepr {
+    int64_t offset;
+    std::string_view reg;
+};
+
+// A register, a memory operand or an immediate.
+struct AsmOperand {
+    enum Kind {
+        Reg,
+        Ptr,
+        Imm,
+    };
+
+    AsmOperand(std::string_view reg) : kind(Reg), reg(reg), ptr{0, ""} {}
+    AsmOperand(AsmPtrRepr ptr) : kind(Ptr), reg(), ptr(ptr) {}
+    static AsmOperand Immediate(int64_t imm) {
+        AsmOperand op(AsmPtrRepr{imm, ""});
+        op.kind = Imm;
+        return op;
+    }
+
+    Kind kind;
+    std::string_view reg;
+    AsmPtrRepr ptr;  // `offset` is the value of immediate.
+};
+
 // A pointer represented by a register.
 class IndexableAsmRegPtr {
 public:
     IndexableAsmRegPtr(Register reg, int64_t init_offset)
         : reg_(reg), init_offset_(init_offset) {}
-    std::string ToAsmRepr(int64_t offset, uint8_t size) const;
+    AsmPtrRepr ToAsmRepr(int64_t offset, uint8_t size) const;
 
 private:
     Register reg_;
     int64_t init_offset_;
 };
 
-std::string AsmAdd(uint8_t size);
-std::string AsmSub(uint8_t size);
-std::string AsmMul(bool is_signed, uint8_t size);
-std::string AsmDiv(bool is_signed, uint8_t size);
-std::string AsmAnd(uint8_t size);
-std::string AsmOr(uint8_t size);
-std::string AsmXor(uint8_t size);
-std::string AsmCmp(uint8_t size);
-std::string AsmNot(uint8_t size);
-std::string AsmNeg(uint8_t size);
-std::string AsmLShift(bool is_signed, uint8_t size);
-std::string AsmRShift(bool is_signed, uint8_t size);
+std::string_view AsmAdd(uint8_t size);
+std::string_view AsmSub(uint8_t size);
+std::string_view AsmMul(bool is_signed, uint8_t size);
+std::string_view AsmDiv(bool is_signed, uint8_t size);
+std::string_view AsmAnd(uint8_t size);
+std::string_view AsmOr(uint8_t size);
+std::string_view AsmXor(uint8_t size);
+std::string_view AsmCmp(uint8_t size);
+std::string_view AsmNot(uint8_t size);
+std::string_view AsmNeg(uint8_t size);
+std::string_view AsmLShift(bool is_signed, uint8_t size);
+std::string_view AsmRShift(bool is_signed, uint8_t size);
 
 class CodeGenContext;
 
@@ -82,6 +116,33 @@ class CodeGenContext;
 void CopyBytes(CodeGenContext& ctx, const IndexableAsmRegPtr& src,
                const IndexableAsmRegPtr& dst, uint64_t size);
 
+// Generate code which multiply `reg` by `factor` in `size` bytes, which is 4 or
+// 8, with shifts and lea where these are enough. `scratch` is used if `factor`
+// doesn't fit in an immediate.
+void MulByConst(CodeGenContext& ctx, Register reg, Register scratch,
+                uint8_t size, uint64_t factor);
+
 }  // namespace mini
 
+template <>
+struct fmt::formatter<mini::AsmPtrRepr> : fmt::formatter<std::string_view> {
+    auto format(const mini::AsmPtrRepr &ptr, format_context &ctx) const {
+        return fmt::format_to(ctx.out(), "{}({})", ptr.offset, ptr.reg);
+    }
+};
+
+template <>
+struct fmt::formatter<mini::AsmOperand> : fmt::formatter<std::string_view> {
+    auto format(const mini::AsmOperand &op, format_context &ctx) const {
+        switch (op.kind) {
+            case mini::AsmOperand::Reg:
+                return fmt::format_to(ctx.out(), "{}", op.reg);
+            case mini::AsmOperand::Ptr:
+                return fmt::format_to(ctx.out(), "{}", op.ptr);
+            default:
+                return fmt::format_to(ctx.out(), "${}", op.ptr.offset);
+        }
+    }
+};
+
 #endif  // MINI_CODEGEN_ASM_H_
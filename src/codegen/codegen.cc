@@ -1,16 +1,29 @@
 #include "codegen.h"
 
+#include <sstream>
+
 #include "../hirgen/hirgen.h"
 #include "context.h"
 #include "decl.h"
 
 namespace mini {
 
-bool CodeGenFile(Context &ctx, std::ostream &os, const std::string &path) {
-    auto root = HirGenFile(ctx, path);
+// Generates assembly to `os`, or mir to `mir_os` if not null.
+static bool Generate(Context &ctx, std::ostream &os, size_t id,
+                     std::ostream *mir_os) {
+    auto root = HirGen(ctx, id);
     if (!root) return false;
 
+    // Types inferred while generating code are also placed in the hir arena.
+    ArenaScope scope(ArenaKind::Hir, ctx.hir_arena());
+    PassScope pass(ctx.pass_timer(), "codegen");
+    auto start = os.tellp();
+
     CodeGenContext gen_ctx(ctx, root->string_table(), os);
+    if (mir_os) {
+        gen_ctx.SuppressOutput();
+        gen_ctx.SetMirStream(*mir_os);
+    }
 
     // Place string literals to the section `rodata`.
     if (!gen_ctx.string_table().InnerRepr().empty()) {
@@ -37,7 +50,27 @@ bool CodeGenFile(Context &ctx, std::ostream &os, const std::string &path) {
         if (!gen) return false;
     }
 
+    gen_ctx.printer().Flush();
+    if (start != -1) pass.SetOutputBytes(os.tellp() - start);
     return true;
 }
 
+bool CodeGen(Context &ctx, std::ostream &os, size_t id) {
+    return Generate(ctx, os, id, nullptr);
+}
+
+bool CodeGenFile(Context &ctx, std::ostream &os, const std::string &path) {
+    return CodeGen(ctx, os, ctx.input_cache().Cache(path));
+}
+
+bool EmitMir(Context &ctx, std::ostream &os, size_t id) {
+    // Assembly is not written, but still generated to report errors.
+    std::ostringstream asm_os;
+    return Generate(ctx, asm_os, id, &os);
+}
+
+bool EmitMirFile(Context &ctx, std::ostream &os, const std::string &path) {
+    return EmitMir(ctx, os, ctx.input_cache().Cache(path));
+}
+
 }  // namespace mini
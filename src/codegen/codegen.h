@@ -8,8 +8,17 @@
 
 namespace mini {
 
+// Generates assembly from the source cached as `id` in the input cache.
+bool CodeGen(Context &ctx, std::ostream &os, size_t id);
+
 bool CodeGenFile(Context &ctx, std::ostream &os, const std::string &path);
 
+// Writes mir of each function in the source cached as `id` instead of
+// assembly. Functions mir doesn't support are noted as such.
+bool EmitMir(Context &ctx, std::ostream &os, size_t id);
+
+bool EmitMirFile(Context &ctx, std::ostream &os, const std::string &path);
+
 }
 
 #endif  // MINI_CODEGEN_CODEGEN_H_
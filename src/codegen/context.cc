@@ -1,7 +1,47 @@
 #include "context.h"
 
+#include <algorithm>
+#include <string_view>
+
 namespace mini {
 
-const std::string LVarTable::ret_name = "<ret>";
+const Symbol LVarTable::ret_name("<ret>");
+
+void Printer::EndFunction() {
+    TakeLines();
+    {
+        PassScope pass(ctx_.pass_timer(), "peephole");
+        OptimizePeephole(lines_, ctx_.opt_stats());
+    }
+    for (const auto &line : lines_) PrintAsmLine(line, out_);
+    lines_.clear();
+    if (out_.size() >= flush_size) {
+        os_.write(out_.data(), out_.size());
+        out_.clear();
+    }
+}
 
+void Printer::Flush() {
+    EndFunction();
+    os_.write(out_.data(), out_.size());
+    os_.write(buf_.data(), buf_.size());
+    out_.clear();
+    buf_.clear();
 }
+
+void Printer::TakeLines() {
+    std::string_view text(buf_.data(), buf_.size());
+    size_t begin = 0;
+    for (auto end = text.find('\n'); end != std::string_view::npos;
+         end = text.find('\n', begin)) {
+        lines_.push_back(ParseAsmLine(text.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+    if (begin == 0) return;
+
+    // Keep the unterminated line.
+    std::copy(buf_.data() + begin, buf_.data() + buf_.size(), buf_.data());
+    buf_.resize(buf_.size() - begin);
+}
+
+}  // namespace mini
@@ -3,18 +3,21 @@
 
 #include <cassert>
 #include <cstdint>
-#include <map>
 #include <memory>
 #include <ostream>
 #include <stack>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "../context.h"
 #include "../hir/root.h"
 #include "../hir/type.h"
+#include "../symbol.h"
 #include "asm.h"
+#include "peephole.h"
 #include "fmt/base.h"
 #include "fmt/format.h"
 
@@ -70,9 +73,9 @@ public:
 
         // Returns the name of register corresponding to the value of `InitReg`.
         // This contains `%` at beginning so that ready to use in assembly code.
-        inline std::string InitRegName() const {
-            static std::string aregs[] = {"%rdi", "%rsi", "%rdx",
-                                          "%rcx", "%r8",  "%r9"};
+        inline std::string_view InitRegName() const {
+            static constexpr std::string_view aregs[] = {
+                "%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
             auto pos = InitReg();
             return aregs[pos];
         }
@@ -183,13 +186,13 @@ public:
     inline void Clear() { map_.clear(); }
 
     // Returns true if an entry exists associated with `name`.
-    inline bool Exists(const std::string &name) const {
+    inline bool Exists(Symbol name) const {
         return map_.find(name) != map_.end();
     }
 
     // Insert `name`-`entry` pair to this table.
     // Calling this when `Exists` returns true cause error.
-    inline void Insert(std::string &&name, Entry &&entry) {
+    inline void Insert(Symbol name, Entry &&entry) {
         if (!Exists(name)) {
             map_.insert(std::make_pair(name, entry));
         } else {
@@ -199,19 +202,18 @@ public:
 
     // Try to get `Entry` associated with `name`.
     // Must not be called when `Exists` returns false.
-    const Entry &Query(const std::string &name) const {
-        if (!Exists(name)) {
+    const Entry &Query(Symbol name) const {
+        auto it = map_.find(name);
+        if (it == map_.end())
             FatalError("{} doesn't exists in this LVarTable", name);
-        } else {
-            return map_.at(name);
-        }
+        return it->second;
     };
 
     // Special name for accessing entry of return value.
-    static const std::string ret_name;
+    static const Symbol ret_name;
 
 private:
-    std::map<std::string, Entry> map_;
+    std::unordered_map<Symbol, Entry> map_;
     std::stack<uint64_t> callee_sizes_;  // Sizes which should be restored.
     std::stack<uint64_t> caller_sizes_;  // Sizes which should be restored.
     uint64_t callee_size_;               // The size callee should reserve.
@@ -239,7 +241,7 @@ public:
             uint64_t offset_;
         };
 
-        using map = std::vector<std::pair<std::string, Field>>;
+        using map = std::vector<std::pair<Symbol, Field>>;
         using iterator = map::iterator;
         using const_iterator = map::const_iterator;
         using reference = map::reference;
@@ -273,20 +275,20 @@ public:
         inline uint64_t Align() const { return align_; }
 
         inline Span span() const { return span_; }
-        inline bool Exists(const std::string &name) const {
+        inline bool Exists(Symbol name) const {
             for (const auto &[name_, _] : fields_) {
                 if (name == name_) return true;
             }
             return false;
         }
-        inline void Insert(std::string &&name, Field &&type) {
+        inline void Insert(Symbol name, Field &&type) {
             if (!Exists(name)) {
                 fields_.emplace_back(std::make_pair(name, type));
             } else {
                 FatalError("{} already exists as struct field", name);
             }
         }
-        Field &Query(const std::string &name) {
+        Field &Query(Symbol name) {
             for (auto &[name_, field] : fields_) {
                 if (name == name_) return field;
             }
@@ -302,26 +304,24 @@ public:
         Span span_;
     };
 
-    inline bool Exists(const std::string &name) {
+    inline bool Exists(Symbol name) {
         return map_.find(name) != map_.end();
     }
-    inline void Insert(std::string &&name, Entry &&entry) {
+    inline void Insert(Symbol name, Entry &&entry) {
         if (!Exists(name)) {
             map_.insert(std::make_pair(name, entry));
         } else {
             FatalError("{} already exists", name);
         }
     }
-    Entry &Query(const std::string &name) {
-        if (!Exists(name)) {
-            FatalError("no such struct exists: {}", name);
-        } else {
-            return map_.at(name);
-        }
+    Entry &Query(Symbol name) {
+        auto it = map_.find(name);
+        if (it == map_.end()) FatalError("no such struct exists: {}", name);
+        return it->second;
     }
 
 private:
-    std::map<std::string, Entry> map_;
+    std::unordered_map<Symbol, Entry> map_;
 };
 
 class EnumTable {
@@ -334,50 +334,47 @@ public:
         const std::shared_ptr<hir::Type> &base_type() const {
             return base_type_;
         }
-        bool Exists(const std::string &name) const {
+        bool Exists(Symbol name) const {
             return fields_.find(name) != fields_.end();
         }
-        void Insert(std::string &&name, uint64_t value) {
+        void Insert(Symbol name, uint64_t value) {
             if (!Exists(name)) {
                 fields_.insert(std::make_pair(name, value));
             } else {
                 FatalError("{} already exists", name);
             }
         }
-        uint64_t Query(const std::string &name) const {
-            if (!Exists(name)) {
+        uint64_t Query(Symbol name) const {
+            auto it = fields_.find(name);
+            if (it == fields_.end())
                 FatalError("no such enum field exists: {}", name);
-            } else {
-                return fields_.at(name);
-            }
+            return it->second;
         }
 
     private:
         std::shared_ptr<hir::Type> base_type_;
-        std::map<std::string, uint64_t> fields_;
+        std::unordered_map<Symbol, uint64_t> fields_;
         Span span_;
     };
 
-    inline bool Exists(const std::string &name) {
+    inline bool Exists(Symbol name) {
         return map_.find(name) != map_.end();
     }
-    inline void Insert(std::string &&name, Entry &&entry) {
+    inline void Insert(Symbol name, Entry &&entry) {
         if (!Exists(name)) {
             map_.insert(std::make_pair(name, entry));
         } else {
             FatalError("{} already exists", name);
         }
     }
-    const Entry &Query(const std::string &name) {
-        if (!Exists(name)) {
-            FatalError("no such enum exists: {}", name);
-        } else {
-            return map_.at(name);
-        }
+    const Entry &Query(Symbol name) {
+        auto it = map_.find(name);
+        if (it == map_.end()) FatalError("no such enum exists: {}", name);
+        return it->second;
     }
 
 private:
-    std::map<std::string, Entry> map_;
+    std::unordered_map<Symbol, Entry> map_;
 };
 
 // A table which holds infomation about, for each function, the parameters,
@@ -398,7 +395,7 @@ public:
             // - Its holds original order of parameters.
             // - Most cases parameters < 10, so no effect to speed.
             using map =
-                std::vector<std::pair<std::string, std::shared_ptr<hir::Type>>>;
+                std::vector<std::pair<Symbol, std::shared_ptr<hir::Type>>>;
             using iterator = map::iterator;
             using const_iterator = map::const_iterator;
             using size_type = map::size_type;
@@ -413,13 +410,13 @@ public:
             inline reference at(size_type n) { return map_.at(n); }
             inline const_reference at(size_type n) const { return map_.at(n); }
 
-            bool Exists(const std::string &name) const {
+            bool Exists(Symbol name) const {
                 for (const auto &[name_, _] : map_) {
                     if (name == name_) return true;
                 }
                 return false;
             }
-            void Insert(std::string &&name,
+            void Insert(Symbol name,
                         const std::shared_ptr<hir::Type> &type) {
                 if (!Exists(name)) {
                     map_.emplace_back(std::make_pair(name, type));
@@ -427,7 +424,7 @@ public:
                     FatalError("{} already exists as parameter", name);
                 }
             }
-            const std::shared_ptr<hir::Type> &Query(const std::string &name) {
+            const std::shared_ptr<hir::Type> &Query(Symbol name) {
                 for (const auto &[name_, type] : map_) {
                     if (name == name_) return type;
                 }
@@ -462,50 +459,73 @@ public:
         Span span_;
     };
 
-    inline bool Exists(const std::string &name) {
+    inline bool Exists(Symbol name) {
         return map_.find(name) != map_.end();
     }
-    inline void Insert(std::string &&name, Entry &&entry) {
+    inline void Insert(Symbol name, Entry &&entry) {
         if (!Exists(name)) {
             map_.insert(std::make_pair(name, entry));
         } else {
             FatalError("{} already exists", name);
         }
     }
-    Entry &Query(const std::string &name) {
-        if (!Exists(name)) {
-            FatalError("no such function exists: {}", name);
-        } else {
-            return map_.at(name);
-        }
+    Entry &Query(Symbol name) {
+        auto it = map_.find(name);
+        if (it == map_.end()) FatalError("no such function exists: {}", name);
+        return it->second;
     }
 
 private:
-    std::map<std::string, Entry> map_;
+    std::unordered_map<Symbol, Entry> map_;
 };
 
+// Writes assembly code to `os`. Printed lines are parsed into the lines of
+// the current function, which the peephole optimizer rewrites on
+// `EndFunction` before they're formatted into a buffer. The buffer is written
+// out when it grows large, on `Flush` and on destruction.
 class Printer {
 public:
-    Printer(std::ostream &os, bool &should_output)
-        : os_(os), should_output_(should_output) {}
+    Printer(std::ostream &os, bool &should_output, Context &ctx)
+        : os_(os), should_output_(should_output), ctx_(ctx) {}
+    Printer(const Printer &) = delete;
+    Printer &operator=(const Printer &) = delete;
+    ~Printer() { Flush(); }
 
     template <typename... T>
     inline void Print(fmt::format_string<T...> fmt, T &&...args) {
         if (should_output_) {
-            os_ << fmt::format(fmt, std::forward<T>(args)...);
+            fmt::format_to(fmt::appender(buf_), fmt, std::forward<T>(args)...);
         }
     }
 
     template <typename... T>
     inline void PrintLn(fmt::format_string<T...> fmt, T &&...args) {
         if (should_output_) {
-            os_ << fmt::format(fmt, std::forward<T>(args)...) << std::endl;
+            fmt::format_to(fmt::appender(buf_), fmt, std::forward<T>(args)...);
+            buf_.push_back('\n');
+            TakeLines();
         }
     }
 
+    // Optimizes the lines printed since the last call, which make up a
+    // function, and moves them to the buffer.
+    void EndFunction();
+
+    void Flush();
+
 private:
+    static constexpr size_t flush_size = 64 * 1024;
+
+    // Parses whole lines in `buf_` into `lines_`, leaving the last line if
+    // it's not terminated yet.
+    void TakeLines();
+
     std::ostream &os_;
     bool &should_output_;
+    Context &ctx_;
+    fmt::memory_buffer buf_;
+    std::vector<AsmLine> lines_;
+    fmt::memory_buffer out_;
 };
 
 // Unique id generator for label.
@@ -526,9 +546,10 @@ public:
                    std::ostream &os)
         : ctx_(ctx),
           string_table_(string_table),
-          printer_(os, should_output_),
+          printer_(os, should_output_, ctx),
           should_output_(true),
-          suppress_output_count_(0) {}
+          suppress_output_count_(0),
+          mir_os_(nullptr) {}
     inline Context &ctx() { return ctx_; }
     inline const hir::StringTable &string_table() { return string_table_; }
     inline Printer &printer() { return printer_; }
@@ -541,8 +562,8 @@ public:
     inline LabelIdGenerator &label_id_generator() {
         return label_id_generator_;
     }
-    inline void SetCurrFuncName(std::string &&name) { curr_func_name_ = name; }
-    inline const std::string &CurrFuncName() const { return curr_func_name_; }
+    inline void SetCurrFuncName(Symbol name) { curr_func_name_ = name; }
+    inline Symbol CurrFuncName() const { return curr_func_name_; }
     inline bool IsInLoop() const { return !loop_id_stack_.empty(); }
     inline void EnterLoop() {
         loop_id_stack_.push(label_id_generator_.GenNewId());
@@ -571,6 +592,10 @@ public:
         if (suppress_output_count_ == 0) should_output_ = true;
     }
 
+    // Where mir of each function is written instead of assembly, if any.
+    inline std::ostream *mir_os() { return mir_os_; }
+    inline void SetMirStream(std::ostream &os) { mir_os_ = &os; }
+
 private:
     Context &ctx_;
     const hir::StringTable &string_table_;
@@ -579,10 +604,11 @@ private:
     EnumTable enum_table_;
     FuncInfoTable func_info_table_;
     LabelIdGenerator label_id_generator_;
-    std::string curr_func_name_;
+    Symbol curr_func_name_;
     std::stack<uint64_t> loop_id_stack_;
     bool should_output_;
     uint64_t suppress_output_count_;
+    std::ostream *mir_os_;
 };
 
 }  // namespace mini
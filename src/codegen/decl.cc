@@ -4,10 +4,20 @@
 #include <string>
 #include <utility>
 
+#include "../mir/gvn.h"
+#include "../mir/licm.h"
+#include "../mir/mir.h"
+#include "../mir/tailcall.h"
+#include "../mir/verify.h"
+#include "../mirgen/mirgen.h"
+#include "../panic.h"
 #include "../report.h"
+#include "../timer.h"
 #include "context.h"
+#include "lower.h"
 #include "stmt.h"
 #include "type.h"
+#include "typing.h"
 
 namespace mini {
 
@@ -24,10 +34,9 @@ void DeclCollect::Visit(const hir::StructDeclaration &decl) {
             Report(ctx_.ctx(), ReportLevel::Error, info);
             return;
         }
-        entry.Insert(std::string(field.name().value()), field.type());
+        entry.Insert(field.name().value(), field.type());
     }
-    ctx_.struct_table().Insert(std::string(decl.name().value()),
-                               std::move(entry));
+    ctx_.struct_table().Insert(decl.name().value(), std::move(entry));
     success_ = true;
 }
 
@@ -39,10 +48,9 @@ void DeclCollect::Visit(const hir::EnumDeclaration &decl) {
             Report(ctx_.ctx(), ReportLevel::Error, info);
             return;
         }
-        entry.Insert(std::string(field.name().value()), field.value().value());
+        entry.Insert(field.name().value(), field.value().value());
     }
-    ctx_.enum_table().Insert(std::string(decl.name().value()),
-                             std::move(entry));
+    ctx_.enum_table().Insert(decl.name().value(), std::move(entry));
     success_ = true;
 }
 
@@ -51,12 +59,11 @@ void DeclCollect::Visit(const hir::FunctionDeclaration &decl) {
     FuncInfoTable::Entry entry(decl.ret(), decl.variadic() ? true : false,
                                is_outer, decl.span());
     for (const auto &param : decl.params()) {
-        entry.params().Insert(std::string(param.name().value()), param.type());
+        entry.params().Insert(param.name().value(), param.type());
     }
-    ctx_.func_info_table().Insert(std::string(decl.name().value()),
-                                  std::move(entry));
+    ctx_.func_info_table().Insert(decl.name().value(), std::move(entry));
 
-    if (decl.name().value() == "main") {
+    if (decl.name().value() == Symbol("main")) {
         if (!decl.ret()->IsBuiltin() ||
             decl.ret()->ToBuiltin()->kind() != hir::BuiltinType::USize) {
             ReportInfo info(decl.ret()->span(),
@@ -80,13 +87,67 @@ void DeclCodeGen::Visit(const hir::FunctionDeclaration &decl) {
         return;
     }
 
-    ctx_.SetCurrFuncName(std::string(decl.name().value()));
+    ctx_.SetCurrFuncName(decl.name().value());
+
+    // Resolve types of expressions so that these can be queried before
+    // generating them.
+    {
+        PassScope pass(ctx_.ctx().pass_timer(), "typing");
+        AnnotateExprTypes(ctx_, decl);
+    }
+
+    // Generate the function through mir if possible. Otherwise it's generated
+    // below, which also reports errors in it.
+    auto should_report = ctx_.ctx().should_report();
+    ctx_.ctx().SuppressReport();
+    auto func = [&] {
+        PassScope pass(ctx_.ctx().pass_timer(), "mirgen");
+        return MirGen(ctx_, decl);
+    }();
+    if (should_report) ctx_.ctx().ActivateReport();
+
+    if (func) {
+        auto &stats = ctx_.ctx().opt_stats();
+        {
+            PassScope pass(ctx_.ctx().pass_timer(), "gvn");
+            stats.replaced_insts += mir::NumberValues(*func);
+        }
+        {
+            // Loops made of recursion are subject to licm.
+            PassScope pass(ctx_.ctx().pass_timer(), "tailcall");
+            mir::OptimizeTailCalls(*func, stats.tail_call_report);
+        }
+        PassScope pass(ctx_.ctx().pass_timer(), "licm");
+        stats.hoisted_insts += mir::HoistLoopInvariants(*func);
+        if (auto error = mir::Verify(*func)) {
+            FatalError("invalid mir of {} after optimization: {}",
+                       decl.name().value(), *error);
+        }
+    }
+
+    if (func && ctx_.mir_os()) {
+        mir::Print(*ctx_.mir_os(), *func);
+        success_ = true;
+        return;
+    } else if (func) {
+        PassScope pass(ctx_.ctx().pass_timer(), "lower");
+        LowerFunction(ctx_, *func);
+        ctx_.printer().EndFunction();
+        success_ = true;
+        return;
+    } else if (ctx_.mir_os()) {
+        *ctx_.mir_os() << "; " << decl.name().value()
+                       << ": not supported by mir\n";
+    }
 
     auto callee_size = ctx_.lvar_table().CalleeSize();
 
     ctx_.printer().PrintLn("    .text");
     ctx_.printer().PrintLn("    .type {}, @function", decl.name().value());
-    ctx_.printer().PrintLn("    .global {}", decl.name().value());
+    // Other functions of the whole program are called only from it.
+    if (!ctx_.ctx().whole_program() || decl.name().value() == Symbol("main")) {
+        ctx_.printer().PrintLn("    .global {}", decl.name().value());
+    }
     ctx_.printer().PrintLn("{}:", decl.name().value());
     ctx_.printer().PrintLn("    pushq %rbp");
     ctx_.printer().PrintLn("    movq %rsp, %rbp");
@@ -97,10 +158,6 @@ void DeclCodeGen::Visit(const hir::FunctionDeclaration &decl) {
 
     // Push callee preserve registers.
     ctx_.printer().PrintLn("    movq %rbx, -8(%rbp)");
-    ctx_.printer().PrintLn("    movq %r12, -16(%rbp)");
-    ctx_.printer().PrintLn("    movq %r13, -24(%rbp)");
-    ctx_.printer().PrintLn("    movq %r14, -32(%rbp)");
-    ctx_.printer().PrintLn("    movq %r15, -40(%rbp)");
 
     // Copy arguments passed by register to stack so that these can take its
     // address.
@@ -122,15 +179,12 @@ void DeclCodeGen::Visit(const hir::FunctionDeclaration &decl) {
 
     // Pop callee preserve registers.
     ctx_.printer().PrintLn("    movq -8(%rbp) , %rbx");
-    ctx_.printer().PrintLn("    movq -16(%rbp), %r12");
-    ctx_.printer().PrintLn("    movq -24(%rbp), %r13");
-    ctx_.printer().PrintLn("    movq -32(%rbp), %r14");
-    ctx_.printer().PrintLn("    movq -40(%rbp), %r15");
 
     // Epilogue
     ctx_.printer().PrintLn("    movq %rbp, %rsp");
     ctx_.printer().PrintLn("    popq %rbp");
     ctx_.printer().PrintLn("    retq");
+    ctx_.printer().EndFunction();
 
     success_ = true;
 }
@@ -142,9 +196,9 @@ bool ConstructLVarTable(CodeGenContext &ctx,
     table.Clear();
     table.ChangeCallerSize(0);
 
-    // System V ABI requires to preserve rbx and r12 ~ r15, so preserve stack
-    // for these register.
-    table.ChangeCalleeSize(40);
+    // System V ABI requires to preserve rbx and r12 ~ r15. Generated code
+    // only uses rbx among these, so preserve stack for it.
+    table.ChangeCalleeSize(8);
 
     TypeSizeCalc ret_size(ctx);
     entry.ret_type()->Accept(ret_size);
@@ -175,7 +229,7 @@ bool ConstructLVarTable(CodeGenContext &ctx,
 
             LVarTable::Entry entry(LVarTable::Entry::CalleeAllocArg, regnum,
                                    table.CalleeSize(), param.type());
-            table.Insert(std::string(param.name().value()), std::move(entry));
+            table.Insert(param.name().value(), std::move(entry));
 
             regnum++;
         } else {
@@ -186,7 +240,7 @@ bool ConstructLVarTable(CodeGenContext &ctx,
 
             LVarTable::Entry entry(LVarTable::Entry::CallerAllocArg, 0,
                                    table.CallerSize(), param.type());
-            table.Insert(std::string(param.name().value()), std::move(entry));
+            table.Insert(param.name().value(), std::move(entry));
 
             table.AddCallerSize(RoundUp(size.size(), 8));
         }
@@ -198,7 +252,7 @@ bool ConstructLVarTable(CodeGenContext &ctx,
 
         LVarTable::Entry ret_entry(LVarTable::Entry::CallerAllocRet, 0,
                                    table.CallerSize(), entry.ret_type());
-        table.Insert(std::string(LVarTable::ret_name), std::move(ret_entry));
+        table.Insert(LVarTable::ret_name, std::move(ret_entry));
 
         table.AddCallerSize(ret_size.size());
     }
@@ -218,14 +272,11 @@ bool ConstructLVarTable(CodeGenContext &ctx,
 
         LVarTable::Entry entry(LVarTable::Entry::CalleeLVar, 0,
                                table.CalleeSize(), decl.type());
-        table.Insert(std::string(decl.name().value()), std::move(entry));
+        table.Insert(decl.name().value(), std::move(entry));
     }
 
     // Ensure the stack aligned 8 bytes
-    auto prev = table.CalleeSize();
     table.AlignCalleeSize(8);
-    auto diff = table.CalleeSize() - prev;
-    if (diff) ctx.printer().PrintLn("    subq ${}, %rsp", diff);
 
     return true;
 }
@@ -85,7 +85,7 @@ static uint64_t RoundUp(uint64_t n, uint64_t t) {
     return n;
 }
 
-static std::shared_ptr<hir::Type> ConvertTypeAtVariadic(
+std::shared_ptr<hir::Type> ConvertTypeAtVariadic(
     const std::shared_ptr<hir::Type> &type) {
     if (type->IsBuiltin() && type->ToBuiltin()->IsInteger()) {
         // If the callee expect larger integer than passed one, the passed value
@@ -97,23 +97,27 @@ static std::shared_ptr<hir::Type> ConvertTypeAtVariadic(
         // So, it's safe to extend the integer to biggest one, and here I return
         // isize or usize.
         if (type->ToBuiltin()->IsSigned()) {
-            return std::make_shared<hir::BuiltinType>(hir::BuiltinType::ISize,
+            return hir::MakeType<hir::BuiltinType>(hir::BuiltinType::ISize,
                                                       type->span());
         } else {
-            return std::make_shared<hir::BuiltinType>(hir::BuiltinType::USize,
+            return hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
                                                       type->span());
         }
     } else if (type->IsArray()) {
-        return std::make_shared<hir::PointerType>(type->ToArray()->of(),
+        return hir::MakeType<hir::PointerType>(type->ToArray()->of(),
                                                   type->span());
     } else {
         return type;
     }
 }
 
+// Returns the type of `expr` resolved by AnnotateExprTypes.
+// If it's not resolved, generate `expr` without output to report why.
 static std::shared_ptr<hir::Type> InferExprType(
     CodeGenContext &ctx, const std::unique_ptr<hir::Expression> &expr,
     std::optional<std::shared_ptr<hir::Type>> &array_base_type) {
+    if (expr->inferred_type()) return expr->inferred_type();
+
     ctx.SuppressOutput();
     ctx.lvar_table().SaveCalleeSize();
     ExprRValGen gen(ctx, array_base_type);
@@ -190,6 +194,7 @@ public:
                 array_base_type.emplace(params.at(i).second->ToArray()->of());
             }
             auto inferred = InferExprType(ctx, arg, array_base_type);
+            if (!inferred) return false;
 
             // If it's variadic, infer expected type from inferred type.
             std::shared_ptr<hir::Type> expect_type =
@@ -197,11 +202,10 @@ public:
                                   : ConvertTypeAtVariadic(inferred);
 
             ctx.SuppressOutput();
-            if (!ImplicitlyConvertValueInStack(ctx, arg->span(), inferred,
-                                               expect_type)) {
-                return false;
-            }
+            auto convertible = ImplicitlyConvertValueInStack(
+                ctx, arg->span(), inferred, expect_type);
             ctx.ActivateOutput();
+            if (!convertible) return false;
 
             TypeSizeCalc size(ctx);
             expect_type->Accept(size);
@@ -233,13 +237,13 @@ private:
     uint64_t ret_offset_;
 };
 
-static std::optional<std::string> IsVariable(
+static std::optional<Symbol> IsVariable(
     const std::unique_ptr<hir::Expression> &expr) {
     class IsVariable : public hir::ExpressionVisitor {
     public:
         IsVariable() : success_(false) {}
         explicit operator bool() const { return success_; }
-        const std::string &value() const { return value_; }
+        Symbol value() const { return value_; }
         void Visit(const hir::UnaryExpression &) override {}
         void Visit(const hir::InfixExpression &) override {}
         void Visit(const hir::IndexExpression &) override {}
@@ -263,7 +267,7 @@ static std::optional<std::string> IsVariable(
 
     private:
         bool success_;
-        std::string value_;
+        Symbol value_;
     };
 
     IsVariable check;
@@ -284,10 +288,7 @@ static void AllocateAlignedStackMemory(CodeGenContext &ctx, uint64_t size,
     if (diff) ctx.printer().PrintLn("    subq ${}, %rsp", diff);
 }
 
-// Returns true if the object which type is `type` should be passed by pointer
-// when it was generated as rvalue.
-static bool IsFatObject(CodeGenContext &ctx,
-                        const std::shared_ptr<hir::Type> &type) {
+bool IsFatObject(CodeGenContext &ctx, const std::shared_ptr<hir::Type> &type) {
     auto is_array = type->IsArray();
     auto is_struct =
         type->IsName() && ctx.struct_table().Exists(type->ToName()->value());
@@ -345,7 +346,7 @@ static bool GenMinusExpr(CodeGenContext &ctx,
             break;
     }
 
-    inferred = std::make_shared<hir::BuiltinType>(kind, expr.span());
+    inferred = hir::MakeType<hir::BuiltinType>(kind, expr.span());
     return true;
 }
 
@@ -369,7 +370,7 @@ static bool GenInvExpr(CodeGenContext &ctx,
 
     ctx.printer().PrintLn("    {} (%rsp)", AsmNot(size.size()));
 
-    inferred = std::make_shared<hir::BuiltinType>(builtin->kind(), expr.span());
+    inferred = hir::MakeType<hir::BuiltinType>(builtin->kind(), expr.span());
     return true;
 }
 
@@ -389,7 +390,7 @@ static bool GenNegExpr(CodeGenContext &ctx,
     ctx.printer().PrintLn("    xorb $1, (%rsp)");
 
     inferred =
-        std::make_shared<hir::BuiltinType>(hir::BuiltinType::Bool, expr.span());
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool, expr.span());
     return true;
 }
 
@@ -400,7 +401,7 @@ void ExprRValGen::Visit(const hir::UnaryExpression &expr) {
         if (!gen) return;
 
         inferred_ =
-            std::make_shared<hir::PointerType>(gen.inferred(), expr.span());
+            hir::MakeType<hir::PointerType>(gen.inferred(), expr.span());
         success_ = true;
     } else if (expr.op().kind() == hir::UnaryExpression::Op::Deref) {
         ExprRValGen gen(ctx_);
@@ -532,7 +533,7 @@ static bool GenAdditiveExpr(CodeGenContext &ctx,
     if (!gen_rhs) return false;
 
     if (gen_lhs.inferred()->IsPointer()) {
-        auto to = std::make_shared<hir::BuiltinType>(hir::BuiltinType::USize,
+        auto to = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
                                                      lhs->span());
         if (!ImplicitlyConvertValueInStack(ctx, rhs->span(), gen_rhs.inferred(),
                                            to)) {
@@ -546,8 +547,7 @@ static bool GenAdditiveExpr(CodeGenContext &ctx,
         // Calculate how much to add/sub to pointer.
         ctx.lvar_table().SubCalleeSize(8);
         ctx.printer().PrintLn("    popq %rax");
-        ctx.printer().PrintLn("    movq ${}, %rbx", size.size());
-        ctx.printer().PrintLn("    mulq %rbx");
+        MulByConst(ctx, Register::AX, Register::BX, 8, size.size());
 
         // Free memory allocated by rhs.
         auto diff = ctx.lvar_table().RestoreCalleeSize();
@@ -735,7 +735,7 @@ static bool GenBooleanExpr(CodeGenContext &ctx,
     if (!gen_rhs) return false;
 
     if (gen_lhs.inferred()->IsBuiltin() && gen_rhs.inferred()->IsBuiltin()) {
-        auto to = std::make_shared<hir::BuiltinType>(hir::BuiltinType::Bool,
+        auto to = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool,
                                                      expr.span());
 
         // Convert rhs to proper type, then pop it from stack
@@ -923,20 +923,27 @@ static bool GenComparsonExpr(CodeGenContext &ctx,
                 Register(Register::BX).ToNameBySize(size.size()));
         }
 
+        // Unsigned integers and enums based on them are compared as unsigned.
+        auto base = merged.value();
+        if (base->IsName() && ctx.enum_table().Exists(base->ToName()->value())) {
+            base = ctx.enum_table().Query(base->ToName()->value()).base_type();
+        }
+        bool is_signed = base->IsBuiltin() && base->ToBuiltin()->IsSigned();
+
         if (expr.op().kind() == hir::InfixExpression::Op::EQ) {
             ctx.printer().PrintLn("    sete %al");
         } else if (expr.op().kind() == hir::InfixExpression::Op::NE) {
             ctx.printer().PrintLn("    setne %al");
         } else if (expr.op().kind() == hir::InfixExpression::Op::LT ||
                    expr.op().kind() == hir::InfixExpression::Op::GT) {
-            ctx.printer().PrintLn("    setl %al");
+            ctx.printer().PrintLn("    {} %al", is_signed ? "setl" : "setb");
         } else {
-            ctx.printer().PrintLn("    setle %al");
+            ctx.printer().PrintLn("    {} %al", is_signed ? "setle" : "setbe");
         }
         ctx.printer().PrintLn("    movzbq %al, %rax");
         ctx.printer().PrintLn("    movq %rax, (%rsp)");
 
-        inferred = std::make_shared<hir::BuiltinType>(hir::BuiltinType::Bool,
+        inferred = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool,
                                                       expr.span());
         return true;
     } else {
@@ -1260,7 +1267,7 @@ void ExprRValGen::Visit(const hir::ESizeofExpression &expr) {
 
     ctx_.printer().PrintLn("    pushq ${}", size.size());
 
-    inferred_ = std::make_shared<hir::BuiltinType>(hir::BuiltinType::USize,
+    inferred_ = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
                                                    expr.span());
     success_ = true;
 }
@@ -1273,7 +1280,7 @@ void ExprRValGen::Visit(const hir::TSizeofExpression &expr) {
     ctx_.lvar_table().AddCalleeSize(8);
     ctx_.printer().PrintLn("    pushq ${}", size.size());
 
-    inferred_ = std::make_shared<hir::BuiltinType>(hir::BuiltinType::USize,
+    inferred_ = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
                                                    expr.span());
     success_ = true;
 }
@@ -1297,8 +1304,7 @@ void ExprRValGen::Visit(const hir::EnumSelectExpression &expr) {
     ctx_.lvar_table().AddCalleeSize(8);
     ctx_.printer().PrintLn("    pushq ${}", value);
 
-    inferred_ = std::make_shared<hir::NameType>(std::string(expr.src().value()),
-                                                expr.span());
+    inferred_ = hir::MakeType<hir::NameType>(expr.src().value(), expr.span());
     success_ = true;
 }
 
@@ -1347,7 +1353,7 @@ void ExprRValGen::Visit(const hir::IntegerExpression &expr) {
     ctx_.lvar_table().AddCalleeSize(8);
     ctx_.printer().PrintLn("    pushq ${}", expr.value());
 
-    inferred_ = std::make_shared<hir::BuiltinType>(kind, expr.span());
+    inferred_ = hir::MakeType<hir::BuiltinType>(kind, expr.span());
     success_ = true;
 }
 
@@ -1359,8 +1365,8 @@ void ExprRValGen::Visit(const hir::StringExpression &expr) {
     ctx_.printer().PrintLn("    pushq %rax");
 
     auto of =
-        std::make_shared<hir::BuiltinType>(hir::BuiltinType::Char, expr.span());
-    inferred_ = std::make_shared<hir::ArrayType>(of, expr.value().size() + 1,
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Char, expr.span());
+    inferred_ = hir::MakeType<hir::ArrayType>(of, expr.value().size() + 1,
                                                  expr.span());
     success_ = true;
 }
@@ -1369,7 +1375,7 @@ void ExprRValGen::Visit(const hir::CharExpression &expr) {
     ctx_.lvar_table().AddCalleeSize(8);
     ctx_.printer().PrintLn("    pushq ${}", (int)expr.value());
     inferred_ =
-        std::make_shared<hir::BuiltinType>(hir::BuiltinType::Char, expr.span());
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Char, expr.span());
     success_ = true;
 }
 
@@ -1377,7 +1383,7 @@ void ExprRValGen::Visit(const hir::BoolExpression &expr) {
     ctx_.lvar_table().AddCalleeSize(8);
     ctx_.printer().PrintLn("    pushq ${}", expr.value() ? 1 : 0);
     inferred_ =
-        std::make_shared<hir::BuiltinType>(hir::BuiltinType::Bool, expr.span());
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool, expr.span());
     success_ = true;
 }
 
@@ -1386,13 +1392,13 @@ void ExprRValGen::Visit(const hir::NullPtrExpression &expr) {
     ctx_.printer().PrintLn("    pushq ${}", 0);
 
     auto of =
-        std::make_shared<hir::BuiltinType>(hir::BuiltinType::Void, expr.span());
-    inferred_ = std::make_shared<hir::PointerType>(of, expr.span());
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Void, expr.span());
+    inferred_ = hir::MakeType<hir::PointerType>(of, expr.span());
     success_ = true;
 }
 
 void ExprRValGen::Visit(const hir::StructExpression &expr) {
-    hir::NameType type(std::string(expr.name().value()), expr.span());
+    hir::NameType type(expr.name().value(), expr.span());
 
     if (!ctx_.struct_table().Exists(expr.name().value())) {
         ReportInfo info(expr.name().span(), "no such struct exists", "");
@@ -1448,7 +1454,7 @@ void ExprRValGen::Visit(const hir::StructExpression &expr) {
     ctx_.lvar_table().AddCalleeSize(8);
     ctx_.printer().PrintLn("    pushq %rsp");
 
-    inferred_ = std::make_shared<hir::NameType>(type);
+    inferred_ = hir::MakeType<hir::NameType>(type);
     success_ = true;
 }
 
@@ -1511,7 +1517,7 @@ void ExprRValGen::Visit(const hir::ArrayExpression &expr) {
     ctx_.lvar_table().AddCalleeSize(8);
     ctx_.printer().PrintLn("    pushq %rsp");
 
-    inferred_ = std::make_shared<hir::ArrayType>(
+    inferred_ = hir::MakeType<hir::ArrayType>(
         array_base_type_.value(), expr.inits().size(), expr.span());
     success_ = true;
 }
@@ -1575,7 +1581,7 @@ void ExprLValGen::Visit(const hir::IndexExpression &expr) {
     if (!gen_index) return;
 
     // Convert index to usize.
-    auto to = std::make_shared<hir::BuiltinType>(hir::BuiltinType::USize,
+    auto to = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
                                                  expr.index()->span());
     if (!ImplicitlyConvertValueInStack(ctx_, expr.index()->span(),
                                        gen_index.inferred(), to)) {
@@ -1587,8 +1593,7 @@ void ExprLValGen::Visit(const hir::IndexExpression &expr) {
     ctx_.printer().PrintLn("    popq %rax");
 
     // Calculate offset to the element
-    ctx_.printer().PrintLn("    movq ${}, %rbx", of_size.size());
-    ctx_.printer().PrintLn("    mulq %rbx");
+    MulByConst(ctx_, Register::AX, Register::BX, 8, of_size.size());
 
     // Free memory allocated by rhs so top of stack to be generated address.
     auto diff = ctx_.lvar_table().RestoreCalleeSize();
@@ -1624,7 +1629,7 @@ void ExprLValGen::Visit(const hir::AccessExpression &expr) {
         Report(ctx_.ctx(), ReportLevel::Error, info);
         return;
     }
-    auto &name = type->ToName()->value();
+    auto name = type->ToName()->value();
 
     // Here, top of stack is pointer to struct, because
     // - If it is pointer to struct, it trivial.
@@ -1754,16 +1759,16 @@ bool ImplicitlyConvertValueInStack(
                     ctx.printer().PrintLn("    movzbq (%rsp), %rax");
                     conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::Int16) {
-                    ctx.printer().PrintLn("    movsbw (%rsp), %ax");
+                    ctx.printer().PrintLn("    movzbw (%rsp), %ax");
                     conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::Int32) {
-                    ctx.printer().PrintLn("    movsbl (%rsp), %eax");
+                    ctx.printer().PrintLn("    movzbl (%rsp), %eax");
                     conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::Int64) {
-                    ctx.printer().PrintLn("    movsbq (%rsp), %rax");
+                    ctx.printer().PrintLn("    movzbq (%rsp), %rax");
                     conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::ISize) {
-                    ctx.printer().PrintLn("    movsbq (%rsp), %rax");
+                    ctx.printer().PrintLn("    movzbq (%rsp), %rax");
                     conversion_happen = true;
                 } else {
                     goto failed;
@@ -1781,13 +1786,13 @@ bool ImplicitlyConvertValueInStack(
                     ctx.printer().PrintLn("    movzwq (%rsp), %rax");
                     conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::Int32) {
-                    ctx.printer().PrintLn("    movswl (%rsp), %eax");
+                    ctx.printer().PrintLn("    movzwl (%rsp), %eax");
                     conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::Int64) {
-                    ctx.printer().PrintLn("    movswq (%rsp), %rax");
+                    ctx.printer().PrintLn("    movzwq (%rsp), %rax");
                     conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::ISize) {
-                    ctx.printer().PrintLn("    movswq (%rsp), %rax");
+                    ctx.printer().PrintLn("    movzwq (%rsp), %rax");
                     conversion_happen = true;
                 } else {
                     goto failed;
@@ -1796,14 +1801,17 @@ bool ImplicitlyConvertValueInStack(
                 if (to_kind == hir::BuiltinType::UInt32) {
                     // no conversion
                 } else if (to_kind == hir::BuiltinType::UInt64) {
-                    // no conversion, as movzlq doesn't exists
+                    // Writing to 32-bit register clears the upper half.
+                    ctx.printer().PrintLn("    movl (%rsp), %eax");
+                    conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::USize) {
-                    // no conversion, as movzlq doesn't exists
+                    ctx.printer().PrintLn("    movl (%rsp), %eax");
+                    conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::Int64) {
-                    ctx.printer().PrintLn("    movslq (%rsp), %rax");
+                    ctx.printer().PrintLn("    movl (%rsp), %eax");
                     conversion_happen = true;
                 } else if (to_kind == hir::BuiltinType::ISize) {
-                    ctx.printer().PrintLn("    movslq (%rsp), %rax");
+                    ctx.printer().PrintLn("    movl (%rsp), %eax");
                     conversion_happen = true;
                 } else {
                     goto failed;
@@ -94,6 +94,14 @@ bool ImplicitlyConvertValueInStack(
     const std::shared_ptr<hir::Type> &to,
     const std::shared_ptr<hir::Type> &from_original = nullptr);
 
+// Returns true if the object which type is `type` should be passed by pointer
+// when it was generated as rvalue.
+bool IsFatObject(CodeGenContext &ctx, const std::shared_ptr<hir::Type> &type);
+
+// Returns the type which a variadic argument of `type` is passed as.
+std::shared_ptr<hir::Type> ConvertTypeAtVariadic(
+    const std::shared_ptr<hir::Type> &type);
+
 }  // namespace mini
 
 #endif  // MINI_CODEGEN_EXPR_H_
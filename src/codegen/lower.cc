@@ -0,0 +1,1091 @@
+#include "lower.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "asm.h"
+#include "fmt/format.h"
+#include "regalloc.h"
+
+namespace mini {
+
+namespace {
+
+uint64_t RoundUp(uint64_t n, uint64_t t) { return (n + t - 1) / t * t; }
+
+constexpr Register::Kind arg_regs[6] = {Register::DI, Register::SI,
+                                        Register::DX, Register::CX,
+                                        Register::R8, Register::R9};
+
+constexpr Register::Kind callee_saved_regs[5] = {
+    Register::BX, Register::R12, Register::R13, Register::R14, Register::R15};
+
+constexpr std::string_view mov_names[4] = {"movb", "movw", "movl", "movq"};
+
+// Conditional jumps of comparisons and of their negations, indexed from
+// `mir::Opcode::Eq`.
+constexpr std::string_view jcc_names[10] = {"je", "jne", "jl", "jle", "jg",
+                                            "jge", "jb", "jbe", "ja", "jae"};
+constexpr std::string_view neg_jcc_names[10] = {
+    "jne", "je", "jge", "jg", "jle", "jl", "jae", "ja", "jbe", "jb"};
+
+std::string_view AsmMov(uint8_t size) {
+    switch (size) {
+        case 1:
+            return mov_names[0];
+        case 2:
+            return mov_names[1];
+        case 4:
+            return mov_names[2];
+        default:
+            return mov_names[3];
+    }
+}
+
+char Suffix(uint8_t size) {
+    switch (size) {
+        case 1:
+            return 'b';
+        case 2:
+            return 'w';
+        case 4:
+            return 'l';
+        default:
+            return 'q';
+    }
+}
+
+// Truncates `imm` to `size` bytes as a signed integer.
+int64_t TruncImm(int64_t imm, uint8_t size) {
+    switch (size) {
+        case 1:
+            return static_cast<int8_t>(imm);
+        case 2:
+            return static_cast<int16_t>(imm);
+        case 4:
+            return static_cast<int32_t>(imm);
+        default:
+            return imm;
+    }
+}
+
+// Multiplier and shift which divide unsigned integers by a constant with the
+// upper half of their product, as in "Division by Invariant Integers using
+// Multiplication". If `add` is set, the multiplier has 65 bits whose top is
+// not included, and the dividend is added back halfway.
+struct UnsignedMagic {
+    uint64_t mul;
+    int shift;
+    bool add;
+};
+
+// `divisor` must not be a power of two. Dividends of less than 8 bytes never
+// need the 65-bit multiplier.
+UnsignedMagic MagicUnsigned(uint64_t divisor, uint8_t size) {
+    using uint128 = unsigned __int128;
+    int log = 63 - __builtin_clzll(divisor);
+    uint128 num = uint128(1) << (64 + log);
+    auto mul = uint64_t(num / divisor);
+    auto rem = uint64_t(num % divisor);
+    if (size < 8 || divisor - rem < (uint64_t(1) << log)) {
+        return {mul + 1, log, false};
+    }
+    uint64_t twice_rem = rem + rem;
+    mul += mul;
+    if (twice_rem >= divisor || twice_rem < rem) mul++;
+    return {mul + 1, log, true};
+}
+
+// Multiplier and shift which divide signed integers by a constant with the
+// upper half of their signed product, as in Hacker's Delight.
+struct SignedMagic {
+    int64_t mul;
+    int shift;
+};
+
+// `divisor` must not be 0, 1 nor -1.
+SignedMagic MagicSigned(int64_t divisor) {
+    constexpr uint64_t two63 = uint64_t(1) << 63;
+    uint64_t abs = divisor < 0 ? -uint64_t(divisor) : uint64_t(divisor);
+    uint64_t t = two63 + (uint64_t(divisor) >> 63);
+    uint64_t anc = t - 1 - t % abs;
+    uint64_t q1 = two63 / anc, r1 = two63 - q1 * anc;
+    uint64_t q2 = two63 / abs, r2 = two63 - q2 * abs;
+    uint64_t delta;
+    int p = 63;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= abs) {
+            q2++;
+            r2 -= abs;
+        }
+        delta = abs - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    auto mul = int64_t(q2 + 1);
+    return {divisor < 0 ? -mul : mul, p - 64};
+}
+
+// A source or destination of moves between blocks and around calls. Memory
+// is always relative to the frame base.
+struct Place {
+    enum Kind {
+        Reg,
+        Mem,
+        Imm,
+    };
+
+    inline bool operator==(const Place &rhs) const {
+        return kind == rhs.kind &&
+               (kind == Reg ? reg == rhs.reg : value == rhs.value);
+    }
+
+    Kind kind;
+    Register reg;
+    int64_t value;  // Offset from the frame base, or the immediate.
+};
+
+// A move of `size` bytes, zero-extended to the whole register if smaller
+// than 8 bytes.
+struct Move {
+    Place dst;
+    Place src;
+    uint8_t size;
+};
+
+// Values live in registers the allocator assigned, or in 8-byte spill slots,
+// and instructions use rax, rcx and rdx as scratch.
+class Lowering {
+public:
+    Lowering(CodeGenContext &ctx, const mir::Function &func,
+             const std::vector<mir::BlockId> &order)
+        : ctx_(ctx),
+          func_(func),
+          order_(order),
+          alloc_(AllocateRegisters(func, order)),
+          fused_(func.ValueCount(), false) {}
+    void Run();
+
+private:
+    const ValueLocation &Loc(mir::Value value) const {
+        return alloc_.Query(value);
+    }
+    bool InReg(mir::Value value) const {
+        return Loc(value).kind() == ValueLocation::Reg;
+    }
+    bool InReg(mir::Value value, Register reg) const {
+        return InReg(value) && Loc(value).reg() == reg;
+    }
+    uint8_t SizeOf(mir::Value value) const {
+        return mir::SizeOf(func_.TypeOf(value));
+    }
+
+    // Returns `value` as an operand of `size` bytes.
+    AsmOperand Operand(mir::Value value, uint8_t size) const;
+
+    // Same as Operand, but moves constants to `scratch` as some instructions
+    // don't take immediates.
+    AsmOperand RegOrMem(mir::Value value, uint8_t size, Register scratch);
+
+    // Returns the register of `value`, or `scratch` if it's spilled, where
+    // the result of instruction is computed.
+    Register DstReg(mir::Value value, Register scratch) const {
+        return InReg(value) ? Loc(value).reg() : scratch;
+    }
+
+    // Moves `size` bytes in `reg` to `value` if these are not the same.
+    void SetDst(mir::Value value, Register reg, uint8_t size);
+
+    // Returns the value of `value` if it's a constant, including the ones
+    // which don't fit in an immediate.
+    std::optional<int64_t> ConstOf(mir::Value value) const;
+
+    // Moves `value` to `reg` unless it's already there.
+    void MoveTo(Register reg, mir::Value value, uint8_t size);
+
+    // Returns a register holding `value` as an address.
+    Register AddrReg(mir::Value value, Register scratch);
+
+    Place PlaceOf(mir::Value value) const;
+    void EmitMove(const Move &move);
+
+    // Performs `moves` as if all sources are read before any destination is
+    // written. Destinations must be distinct.
+    void ParallelMove(std::vector<Move> &&moves);
+
+    void LayoutFrame();
+    void FindFusedCompares();
+    void LowerInst(const mir::Instruction &inst, mir::BlockId block,
+                   mir::BlockId next);
+    void LowerCompare(const mir::Instruction &inst);
+    void LowerMul(const mir::Instruction &inst);
+    void LowerDiv(const mir::Instruction &inst);
+    bool LowerDivByConst(const mir::Instruction &inst);
+    void LowerCall(const mir::Instruction &inst);
+    void LowerTailCall(const mir::Instruction &inst);
+    void RestoreFrame();
+    void LowerBranch(const mir::Instruction &inst, mir::BlockId block,
+                     mir::BlockId next);
+    void CopyPhis(mir::BlockId from, mir::BlockId to);
+    void JumpTo(mir::BlockId target, mir::BlockId next);
+
+    CodeGenContext &ctx_;
+    const mir::Function &func_;
+    const std::vector<mir::BlockId> &order_;
+    RegAllocResult alloc_;
+
+    // Comparisons generated with the branch using its result.
+    std::vector<bool> fused_;
+
+    // Values of constants by their value.
+    std::unordered_map<mir::Value, int64_t> consts_;
+
+    // Callee-saved registers the function uses, saved at the top of frame.
+    std::vector<Register> saved_regs_;
+
+    // Leaf functions whose frame fits in the red zone don't set up rbp nor
+    // move rsp, and address the frame from rsp.
+    bool frameless_ = false;
+    std::string_view base_ = "%rbp";
+
+    std::vector<int64_t> slot_offsets_;
+    std::vector<int64_t> spill_offsets_;
+    uint64_t frame_size_ = 0;
+};
+
+AsmOperand Lowering::Operand(mir::Value value, uint8_t size) const {
+    const auto &loc = Loc(value);
+    switch (loc.kind()) {
+        case ValueLocation::Reg:
+            return loc.reg().ToNameBySize(size);
+        case ValueLocation::Const:
+            return AsmOperand::Immediate(TruncImm(loc.imm(), size));
+        default:
+            return AsmPtrRepr{-spill_offsets_[loc.spill()], base_};
+    }
+}
+
+AsmOperand Lowering::RegOrMem(mir::Value value, uint8_t size,
+                              Register scratch) {
+    if (Loc(value).kind() != ValueLocation::Const) return Operand(value, size);
+    MoveTo(scratch, value, size);
+    return scratch.ToNameBySize(size);
+}
+
+std::optional<int64_t> Lowering::ConstOf(mir::Value value) const {
+    auto it = consts_.find(value);
+    if (it == consts_.end()) return std::nullopt;
+    return it->second;
+}
+
+// Moves between registers write at least 4 bytes, as writing to a part of
+// register depends on its previous value.
+void Lowering::SetDst(mir::Value value, Register reg, uint8_t size) {
+    if (InReg(value, reg)) return;
+    if (InReg(value) && size < 4) {
+        ctx_.printer().PrintLn("    movl {}, {}", reg.ToLongName(),
+                               Loc(value).reg().ToLongName());
+        return;
+    }
+    ctx_.printer().PrintLn("    {} {}, {}", AsmMov(size),
+                           reg.ToNameBySize(size), Operand(value, size));
+}
+
+void Lowering::MoveTo(Register reg, mir::Value value, uint8_t size) {
+    if (InReg(value, reg)) return;
+    auto &printer = ctx_.printer();
+    auto src = Operand(value, size);
+    if (size >= 4) {
+        printer.PrintLn("    {} {}, {}", AsmMov(size), src,
+                        reg.ToNameBySize(size));
+    } else if (src.kind == AsmOperand::Ptr) {
+        printer.PrintLn("    movz{}l {}, {}", size == 1 ? 'b' : 'w', src,
+                        reg.ToLongName());
+    } else {
+        printer.PrintLn("    movl {}, {}", Operand(value, 4), reg.ToLongName());
+    }
+}
+
+Register Lowering::AddrReg(mir::Value value, Register scratch) {
+    if (InReg(value)) return Loc(value).reg();
+    MoveTo(scratch, value, 8);
+    return scratch;
+}
+
+Place Lowering::PlaceOf(mir::Value value) const {
+    const auto &loc = Loc(value);
+    switch (loc.kind()) {
+        case ValueLocation::Reg:
+            return {Place::Reg, loc.reg(), 0};
+        case ValueLocation::Const:
+            return {Place::Imm, Register::AX, loc.imm()};
+        default:
+            return {Place::Mem, Register::AX, -spill_offsets_[loc.spill()]};
+    }
+}
+
+void Lowering::EmitMove(const Move &move) {
+    auto &printer = ctx_.printer();
+    const auto &[dst, src, size] = move;
+    AsmOperand src_op = src.kind == Place::Reg
+                            ? AsmOperand(src.reg.ToNameBySize(size))
+                        : src.kind == Place::Mem
+                            ? AsmOperand(AsmPtrRepr{src.value, base_})
+                            : AsmOperand::Immediate(src.value);
+
+    if (dst.kind == Place::Mem) {
+        AsmPtrRepr dst_ptr{dst.value, base_};
+        if (src.kind == Place::Mem) {
+            printer.PrintLn("    pushq {}", src_op);
+            printer.PrintLn("    popq {}", dst_ptr);
+        } else {
+            printer.PrintLn("    movq {}, {}", src_op, dst_ptr);
+        }
+        return;
+    }
+
+    if (src.kind == Place::Imm) {
+        // Writing to 32-bit register clears the upper half.
+        if (size == 8) {
+            printer.PrintLn("    movq {}, {}", src_op, dst.reg.ToQuadName());
+        } else {
+            auto imm = size == 4 ? TruncImm(src.value, 4)
+                                 : src.value & ((int64_t(1) << size * 8) - 1);
+            printer.PrintLn("    movl ${}, {}", imm, dst.reg.ToLongName());
+        }
+        return;
+    }
+
+    switch (size) {
+        case 1:
+            printer.PrintLn("    movzbl {}, {}", src_op, dst.reg.ToLongName());
+            break;
+        case 2:
+            printer.PrintLn("    movzwl {}, {}", src_op, dst.reg.ToLongName());
+            break;
+        case 4:
+            printer.PrintLn("    movl {}, {}", src_op, dst.reg.ToLongName());
+            break;
+        default:
+            printer.PrintLn("    movq {}, {}", src_op, dst.reg.ToQuadName());
+            break;
+    }
+}
+
+void Lowering::ParallelMove(std::vector<Move> &&moves) {
+    moves.erase(std::remove_if(moves.begin(), moves.end(),
+                               [](const Move &move) {
+                                   return move.size == 8 &&
+                                          move.dst == move.src;
+                               }),
+                moves.end());
+
+    Place ax{Place::Reg, Register::AX, 0};
+    while (!moves.empty()) {
+        // Perform a move whose destination no other move reads.
+        auto ready = std::find_if(moves.begin(), moves.end(), [&](auto &move) {
+            return std::none_of(moves.begin(), moves.end(), [&](auto &other) {
+                return &other != &move && other.src == move.dst;
+            });
+        });
+        if (ready != moves.end()) {
+            EmitMove(*ready);
+            moves.erase(ready);
+            continue;
+        }
+
+        // Every destination is read by another move, so these form cycles.
+        // Save one destination to rax to break its cycle.
+        auto saved = moves.front().dst;
+        EmitMove({ax, saved, 8});
+        for (auto &move : moves) {
+            if (move.src == saved) move.src = ax;
+        }
+    }
+}
+
+void Lowering::LayoutFrame() {
+    std::vector<bool> used(16, false);
+    for (mir::Value value = 0; value < func_.ValueCount(); value++) {
+        const auto &loc = Loc(value);
+        if (loc.kind() == ValueLocation::Reg) used[loc.reg().kind()] = true;
+    }
+    for (auto reg : callee_saved_regs) {
+        if (used[reg]) saved_regs_.push_back(reg);
+    }
+
+    uint64_t size = 8 * saved_regs_.size();
+    for (const auto &slot : func_.slots()) {
+        size = RoundUp(size + slot.size, std::max<uint64_t>(slot.align, 1));
+        slot_offsets_.push_back(size);
+    }
+    for (uint32_t i = 0; i < alloc_.spill_count(); i++) {
+        size = RoundUp(size, 8) + 8;
+        spill_offsets_.push_back(size);
+    }
+
+    // Arguments which are not passed by register are placed at the bottom.
+    bool is_leaf = true;
+    uint64_t out_args = 0;
+    for (auto id : order_) {
+        for (const auto &inst : func_.blocks()[id].insts) {
+            if (inst.op != mir::Opcode::Call) continue;
+            is_leaf = false;
+            if (inst.args.size() > 6) {
+                out_args = std::max<uint64_t>(out_args,
+                                              (inst.args.size() - 6) * 8);
+            }
+        }
+    }
+
+    // Moves between spill slots push to the stack, which would overwrite the
+    // red zone.
+    if (is_leaf && alloc_.spill_count() == 0 && size <= 128) {
+        frameless_ = true;
+        base_ = "%rsp";
+        frame_size_ = 0;
+    } else {
+        frame_size_ = RoundUp(size + out_args, 16);
+    }
+}
+
+// A comparison is fused with a branch if the branch immediately follows it and
+// is the only use of the result, so that flags are still there.
+void Lowering::FindFusedCompares() {
+    std::vector<uint32_t> use_counts(func_.ValueCount(), 0);
+    for (auto id : order_) {
+        for (const auto &inst : func_.blocks()[id].insts) {
+            for (auto arg : inst.args) use_counts[arg]++;
+        }
+    }
+    for (auto id : order_) {
+        const auto &insts = func_.blocks()[id].insts;
+        if (insts.size() < 2) continue;
+        const auto &branch = insts.back(), &cmp = insts[insts.size() - 2];
+        if (branch.op == mir::Opcode::Branch && mir::IsCompare(cmp.op) &&
+            branch.args[0] == cmp.dst && use_counts[cmp.dst] == 1) {
+            fused_[cmp.dst] = true;
+        }
+    }
+}
+
+void Lowering::Run() {
+    auto &printer = ctx_.printer();
+    LayoutFrame();
+    FindFusedCompares();
+    for (auto id : order_) {
+        for (const auto &inst : func_.blocks()[id].insts) {
+            if (inst.op == mir::Opcode::Const) consts_[inst.dst] = inst.imm;
+        }
+    }
+
+    printer.PrintLn("    .text");
+    printer.PrintLn("    .type {}, @function", func_.name());
+    if (!ctx_.ctx().whole_program() || func_.name() == Symbol("main")) {
+        printer.PrintLn("    .global {}", func_.name());
+    }
+    printer.PrintLn("{}:", func_.name());
+    if (!frameless_) {
+        printer.PrintLn("    pushq %rbp");
+        printer.PrintLn("    movq %rsp, %rbp");
+    }
+    if (frame_size_ != 0) printer.PrintLn("    subq ${}, %rsp", frame_size_);
+    for (size_t i = 0; i < saved_regs_.size(); i++) {
+        printer.PrintLn("    movq {}, {}({})", saved_regs_[i].ToQuadName(),
+                        -8 * int64_t(i + 1), base_);
+    }
+
+    // Move arguments to where these are allocated. Arguments on the stack are
+    // above the return address, and saved rbp if any.
+    int64_t stack_args = frameless_ ? 8 : 16;
+    std::vector<Move> moves;
+    for (const auto &inst : func_.blocks()[0].insts) {
+        if (inst.op != mir::Opcode::Arg) continue;
+        Place src = inst.imm < 6
+                        ? Place{Place::Reg, arg_regs[inst.imm], 0}
+                        : Place{Place::Mem, Register::AX,
+                                stack_args + 8 * (inst.imm - 6)};
+        moves.push_back({PlaceOf(inst.dst), src, 8});
+    }
+    ParallelMove(std::move(moves));
+
+    for (size_t i = 0; i < order_.size(); i++) {
+        auto block = order_[i];
+        auto next = i + 1 < order_.size() ? order_[i + 1] : mir::no_block;
+        if (block != 0) printer.PrintLn(".L.{}.{}:", func_.name(), block);
+        for (const auto &inst : func_.blocks()[block].insts) {
+            if (inst.dst != mir::no_value && fused_[inst.dst]) continue;
+
+            // The callee returns in place of the return following it.
+            if (inst.op == mir::Opcode::Call && inst.tail) {
+                LowerTailCall(inst);
+                break;
+            }
+            LowerInst(inst, block, next);
+        }
+    }
+}
+
+void Lowering::LowerInst(const mir::Instruction &inst, mir::BlockId block,
+                         mir::BlockId next) {
+    using mir::Opcode;
+    auto &printer = ctx_.printer();
+    Register ax(Register::AX), cx(Register::CX);
+    auto size = mir::SizeOf(inst.type);
+
+    switch (inst.op) {
+        case Opcode::Const: {
+            const auto &loc = Loc(inst.dst);
+            if (loc.kind() == ValueLocation::Const) break;
+            // Only 8-byte constants which don't fit in an immediate are here.
+            auto reg = DstReg(inst.dst, ax);
+            printer.PrintLn("    movq ${}, {}", inst.imm, reg.ToQuadName());
+            SetDst(inst.dst, reg, 8);
+            break;
+        }
+        case Opcode::Arg:
+            // Moved at the entry.
+            break;
+        case Opcode::SlotAddr: {
+            auto reg = DstReg(inst.dst, ax);
+            printer.PrintLn("    leaq {}({}), {}", -slot_offsets_[inst.imm],
+                            base_, reg.ToQuadName());
+            SetDst(inst.dst, reg, 8);
+            break;
+        }
+        case Opcode::StrAddr: {
+            auto reg = DstReg(inst.dst, ax);
+            printer.PrintLn("    leaq .L.{}(%rip), {}", inst.symbol,
+                            reg.ToQuadName());
+            SetDst(inst.dst, reg, 8);
+            break;
+        }
+        case Opcode::Add:
+        case Opcode::Sub:
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::Xor: {
+            std::string_view op = inst.op == Opcode::Add   ? AsmAdd(size)
+                                  : inst.op == Opcode::Sub ? AsmSub(size)
+                                  : inst.op == Opcode::And ? AsmAnd(size)
+                                  : inst.op == Opcode::Or  ? AsmOr(size)
+                                                           : AsmXor(size);
+            auto lhs = inst.args[0], rhs = inst.args[1];
+            auto reg = DstReg(inst.dst, ax);
+            if (InReg(rhs, reg) && lhs != rhs) {
+                // Moving lhs to the destination would overwrite rhs.
+                if (inst.op != Opcode::Sub) {
+                    printer.PrintLn("    {} {}, {}", op, Operand(lhs, size),
+                                    reg.ToNameBySize(size));
+                } else {
+                    MoveTo(ax, lhs, size);
+                    printer.PrintLn("    {} {}, {}", op, Operand(rhs, size),
+                                    ax.ToNameBySize(size));
+                    SetDst(inst.dst, ax, size);
+                }
+                break;
+            }
+            MoveTo(reg, lhs, size);
+            printer.PrintLn("    {} {}, {}", op, Operand(rhs, size),
+                            reg.ToNameBySize(size));
+            SetDst(inst.dst, reg, size);
+            break;
+        }
+        case Opcode::Mul:
+            LowerMul(inst);
+            break;
+        case Opcode::SDiv:
+        case Opcode::UDiv:
+        case Opcode::SRem:
+        case Opcode::URem:
+            LowerDiv(inst);
+            break;
+        case Opcode::Shl:
+        case Opcode::LShr:
+        case Opcode::AShr: {
+            std::string_view op = inst.op == Opcode::Shl  ? AsmLShift(false, size)
+                                  : inst.op == Opcode::AShr ? AsmRShift(true, size)
+                                                            : AsmRShift(false, size);
+            auto lhs = inst.args[0], rhs = inst.args[1];
+            auto reg = DstReg(inst.dst, ax);
+            const auto &count = Loc(rhs);
+            if (count.kind() == ValueLocation::Const) {
+                // The processor masks the count as it does for %cl.
+                MoveTo(reg, lhs, size);
+                printer.PrintLn("    {} ${}, {}", op,
+                                count.imm() & (size == 8 ? 63 : 31),
+                                reg.ToNameBySize(size));
+            } else {
+                printer.PrintLn("    movb {}, %cl", Operand(rhs, 1));
+                MoveTo(reg, lhs, size);
+                printer.PrintLn("    {} %cl, {}", op, reg.ToNameBySize(size));
+            }
+            SetDst(inst.dst, reg, size);
+            break;
+        }
+        case Opcode::Neg:
+        case Opcode::Not: {
+            auto reg = DstReg(inst.dst, ax);
+            MoveTo(reg, inst.args[0], size);
+            printer.PrintLn("    {} {}",
+                            inst.op == Opcode::Neg ? AsmNeg(size) : AsmNot(size),
+                            reg.ToNameBySize(size));
+            SetDst(inst.dst, reg, size);
+            break;
+        }
+        case Opcode::Eq:
+        case Opcode::Ne:
+        case Opcode::SLt:
+        case Opcode::SLe:
+        case Opcode::SGt:
+        case Opcode::SGe:
+        case Opcode::ULt:
+        case Opcode::ULe:
+        case Opcode::UGt:
+        case Opcode::UGe: {
+            static constexpr std::string_view sets[] = {
+                "sete", "setne", "setl", "setle", "setg",
+                "setge", "setb", "setbe", "seta", "setae"};
+            LowerCompare(inst);
+            auto reg = DstReg(inst.dst, ax);
+            printer.PrintLn("    {} {}",
+                            sets[static_cast<int>(inst.op) -
+                                 static_cast<int>(Opcode::Eq)],
+                            reg.ToByteName());
+            SetDst(inst.dst, reg, 1);
+            break;
+        }
+        case Opcode::SExt:
+        case Opcode::ZExt: {
+            auto from = SizeOf(inst.args[0]);
+            auto src = RegOrMem(inst.args[0], from, ax);
+            auto reg = DstReg(inst.dst, ax);
+            if (inst.op == Opcode::ZExt && from == 4) {
+                // Writing to 32-bit register clears the upper half.
+                printer.PrintLn("    movl {}, {}", src, reg.ToLongName());
+            } else if (from == 4) {
+                printer.PrintLn("    movslq {}, {}", src, reg.ToQuadName());
+            } else {
+                printer.PrintLn("    mov{}{}{} {}, {}",
+                                inst.op == Opcode::SExt ? 's' : 'z',
+                                Suffix(from), Suffix(size), src,
+                                reg.ToNameBySize(size));
+            }
+            SetDst(inst.dst, reg, size);
+            break;
+        }
+        case Opcode::Trunc: {
+            // Values are little endian, so the lower bytes are at the same
+            // address.
+            auto reg = DstReg(inst.dst, ax);
+            MoveTo(reg, inst.args[0], size);
+            SetDst(inst.dst, reg, size);
+            break;
+        }
+        case Opcode::Load: {
+            auto addr = AddrReg(inst.args[0], ax);
+            auto reg = DstReg(inst.dst, cx);
+            printer.PrintLn("    {} 0({}), {}", AsmMov(size),
+                            addr.ToQuadName(), reg.ToNameBySize(size));
+            SetDst(inst.dst, reg, size);
+            break;
+        }
+        case Opcode::Store: {
+            auto value_size = SizeOf(inst.args[1]);
+            auto addr = AddrReg(inst.args[0], ax);
+            AsmOperand value = Operand(inst.args[1], value_size);
+            if (value.kind == AsmOperand::Ptr) {
+                MoveTo(cx, inst.args[1], value_size);
+                value = cx.ToNameBySize(value_size);
+            }
+            printer.PrintLn("    {} {}, 0({})", AsmMov(value_size), value,
+                            addr.ToQuadName());
+            break;
+        }
+        case Opcode::MemCopy: {
+            ParallelMove({{{Place::Reg, Register::SI, 0},
+                           PlaceOf(inst.args[1]),
+                           8},
+                          {{Place::Reg, Register::DI, 0},
+                           PlaceOf(inst.args[0]),
+                           8}});
+            IndexableAsmRegPtr src(Register::SI, 0);
+            IndexableAsmRegPtr dst(Register::DI, 0);
+            CopyBytes(ctx_, src, dst, inst.imm);
+            break;
+        }
+        case Opcode::Call:
+            LowerCall(inst);
+            break;
+        case Opcode::Phi:
+            // Copied at the end of predecessors.
+            break;
+        case Opcode::Jump:
+            CopyPhis(block, inst.targets[0]);
+            JumpTo(inst.targets[0], next);
+            break;
+        case Opcode::Branch:
+            LowerBranch(inst, block, next);
+            break;
+        case Opcode::Return:
+            if (!inst.args.empty()) {
+                EmitMove({{Place::Reg, Register::AX, 0},
+                          PlaceOf(inst.args[0]),
+                          SizeOf(inst.args[0])});
+            }
+            RestoreFrame();
+            printer.PrintLn("    retq");
+            break;
+    }
+}
+
+// Sets flags by comparing operands of `inst`.
+void Lowering::LowerCompare(const mir::Instruction &inst) {
+    Register ax(Register::AX);
+    auto lhs = inst.args[0], rhs = inst.args[1];
+    auto size = SizeOf(lhs);
+    AsmOperand lhs_op = Operand(lhs, size), rhs_op = Operand(rhs, size);
+    if (lhs_op.kind == AsmOperand::Imm ||
+        (lhs_op.kind == AsmOperand::Ptr && rhs_op.kind == AsmOperand::Ptr)) {
+        MoveTo(ax, lhs, size);
+        lhs_op = ax.ToNameBySize(size);
+    }
+    ctx_.printer().PrintLn("    {} {}, {}", AsmCmp(size), rhs_op, lhs_op);
+}
+
+// The lower half of the product doesn't depend on the sign nor on the upper
+// bits of operands, so it's computed in at least 4 bytes by imul.
+void Lowering::LowerMul(const mir::Instruction &inst) {
+    Register ax(Register::AX), cx(Register::CX);
+    auto size = mir::SizeOf(inst.type);
+    auto width = std::max<uint8_t>(size, 4);
+    auto lhs = inst.args[0], rhs = inst.args[1];
+    if (ConstOf(lhs)) std::swap(lhs, rhs);
+
+    auto reg = DstReg(inst.dst, ax);
+    if (auto factor = ConstOf(rhs)) {
+        MoveTo(reg, lhs, size);
+        MulByConst(ctx_, reg, cx, width, *factor);
+    } else {
+        // Moving lhs to the destination would overwrite rhs.
+        if (InReg(rhs, reg) && lhs != rhs) std::swap(lhs, rhs);
+        MoveTo(reg, lhs, size);
+        ctx_.printer().PrintLn("    {} {}, {}", AsmMul(true, width),
+                               Operand(rhs, width), reg.ToNameBySize(width));
+    }
+    SetDst(inst.dst, reg, size);
+}
+
+void Lowering::LowerDiv(const mir::Instruction &inst) {
+    using mir::Opcode;
+    auto &printer = ctx_.printer();
+    Register ax(Register::AX), cx(Register::CX), dx(Register::DX);
+    auto size = mir::SizeOf(inst.type);
+    bool is_signed = inst.op == Opcode::SDiv || inst.op == Opcode::SRem;
+    bool is_rem = inst.op == Opcode::SRem || inst.op == Opcode::URem;
+
+    if (ConstOf(inst.args[1]) && !ConstOf(inst.args[0]) &&
+        LowerDivByConst(inst)) {
+        return;
+    }
+
+    MoveTo(ax, inst.args[0], size);
+    if (size == 1) {
+        // 8-bit division divides ax.
+        printer.PrintLn("    {} %al, %ax", is_signed ? "movsbw" : "movzbw");
+    } else if (is_signed) {
+        printer.PrintLn("    {}", size == 8   ? "cqo"
+                                  : size == 4 ? "cdq"
+                                              : "cwd");
+    } else {
+        printer.PrintLn("    xorl %edx, %edx");
+    }
+    printer.PrintLn("    {} {}", AsmDiv(is_signed, size),
+                    RegOrMem(inst.args[1], size, cx));
+
+    if (!is_rem) {
+        SetDst(inst.dst, ax, size);
+    } else if (size == 1) {
+        // 8-bit remainder is placed at ah, which can't be used with registers
+        // requiring REX prefix.
+        printer.PrintLn("    movb %ah, %al");
+        SetDst(inst.dst, ax, size);
+    } else {
+        SetDst(inst.dst, dx, size);
+    }
+}
+
+// Divides by a constant with shifts, or with multiplication by its
+// reciprocal, on the dividend extended to 8 bytes in rcx. Returns false if the
+// divisor is left to div, which traps on 0 and on overflow of -1.
+bool Lowering::LowerDivByConst(const mir::Instruction &inst) {
+    using mir::Opcode;
+    auto &printer = ctx_.printer();
+    Register ax(Register::AX), cx(Register::CX), dx(Register::DX);
+    auto size = mir::SizeOf(inst.type);
+    bool is_signed = inst.op == Opcode::SDiv || inst.op == Opcode::SRem;
+    bool is_rem = inst.op == Opcode::SRem || inst.op == Opcode::URem;
+    auto divisor = TruncImm(*ConstOf(inst.args[1]), size);
+    uint64_t abs;
+    if (!is_signed) {
+        abs = size == 8 ? uint64_t(divisor)
+                        : uint64_t(divisor) & ((uint64_t(1) << size * 8) - 1);
+    } else if (divisor != -1) {
+        abs = divisor < 0 ? -uint64_t(divisor) : uint64_t(divisor);
+    } else {
+        return false;
+    }
+    if (abs == 0) return false;
+
+    auto src = Operand(inst.args[0], size);
+    if (size == 8) {
+        printer.PrintLn("    movq {}, %rcx", src);
+    } else if (size == 4) {
+        printer.PrintLn("    {} {}, {}", is_signed ? "movslq" : "movl", src,
+                        is_signed ? "%rcx" : "%ecx");
+    } else {
+        printer.PrintLn("    mov{}{}{} {}, {}", is_signed ? 's' : 'z',
+                        Suffix(size), is_signed ? 'q' : 'l', src,
+                        is_signed ? "%rcx" : "%ecx");
+    }
+
+    // Computes the remainder from the quotient in `reg`.
+    auto remainder = [&](Register reg) {
+        MulByConst(ctx_, reg, reg == ax ? dx : ax, 8, divisor);
+        printer.PrintLn("    subq {}, %rcx", reg.ToQuadName());
+        SetDst(inst.dst, cx, size);
+    };
+
+    bool pow2 = (abs & (abs - 1)) == 0;
+    int log = __builtin_ctzll(abs);
+    if (pow2 && !is_signed) {
+        if (!is_rem) {
+            if (log) printer.PrintLn("    shrq ${}, %rcx", log);
+        } else if (abs - 1 <= INT32_MAX) {
+            printer.PrintLn("    andq ${}, %rcx", abs - 1);
+        } else {
+            printer.PrintLn("    movq ${}, %rax", abs - 1);
+            printer.PrintLn("    andq %rax, %rcx");
+        }
+        SetDst(inst.dst, cx, size);
+    } else if (pow2 && log == 0) {
+        // Dividing by 1.
+        if (is_rem) printer.PrintLn("    xorl %ecx, %ecx");
+        SetDst(inst.dst, cx, size);
+    } else if (pow2) {
+        // Negative dividends are biased by `abs - 1` to round toward zero.
+        printer.PrintLn("    movq %rcx, %rax");
+        if (log > 1) printer.PrintLn("    sarq $63, %rax");
+        printer.PrintLn("    shrq ${}, %rax", 64 - log);
+        printer.PrintLn("    addq %rcx, %rax");
+        if (!is_rem) {
+            printer.PrintLn("    sarq ${}, %rax", log);
+            if (divisor < 0) printer.PrintLn("    negq %rax");
+            SetDst(inst.dst, ax, size);
+        } else {
+            if (log < 32) {
+                printer.PrintLn("    andq ${}, %rax", -int64_t(abs));
+            } else {
+                printer.PrintLn("    movq ${}, %rdx", -int64_t(abs));
+                printer.PrintLn("    andq %rdx, %rax");
+            }
+            printer.PrintLn("    subq %rax, %rcx");
+            SetDst(inst.dst, cx, size);
+        }
+    } else if (!is_signed) {
+        auto magic = MagicUnsigned(abs, size);
+        printer.PrintLn("    movq ${}, %rax", int64_t(magic.mul));
+        printer.PrintLn("    mulq %rcx");
+        Register quot = dx;
+        if (magic.add) {
+            printer.PrintLn("    movq %rcx, %rax");
+            printer.PrintLn("    subq %rdx, %rax");
+            printer.PrintLn("    shrq $1, %rax");
+            printer.PrintLn("    addq %rdx, %rax");
+            quot = ax;
+        }
+        if (magic.shift) {
+            printer.PrintLn("    shrq ${}, {}", magic.shift, quot.ToQuadName());
+        }
+        if (is_rem) {
+            remainder(quot);
+        } else {
+            SetDst(inst.dst, quot, size);
+        }
+    } else {
+        auto magic = MagicSigned(divisor);
+        printer.PrintLn("    movq ${}, %rax", magic.mul);
+        printer.PrintLn("    imulq %rcx");
+        if (divisor > 0 && magic.mul < 0) printer.PrintLn("    addq %rcx, %rdx");
+        if (divisor < 0 && magic.mul > 0) printer.PrintLn("    subq %rcx, %rdx");
+        if (magic.shift) printer.PrintLn("    sarq ${}, %rdx", magic.shift);
+
+        // Rounds toward zero by adding 1 if negative.
+        printer.PrintLn("    movq %rdx, %rax");
+        printer.PrintLn("    shrq $63, %rax");
+        printer.PrintLn("    addq %rax, %rdx");
+        if (is_rem) {
+            remainder(dx);
+        } else {
+            SetDst(inst.dst, dx, size);
+        }
+    }
+    return true;
+}
+
+void Lowering::LowerCall(const mir::Instruction &inst) {
+    auto &printer = ctx_.printer();
+    Register ax(Register::AX);
+    Place ax_place{Place::Reg, Register::AX, 0};
+
+    // Arguments are extended to 8 bytes by zero.
+    for (size_t i = 6; i < inst.args.size(); i++) {
+        auto arg = inst.args[i];
+        AsmPtrRepr dst{int64_t(8 * (i - 6)), "%rsp"};
+        if (SizeOf(arg) == 8 && Loc(arg).kind() != ValueLocation::Spill) {
+            printer.PrintLn("    movq {}, {}", Operand(arg, 8), dst);
+        } else {
+            EmitMove({ax_place, PlaceOf(arg), SizeOf(arg)});
+            printer.PrintLn("    movq %rax, {}", dst);
+        }
+    }
+    std::vector<Move> moves;
+    for (size_t i = 0; i < inst.args.size() && i < 6; i++) {
+        moves.push_back({{Place::Reg, arg_regs[i], 0},
+                         PlaceOf(inst.args[i]),
+                         SizeOf(inst.args[i])});
+    }
+    ParallelMove(std::move(moves));
+
+    printer.PrintLn("    movb $0, %al");
+    if (inst.outer) {
+        printer.PrintLn("    callq {}@PLT", inst.symbol);
+    } else {
+        printer.PrintLn("    callq {}", inst.symbol);
+    }
+
+    if (inst.dst != mir::no_value) {
+        SetDst(inst.dst, ax, mir::SizeOf(inst.type));
+    }
+}
+
+// Passes arguments as LowerCall does, but stack arguments overwrite the ones
+// this function received, and the frame is left before jumping to the callee.
+void Lowering::LowerTailCall(const mir::Instruction &inst) {
+    auto &printer = ctx_.printer();
+    Place ax_place{Place::Reg, Register::AX, 0};
+
+    // Arguments are moved to allocated places at the entry, so the ones on
+    // the stack are no longer read.
+    for (size_t i = 6; i < inst.args.size(); i++) {
+        auto arg = inst.args[i];
+        AsmPtrRepr dst{int64_t(16 + 8 * (i - 6)), "%rbp"};
+        EmitMove({ax_place, PlaceOf(arg), SizeOf(arg)});
+        printer.PrintLn("    movq %rax, {}", dst);
+    }
+    std::vector<Move> moves;
+    for (size_t i = 0; i < inst.args.size() && i < 6; i++) {
+        moves.push_back({{Place::Reg, arg_regs[i], 0},
+                         PlaceOf(inst.args[i]),
+                         SizeOf(inst.args[i])});
+    }
+    ParallelMove(std::move(moves));
+
+    RestoreFrame();
+    printer.PrintLn("    movb $0, %al");
+    if (inst.outer) {
+        printer.PrintLn("    jmp {}@PLT", inst.symbol);
+    } else {
+        printer.PrintLn("    jmp {}", inst.symbol);
+    }
+}
+
+// Restores callee-saved registers and the stack pointer as at the entry.
+void Lowering::RestoreFrame() {
+    auto &printer = ctx_.printer();
+    for (size_t i = 0; i < saved_regs_.size(); i++) {
+        printer.PrintLn("    movq {}({}), {}", -8 * int64_t(i + 1), base_,
+                        saved_regs_[i].ToQuadName());
+    }
+    if (!frameless_) {
+        printer.PrintLn("    movq %rbp, %rsp");
+        printer.PrintLn("    popq %rbp");
+    }
+}
+
+void Lowering::LowerBranch(const mir::Instruction &inst, mir::BlockId block,
+                           mir::BlockId next) {
+    auto &printer = ctx_.printer();
+    auto cond = inst.args[0];
+    auto then_block = inst.targets[0], else_block = inst.targets[1];
+
+    std::string_view jcc = "jne", neg_jcc = "je";
+    const auto &loc = Loc(cond);
+    if (fused_[cond]) {
+        const auto &insts = func_.blocks()[block].insts;
+        const auto &cmp = insts[insts.size() - 2];
+        LowerCompare(cmp);
+        auto index = static_cast<int>(cmp.op) - static_cast<int>(mir::Opcode::Eq);
+        jcc = jcc_names[index];
+        neg_jcc = neg_jcc_names[index];
+    } else if (loc.kind() == ValueLocation::Const) {
+        JumpTo(loc.imm() ? then_block : else_block, next);
+        return;
+    } else if (loc.kind() == ValueLocation::Reg) {
+        printer.PrintLn("    testb {}, {}", loc.reg().ToByteName(),
+                        loc.reg().ToByteName());
+    } else {
+        printer.PrintLn("    cmpb $0, {}", Operand(cond, 1));
+    }
+
+    if (then_block == next) {
+        printer.PrintLn("    {} .L.{}.{}", neg_jcc, func_.name(), else_block);
+    } else {
+        printer.PrintLn("    {} .L.{}.{}", jcc, func_.name(), then_block);
+        JumpTo(else_block, next);
+    }
+}
+
+// Copies incoming values of phis in `to` for the edge from `from`. All values
+// are read before writing, as a phi may use another phi of the same block.
+void Lowering::CopyPhis(mir::BlockId from, mir::BlockId to) {
+    std::vector<Move> moves;
+    for (const auto &inst : func_.blocks()[to].insts) {
+        if (inst.op != mir::Opcode::Phi) break;
+        for (size_t i = 0; i < inst.targets.size(); i++) {
+            if (inst.targets[i] != from) continue;
+            moves.push_back({PlaceOf(inst.dst), PlaceOf(inst.args[i]), 8});
+            break;
+        }
+    }
+    ParallelMove(std::move(moves));
+}
+
+void Lowering::JumpTo(mir::BlockId target, mir::BlockId next) {
+    if (target != next) {
+        ctx_.printer().PrintLn("    jmp .L.{}.{}", func_.name(), target);
+    }
+}
+
+}  // namespace
+
+void LowerFunction(CodeGenContext &ctx, mir::Function &func) {
+    mir::SplitCriticalEdges(func);
+    auto order = mir::ReversePostorder(func);
+    Lowering lowering(ctx, func, order);
+    lowering.Run();
+}
+
+}  // namespace mini
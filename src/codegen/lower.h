@@ -0,0 +1,15 @@
+#ifndef MINI_CODEGEN_LOWER_H_
+#define MINI_CODEGEN_LOWER_H_
+
+#include "../mir/mir.h"
+#include "context.h"
+
+namespace mini {
+
+// Generates assembly of `func`, following the same calling convention as
+// DeclCodeGen so that functions from both can call each other.
+void LowerFunction(CodeGenContext &ctx, mir::Function &func);
+
+}  // namespace mini
+
+#endif  // MINI_CODEGEN_LOWER_H_
@@ -0,0 +1,239 @@
+#include "peephole.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace mini {
+
+namespace {
+
+constexpr std::string_view rule_names[peephole_rule_count] = {
+    "push-pop",  "pop-push",     "nop-arith",
+    "self-move", "jump-to-next", "unreachable",
+};
+
+std::string_view Trim(std::string_view s) {
+    auto begin = s.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) return {};
+    auto end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+bool StartsWith(std::string_view s, std::string_view prefix) {
+    return s.substr(0, prefix.size()) == prefix;
+}
+
+bool IsReg(std::string_view op) { return !op.empty() && op.front() == '%'; }
+
+bool IsInst(const AsmLine &line, std::string_view mnemonic) {
+    return line.kind == AsmLine::Instruction && line.mnemonic == mnemonic;
+}
+
+// Returns true if `line` may read flags set by instructions before it.
+bool ReadsFlags(const AsmLine &line) {
+    if (line.kind != AsmLine::Instruction) return true;
+    std::string_view m = line.mnemonic;
+    return (m.front() == 'j' && m != "jmp") || StartsWith(m, "set") ||
+           StartsWith(m, "cmov") || StartsWith(m, "adc") ||
+           StartsWith(m, "sbb");
+}
+
+// Returns true if `line` sets all flags without reading them, or leaves them
+// undefined to the code after it as calls and returns do.
+bool SetsFlags(const AsmLine &line) {
+    static constexpr std::string_view ops[] = {
+        "add", "sub", "and", "or", "xor", "cmp", "test", "neg",
+    };
+    if (line.kind != AsmLine::Instruction) return false;
+    std::string_view m = line.mnemonic;
+    for (auto op : ops) {
+        if (m == op || (m.size() == op.size() + 1 && StartsWith(m, op) &&
+                        std::string_view("bwlq").find(m.back()) !=
+                            std::string_view::npos)) {
+            return true;
+        }
+    }
+    return m == "call" || m == "callq" || m == "ret" || m == "retq";
+}
+
+// Returns true if flags set by `lines[i]` may be read, that is if an
+// instruction reads them before another sets them. Where control goes after
+// a jump or a label is unknown, so flags may be read there.
+bool FlagsMayBeRead(const std::vector<AsmLine> &lines, size_t i) {
+    for (i++; i < lines.size(); i++) {
+        const auto &line = lines[i];
+        if (ReadsFlags(line) || IsInst(line, "jmp")) return true;
+        if (SetsFlags(line)) return false;
+    }
+    return true;
+}
+
+// Returns true if `line` is an arithmetic which changes nothing but flags.
+bool IsNopArith(const AsmLine &line) {
+    if (line.kind != AsmLine::Instruction || line.op_count != 2) return false;
+    std::string_view m = line.mnemonic;
+    if (m.size() < 4) return false;
+
+    // Writing to 32-bit register clears the upper half.
+    if (m.back() == 'l' && IsReg(line.ops[1])) return false;
+    auto op = m.substr(0, m.size() - 1);
+    if (op == "add" || op == "sub" || op == "or" || op == "xor" ||
+        op == "shl" || op == "sal" || op == "shr" || op == "sar") {
+        return line.ops[0] == "$0";
+    } else if (op == "and") {
+        return line.ops[0] == "$-1";
+    }
+    return false;
+}
+
+bool IsSelfMove(const AsmLine &line) {
+    return (IsInst(line, "movq") || IsInst(line, "movw") ||
+            IsInst(line, "movb")) &&
+           line.op_count == 2 && IsReg(line.ops[0]) &&
+           line.ops[0] == line.ops[1];
+}
+
+// Returns true if control never goes to the next line from `line`.
+bool IsJumpAway(const AsmLine &line) {
+    return IsInst(line, "jmp") || IsInst(line, "ret") || IsInst(line, "retq");
+}
+
+// `src` and `dst` are copied as they may be operands of `line`.
+void Rewrite(AsmLine &line, std::string_view mnemonic, std::string src,
+             std::string dst) {
+    line.mnemonic = mnemonic;
+    line.ops[0] = std::move(src);
+    line.ops[1] = std::move(dst);
+    line.op_count = 2;
+}
+
+}  // namespace
+
+std::string_view PeepholeRuleName(PeepholeRule rule) {
+    return rule_names[static_cast<size_t>(rule)];
+}
+
+AsmLine ParseAsmLine(std::string_view text) {
+    AsmLine line{AsmLine::Other, std::string(text), {}, 0};
+    auto s = Trim(text);
+    if (s.empty() || (s.front() == '.' && s.back() != ':')) return line;
+    if (s.back() == ':') {
+        line.kind = AsmLine::Label;
+        line.mnemonic = s.substr(0, s.size() - 1);
+        return line;
+    }
+
+    auto space = s.find_first_of(" \t");
+    std::string_view ops[3];
+    uint8_t op_count = 0;
+
+    // Commas inside parentheses separate base and index of memory.
+    auto rest = space == std::string_view::npos ? "" : Trim(s.substr(space));
+    while (!rest.empty()) {
+        size_t depth = 0, end = 0;
+        for (; end < rest.size(); end++) {
+            if (rest[end] == '(') depth++;
+            if (rest[end] == ')') depth--;
+            if (rest[end] == ',' && depth == 0) break;
+        }
+        // Never emitted; leave the line as is.
+        if (op_count == 3) return line;
+        ops[op_count++] = Trim(rest.substr(0, end));
+        rest = end < rest.size() ? Trim(rest.substr(end + 1)) : "";
+    }
+
+    line.kind = AsmLine::Instruction;
+    line.mnemonic = s.substr(0, space);
+    for (uint8_t i = 0; i < op_count; i++) line.ops[i] = ops[i];
+    line.op_count = op_count;
+    return line;
+}
+
+// Lines are moved to the output one by one, and each rule looks at the end of
+// the output, so that what a rewrite exposes is also rewritten.
+void OptimizePeephole(std::vector<AsmLine> &lines, OptStats &stats) {
+    auto &counts = stats.peephole_rewrites;
+    counts.resize(peephole_rule_count, 0);
+    auto count = [&](PeepholeRule rule) {
+        counts[static_cast<size_t>(rule)]++;
+    };
+
+    std::vector<AsmLine> out;
+    out.reserve(lines.size());
+    bool unreachable = false;
+    for (size_t i = 0; i < lines.size(); i++) {
+        auto &line = lines[i];
+        if (line.kind != AsmLine::Instruction) {
+            unreachable = false;
+        } else if (unreachable) {
+            count(PeepholeRule::Unreachable);
+            continue;
+        }
+
+        if (line.kind == AsmLine::Label) {
+            // Find the last instruction, which only labels follow.
+            auto it = std::find_if(out.rbegin(), out.rend(), [](auto &l) {
+                return l.kind != AsmLine::Label;
+            });
+            if (it != out.rend() && it->kind == AsmLine::Instruction &&
+                it->mnemonic.front() == 'j' && it->op_count == 1 &&
+                (it->ops[0] == line.mnemonic ||
+                 std::any_of(out.rbegin(), it, [&](auto &l) {
+                     return l.mnemonic == it->ops[0];
+                 }))) {
+                out.erase(std::next(it).base());
+                count(PeepholeRule::JumpToNext);
+            }
+        } else if (line.kind == AsmLine::Instruction) {
+            if (IsSelfMove(line)) {
+                count(PeepholeRule::SelfMove);
+                continue;
+            }
+            if (IsNopArith(line) && !FlagsMayBeRead(lines, i)) {
+                count(PeepholeRule::NopArith);
+                continue;
+            }
+
+            auto *prev = out.empty() ? nullptr : &out.back();
+            if (prev && IsInst(line, "popq") && line.op_count == 1 &&
+                IsReg(line.ops[0]) && IsInst(*prev, "pushq") &&
+                prev->op_count == 1) {
+                count(PeepholeRule::PushPop);
+                if (prev->ops[0] == line.ops[0]) {
+                    out.pop_back();
+                } else {
+                    Rewrite(*prev, "movq", prev->ops[0], line.ops[0]);
+                }
+                continue;
+            }
+            if (prev && IsInst(line, "pushq") && line.op_count == 1 &&
+                IsInst(*prev, "popq") && prev->op_count == 1 &&
+                IsReg(prev->ops[0]) && prev->ops[0] == line.ops[0]) {
+                count(PeepholeRule::PopPush);
+                Rewrite(*prev, "movq", "(%rsp)", line.ops[0]);
+                continue;
+            }
+            unreachable = IsJumpAway(line);
+        }
+        out.push_back(std::move(line));
+    }
+    lines = std::move(out);
+}
+
+void PrintAsmLine(const AsmLine &line, fmt::memory_buffer &out) {
+    if (line.kind == AsmLine::Label) {
+        fmt::format_to(fmt::appender(out), "{}:\n", line.mnemonic);
+        return;
+    } else if (line.kind == AsmLine::Other) {
+        out.append(line.mnemonic);
+        out.push_back('\n');
+        return;
+    }
+    fmt::format_to(fmt::appender(out), "    {}", line.mnemonic);
+    for (uint8_t i = 0; i < line.op_count; i++) {
+        fmt::format_to(fmt::appender(out), "{}{}", i ? ", " : " ", line.ops[i]);
+    }
+    out.push_back('\n');
+}
+
+}  // namespace mini
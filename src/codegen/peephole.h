@@ -0,0 +1,68 @@
+#ifndef MINI_CODEGEN_PEEPHOLE_H_
+#define MINI_CODEGEN_PEEPHOLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../context.h"
+#include "fmt/format.h"
+
+namespace mini {
+
+// Rules of the peephole optimizer. Each rewrites a few adjacent instructions
+// into fewer ones which do the same.
+enum class PeepholeRule {
+    // pushq X; popq X => (removed)
+    // pushq X; popq %reg => movq X, %reg
+    PushPop,
+    // popq %reg; pushq %reg => movq (%rsp), %reg
+    PopPush,
+    // addq $0, X, and sub, or, xor and shifts by 0 and `and` with -1 =>
+    // (removed), unless flags are read before the next instruction which
+    // sets them.
+    NopArith,
+    // movq %reg, %reg => (removed), and the same for movb and movw. movl
+    // clears the upper half, so it's kept.
+    SelfMove,
+    // jmp L; L: => L:, and the same for conditional jumps.
+    JumpToNext,
+    // Instructions after jmp or ret until the next label => (removed).
+    Unreachable,
+};
+
+constexpr size_t peephole_rule_count = 6;
+
+// Returns the name of `rule`, such as "push-pop".
+std::string_view PeepholeRuleName(PeepholeRule rule);
+
+// A line of assembly, which is an instruction with its mnemonic and operands,
+// a label or anything else kept as is.
+struct AsmLine {
+    enum Kind {
+        Instruction,
+        Label,
+        Other,  // Directives and empty lines.
+    };
+
+    Kind kind;
+    std::string mnemonic;  // Or the name of Label, or the line of Other.
+    std::string ops[3];
+    uint8_t op_count;
+};
+
+// Parses `text`, a line without newline.
+AsmLine ParseAsmLine(std::string_view text);
+
+// Applies the rules to `lines` of a function, counting rewrites of each rule
+// in `stats`.
+void OptimizePeephole(std::vector<AsmLine> &lines, OptStats &stats);
+
+// Appends `line` to `out` with newline.
+void PrintAsmLine(const AsmLine &line, fmt::memory_buffer &out);
+
+}  // namespace mini
+
+#endif  // MINI_CODEGEN_PEEPHOLE_H_
@@ -0,0 +1,316 @@
+#include "regalloc.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+namespace mini {
+
+namespace {
+
+constexpr Register::Kind caller_saved_regs[] = {
+    Register::SI, Register::DI, Register::R8,
+    Register::R9, Register::R10, Register::R11};
+
+constexpr Register::Kind callee_saved_regs[] = {
+    Register::BX, Register::R12, Register::R13, Register::R14, Register::R15};
+
+constexpr Register::Kind arg_regs[6] = {Register::DI, Register::SI,
+                                        Register::DX, Register::CX,
+                                        Register::R8, Register::R9};
+
+constexpr size_t reg_count = 16;
+
+// A set of values.
+class ValueSet {
+public:
+    ValueSet(size_t size) : words_((size + 63) / 64, 0) {}
+    inline bool Contains(mir::Value value) const {
+        return words_[value / 64] >> (value % 64) & 1;
+    }
+    inline void Insert(mir::Value value) {
+        words_[value / 64] |= uint64_t(1) << (value % 64);
+    }
+
+    // Inserts values in `set` but not in `except`, and returns true if this
+    // changes.
+    bool Merge(const ValueSet &set, const ValueSet *except = nullptr) {
+        bool changed = false;
+        for (size_t i = 0; i < words_.size(); i++) {
+            auto word = set.words_[i] & (except ? ~except->words_[i] : ~0ull);
+            changed |= (words_[i] | word) != words_[i];
+            words_[i] |= word;
+        }
+        return changed;
+    }
+
+    template <typename F>
+    void ForEach(F f) const {
+        for (size_t i = 0; i < words_.size(); i++) {
+            for (auto word = words_[i]; word; word &= word - 1) {
+                f(i * 64 + __builtin_ctzll(word));
+            }
+        }
+    }
+
+private:
+    std::vector<uint64_t> words_;
+};
+
+// Range of positions a value is live, where the i-th instruction in the
+// layout reads operands at 2i and writes its result at 2i + 1.
+struct Interval {
+    mir::Value value;
+    uint32_t start;
+    uint32_t end;
+};
+
+bool FitsImm(int64_t imm) { return INT32_MIN <= imm && imm <= INT32_MAX; }
+
+int64_t SignExtend(int64_t imm, mir::Type type) {
+    switch (type) {
+        case mir::Type::I8:
+            return static_cast<int8_t>(imm);
+        case mir::Type::I16:
+            return static_cast<int16_t>(imm);
+        case mir::Type::I32:
+            return static_cast<int32_t>(imm);
+        default:
+            return imm;
+    }
+}
+
+class LinearScan {
+public:
+    LinearScan(const mir::Function &func, const std::vector<mir::BlockId> &order)
+        : func_(func),
+          order_(order),
+          locations_(func.ValueCount()),
+          starts_(func.ValueCount(), UINT32_MAX),
+          ends_(func.ValueCount(), 0) {}
+    RegAllocResult Run();
+
+private:
+    void ComputeIntervals();
+    void Def(mir::Value value, uint32_t pos);
+    void Use(mir::Value value, uint32_t pos);
+
+    // Returns true if any of `positions` is inside of `interval`.
+    static bool Crosses(const std::vector<uint32_t> &positions,
+                        const Interval &interval);
+
+    void Spill(mir::Value value) {
+        locations_[value] = ValueLocation::InSpill(spill_count_++);
+    }
+
+    const mir::Function &func_;
+    const std::vector<mir::BlockId> &order_;
+    std::vector<ValueLocation> locations_;
+    std::vector<uint32_t> starts_;
+    std::vector<uint32_t> ends_;
+    std::vector<uint32_t> calls_;
+    std::vector<uint32_t> memcopies_;
+    uint32_t spill_count_ = 0;
+};
+
+void LinearScan::Def(mir::Value value, uint32_t pos) {
+    if (value == mir::no_value) return;
+    starts_[value] = std::min(starts_[value], pos);
+    ends_[value] = std::max(ends_[value], pos);
+}
+
+void LinearScan::Use(mir::Value value, uint32_t pos) {
+    starts_[value] = std::min(starts_[value], pos);
+    ends_[value] = std::max(ends_[value], pos);
+}
+
+void LinearScan::ComputeIntervals() {
+    const auto &blocks = func_.blocks();
+    auto value_count = func_.ValueCount();
+
+    // Values used in each block before being defined there, values defined
+    // by non-phi instructions, and values defined by phis.
+    std::vector<ValueSet> uses(blocks.size(), ValueSet(value_count));
+    std::vector<ValueSet> defs(blocks.size(), ValueSet(value_count));
+    std::vector<ValueSet> phi_defs(blocks.size(), ValueSet(value_count));
+    for (auto id : order_) {
+        for (const auto &inst : blocks[id].insts) {
+            if (inst.op == mir::Opcode::Phi) {
+                phi_defs[id].Insert(inst.dst);
+                continue;
+            }
+            for (auto arg : inst.args) {
+                if (!defs[id].Contains(arg)) uses[id].Insert(arg);
+            }
+            if (inst.dst != mir::no_value) defs[id].Insert(inst.dst);
+        }
+    }
+
+    // live_in = uses + phi_defs + (live_out - defs), and live_out is the
+    // union of live_in - phi_defs of successors and incoming values of their
+    // phis from the block.
+    std::vector<ValueSet> live_in(blocks.size(), ValueSet(value_count));
+    std::vector<ValueSet> live_out(blocks.size(), ValueSet(value_count));
+    for (auto id : order_) {
+        for (auto succ : mir::Successors(blocks[id])) {
+            for (const auto &inst : blocks[succ].insts) {
+                if (inst.op != mir::Opcode::Phi) break;
+                for (size_t i = 0; i < inst.targets.size(); i++) {
+                    if (inst.targets[i] == id) live_out[id].Insert(inst.args[i]);
+                }
+            }
+        }
+    }
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto it = order_.rbegin(); it != order_.rend(); it++) {
+            auto id = *it;
+            for (auto succ : mir::Successors(blocks[id])) {
+                live_out[id].Merge(live_in[succ], &phi_defs[succ]);
+            }
+            changed |= live_in[id].Merge(uses[id]);
+            changed |= live_in[id].Merge(phi_defs[id]);
+            changed |= live_in[id].Merge(live_out[id], &defs[id]);
+        }
+    }
+
+    uint32_t index = 0;
+    for (auto id : order_) {
+        uint32_t from = 2 * index;
+        for (const auto &inst : blocks[id].insts) {
+            uint32_t pos = 2 * index++;
+            if (inst.op == mir::Opcode::Call) calls_.push_back(pos);
+            if (inst.op == mir::Opcode::MemCopy) memcopies_.push_back(pos);
+            if (inst.op != mir::Opcode::Phi) {
+                for (auto arg : inst.args) Use(arg, pos);
+            }
+
+            // Arguments are all moved from registers at the entry, so these
+            // must not share a register even if some of them are unused.
+            Def(inst.dst, inst.op == mir::Opcode::Arg ? 0 : pos + 1);
+        }
+        uint32_t to = 2 * (index - 1);
+        live_in[id].ForEach([&](mir::Value value) { Use(value, from); });
+        live_out[id].ForEach([&](mir::Value value) { Use(value, to); });
+    }
+}
+
+bool LinearScan::Crosses(const std::vector<uint32_t> &positions,
+                         const Interval &interval) {
+    auto it = std::upper_bound(positions.begin(), positions.end(),
+                               interval.start);
+    return it != positions.end() && *it < interval.end;
+}
+
+RegAllocResult LinearScan::Run() {
+    ComputeIntervals();
+
+    // Constants are not allocated if they can be immediates.
+    std::vector<bool> is_const(func_.ValueCount(), false);
+    for (auto id : order_) {
+        for (const auto &inst : func_.blocks()[id].insts) {
+            if (inst.op != mir::Opcode::Const) continue;
+            auto imm = SignExtend(inst.imm, inst.type);
+            if (!FitsImm(imm)) continue;
+            locations_[inst.dst] = ValueLocation::InConst(imm);
+            is_const[inst.dst] = true;
+        }
+    }
+
+    std::vector<std::optional<Register::Kind>> hints(func_.ValueCount());
+    for (const auto &inst : func_.blocks()[0].insts) {
+        if (inst.op != mir::Opcode::Arg || inst.imm >= 6) continue;
+        auto reg = arg_regs[inst.imm];
+        if (std::count(std::begin(caller_saved_regs),
+                       std::end(caller_saved_regs), reg)) {
+            hints[inst.dst] = reg;
+        }
+    }
+
+    std::vector<Interval> intervals;
+    for (mir::Value value = 0; value < func_.ValueCount(); value++) {
+        if (is_const[value] || starts_[value] == UINT32_MAX) continue;
+        intervals.push_back({value, starts_[value], ends_[value]});
+    }
+    std::stable_sort(intervals.begin(), intervals.end(),
+                     [](const Interval &lhs, const Interval &rhs) {
+                         return lhs.start < rhs.start;
+                     });
+
+    // Intervals which have a register, and which value has each register.
+    std::vector<Interval> active;
+    bool used[reg_count] = {};
+
+    for (const auto &curr : intervals) {
+        // Expire intervals which end before this starts.
+        for (auto it = active.begin(); it != active.end();) {
+            if (it->end < curr.start) {
+                used[locations_[it->value].reg().kind()] = false;
+                it = active.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        bool crosses_call = Crosses(calls_, curr);
+        bool crosses_memcopy = Crosses(memcopies_, curr);
+        auto allowed = [&](Register::Kind reg) {
+            Register r(reg);
+            if (crosses_call && !r.IsCalleeSaved()) return false;
+            if (crosses_memcopy && (reg == Register::SI ||
+                                    reg == Register::DI ||
+                                    reg == Register::R10)) {
+                return false;
+            }
+            return true;
+        };
+
+        // Prefer the register an argument is passed by, then caller-saved
+        // registers, which don't need to be preserved.
+        std::optional<Register::Kind> found;
+        if (auto hint = hints[curr.value]; hint && !used[*hint] && allowed(*hint)) {
+            found = hint;
+        }
+        for (auto reg : caller_saved_regs) {
+            if (!found && !used[reg] && allowed(reg)) found = reg;
+        }
+        for (auto reg : callee_saved_regs) {
+            if (!found && !used[reg] && allowed(reg)) found = reg;
+        }
+
+        if (!found) {
+            // Spill the interval which ends last, as it occupies a register
+            // for the longest time.
+            auto victim = active.end();
+            for (auto it = active.begin(); it != active.end(); it++) {
+                if (!allowed(locations_[it->value].reg().kind())) continue;
+                if (victim == active.end() || victim->end < it->end) victim = it;
+            }
+            if (victim == active.end() || victim->end <= curr.end) {
+                Spill(curr.value);
+                continue;
+            }
+            found = locations_[victim->value].reg().kind();
+            Spill(victim->value);
+            active.erase(victim);
+        }
+
+        used[*found] = true;
+        locations_[curr.value] = ValueLocation::InReg(*found);
+        active.push_back(curr);
+    }
+
+    return RegAllocResult(std::move(locations_), spill_count_);
+}
+
+}  // namespace
+
+RegAllocResult AllocateRegisters(const mir::Function &func,
+                                 const std::vector<mir::BlockId> &order) {
+    LinearScan scan(func, order);
+    return scan.Run();
+}
+
+}  // namespace mini
@@ -0,0 +1,87 @@
+#ifndef MINI_CODEGEN_REGALLOC_H_
+#define MINI_CODEGEN_REGALLOC_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "../mir/mir.h"
+#include "asm.h"
+
+namespace mini {
+
+// Where a value of mir lives through its lifetime.
+class ValueLocation {
+public:
+    enum Kind {
+        // The value is never defined.
+        None,
+        Reg,
+        Spill,
+        // The value is a constant which fits in an immediate, so it's
+        // materialized at each use instead of occupying a register.
+        Const,
+    };
+
+    ValueLocation() : kind_(None), reg_(Register::AX), spill_(0), imm_(0) {}
+    static ValueLocation InReg(Register reg) {
+        ValueLocation loc;
+        loc.kind_ = Reg;
+        loc.reg_ = reg;
+        return loc;
+    }
+    static ValueLocation InSpill(uint32_t spill) {
+        ValueLocation loc;
+        loc.kind_ = Spill;
+        loc.spill_ = spill;
+        return loc;
+    }
+    static ValueLocation InConst(int64_t imm) {
+        ValueLocation loc;
+        loc.kind_ = Const;
+        loc.imm_ = imm;
+        return loc;
+    }
+    inline Kind kind() const { return kind_; }
+    inline Register reg() const { return reg_; }
+
+    // The index of 8-byte stack slot for spilled values.
+    inline uint32_t spill() const { return spill_; }
+
+    // The constant, sign-extended from the size of the value.
+    inline int64_t imm() const { return imm_; }
+
+private:
+    Kind kind_;
+    Register reg_;
+    uint32_t spill_;
+    int64_t imm_;
+};
+
+class RegAllocResult {
+public:
+    RegAllocResult(std::vector<ValueLocation> &&locations, uint32_t spill_count)
+        : locations_(std::move(locations)), spill_count_(spill_count) {}
+    inline const ValueLocation &Query(mir::Value value) const {
+        return locations_.at(value);
+    }
+    inline uint32_t spill_count() const { return spill_count_; }
+
+private:
+    std::vector<ValueLocation> locations_;
+    uint32_t spill_count_;
+};
+
+// Assigns a register to each value by linear scan over live intervals, in the
+// order of `order`, spilling values which live longest when no register is
+// left.
+//
+// rax, rcx and rdx are not assigned, as lowering uses these as scratch and
+// some instructions use them implicitly. Values living across a call only
+// take callee-saved registers, and ones living across MemCopy don't take
+// registers CopyBytes uses.
+RegAllocResult AllocateRegisters(const mir::Function &func,
+                                 const std::vector<mir::BlockId> &order);
+
+}  // namespace mini
+
+#endif  // MINI_CODEGEN_REGALLOC_H_
@@ -106,7 +106,7 @@ void StmtCodeGen::Visit(const hir::WhileStatement &stmt) {
     stmt.cond()->Accept(cond_gen);
     if (!cond_gen) return;
 
-    auto to = std::make_shared<hir::BuiltinType>(hir::BuiltinType::Bool,
+    auto to = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool,
                                                  stmt.cond()->span());
     if (!ImplicitlyConvertValueInStack(ctx_, stmt.cond()->span(),
                                        cond_gen.inferred(), to)) {
@@ -137,7 +137,7 @@ void StmtCodeGen::Visit(const hir::IfStatement &stmt) {
     stmt.cond()->Accept(cond_gen);
     if (!cond_gen) return;
 
-    auto to = std::make_shared<hir::BuiltinType>(hir::BuiltinType::Bool,
+    auto to = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool,
                                                  stmt.cond()->span());
     if (!ImplicitlyConvertValueInStack(ctx_, stmt.cond()->span(),
                                        cond_gen.inferred(), to)) {
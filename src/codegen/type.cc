@@ -187,11 +187,10 @@ void TypeSizeCalc::Visit(const hir::NameType &type) {
     }
 }
 
-bool CalculateStructSizeAndOffset(CodeGenContext &ctx, const std::string &name,
-                                  Span span) {
+bool CalculateStructSizeAndOffset(CodeGenContext &ctx, Symbol name, Span span) {
     // TypeSizeCalc internally cache the struct size and offset, so use it.
     TypeSizeCalc calc(ctx);
-    hir::NameType(std::string(name), span).Accept(calc);
+    hir::NameType(name, span).Accept(calc);
     return (bool)calc;
 }
 
@@ -205,14 +204,14 @@ std::optional<std::shared_ptr<hir::Type>> ImplicitlyMergeTwoType(
         auto t2_of = t2->ToPointer()->of();
         if (t1_of->IsBuiltin() &&
             t1_of->ToBuiltin()->kind() == hir::BuiltinType::Void) {
-            return std::make_shared<hir::PointerType>(t2_of,
+            return hir::MakeType<hir::PointerType>(t2_of,
                                                       t1->span() + t2->span());
         } else if (t2_of->IsBuiltin() &&
                    t2_of->ToBuiltin()->kind() == hir::BuiltinType::Void) {
-            return std::make_shared<hir::PointerType>(t1_of,
+            return hir::MakeType<hir::PointerType>(t1_of,
                                                       t1->span() + t2->span());
         } else if (*t1 == *t2) {
-            return std::make_shared<hir::PointerType>(t1_of,
+            return hir::MakeType<hir::PointerType>(t1_of,
                                                       t1->span() + t2->span());
         } else {
             goto failed;
@@ -221,8 +220,8 @@ std::optional<std::shared_ptr<hir::Type>> ImplicitlyMergeTwoType(
         if (!t2->IsName()) goto failed;
 
         if (t1->ToName()->value() == t2->ToName()->value()) {
-            return std::make_shared<hir::NameType>(
-                std::string(t1->ToName()->value()), t1->span() + t2->span());
+            return hir::MakeType<hir::NameType>(
+                t1->ToName()->value(), t1->span() + t2->span());
         } else {
             goto failed;
         }
@@ -230,7 +229,7 @@ std::optional<std::shared_ptr<hir::Type>> ImplicitlyMergeTwoType(
         auto t1_of = t1->ToArray()->of();
         if (t2->IsArray()) {
             if (*t1 == *t2) {
-                return std::make_shared<hir::ArrayType>(
+                return hir::MakeType<hir::ArrayType>(
                     t1_of, t1->ToArray()->size(), t1->span() + t2->span());
             } else {
                 goto failed;
@@ -238,7 +237,7 @@ std::optional<std::shared_ptr<hir::Type>> ImplicitlyMergeTwoType(
         } else if (t2->IsPointer()) {
             auto t2_of = t2->ToPointer()->of();
             if (*t1_of == *t2_of) {
-                return std::make_shared<hir::PointerType>(
+                return hir::MakeType<hir::PointerType>(
                     t2_of, t1->span() + t2->span());
             } else {
                 return std::nullopt;
@@ -254,248 +253,248 @@ std::optional<std::shared_ptr<hir::Type>> ImplicitlyMergeTwoType(
         auto span = t1->span() + t2->span();
         if (t1_kind == hir::BuiltinType::UInt8) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::UInt16) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int16, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::UInt32) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int32, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int32, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::UInt64) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::USize) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::Int8) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int16, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int32, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::ISize, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::Int16) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int32, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::ISize, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::Int32) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::Int64, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::ISize, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::Int64) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     hir::BuiltinType::ISize, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t2_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t2_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::ISize) {
             if (t2_kind == hir::BuiltinType::UInt8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt32) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::UInt64) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::USize) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int8) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int16) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int32) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::Int64) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             } else if (t2_kind == hir::BuiltinType::ISize) {
-                return std::make_shared<hir::BuiltinType>(t1_kind, span);
+                return hir::MakeType<hir::BuiltinType>(t1_kind, span);
             }
         } else if (t1_kind == hir::BuiltinType::Void ||
                    t1_kind == hir::BuiltinType::Char ||
                    t1_kind == hir::BuiltinType::Bool) {
             if (t1_kind == t2_kind) {
-                return std::make_shared<hir::BuiltinType>(
+                return hir::MakeType<hir::BuiltinType>(
                     t1_kind, t1->span() + t2->span());
             } else {
                 goto failed;
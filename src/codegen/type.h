@@ -44,8 +44,7 @@ private:
 
 // Calculate struct size and offsets of the name `name` and save it to table
 // entry.
-bool CalculateStructSizeAndOffset(CodeGenContext &ctx, const std::string &name,
-                                  Span span);
+bool CalculateStructSizeAndOffset(CodeGenContext &ctx, Symbol name, Span span);
 
 // Merge two types so each type can be implicitly converted into merged one.
 std::optional<std::shared_ptr<hir::Type>> ImplicitlyMergeTwoType(
@@ -0,0 +1,382 @@
+#include "typing.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "../hir/expr.h"
+#include "../hir/stmt.h"
+#include "type.h"
+
+namespace mini {
+
+using OptType = std::optional<std::shared_ptr<hir::Type>>;
+
+static std::shared_ptr<hir::Type> Annotate(
+    CodeGenContext &ctx, const std::unique_ptr<hir::Expression> &expr,
+    const OptType &array_base_type = std::nullopt);
+
+// Returns true if the expression can be generated by ExprLValGen.
+static bool IsLValue(const std::unique_ptr<hir::Expression> &expr) {
+    class IsLValue : public hir::ExpressionVisitor {
+    public:
+        IsLValue() : success_(false) {}
+        explicit operator bool() const { return success_; }
+        void Visit(const hir::UnaryExpression &expr) override {
+            success_ = expr.op().kind() == hir::UnaryExpression::Op::Deref;
+        }
+        void Visit(const hir::InfixExpression &) override {}
+        void Visit(const hir::IndexExpression &) override { success_ = true; }
+        void Visit(const hir::CallExpression &) override {}
+        void Visit(const hir::AccessExpression &) override { success_ = true; }
+        void Visit(const hir::CastExpression &) override {}
+        void Visit(const hir::ESizeofExpression &) override {}
+        void Visit(const hir::TSizeofExpression &) override {}
+        void Visit(const hir::EnumSelectExpression &) override {}
+        void Visit(const hir::VariableExpression &) override {
+            success_ = true;
+        }
+        void Visit(const hir::IntegerExpression &) override {}
+        void Visit(const hir::StringExpression &) override {}
+        void Visit(const hir::CharExpression &) override {}
+        void Visit(const hir::BoolExpression &) override {}
+        void Visit(const hir::NullPtrExpression &) override {}
+        void Visit(const hir::StructExpression &) override {}
+        void Visit(const hir::ArrayExpression &) override {}
+
+    private:
+        bool success_;
+    };
+
+    IsLValue check;
+    expr->Accept(check);
+    return (bool)check;
+}
+
+static bool IsIntegerType(const std::shared_ptr<hir::Type> &type) {
+    return type->IsBuiltin() && type->ToBuiltin()->IsInteger();
+}
+
+static hir::BuiltinType::Kind ToSigned(hir::BuiltinType::Kind kind) {
+    switch (kind) {
+        case hir::BuiltinType::UInt8:
+            return hir::BuiltinType::Int8;
+        case hir::BuiltinType::UInt16:
+            return hir::BuiltinType::Int16;
+        case hir::BuiltinType::UInt32:
+            return hir::BuiltinType::Int32;
+        case hir::BuiltinType::UInt64:
+            return hir::BuiltinType::Int64;
+        case hir::BuiltinType::USize:
+            return hir::BuiltinType::ISize;
+        default:
+            return kind;
+    }
+}
+
+static std::optional<Symbol> IsVariable(
+    const std::unique_ptr<hir::Expression> &expr) {
+    class IsVariable : public hir::ExpressionVisitor {
+    public:
+        std::optional<Symbol> value;
+        void Visit(const hir::UnaryExpression &) override {}
+        void Visit(const hir::InfixExpression &) override {}
+        void Visit(const hir::IndexExpression &) override {}
+        void Visit(const hir::CallExpression &) override {}
+        void Visit(const hir::AccessExpression &) override {}
+        void Visit(const hir::CastExpression &) override {}
+        void Visit(const hir::ESizeofExpression &) override {}
+        void Visit(const hir::TSizeofExpression &) override {}
+        void Visit(const hir::EnumSelectExpression &) override {}
+        void Visit(const hir::VariableExpression &expr) override {
+            value = expr.value();
+        }
+        void Visit(const hir::IntegerExpression &) override {}
+        void Visit(const hir::StringExpression &) override {}
+        void Visit(const hir::CharExpression &) override {}
+        void Visit(const hir::BoolExpression &) override {}
+        void Visit(const hir::NullPtrExpression &) override {}
+        void Visit(const hir::StructExpression &) override {}
+        void Visit(const hir::ArrayExpression &) override {}
+    };
+
+    IsVariable check;
+    expr->Accept(check);
+    return check.value;
+}
+
+// Compute the type of expression as ExprRValGen infers it. Whenever
+// ExprRValGen succeeds to generate an expression, the type computed here must
+// be the same one.
+class ExprTyping : public hir::ExpressionVisitor {
+public:
+    ExprTyping(CodeGenContext &ctx, const OptType &array_base_type)
+        : array_base_type_(array_base_type), ctx_(ctx) {}
+    const std::shared_ptr<hir::Type> &inferred() const { return inferred_; }
+    void Visit(const hir::UnaryExpression &expr) override {
+        auto type = Annotate(ctx_, expr.expr());
+        if (!type) return;
+
+        switch (expr.op().kind()) {
+            case hir::UnaryExpression::Op::Ref:
+                if (IsLValue(expr.expr())) {
+                    inferred_ =
+                        hir::MakeType<hir::PointerType>(type, expr.span());
+                }
+                break;
+            case hir::UnaryExpression::Op::Deref:
+                if (type->IsPointer()) inferred_ = type->ToPointer()->of();
+                break;
+            case hir::UnaryExpression::Op::Minus:
+                if (IsIntegerType(type)) {
+                    inferred_ = hir::MakeType<hir::BuiltinType>(
+                        ToSigned(type->ToBuiltin()->kind()), expr.span());
+                }
+                break;
+            case hir::UnaryExpression::Op::Inv:
+                if (IsIntegerType(type)) {
+                    inferred_ = hir::MakeType<hir::BuiltinType>(
+                        type->ToBuiltin()->kind(), expr.span());
+                }
+                break;
+            case hir::UnaryExpression::Op::Neg:
+                if (type->IsBuiltin() &&
+                    type->ToBuiltin()->kind() == hir::BuiltinType::Bool) {
+                    inferred_ = hir::MakeType<hir::BuiltinType>(
+                        hir::BuiltinType::Bool, expr.span());
+                }
+                break;
+        }
+    }
+    void Visit(const hir::InfixExpression &expr) override {
+        if (expr.op().kind() == hir::InfixExpression::Op::Assign) {
+            auto lhs = Annotate(ctx_, expr.lhs());
+            OptType of;
+            if (lhs && lhs->IsPointer()) {
+                of = lhs->ToPointer()->of();
+            } else if (lhs && lhs->IsArray()) {
+                of = lhs->ToArray()->of();
+            }
+            auto rhs = Annotate(ctx_, expr.rhs(), of);
+            if (lhs && rhs && IsLValue(expr.lhs())) inferred_ = lhs;
+            return;
+        }
+
+        auto lhs = Annotate(ctx_, expr.lhs());
+        auto rhs = Annotate(ctx_, expr.rhs());
+        if (!lhs || !rhs) return;
+
+        switch (expr.op().kind()) {
+            case hir::InfixExpression::Op::Add:
+            case hir::InfixExpression::Op::Sub:
+                if (lhs->IsPointer()) {
+                    inferred_ = lhs;
+                    break;
+                }
+                [[fallthrough]];
+            case hir::InfixExpression::Op::Mul:
+            case hir::InfixExpression::Op::Div:
+            case hir::InfixExpression::Op::Mod:
+            case hir::InfixExpression::Op::BitOr:
+            case hir::InfixExpression::Op::BitAnd:
+            case hir::InfixExpression::Op::BitXor:
+            case hir::InfixExpression::Op::LShift:
+            case hir::InfixExpression::Op::RShift:
+                if (lhs->IsBuiltin() && rhs->IsBuiltin()) {
+                    auto merged = ImplicitlyMergeTwoType(ctx_, lhs, rhs);
+                    if (merged && IsIntegerType(merged.value())) {
+                        inferred_ = merged.value();
+                    }
+                }
+                break;
+            case hir::InfixExpression::Op::Or:
+            case hir::InfixExpression::Op::And:
+                if (lhs->IsBuiltin() && rhs->IsBuiltin()) {
+                    inferred_ = hir::MakeType<hir::BuiltinType>(
+                        hir::BuiltinType::Bool, expr.span());
+                }
+                break;
+            default:
+                // Comparison always results in bool, and its operands are
+                // checked when it's generated.
+                inferred_ = hir::MakeType<hir::BuiltinType>(
+                    hir::BuiltinType::Bool, expr.span());
+                break;
+        }
+    }
+    void Visit(const hir::IndexExpression &expr) override {
+        auto type = Annotate(ctx_, expr.expr());
+        auto index = Annotate(ctx_, expr.index());
+        if (!type || !index) return;
+
+        if (type->IsArray()) {
+            inferred_ = type->ToArray()->of();
+        } else if (type->IsPointer()) {
+            inferred_ = type->ToPointer()->of();
+        }
+    }
+    void Visit(const hir::CallExpression &expr) override {
+        auto var = IsVariable(expr.func());
+        if (!var || !ctx_.func_info_table().Exists(var.value())) {
+            for (const auto &arg : expr.args()) Annotate(ctx_, arg);
+            return;
+        }
+
+        auto &callee_info = ctx_.func_info_table().Query(var.value());
+        auto &params = callee_info.params();
+        bool success = true;
+        for (size_t i = 0; i < expr.args().size(); i++) {
+            OptType array_base_type;
+            if (i < params.size() && params.at(i).second->IsArray()) {
+                array_base_type.emplace(params.at(i).second->ToArray()->of());
+            }
+            success &= !!Annotate(ctx_, expr.args().at(i), array_base_type);
+        }
+        if (success) inferred_ = callee_info.ret_type();
+    }
+    void Visit(const hir::AccessExpression &expr) override {
+        auto type = Annotate(ctx_, expr.expr());
+        if (!type) return;
+
+        if (type->IsPointer()) type = type->ToPointer()->of();
+        if (!type->IsName()) return;
+
+        auto name = type->ToName()->value();
+        if (!ctx_.struct_table().Exists(name)) return;
+        auto &entry = ctx_.struct_table().Query(name);
+        if (!entry.Exists(expr.field().value())) return;
+
+        inferred_ = entry.Query(expr.field().value()).type();
+    }
+    void Visit(const hir::CastExpression &expr) override {
+        Annotate(ctx_, expr.expr());
+        inferred_ = expr.cast_type();
+    }
+    void Visit(const hir::ESizeofExpression &expr) override {
+        if (!Annotate(ctx_, expr.expr())) return;
+        inferred_ = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
+                                                   expr.span());
+    }
+    void Visit(const hir::TSizeofExpression &expr) override {
+        inferred_ = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
+                                                   expr.span());
+    }
+    void Visit(const hir::EnumSelectExpression &expr) override {
+        if (!ctx_.enum_table().Exists(expr.src().value())) return;
+        inferred_ =
+            hir::MakeType<hir::NameType>(expr.src().value(), expr.span());
+    }
+    void Visit(const hir::VariableExpression &expr) override {
+        if (!ctx_.lvar_table().Exists(expr.value())) return;
+        inferred_ = ctx_.lvar_table().Query(expr.value()).type();
+    }
+    void Visit(const hir::IntegerExpression &expr) override {
+        hir::BuiltinType::Kind kind;
+        if (expr.value() <= UINT8_MAX) {
+            kind = hir::BuiltinType::UInt8;
+        } else if (expr.value() <= UINT16_MAX) {
+            kind = hir::BuiltinType::UInt16;
+        } else if (expr.value() <= UINT32_MAX) {
+            kind = hir::BuiltinType::UInt32;
+        } else {
+            kind = hir::BuiltinType::UInt64;
+        }
+        inferred_ = hir::MakeType<hir::BuiltinType>(kind, expr.span());
+    }
+    void Visit(const hir::StringExpression &expr) override {
+        auto of = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Char,
+                                                  expr.span());
+        inferred_ = hir::MakeType<hir::ArrayType>(of, expr.value().size() + 1,
+                                                  expr.span());
+    }
+    void Visit(const hir::CharExpression &expr) override {
+        inferred_ = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Char,
+                                                   expr.span());
+    }
+    void Visit(const hir::BoolExpression &expr) override {
+        inferred_ = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool,
+                                                   expr.span());
+    }
+    void Visit(const hir::NullPtrExpression &expr) override {
+        auto of = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Void,
+                                                  expr.span());
+        inferred_ = hir::MakeType<hir::PointerType>(of, expr.span());
+    }
+    void Visit(const hir::StructExpression &expr) override {
+        bool success = true;
+        for (const auto &init : expr.inits()) {
+            success &= !!Annotate(ctx_, init.value());
+        }
+        if (!success || !ctx_.struct_table().Exists(expr.name().value())) {
+            return;
+        }
+        inferred_ =
+            hir::MakeType<hir::NameType>(expr.name().value(), expr.span());
+    }
+    void Visit(const hir::ArrayExpression &expr) override {
+        OptType of;
+        if (array_base_type_ && array_base_type_.value()->IsArray()) {
+            of = array_base_type_.value()->ToArray()->of();
+        }
+
+        bool success = true;
+        for (const auto &init : expr.inits()) {
+            success &= !!Annotate(ctx_, init, of);
+        }
+        if (!success || !array_base_type_) return;
+
+        inferred_ = hir::MakeType<hir::ArrayType>(
+            array_base_type_.value(), expr.inits().size(), expr.span());
+    }
+
+private:
+    const OptType &array_base_type_;
+    std::shared_ptr<hir::Type> inferred_;
+    CodeGenContext &ctx_;
+};
+
+static std::shared_ptr<hir::Type> Annotate(
+    CodeGenContext &ctx, const std::unique_ptr<hir::Expression> &expr,
+    const OptType &array_base_type) {
+    ExprTyping typing(ctx, array_base_type);
+    expr->Accept(typing);
+    expr->set_inferred_type(typing.inferred());
+    return typing.inferred();
+}
+
+class StmtTyping : public hir::StatementVisitor {
+public:
+    StmtTyping(CodeGenContext &ctx) : ctx_(ctx) {}
+    void Visit(const hir::ExpressionStatement &stmt) override {
+        Annotate(ctx_, stmt.expr());
+    }
+    void Visit(const hir::ReturnStatement &stmt) override {
+        if (stmt.ret_value()) Annotate(ctx_, stmt.ret_value().value());
+    }
+    void Visit(const hir::BreakStatement &) override {}
+    void Visit(const hir::ContinueStatement &) override {}
+    void Visit(const hir::WhileStatement &stmt) override {
+        Annotate(ctx_, stmt.cond());
+        stmt.body()->Accept(*this);
+    }
+    void Visit(const hir::IfStatement &stmt) override {
+        Annotate(ctx_, stmt.cond());
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(const hir::BlockStatement &stmt) override {
+        for (const auto &inner : stmt.stmts()) inner->Accept(*this);
+    }
+
+private:
+    CodeGenContext &ctx_;
+};
+
+void AnnotateExprTypes(CodeGenContext &ctx,
+                       const hir::FunctionDeclaration &decl) {
+    if (!decl.body()) return;
+    StmtTyping typing(ctx);
+    decl.body()->Accept(typing);
+}
+
+}  // namespace mini
@@ -0,0 +1,21 @@
+#ifndef MINI_CODEGEN_TYPING_H_
+#define MINI_CODEGEN_TYPING_H_
+
+#include "../hir/decl.h"
+#include "context.h"
+
+namespace mini {
+
+// Resolve the type of every expression in the body of `decl` and cache it in
+// the expression, so that code generation can know the type of an expression
+// without generating it.
+//
+// This expects the local variables of `decl` are already in the current lvar
+// table. Nothing is reported here: expressions which cannot be typed are left
+// untyped, and the error is reported when code generation reaches them.
+void AnnotateExprTypes(CodeGenContext &ctx,
+                       const hir::FunctionDeclaration &decl);
+
+}  // namespace mini
+
+#endif  // MINI_CODEGEN_TYPING_H_
@@ -0,0 +1,105 @@
+#include "context.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "panic.h"
+
+namespace mini {
+
+InputCacheEntry::InputCacheEntry(std::string &&name, std::string &&contents)
+    : name_(std::move(name)),
+      owned_(std::move(contents)),
+      data_(owned_.data()),
+      size_(owned_.size()),
+      mapped_(false) {}
+
+InputCacheEntry::InputCacheEntry(std::string &&name, const char *data,
+                                 size_t size, bool mapped)
+    : name_(std::move(name)), data_(data), size_(size), mapped_(mapped) {}
+
+InputCacheEntry::~InputCacheEntry() {
+    if (mapped_) munmap(const_cast<char *>(data_), size_);
+}
+
+void InputCacheEntry::BuildLineIndex() const {
+    line_index_built_ = true;
+    line_starts_.push_back(0);
+    const char *p = data_;
+    const char *end = data_ + size_;
+    while (p < end) {
+        auto nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!nl) break;
+        p = nl + 1;
+        line_starts_.push_back(p - data_);
+    }
+    // Like `std::getline`, a newline at the end of file doesn't start a line.
+    if (line_starts_.back() == size_) line_starts_.pop_back();
+}
+
+size_t InputCacheEntry::LineCount() const {
+    if (!line_index_built_) BuildLineIndex();
+    return line_starts_.size();
+}
+
+std::string_view InputCacheEntry::Line(size_t row) const {
+    if (row >= LineCount()) return std::string_view();
+    size_t start = line_starts_[row];
+    size_t end = row + 1 < line_starts_.size() ? line_starts_[row + 1] - 1
+                                               : size_;
+    // The newline at the end of file is not a part of the last line either.
+    if (end == size_ && end > start && data_[end - 1] == '\n') end--;
+    return std::string_view(data_ + start, end - start);
+}
+
+Position InputCacheEntry::PositionOf(size_t offset) const {
+    if (!line_index_built_) BuildLineIndex();
+    auto it = std::upper_bound(line_starts_.begin(), line_starts_.end(), offset);
+    if (it == line_starts_.begin()) return Position(0, offset);
+    size_t row = it - line_starts_.begin() - 1;
+    return Position(row, offset - line_starts_[row]);
+}
+
+size_t InputCache::Cache(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) FatalError("failed to open `{}`", path);
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        FatalError("failed to stat `{}`", path);
+    }
+
+    size_t id = entries_.size();
+    std::string name = path;
+    size_t size = st.st_size;
+    if (S_ISREG(st.st_mode) && size != 0) {
+        void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            close(fd);
+            entries_.push_back(std::make_unique<InputCacheEntry>(
+                std::move(name), static_cast<const char *>(addr), size, true));
+            return id;
+        }
+    }
+
+    // Fallback for pipes, empty files or when mmap is unavailable: read whole
+    // contents into one buffer.
+    std::string contents;
+    char buf[65536];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) contents.append(buf, n);
+    close(fd);
+    if (n < 0) FatalError("failed to read `{}`", path);
+    return Cache(std::move(name), std::move(contents));
+}
+
+};  // namespace mini
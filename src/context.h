@@ -1,62 +1,135 @@
 #ifndef MINI_CONTEXT_H_
 #define MINI_CONTEXT_H_
 
-#include <fstream>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <ostream>
 #include <string>
-#include <utility>
+#include <string_view>
 #include <vector>
 
-#include "panic.h"
+#include "arena.h"
+#include "span.h"
+#include "timer.h"
 
 namespace mini {
 
+// A source file held as one contiguous buffer.
+//
+// The buffer is either mmap-ed from the file or owned as a string. Offsets of
+// each line are only computed when a line or a position is first requested,
+// so lexing a file never allocates per line.
 class InputCacheEntry {
 public:
-    InputCacheEntry(std::string &&name, std::vector<std::string> &&lines)
-        : name_(std::move(name)), lines_(std::move(lines)) {}
+    InputCacheEntry(std::string &&name, std::string &&contents);
+    InputCacheEntry(std::string &&name, const char *data, size_t size,
+                    bool mapped);
+    InputCacheEntry(const InputCacheEntry &) = delete;
+    InputCacheEntry &operator=(const InputCacheEntry &) = delete;
+    ~InputCacheEntry();
     inline const std::string &name() const { return name_; }
-    inline const std::vector<std::string> &lines() const { return lines_; }
+    inline std::string_view contents() const {
+        return std::string_view(data_, size_);
+    }
+
+    // Returns `row`-th line without newline character.
+    std::string_view Line(size_t row) const;
+
+    // Returns the number of lines.
+    size_t LineCount() const;
+
+    // Returns the row and column of the character at `offset`.
+    Position PositionOf(size_t offset) const;
 
 private:
+    void BuildLineIndex() const;
+
     const std::string name_;
-    const std::vector<std::string> lines_;
+    const std::string owned_;
+    const char *data_;
+    const size_t size_;
+    const bool mapped_;
+
+    // Offsets to the start of each line, built lazily.
+    mutable bool line_index_built_ = false;
+    mutable std::vector<size_t> line_starts_;
 };
 
 class InputCache {
 public:
-    size_t Cache(std::string &&name, std::vector<std::string> &&lines) {
+    size_t Cache(std::string &&name, std::string &&contents) {
         size_t id = entries_.size();
-        entries_.emplace_back(std::move(name), std::move(lines));
+        entries_.push_back(std::make_unique<InputCacheEntry>(
+            std::move(name), std::move(contents)));
         return id;
     }
-    size_t Cache(const std::string &path) {
-        std::string line;
-        std::vector<std::string> lines;
-        std::ifstream ifs(path);
-        if (!ifs.is_open()) FatalError("failed to open `{}`", path);
-        while (std::getline(ifs, line)) {
-            lines.emplace_back(line);
-        }
-        std::string name = path;
-        return Cache(std::move(name), std::move(lines));
-    }
-    const InputCacheEntry &Fetch(size_t id) const { return entries_.at(id); }
+    size_t Cache(const std::string &path);
+    const InputCacheEntry &Fetch(size_t id) const { return *entries_.at(id); }
 
 private:
-    std::vector<InputCacheEntry> entries_;
+    std::vector<std::unique_ptr<InputCacheEntry>> entries_;
+};
+
+// What optimization passes did, for reporting.
+struct OptStats {
+    size_t folded_nodes = 0;  // Hir nodes removed by constant folding.
+
+    // Statements and functions removed by dead code elimination.
+    size_t dead_statements = 0;
+    size_t dead_functions = 0;
+
+    size_t replaced_insts = 0;  // Mir instructions reusing an earlier value.
+    size_t hoisted_insts = 0;   // Mir instructions moved out of loops.
+
+    // Rewrites by each rule of the peephole optimizer, indexed by
+    // `PeepholeRule`.
+    std::vector<size_t> peephole_rewrites;
+
+    // A line for each call site the inliner looked at, saying whether it's
+    // inlined and why.
+    std::vector<std::string> inline_report;
+
+    // A line for each call in tail position, saying whether it's converted
+    // to a jump or a loop, or why not.
+    std::vector<std::string> tail_call_report;
 };
 
 class Context {
 public:
-    Context() : should_report_(true) {}
+    Context()
+        : ast_arena_("ast"),
+          hir_arena_("hir"),
+          should_report_(true),
+          whole_program_(false),
+          report_stream_(&std::cerr) {}
     InputCache &input_cache() { return input_cache_; }
+    Arena &ast_arena() { return ast_arena_; }
+    Arena &hir_arena() { return hir_arena_; }
+    PassTimer &pass_timer() { return pass_timer_; }
+    OptStats &opt_stats() { return opt_stats_; }
     bool should_report() const { return should_report_; }
     void SuppressReport() { should_report_ = false; }
     void ActivateReport() { should_report_ = true; }
 
+    // Whether the unit is linked alone into an executable, so that nothing
+    // but `_start` calls its functions, and only `main` from there.
+    bool whole_program() const { return whole_program_; }
+    void SetWholeProgram() { whole_program_ = true; }
+
+    // Where diagnostics go, stderr unless redirected.
+    std::ostream &report_stream() { return *report_stream_; }
+    void SetReportStream(std::ostream &os) { report_stream_ = &os; }
+
 private:
     InputCache input_cache_;
+    Arena ast_arena_;
+    Arena hir_arena_;
+    PassTimer pass_timer_;
+    OptStats opt_stats_;
     bool should_report_;
+    bool whole_program_;
+    std::ostream *report_stream_;
 };
 
 };  // namespace mini
@@ -47,6 +47,11 @@ void EnumDeclaration::Print(PrintableContext &ctx) const {
 }
 
 void FunctionDeclaration::Print(PrintableContext &ctx) const {
+    if (inline_attr_) {
+        bool is_inline =
+            inline_attr_->kind() == FunctionDeclarationInline::Inline;
+        ctx.printer().Print("{} ", is_inline ? "inline" : "noinline");
+    }
     ctx.printer().Print("function {}(", name_.value());
     if (!params_.empty()) {
         auto param = params_.at(0);
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "../span.h"
+#include "../symbol.h"
 #include "printable.h"
 #include "stmt.h"
 #include "type.h"
@@ -49,13 +50,13 @@ private:
 
 class StructDeclarationFieldName {
 public:
-    StructDeclarationFieldName(std::string &&value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string &value() const { return value_; }
+    StructDeclarationFieldName(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -76,13 +77,13 @@ private:
 
 class StructDeclarationName {
 public:
-    StructDeclarationName(std::string &&value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string &value() const { return value_; }
+    StructDeclarationName(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -112,13 +113,13 @@ private:
 
 class EnumDeclarationFieldName {
 public:
-    EnumDeclarationFieldName(std::string &&value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string &value() const { return value_; }
+    EnumDeclarationFieldName(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -150,13 +151,12 @@ private:
 
 class EnumDeclarationName {
 public:
-    EnumDeclarationName(std::string &&value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string &value() const { return value_; }
+    EnumDeclarationName(Symbol value, Span span) : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -190,25 +190,25 @@ private:
 
 class FunctionDeclarationName {
 public:
-    FunctionDeclarationName(std::string &&value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string &value() const { return value_; }
+    FunctionDeclarationName(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
 class FunctionDeclarationParamName {
 public:
-    FunctionDeclarationParamName(std::string &&value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string &value() const { return value_; }
+    FunctionDeclarationParamName(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -229,13 +229,13 @@ private:
 
 class VariableDeclarationName {
 public:
-    VariableDeclarationName(std::string &&value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string &value() const { return value_; }
+    VariableDeclarationName(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -262,15 +262,33 @@ private:
     Span span_;
 };
 
+class FunctionDeclarationInline {
+public:
+    enum Kind {
+        Inline,    // "inline"
+        NoInline,  // "noinline"
+    };
+    FunctionDeclarationInline(Kind kind, Span span)
+        : kind_(kind), span_(span) {}
+    inline Kind kind() const { return kind_; }
+    inline Span span() const { return span_; }
+
+private:
+    Kind kind_;
+    Span span_;
+};
+
 class FunctionDeclaration : public Declaration {
 public:
-    FunctionDeclaration(FunctionDeclarationName &&name,
+    FunctionDeclaration(std::optional<FunctionDeclarationInline> inline_attr,
+                        FunctionDeclarationName &&name,
                         std::vector<FunctionDeclarationParam> &&params,
                         std::optional<FunctionDeclarationVariadic> variadic,
                         const std::shared_ptr<Type> &ret,
                         std::vector<VariableDeclaration> &&decls,
                         std::optional<BlockStatement> &&body, Span span)
         : Declaration(span),
+          inline_attr_(inline_attr),
           name_(std::move(name)),
           params_(std::move(params)),
           variadic_(variadic),
@@ -284,6 +302,10 @@ public:
         visitor.Visit(*this);
     }
     void Print(PrintableContext &ctx) const override;
+    inline const std::optional<FunctionDeclarationInline> &inline_attr()
+        const {
+        return inline_attr_;
+    }
     inline const FunctionDeclarationName &name() const { return name_; }
     inline const std::vector<FunctionDeclarationParam> &params() const {
         return params_;
@@ -300,6 +322,7 @@ public:
     inline std::optional<BlockStatement> &body() { return body_; }
 
 private:
+    std::optional<FunctionDeclarationInline> inline_attr_;
     FunctionDeclarationName name_;
     std::vector<FunctionDeclarationParam> params_;
     std::optional<FunctionDeclarationVariadic> variadic_;
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "../span.h"
+#include "../symbol.h"
 #include "../utils.h"
 #include "printable.h"
 #include "type.h"
@@ -55,14 +56,47 @@ public:
     virtual void Visit(const ArrayExpression& expr) = 0;
 };
 
+class ExpressionVisitorMut {
+public:
+    virtual ~ExpressionVisitorMut() {}
+    virtual void Visit(UnaryExpression& expr) = 0;
+    virtual void Visit(InfixExpression& expr) = 0;
+    virtual void Visit(IndexExpression& expr) = 0;
+    virtual void Visit(CallExpression& expr) = 0;
+    virtual void Visit(AccessExpression& expr) = 0;
+    virtual void Visit(CastExpression& expr) = 0;
+    virtual void Visit(ESizeofExpression& expr) = 0;
+    virtual void Visit(TSizeofExpression& expr) = 0;
+    virtual void Visit(EnumSelectExpression& expr) = 0;
+    virtual void Visit(VariableExpression& expr) = 0;
+    virtual void Visit(IntegerExpression& expr) = 0;
+    virtual void Visit(StringExpression& expr) = 0;
+    virtual void Visit(CharExpression& expr) = 0;
+    virtual void Visit(BoolExpression& expr) = 0;
+    virtual void Visit(NullPtrExpression& expr) = 0;
+    virtual void Visit(StructExpression& expr) = 0;
+    virtual void Visit(ArrayExpression& expr) = 0;
+};
+
 class Expression : public Printable {
 public:
     Expression(Span span) : span_(span) {}
     virtual void Accept(ExpressionVisitor& visitor) const = 0;
+    virtual void Accept(ExpressionVisitorMut& visitor) = 0;
     inline Span span() const { return span_; }
 
+    // Type of this expression as rvalue, resolved before code generation.
+    // Null if it's not resolved.
+    inline const std::shared_ptr<Type>& inferred_type() const {
+        return inferred_type_;
+    }
+    inline void set_inferred_type(const std::shared_ptr<Type>& type) const {
+        inferred_type_ = type;
+    }
+
 private:
     Span span_;
+    mutable std::shared_ptr<Type> inferred_type_;
 };
 
 class UnaryExpression : public Expression {
@@ -90,9 +124,13 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline Op op() const { return op_; }
     inline const std::unique_ptr<Expression>& expr() const { return expr_; }
+    inline std::unique_ptr<Expression>& expr() { return expr_; }
 
 private:
     Op op_;
@@ -142,10 +180,15 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const std::unique_ptr<Expression>& lhs() const { return lhs_; }
+    inline std::unique_ptr<Expression>& lhs() { return lhs_; }
     inline Op op() const { return op_; }
     inline const std::unique_ptr<Expression>& rhs() const { return rhs_; }
+    inline std::unique_ptr<Expression>& rhs() { return rhs_; }
 
 private:
     std::unique_ptr<Expression> lhs_;
@@ -161,9 +204,14 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const std::unique_ptr<Expression>& expr() const { return expr_; }
+    inline std::unique_ptr<Expression>& expr() { return expr_; }
     inline const std::unique_ptr<Expression>& index() const { return index_; }
+    inline std::unique_ptr<Expression>& index() { return index_; }
 
 private:
     std::unique_ptr<Expression> expr_;
@@ -178,11 +226,16 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const std::unique_ptr<Expression>& func() const { return func_; }
+    inline std::unique_ptr<Expression>& func() { return func_; }
     inline const std::vector<std::unique_ptr<Expression>>& args() const {
         return args_;
     }
+    inline std::vector<std::unique_ptr<Expression>>& args() { return args_; }
 
 private:
     std::unique_ptr<Expression> func_;
@@ -191,13 +244,13 @@ private:
 
 class AccessExpressionField {
 public:
-    AccessExpressionField(std::string&& value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string& value() const { return value_; }
+    AccessExpressionField(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -209,8 +262,12 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const std::unique_ptr<Expression>& expr() const { return expr_; }
+    inline std::unique_ptr<Expression>& expr() { return expr_; }
     inline const AccessExpressionField& field() const { return field_; }
 
 private:
@@ -228,8 +285,12 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const std::unique_ptr<Expression>& expr() const { return expr_; }
+    inline std::unique_ptr<Expression>& expr() { return expr_; }
     inline const std::shared_ptr<Type>& cast_type() const { return cast_type_; }
 
 private:
@@ -244,8 +305,12 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const std::unique_ptr<Expression>& expr() const { return expr_; }
+    inline std::unique_ptr<Expression>& expr() { return expr_; }
 
 private:
     std::unique_ptr<Expression> expr_;
@@ -258,6 +323,9 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const std::shared_ptr<Type>& type() const { return type_; }
 
@@ -267,25 +335,25 @@ private:
 
 class EnumSelectExpressionSrc {
 public:
-    EnumSelectExpressionSrc(std::string&& value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string& value() const { return value_; }
+    EnumSelectExpressionSrc(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
 class EnumSelectExpressionDst {
 public:
-    EnumSelectExpressionDst(std::string&& value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string& value() const { return value_; }
+    EnumSelectExpressionDst(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -297,6 +365,9 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     inline void Print(PrintableContext& ctx) const override {
         ctx.printer().Print("{}::{}", src_.value(), dst_.value());
     }
@@ -310,18 +381,21 @@ private:
 
 class VariableExpression : public Expression {
 public:
-    VariableExpression(std::string&& value, Span span)
-        : Expression(span), value_(std::move(value)) {}
+    VariableExpression(Symbol value, Span span)
+        : Expression(span), value_(value) {}
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     inline void Print(PrintableContext& ctx) const override {
-        ctx.printer().Print(value_);
+        ctx.printer().Print("{}", value_);
     }
-    inline const std::string& value() const { return value_; }
+    inline Symbol value() const { return value_; }
 
 private:
-    std::string value_;
+    Symbol value_;
 };
 
 class IntegerExpression : public Expression {
@@ -331,6 +405,9 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     inline void Print(PrintableContext& ctx) const override {
         ctx.printer().Print("{}", value_);
     }
@@ -347,6 +424,9 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     inline void Print(PrintableContext& ctx) const override {
         ctx.printer().Print("\"{}\"", EscapeStringContent(value_));
     }
@@ -362,6 +442,9 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     inline void Print(PrintableContext& ctx) const override {
         ctx.printer().Print("'{}'", EscapeCharContent(value_));
     }
@@ -377,6 +460,9 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     inline void Print(PrintableContext& ctx) const override {
         ctx.printer().Print("{}", value_);
     }
@@ -392,6 +478,9 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     inline void Print(PrintableContext& ctx) const override {
         ctx.printer().Print("nullptr");
     }
@@ -399,25 +488,25 @@ public:
 
 class StructExpressionName {
 public:
-    StructExpressionName(std::string&& value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string& value() const { return value_; }
+    StructExpressionName(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
 class StructExpressionInitName {
 public:
-    StructExpressionInitName(std::string&& value, Span span)
-        : value_(std::move(value)), span_(span) {}
-    inline const std::string& value() const { return value_; }
+    StructExpressionInitName(Symbol value, Span span)
+        : value_(value), span_(span) {}
+    inline Symbol value() const { return value_; }
     inline Span span() const { return span_; }
 
 private:
-    std::string value_;
+    Symbol value_;
     Span span_;
 };
 
@@ -428,6 +517,7 @@ public:
         : name_(std::move(name)), value_(std::move(value)) {}
     inline const StructExpressionInitName& name() const { return name_; }
     inline const std::unique_ptr<Expression>& value() const { return value_; }
+    inline std::unique_ptr<Expression>& value() { return value_; }
     inline Span span() const { return name_.span() + value_->span(); }
 
 private:
@@ -443,11 +533,15 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const StructExpressionName& name() const { return name_; }
     inline const std::vector<StructExpressionInit>& inits() const {
         return inits_;
     }
+    inline std::vector<StructExpressionInit>& inits() { return inits_; }
 
 private:
     StructExpressionName name_;
@@ -461,10 +555,14 @@ public:
     inline void Accept(ExpressionVisitor& visitor) const override {
         return visitor.Visit(*this);
     }
+    inline void Accept(ExpressionVisitorMut& visitor) override {
+        return visitor.Visit(*this);
+    }
     void Print(PrintableContext& ctx) const override;
     inline const std::vector<std::unique_ptr<Expression>>& inits() const {
         return inits_;
     }
+    inline std::vector<std::unique_ptr<Expression>>& inits() { return inits_; }
 
 private:
     std::vector<std::unique_ptr<Expression>> inits_;
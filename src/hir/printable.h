@@ -1,11 +1,13 @@
 #ifndef MINI_HIR_PRINTABLE_H_
 #define MINI_HIR_PRINTABLE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <ostream>
 #include <string>
 #include <utility>
 
+#include "../arena.h"
 #include "../panic.h"
 #include "fmt/base.h"
 #include "fmt/format.h"
@@ -55,6 +57,13 @@ private:
 
 class Printable {
 public:
+    // Nodes live in the current hir arena and are freed along with it.
+    static void *operator new(size_t size) {
+        return CurrentArena(ArenaKind::Hir)
+            .Allocate(size, alignof(std::max_align_t));
+    }
+    static void operator delete(void *) {}
+
     virtual ~Printable() {}
     virtual void Print(PrintableContext &ctx) const = 0;
     virtual void PrintLn(PrintableContext &ctx) const {
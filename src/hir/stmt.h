@@ -68,6 +68,7 @@ public:
     }
     void Print(PrintableContext &ctx) const override;
     inline const std::unique_ptr<Expression> &expr() const { return expr_; }
+    inline std::unique_ptr<Expression> &expr() { return expr_; }
 
 private:
     std::unique_ptr<Expression> expr_;
@@ -88,6 +89,9 @@ public:
     inline const std::optional<std::unique_ptr<Expression>> &ret_value() const {
         return ret_value_;
     }
+    inline std::optional<std::unique_ptr<Expression>> &ret_value() {
+        return ret_value_;
+    }
 
 private:
     std::optional<std::unique_ptr<Expression>> ret_value_;
@@ -134,7 +138,9 @@ public:
     }
     void Print(PrintableContext &ctx) const override;
     inline const std::unique_ptr<Expression> &cond() const { return cond_; }
+    inline std::unique_ptr<Expression> &cond() { return cond_; }
     inline const std::unique_ptr<Statement> &body() const { return body_; }
+    inline std::unique_ptr<Statement> &body() { return body_; }
 
 private:
     std::unique_ptr<Expression> cond_;
@@ -159,6 +165,7 @@ public:
     }
     void Print(PrintableContext &ctx) const override;
     inline const std::unique_ptr<Expression> &cond() const { return cond_; }
+    inline std::unique_ptr<Expression> &cond() { return cond_; }
     inline const std::unique_ptr<Statement> &then_body() const {
         return then_body_;
     }
@@ -166,6 +173,9 @@ public:
     inline const std::optional<std::unique_ptr<Statement>> &else_body() const {
         return else_body_;
     }
+    inline std::optional<std::unique_ptr<Statement>> &else_body() {
+        return else_body_;
+    }
 
 private:
     std::unique_ptr<Expression> cond_;
@@ -6,8 +6,11 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <utility>
 
+#include "../arena.h"
 #include "../span.h"
+#include "../symbol.h"
 #include "printable.h"
 
 namespace mini {
@@ -157,8 +160,7 @@ private:
 
 class NameType : public Type {
 public:
-    NameType(std::string &&value, Span span)
-        : Type(span), value_(std::move(value)) {}
+    NameType(Symbol value, Span span) : Type(span), value_(value) {}
     inline void Accept(TypeVisitor &visitor) const override {
         visitor.Visit(*this);
     }
@@ -171,12 +173,20 @@ public:
     bool operator==(const Type &rhs) const override {
         return rhs.IsName() ? rhs.ToName()->value_ == value_ : false;
     }
-    const std::string &value() const { return value_; }
+    Symbol value() const { return value_; }
 
 private:
-    std::string value_;
+    Symbol value_;
 };
 
+// Creates a type sharing the current hir arena with the nodes.
+template <typename T, typename... Args>
+inline std::shared_ptr<T> MakeType(Args &&...args) {
+    return std::allocate_shared<T>(
+        ArenaAllocator<T>(CurrentArena(ArenaKind::Hir)),
+        std::forward<Args>(args)...);
+}
+
 }  // namespace hir
 
 }  // namespace mini
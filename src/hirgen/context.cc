@@ -6,18 +6,18 @@
 
 namespace mini {
 
-const std::string &NameTranslator::RegName(const std::string &name) {
-    auto assoc = fmt::format("_{}", curr_id_++);
-    assoc_table_->Insert(std::string(name), std::move(assoc));
+Symbol NameTranslator::RegName(Symbol name) {
+    Symbol assoc(fmt::format("_{}", curr_id_++));
+    assoc_table_->Insert(name, assoc);
     return assoc_table_->Query(name);
 }
 
-const std::string &NameTranslator::RegNameRaw(const std::string &name) {
-    assoc_table_->Insert(std::string(name), std::string(name));
+Symbol NameTranslator::RegNameRaw(Symbol name) {
+    assoc_table_->Insert(name, name);
     return assoc_table_->Query(name);
 }
 
-const std::string &NameTranslator::Translate(const std::string &name) {
+Symbol NameTranslator::Translate(Symbol name) {
     if (Translatable(name))
         return assoc_table_->Query(name);
     else
@@ -35,10 +35,10 @@ void NameTranslator::LeaveScope() {
     }
 }
 
-const std::string &NameTranslator::SymbolAssocTable::Query(
-    const std::string &name) {
-    if (map_.find(name) != map_.end()) {
-        return map_.at(name);
+Symbol NameTranslator::SymbolAssocTable::Query(Symbol name) {
+    auto it = map_.find(name);
+    if (it != map_.end()) {
+        return it->second;
     } else {
         if (!outer_) {
             throw std::out_of_range(fmt::format("{} doesn't exists", name));
@@ -48,8 +48,7 @@ const std::string &NameTranslator::SymbolAssocTable::Query(
     }
 }
 
-bool NameTranslator::SymbolAssocTable::Exists(const std::string &name,
-                                              bool upward) {
+bool NameTranslator::SymbolAssocTable::Exists(Symbol name, bool upward) {
     if (map_.find(name) != map_.end()) {
         return true;
     } else if (upward) {
@@ -1,12 +1,12 @@
 #ifndef MINI_HIRGEN_CONTEXT_H_
 #define MINI_HIRGEN_CONTEXT_H_
 
-#include <map>
 #include <memory>
-#include <string>
+#include <unordered_map>
 
 #include "../context.h"
 #include "../hir/root.h"
+#include "../symbol.h"
 
 namespace mini {
 
@@ -17,18 +17,18 @@ public:
 
     // Returns true if the name is translatable.
     // Set `upward` false will checks translatability only at current scope.
-    inline bool Translatable(const std::string &name, bool upward = true) {
+    inline bool Translatable(Symbol name, bool upward = true) {
         return assoc_table_->Exists(name, upward);
     }
 
     // Register name and associate it with unique name.
-    const std::string &RegName(const std::string &name);
+    Symbol RegName(Symbol name);
 
     // Register name but associate with itself.
-    const std::string &RegNameRaw(const std::string &name);
+    Symbol RegNameRaw(Symbol name);
 
     // Translate given name into associated name.
-    const std::string &Translate(const std::string &name);
+    Symbol Translate(Symbol name);
 
     void EnterFunc() { curr_id_ = 0; }
     void EnterScope();
@@ -47,20 +47,20 @@ private:
         }
 
         // Try to get name associated with `name`.
-        const std::string &Query(const std::string &name);
+        Symbol Query(Symbol name);
 
         // Insert `symbol` with `assoc`.
-        inline void Insert(std::string &&symbol, std::string &&assoc) {
+        inline void Insert(Symbol symbol, Symbol assoc) {
             map_.insert(std::make_pair(symbol, assoc));
         }
 
         // Returns true if the `name` is registerd in thsi table.
         // Set `upward` false will ignore outer table.
-        bool Exists(const std::string &name, bool upward);
+        bool Exists(Symbol name, bool upward);
 
     private:
         std::shared_ptr<SymbolAssocTable> outer_;
-        std::map<std::string, std::string> map_;
+        std::unordered_map<Symbol, Symbol> map_;
     };
 
     std::shared_ptr<SymbolAssocTable> assoc_table_;
@@ -17,8 +17,7 @@ void DeclVarReg::Visit(const ast::EnumDeclaration &) {}
 
 void DeclHirGen::Visit(const ast::FunctionDeclaration &decl) {
     hir::FunctionDeclarationName name(
-        std::string(ctx_.translator().Translate(decl.name().name())),
-        decl.name().span());
+        ctx_.translator().Translate(decl.name().name()), decl.name().span());
 
     ctx_.translator().EnterScope();
     ctx_.translator().EnterFunc();
@@ -30,7 +29,7 @@ void DeclHirGen::Visit(const ast::FunctionDeclaration &decl) {
         if (!gen) return;
 
         hir::FunctionDeclarationParamName name(
-            std::string(ctx_.translator().RegName(param.name().name())),
+            ctx_.translator().RegName(param.name().name()),
             param.name().span());
         params.emplace_back(gen.type(), std::move(name), param.span());
     }
@@ -38,6 +37,15 @@ void DeclHirGen::Visit(const ast::FunctionDeclaration &decl) {
     std::optional<hir::FunctionDeclarationVariadic> variadic;
     if (decl.variadic()) variadic.emplace(decl.variadic()->span());
 
+    std::optional<hir::FunctionDeclarationInline> inline_attr;
+    if (decl.inline_attr()) {
+        auto kind = decl.inline_attr()->kind() ==
+                            ast::FunctionDeclarationInline::Inline
+                        ? hir::FunctionDeclarationInline::Inline
+                        : hir::FunctionDeclarationInline::NoInline;
+        inline_attr.emplace(kind, decl.inline_attr()->span());
+    }
+
     std::shared_ptr<hir::Type> ret;
     if (decl.ret()) {
         TypeHirGen gen(ctx_);
@@ -45,7 +53,7 @@ void DeclHirGen::Visit(const ast::FunctionDeclaration &decl) {
         if (!gen) return;
         ret = gen.type();
     } else {
-        ret = std::make_shared<hir::BuiltinType>(hir::BuiltinType::Void,
+        ret = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Void,
                                                  decl.span());
     }
 
@@ -62,12 +70,12 @@ void DeclHirGen::Visit(const ast::FunctionDeclaration &decl) {
     if (decl.body().IsConcrete()) {
         hir::BlockStatement body(std::move(stmts), decl.body().span());
         decl_ = std::make_unique<hir::FunctionDeclaration>(
-            std::move(name), std::move(params), variadic, ret, std::move(decls),
-            std::move(body), decl.span());
+            inline_attr, std::move(name), std::move(params), variadic, ret,
+            std::move(decls), std::move(body), decl.span());
     } else {
         decl_ = std::make_unique<hir::FunctionDeclaration>(
-            std::move(name), std::move(params), variadic, ret, std::move(decls),
-            std::nullopt, decl.span());
+            inline_attr, std::move(name), std::move(params), variadic, ret,
+            std::move(decls), std::nullopt, decl.span());
     }
     success_ = true;
 }
@@ -80,12 +88,11 @@ void DeclHirGen::Visit(const ast::StructDeclaration &decl) {
         if (!gen) return;
 
         auto name = hir::StructDeclarationFieldName(
-            std::string(field.name().name()), field.name().span());
+            field.name().name(), field.name().span());
         fields.emplace_back(gen.type(), std::move(name), field.span());
     }
 
-    hir::StructDeclarationName name(std::string(decl.name().name()),
-                                    decl.name().span());
+    hir::StructDeclarationName name(decl.name().name(), decl.name().span());
     decl_ = std::make_unique<hir::StructDeclaration>(
         std::move(name), std::move(fields), decl.span());
     success_ = true;
@@ -102,7 +109,7 @@ void DeclHirGen::Visit(const ast::EnumDeclaration &decl) {
             value = eval.value();
         }
         fields.emplace_back(
-            hir::EnumDeclarationFieldName(std::string(field.name().name()),
+            hir::EnumDeclarationFieldName(field.name().name(),
                                           field.name().span()),
             hir::EnumDeclarationFieldValue(
                 value, field.init() ? field.init()->span() : field.span()));
@@ -123,13 +130,12 @@ void DeclHirGen::Visit(const ast::EnumDeclaration &decl) {
             return;
         }
     } else {
-        std::shared_ptr<hir::Type> type = std::make_shared<hir::BuiltinType>(
+        std::shared_ptr<hir::Type> type = hir::MakeType<hir::BuiltinType>(
             hir::BuiltinType::USize, decl.span());
         base_type.emplace(type);
     }
 
-    hir::EnumDeclarationName name(std::string(decl.name().name()),
-                                  decl.name().span());
+    hir::EnumDeclarationName name(decl.name().name(), decl.name().span());
     decl_ = std::make_unique<hir::EnumDeclaration>(
         std::move(name), base_type.value(), std::move(fields), decl.span());
     success_ = true;
@@ -122,8 +122,7 @@ void ExprHirGen::Visit(const ast::AccessExpression &expr) {
     expr.expr()->Accept(gen);
     if (!gen) return;
 
-    hir::AccessExpressionField field(std::string(expr.field().name()),
-                                     expr.field().span());
+    hir::AccessExpressionField field(expr.field().name(), expr.field().span());
     expr_ = std::make_unique<hir::AccessExpression>(
         std::move(gen.expr_), std::move(field), expr.span());
     success_ = true;
@@ -164,10 +163,8 @@ void ExprHirGen::Visit(const ast::TSizeofExpression &expr) {
 }
 
 void ExprHirGen::Visit(const ast::EnumSelectExpression &expr) {
-    hir::EnumSelectExpressionSrc src(std::string(expr.src().name()),
-                                     expr.src().span());
-    hir::EnumSelectExpressionDst dst(std::string(expr.dst().name()),
-                                     expr.dst().span());
+    hir::EnumSelectExpressionSrc src(expr.src().name(), expr.src().span());
+    hir::EnumSelectExpressionDst dst(expr.dst().name(), expr.dst().span());
 
     expr_ = std::make_unique<hir::EnumSelectExpression>(
         std::move(src), std::move(dst), expr.span());
@@ -181,9 +178,8 @@ void ExprHirGen::Visit(const ast::VariableExpression &expr) {
         return;
     }
 
-    std::string translated = ctx_.translator().Translate(expr.value());
-    expr_ = std::make_unique<hir::VariableExpression>(std::move(translated),
-                                                      expr.span());
+    Symbol translated = ctx_.translator().Translate(expr.value());
+    expr_ = std::make_unique<hir::VariableExpression>(translated, expr.span());
     success_ = true;
 }
 
@@ -222,13 +218,12 @@ void ExprHirGen::Visit(const ast::StructExpression &expr) {
         init.value()->Accept(gen);
         if (!gen) return;
 
-        hir::StructExpressionInitName name(std::string(init.name().name()),
+        hir::StructExpressionInitName name(init.name().name(),
                                            init.name().span());
         inits.emplace_back(std::move(name), std::move(gen.expr_));
     }
 
-    hir::StructExpressionName name(std::string(expr.name().name()),
-                                   expr.name().span());
+    hir::StructExpressionName name(expr.name().name(), expr.name().span());
 
     expr_ = std::make_unique<hir::StructExpression>(
         std::move(name), std::move(inits), expr.span());
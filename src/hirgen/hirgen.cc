@@ -7,9 +7,11 @@
 
 namespace mini {
 
-HirGenResult HirGenFile(Context &ctx, const std::string &path) {
-    auto ast_decls = ParseFile(ctx, path);
+HirGenResult HirGen(Context &ctx, size_t id) {
+    ArenaScope scope(ArenaKind::Hir, ctx.hir_arena());
+    auto ast_decls = Parse(ctx, id);
     if (!ast_decls) return std::nullopt;
+    PassScope pass(ctx.pass_timer(), "hirgen");
 
     hir::StringTable table;
     HirGenContext gen_ctx(ctx, table);
@@ -25,6 +27,7 @@ HirGenResult HirGenFile(Context &ctx, const std::string &path) {
         decl->Accept(gen);
         if (!gen) return std::nullopt;
 
+        PassScope cflow_pass(ctx.pass_timer(), "cflow");
         ControlFlowChecker check(ctx);
         gen.decl()->Accept(check);
         if (!check) return std::nullopt;
@@ -37,4 +40,8 @@ HirGenResult HirGenFile(Context &ctx, const std::string &path) {
     return root;
 }
 
+HirGenResult HirGenFile(Context &ctx, const std::string &path) {
+    return HirGen(ctx, ctx.input_cache().Cache(path));
+}
+
 }  // namespace mini
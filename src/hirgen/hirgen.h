@@ -11,6 +11,9 @@ namespace mini {
 
 using HirGenResult = std::optional<hir::Root>;
 
+// Generates hir from the source cached as `id` in the input cache.
+HirGenResult HirGen(Context &ctx, size_t id);
+
 HirGenResult HirGenFile(Context &ctx, const std::string &path);
 
 }  // namespace mini
@@ -35,7 +35,7 @@ bool HirGenBlockItem(HirGenContext &ctx, const ast::BlockStatementItem &item,
             }
 
             hir::VariableDeclarationName name(
-                std::string(ctx.translator().RegName(body.name().name())),
+                ctx.translator().RegName(body.name().name()),
                 body.name().span());
             decls.emplace_back(gen_type.type(), std::move(name));
 
@@ -52,7 +52,7 @@ bool HirGenBlockItem(HirGenContext &ctx, const ast::BlockStatementItem &item,
                 }
 
                 auto lhs = std::make_unique<hir::VariableExpression>(
-                    std::string(ctx.translator().Translate(body.name().name())),
+                    ctx.translator().Translate(body.name().name()),
                     body.name().span());
                 hir::InfixExpression::Op op(hir::InfixExpression::Op::Assign,
                                             body.init()->assign().span());
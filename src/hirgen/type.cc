@@ -35,7 +35,7 @@ void TypeHirGen::Visit(const ast::BuiltinType &type) {
         kind = hir::BuiltinType::Bool;
     else
         FatalError("unreachable");
-    type_ = std::make_shared<hir::BuiltinType>(kind, type.span());
+    type_ = hir::MakeType<hir::BuiltinType>(kind, type.span());
     success_ = true;
 }
 
@@ -44,7 +44,7 @@ void TypeHirGen::Visit(const ast::PointerType &type) {
     type.of()->Accept(gen);
     if (!gen) return;
 
-    type_ = std::make_shared<hir::PointerType>(gen.type_, type.span());
+    type_ = hir::MakeType<hir::PointerType>(gen.type_, type.span());
     success_ = true;
 }
 
@@ -61,13 +61,13 @@ void TypeHirGen::Visit(const ast::ArrayType &type) {
         size = eval.value();
     }
 
-    type_ = std::make_shared<hir::ArrayType>(gen.type_, size, type.span());
+    type_ = hir::MakeType<hir::ArrayType>(gen.type_, size, type.span());
     success_ = true;
 }
 
 void TypeHirGen::Visit(const ast::NameType &type) {
     type_ =
-        std::make_shared<hir::NameType>(std::string(type.name()), type.span());
+        hir::MakeType<hir::NameType>(type.name(), type.span());
     success_ = true;
 }
 
@@ -0,0 +1,359 @@
+#include "dce.h"
+
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace mini {
+
+namespace hiropt {
+
+namespace {
+
+// Returns the value of `expr` if it's a literal `true` or `false`.
+std::optional<bool> ConstantOf(const std::unique_ptr<hir::Expression>& expr) {
+    struct Helper : public hir::ExpressionVisitor {
+        std::optional<bool> value;
+        void Visit(const hir::UnaryExpression&) {}
+        void Visit(const hir::InfixExpression&) {}
+        void Visit(const hir::IndexExpression&) {}
+        void Visit(const hir::CallExpression&) {}
+        void Visit(const hir::AccessExpression&) {}
+        void Visit(const hir::CastExpression&) {}
+        void Visit(const hir::ESizeofExpression&) {}
+        void Visit(const hir::TSizeofExpression&) {}
+        void Visit(const hir::EnumSelectExpression&) {}
+        void Visit(const hir::VariableExpression&) {}
+        void Visit(const hir::IntegerExpression&) {}
+        void Visit(const hir::StringExpression&) {}
+        void Visit(const hir::CharExpression&) {}
+        void Visit(const hir::BoolExpression& expr) { value = expr.value(); }
+        void Visit(const hir::NullPtrExpression&) {}
+        void Visit(const hir::StructExpression&) {}
+        void Visit(const hir::ArrayExpression&) {}
+    };
+    Helper helper;
+    expr->Accept(helper);
+    return helper.value;
+}
+
+// Counts statements in `stmt`, including itself but not blocks.
+class StatementCounter : public hir::StatementVisitor {
+public:
+    StatementCounter() : count_(0) {}
+    size_t count() const { return count_; }
+    void Visit(const hir::ExpressionStatement&) { count_++; }
+    void Visit(const hir::ReturnStatement&) { count_++; }
+    void Visit(const hir::BreakStatement&) { count_++; }
+    void Visit(const hir::ContinueStatement&) { count_++; }
+    void Visit(const hir::WhileStatement& stmt) {
+        count_++;
+        stmt.body()->Accept(*this);
+    }
+    void Visit(const hir::IfStatement& stmt) {
+        count_++;
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(const hir::BlockStatement& stmt) {
+        for (const auto& stmt : stmt.stmts()) stmt->Accept(*this);
+    }
+
+private:
+    size_t count_;
+};
+
+size_t CountStatements(const hir::Statement& stmt) {
+    StatementCounter c;
+    stmt.Accept(c);
+    return c.count();
+}
+
+// Finds `break` which leaves the loop whose body is visited, so not ones in
+// loops nested in it.
+class BreakFinder : public hir::StatementVisitor {
+public:
+    BreakFinder() : found_(false) {}
+    bool found() const { return found_; }
+    void Visit(const hir::ExpressionStatement&) {}
+    void Visit(const hir::ReturnStatement&) {}
+    void Visit(const hir::BreakStatement&) { found_ = true; }
+    void Visit(const hir::ContinueStatement&) {}
+    void Visit(const hir::WhileStatement&) {}
+    void Visit(const hir::IfStatement& stmt) {
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(const hir::BlockStatement& stmt) {
+        for (const auto& stmt : stmt.stmts()) stmt->Accept(*this);
+    }
+
+private:
+    bool found_;
+};
+
+// Removes statements which never run from statements of a function. As blocks
+// have no scope, a block replacing a statement of a block is spliced into it.
+class StatementPruner : public hir::StatementVisitorMut {
+public:
+    StatementPruner() : removed_(0), leaves_(false) {}
+    size_t removed() const { return removed_; }
+
+    // Prunes `stmt`, replacing it with the branch taken if it's known. Returns
+    // true if control never goes to the statement after it.
+    bool Prune(std::unique_ptr<hir::Statement>& stmt) {
+        replacement_.reset();
+        leaves_ = false;
+        stmt->Accept(*this);
+        if (replacement_) stmt = std::move(replacement_);
+        return leaves_;
+    }
+
+    void Visit(hir::ExpressionStatement&) { leaves_ = false; }
+    void Visit(hir::ReturnStatement&) { leaves_ = true; }
+    void Visit(hir::BreakStatement&) { leaves_ = true; }
+    void Visit(hir::ContinueStatement&) { leaves_ = true; }
+    void Visit(hir::WhileStatement& stmt) {
+        auto cond = ConstantOf(stmt.cond());
+        if (cond == false) {
+            removed_ += CountStatements(stmt);
+            replacement_ = Empty(stmt.span());
+            leaves_ = false;
+            return;
+        }
+
+        Prune(stmt.body());
+        BreakFinder c;
+        stmt.body()->Accept(c);
+        replacement_.reset();
+        leaves_ = cond == true && !c.found();
+    }
+    void Visit(hir::IfStatement& stmt) {
+        auto cond = ConstantOf(stmt.cond());
+        if (!cond) {
+            bool then_leaves = Prune(stmt.then_body());
+            bool else_leaves =
+                stmt.else_body() && Prune(stmt.else_body().value());
+            replacement_.reset();
+            leaves_ = then_leaves && else_leaves;
+            return;
+        }
+
+        // The condition itself is a node too.
+        removed_++;
+        std::optional<std::unique_ptr<hir::Statement>> taken, untaken;
+        if (cond.value()) {
+            taken = std::move(stmt.then_body());
+            untaken = std::move(stmt.else_body());
+        } else {
+            taken = std::move(stmt.else_body());
+            untaken = std::move(stmt.then_body());
+        }
+        if (untaken) removed_ += CountStatements(*untaken.value());
+
+        bool leaves = taken && Prune(taken.value());
+        replacement_ = taken ? std::move(taken.value()) : Empty(stmt.span());
+        leaves_ = leaves;
+    }
+    void Visit(hir::BlockStatement& stmt) {
+        auto& stmts = stmt.stmts();
+        bool leaves = false;
+        for (size_t i = 0; i < stmts.size() && !leaves;) {
+            leaves = Prune(stmts[i]);
+            if (auto* block = AsBlock(*stmts[i])) {
+                auto inner = std::move(block->stmts());
+                stmts.erase(stmts.begin() + i);
+                size_t size = inner.size();
+                stmts.insert(stmts.begin() + i,
+                             std::make_move_iterator(inner.begin()),
+                             std::make_move_iterator(inner.end()));
+                i += size;
+            } else {
+                i++;
+            }
+            if (leaves) {
+                for (size_t j = i; j < stmts.size(); j++) {
+                    removed_ += CountStatements(*stmts[j]);
+                }
+                stmts.erase(stmts.begin() + i, stmts.end());
+            }
+        }
+        replacement_.reset();
+        leaves_ = leaves;
+    }
+
+private:
+    static std::unique_ptr<hir::Statement> Empty(Span span) {
+        return std::make_unique<hir::BlockStatement>(
+            std::vector<std::unique_ptr<hir::Statement>>(), span);
+    }
+
+    static hir::BlockStatement* AsBlock(hir::Statement& stmt) {
+        struct Helper : public hir::StatementVisitorMut {
+            hir::BlockStatement* block = nullptr;
+            void Visit(hir::ExpressionStatement&) {}
+            void Visit(hir::ReturnStatement&) {}
+            void Visit(hir::BreakStatement&) {}
+            void Visit(hir::ContinueStatement&) {}
+            void Visit(hir::WhileStatement&) {}
+            void Visit(hir::IfStatement&) {}
+            void Visit(hir::BlockStatement& stmt) { block = &stmt; }
+        };
+        Helper helper;
+        stmt.Accept(helper);
+        return helper.block;
+    }
+
+    size_t removed_;
+
+    // The result of the last visited statement.
+    bool leaves_;
+    std::unique_ptr<hir::Statement> replacement_;
+};
+
+// Collects every variable a function refers to, which includes functions it
+// calls or takes the address of.
+class ReferenceCollector : public hir::ExpressionVisitor,
+                           public hir::StatementVisitor {
+public:
+    ReferenceCollector(std::vector<Symbol>& refs) : refs_(refs) {}
+    void Visit(const hir::UnaryExpression& expr) { expr.expr()->Accept(*this); }
+    void Visit(const hir::InfixExpression& expr) {
+        expr.lhs()->Accept(*this);
+        expr.rhs()->Accept(*this);
+    }
+    void Visit(const hir::IndexExpression& expr) {
+        expr.expr()->Accept(*this);
+        expr.index()->Accept(*this);
+    }
+    void Visit(const hir::CallExpression& expr) {
+        expr.func()->Accept(*this);
+        for (const auto& arg : expr.args()) arg->Accept(*this);
+    }
+    void Visit(const hir::AccessExpression& expr) {
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::CastExpression& expr) { expr.expr()->Accept(*this); }
+    void Visit(const hir::ESizeofExpression& expr) {
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::TSizeofExpression&) {}
+    void Visit(const hir::EnumSelectExpression&) {}
+    void Visit(const hir::VariableExpression& expr) {
+        refs_.push_back(expr.value());
+    }
+    void Visit(const hir::IntegerExpression&) {}
+    void Visit(const hir::StringExpression&) {}
+    void Visit(const hir::CharExpression&) {}
+    void Visit(const hir::BoolExpression&) {}
+    void Visit(const hir::NullPtrExpression&) {}
+    void Visit(const hir::StructExpression& expr) {
+        for (const auto& init : expr.inits()) init.value()->Accept(*this);
+    }
+    void Visit(const hir::ArrayExpression& expr) {
+        for (const auto& init : expr.inits()) init->Accept(*this);
+    }
+
+    void Visit(const hir::ExpressionStatement& stmt) {
+        stmt.expr()->Accept(*this);
+    }
+    void Visit(const hir::ReturnStatement& stmt) {
+        if (stmt.ret_value()) stmt.ret_value().value()->Accept(*this);
+    }
+    void Visit(const hir::BreakStatement&) {}
+    void Visit(const hir::ContinueStatement&) {}
+    void Visit(const hir::WhileStatement& stmt) {
+        stmt.cond()->Accept(*this);
+        stmt.body()->Accept(*this);
+    }
+    void Visit(const hir::IfStatement& stmt) {
+        stmt.cond()->Accept(*this);
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(const hir::BlockStatement& stmt) {
+        for (const auto& stmt : stmt.stmts()) stmt->Accept(*this);
+    }
+
+private:
+    std::vector<Symbol>& refs_;
+};
+
+// The declaration as a function, or null.
+hir::FunctionDeclaration* AsFunction(hir::Declaration& decl) {
+    struct Helper : public hir::DeclarationVisitorMut {
+        hir::FunctionDeclaration* func = nullptr;
+        void Visit(hir::StructDeclaration&) {}
+        void Visit(hir::EnumDeclaration&) {}
+        void Visit(hir::FunctionDeclaration& decl) { func = &decl; }
+    };
+    Helper helper;
+    decl.Accept(helper);
+    return helper.func;
+}
+
+// Removes functions which `main` never reaches, and returns how many.
+size_t RemoveUnreachableFunctions(hir::Root& root) {
+    std::unordered_map<Symbol, const hir::FunctionDeclaration*> funcs;
+    for (auto& decl : root.decls()) {
+        if (auto* func = AsFunction(*decl)) {
+            funcs[func->name().value()] = func;
+        }
+    }
+    Symbol main("main");
+    if (!funcs.count(main)) return 0;
+
+    std::unordered_set<Symbol> reached{main};
+    std::vector<Symbol> worklist{main};
+    while (!worklist.empty()) {
+        auto* func = funcs.at(worklist.back());
+        worklist.pop_back();
+        if (!func->body()) continue;
+
+        // Locals are named `_N`, which no function is.
+        std::vector<Symbol> refs;
+        ReferenceCollector c(refs);
+        func->body()->Accept(c);
+        for (auto ref : refs) {
+            if (funcs.count(ref) && reached.insert(ref).second) {
+                worklist.push_back(ref);
+            }
+        }
+    }
+
+    size_t removed = 0;
+    auto& decls = root.decls();
+    for (auto it = decls.begin(); it != decls.end();) {
+        auto* func = AsFunction(**it);
+        if (func && !reached.count(func->name().value())) {
+            it = decls.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+}  // namespace
+
+void EliminateDeadCode(Context& ctx, hir::Root& root) {
+    auto& stats = ctx.opt_stats();
+    for (auto& decl : root.decls()) {
+        auto* func = AsFunction(*decl);
+        if (!func || !func->body()) continue;
+        StatementPruner prune;
+        prune.Visit(func->body().value());
+        stats.dead_statements += prune.removed();
+    }
+    if (ctx.whole_program()) {
+        stats.dead_functions += RemoveUnreachableFunctions(root);
+    }
+}
+
+}  // namespace hiropt
+
+}  // namespace mini
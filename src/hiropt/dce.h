@@ -0,0 +1,23 @@
+#ifndef MINI_HIROPT_DCE_H_
+#define MINI_HIROPT_DCE_H_
+
+#include "../context.h"
+#include "../hir/root.h"
+
+namespace mini {
+
+namespace hiropt {
+
+// Removes statements which never run: ones after `return`, `break` and
+// `continue`, branches of `if` whose condition is folded to `true` or
+// `false`, and `while (false)`.
+//
+// If `ctx` is the whole program, functions which `main` never reaches through
+// calls or references are removed too.
+void EliminateDeadCode(Context& ctx, hir::Root& root);
+
+}  // namespace hiropt
+
+}  // namespace mini
+
+#endif  // MINI_HIROPT_DCE_H_
@@ -0,0 +1,758 @@
+#include "fold.h"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../hir/decl.h"
+#include "../hir/expr.h"
+#include "../hir/stmt.h"
+
+namespace mini {
+
+namespace hiropt {
+
+namespace {
+
+using Kind = hir::BuiltinType::Kind;
+
+bool IsInteger(Kind kind) {
+    return kind != hir::BuiltinType::Void && kind != hir::BuiltinType::Char &&
+           kind != hir::BuiltinType::Bool;
+}
+
+bool IsSigned(Kind kind) {
+    return kind == hir::BuiltinType::ISize || kind == hir::BuiltinType::Int8 ||
+           kind == hir::BuiltinType::Int16 || kind == hir::BuiltinType::Int32 ||
+           kind == hir::BuiltinType::Int64;
+}
+
+uint64_t SizeOf(Kind kind) {
+    switch (kind) {
+        case hir::BuiltinType::Int8:
+        case hir::BuiltinType::UInt8:
+        case hir::BuiltinType::Char:
+        case hir::BuiltinType::Bool:
+            return 1;
+        case hir::BuiltinType::Int16:
+        case hir::BuiltinType::UInt16:
+            return 2;
+        case hir::BuiltinType::Int32:
+        case hir::BuiltinType::UInt32:
+            return 4;
+        default:
+            return 8;
+    }
+}
+
+uint64_t Truncate(uint64_t value, Kind kind) {
+    auto bits = SizeOf(kind) * 8;
+    return bits == 64 ? value : value & ((uint64_t(1) << bits) - 1);
+}
+
+int64_t SignExtend(uint64_t value, Kind kind) {
+    auto shift = 64 - SizeOf(kind) * 8;
+    return static_cast<int64_t>(value << shift) >> shift;
+}
+
+// Converts `value` of `from` to `to`, extending it by the signedness of
+// `from` as casts do.
+uint64_t Convert(uint64_t value, Kind from, Kind to) {
+    return Truncate(IsSigned(from) ? SignExtend(value, from) : value, to);
+}
+
+// The type of an integer literal, which is the smallest one holding it.
+Kind LiteralKind(uint64_t value) {
+    if (value <= UINT8_MAX) {
+        return hir::BuiltinType::UInt8;
+    } else if (value <= UINT16_MAX) {
+        return hir::BuiltinType::UInt16;
+    } else if (value <= UINT32_MAX) {
+        return hir::BuiltinType::UInt32;
+    } else {
+        return hir::BuiltinType::UInt64;
+    }
+}
+
+Kind ToSigned(Kind kind) {
+    switch (kind) {
+        case hir::BuiltinType::UInt8:
+            return hir::BuiltinType::Int8;
+        case hir::BuiltinType::UInt16:
+            return hir::BuiltinType::Int16;
+        case hir::BuiltinType::UInt32:
+            return hir::BuiltinType::Int32;
+        case hir::BuiltinType::UInt64:
+            return hir::BuiltinType::Int64;
+        case hir::BuiltinType::USize:
+            return hir::BuiltinType::ISize;
+        default:
+            return kind;
+    }
+}
+
+// Returns true if a value of `from` is implicitly converted to `to`.
+bool IsConvertible(Kind from, Kind to) {
+    if (from == to) return true;
+    if (!IsInteger(from) || !IsInteger(to)) return false;
+    if (IsSigned(from) && !IsSigned(to)) return false;
+    if (SizeOf(from) == SizeOf(to)) {
+        return IsSigned(from) == IsSigned(to) && SizeOf(to) == 8;
+    }
+    return SizeOf(from) < SizeOf(to);
+}
+
+// Returns the type which operands of an infix expression are merged into, as
+// ImplicitlyMergeTwoType does, only if both are convertible to it.
+std::optional<Kind> MergeKind(Kind lhs, Kind rhs) {
+    if (lhs == rhs) return lhs;
+    if (!IsInteger(lhs) || !IsInteger(rhs)) return std::nullopt;
+
+    Kind merged;
+    if (IsSigned(lhs) == IsSigned(rhs) && SizeOf(lhs) == SizeOf(rhs)) {
+        merged = IsSigned(lhs) ? hir::BuiltinType::ISize
+                               : hir::BuiltinType::USize;
+    } else if (IsSigned(lhs) == IsSigned(rhs)) {
+        merged = SizeOf(lhs) > SizeOf(rhs) ? lhs : rhs;
+    } else {
+        merged = IsSigned(lhs) ? lhs : rhs;
+    }
+    if (!IsConvertible(lhs, merged) || !IsConvertible(rhs, merged)) {
+        return std::nullopt;
+    }
+    return merged;
+}
+
+// Computes `lhs op rhs` of `kind` as generated code does, where both are
+// already converted to `kind`. Returns nothing if it traps at runtime or
+// `op` is not an operator of values.
+std::optional<uint64_t> Evaluate(hir::InfixExpression::Op::Kind op,
+                                 uint64_t lhs, uint64_t rhs, Kind kind) {
+    auto bits = SizeOf(kind) * 8;
+    auto slhs = SignExtend(lhs, kind);
+    auto srhs = SignExtend(rhs, kind);
+    bool is_signed = IsSigned(kind);
+    switch (op) {
+        case hir::InfixExpression::Op::Add:
+            return Truncate(lhs + rhs, kind);
+        case hir::InfixExpression::Op::Sub:
+            return Truncate(lhs - rhs, kind);
+        case hir::InfixExpression::Op::Mul:
+            return Truncate(lhs * rhs, kind);
+        case hir::InfixExpression::Op::Div:
+        case hir::InfixExpression::Op::Mod:
+            if (rhs == 0) return std::nullopt;
+            if (is_signed) {
+                // The minimum divided by -1 overflows, and traps as well.
+                auto min = SignExtend(uint64_t(1) << (bits - 1), kind);
+                if (slhs == min && srhs == -1) return std::nullopt;
+                return Truncate(op == hir::InfixExpression::Op::Div
+                                    ? slhs / srhs
+                                    : slhs % srhs,
+                                kind);
+            }
+            return op == hir::InfixExpression::Op::Div ? lhs / rhs
+                                                       : lhs % rhs;
+        case hir::InfixExpression::Op::Or:
+        case hir::InfixExpression::Op::BitOr:
+            return lhs | rhs;
+        case hir::InfixExpression::Op::And:
+        case hir::InfixExpression::Op::BitAnd:
+            return lhs & rhs;
+        case hir::InfixExpression::Op::BitXor:
+            return lhs ^ rhs;
+        case hir::InfixExpression::Op::EQ:
+            return lhs == rhs;
+        case hir::InfixExpression::Op::NE:
+            return lhs != rhs;
+        case hir::InfixExpression::Op::LT:
+            return is_signed ? slhs < srhs : lhs < rhs;
+        case hir::InfixExpression::Op::LE:
+            return is_signed ? slhs <= srhs : lhs <= rhs;
+        case hir::InfixExpression::Op::GT:
+            return is_signed ? slhs > srhs : lhs > rhs;
+        case hir::InfixExpression::Op::GE:
+            return is_signed ? slhs >= srhs : lhs >= rhs;
+        case hir::InfixExpression::Op::LShift:
+            // Shift counts are masked as x86 does.
+            return Truncate(lhs << (rhs & (bits == 64 ? 63 : 31)), kind);
+        case hir::InfixExpression::Op::RShift:
+            rhs &= bits == 64 ? 63 : 31;
+            return is_signed ? Truncate(slhs >> rhs, kind) : lhs >> rhs;
+        default:
+            return std::nullopt;
+    }
+}
+
+// Size of a type made only of builtin types and pointers.
+std::optional<uint64_t> SizeOfType(const hir::Type& type) {
+    if (type.IsBuiltin()) {
+        auto kind = type.ToBuiltin()->kind();
+        if (kind == hir::BuiltinType::Void) return std::nullopt;
+        return SizeOf(kind);
+    } else if (type.IsPointer()) {
+        return 8;
+    } else if (type.IsArray() && type.ToArray()->size()) {
+        auto of = SizeOfType(*type.ToArray()->of());
+        if (!of) return std::nullopt;
+        return *of * type.ToArray()->size().value();
+    } else {
+        return std::nullopt;
+    }
+}
+
+// Creates the literal of `value`, with a cast if the literal doesn't have
+// `kind` by itself.
+std::unique_ptr<hir::Expression> MakeLiteral(uint64_t value, Kind kind,
+                                             Span span) {
+    if (kind == hir::BuiltinType::Bool) {
+        return std::make_unique<hir::BoolExpression>(value != 0, span);
+    }
+    auto literal = std::make_unique<hir::IntegerExpression>(value, span);
+    if (LiteralKind(value) == kind) return literal;
+    return std::make_unique<hir::CastExpression>(
+        std::move(literal), hir::MakeType<hir::BuiltinType>(kind, span), span);
+}
+
+struct Constant {
+    uint64_t value;
+    Kind kind;
+};
+
+// What is known about an expression after folding it.
+struct Folded {
+    std::optional<Kind> kind;       // Its type if it's a known builtin type.
+    std::optional<uint64_t> value;  // Its value, with bits beyond kind zero.
+    bool pure = false;              // Evaluating it has no effect.
+    bool literal = false;           // A literal, possibly with a cast.
+    bool integer = false;           // An IntegerExpression.
+    size_t size = 1;                // Nodes in it, a literal being one.
+
+    // The variable if it's a variable, or if it's `x = c` with a constant
+    // `c`, where `stored` is `c`.
+    std::optional<Symbol> variable;
+    std::optional<Constant> stored;
+};
+
+// Reads and writes of each variable.
+struct VariableUses {
+    std::unordered_map<Symbol, size_t> reads;
+    std::unordered_map<Symbol, size_t> writes;
+    std::unordered_set<Symbol> addressed;
+};
+
+class UseCollectorExpr : public hir::ExpressionVisitor {
+public:
+    UseCollectorExpr(VariableUses& uses) : uses_(uses) {}
+    void Visit(const hir::UnaryExpression& expr) {
+        auto var = VariableOf(expr.expr());
+        if (expr.op().kind() == hir::UnaryExpression::Op::Ref && var) {
+            uses_.addressed.insert(var.value());
+        } else {
+            expr.expr()->Accept(*this);
+        }
+    }
+    void Visit(const hir::InfixExpression& expr) {
+        auto var = VariableOf(expr.lhs());
+        if (expr.op().kind() == hir::InfixExpression::Op::Assign && var) {
+            uses_.writes[var.value()]++;
+        } else {
+            expr.lhs()->Accept(*this);
+        }
+        expr.rhs()->Accept(*this);
+    }
+    void Visit(const hir::IndexExpression& expr) {
+        expr.expr()->Accept(*this);
+        expr.index()->Accept(*this);
+    }
+    void Visit(const hir::CallExpression& expr) {
+        expr.func()->Accept(*this);
+        for (const auto& arg : expr.args()) arg->Accept(*this);
+    }
+    void Visit(const hir::AccessExpression& expr) {
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::CastExpression& expr) { expr.expr()->Accept(*this); }
+    void Visit(const hir::ESizeofExpression& expr) {
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::TSizeofExpression&) {}
+    void Visit(const hir::EnumSelectExpression&) {}
+    void Visit(const hir::VariableExpression& expr) {
+        uses_.reads[expr.value()]++;
+    }
+    void Visit(const hir::IntegerExpression&) {}
+    void Visit(const hir::StringExpression&) {}
+    void Visit(const hir::CharExpression&) {}
+    void Visit(const hir::BoolExpression&) {}
+    void Visit(const hir::NullPtrExpression&) {}
+    void Visit(const hir::StructExpression& expr) {
+        for (const auto& init : expr.inits()) init.value()->Accept(*this);
+    }
+    void Visit(const hir::ArrayExpression& expr) {
+        for (const auto& init : expr.inits()) init->Accept(*this);
+    }
+
+private:
+    static std::optional<Symbol> VariableOf(
+        const std::unique_ptr<hir::Expression>& expr) {
+        struct Helper : public hir::ExpressionVisitor {
+            std::optional<Symbol> var_;
+            void Visit(const hir::UnaryExpression&) {}
+            void Visit(const hir::InfixExpression&) {}
+            void Visit(const hir::IndexExpression&) {}
+            void Visit(const hir::CallExpression&) {}
+            void Visit(const hir::AccessExpression&) {}
+            void Visit(const hir::CastExpression&) {}
+            void Visit(const hir::ESizeofExpression&) {}
+            void Visit(const hir::TSizeofExpression&) {}
+            void Visit(const hir::EnumSelectExpression&) {}
+            void Visit(const hir::VariableExpression& expr) {
+                var_ = expr.value();
+            }
+            void Visit(const hir::IntegerExpression&) {}
+            void Visit(const hir::StringExpression&) {}
+            void Visit(const hir::CharExpression&) {}
+            void Visit(const hir::BoolExpression&) {}
+            void Visit(const hir::NullPtrExpression&) {}
+            void Visit(const hir::StructExpression&) {}
+            void Visit(const hir::ArrayExpression&) {}
+        };
+        Helper helper;
+        expr->Accept(helper);
+        return helper.var_;
+    }
+
+    VariableUses& uses_;
+};
+
+class UseCollectorStmt : public hir::StatementVisitor {
+public:
+    UseCollectorStmt(VariableUses& uses) : uses_(uses) {}
+    void Visit(const hir::ExpressionStatement& stmt) {
+        UseCollectorExpr c(uses_);
+        stmt.expr()->Accept(c);
+    }
+    void Visit(const hir::ReturnStatement& stmt) {
+        if (!stmt.ret_value()) return;
+        UseCollectorExpr c(uses_);
+        stmt.ret_value().value()->Accept(c);
+    }
+    void Visit(const hir::BreakStatement&) {}
+    void Visit(const hir::ContinueStatement&) {}
+    void Visit(const hir::WhileStatement& stmt) {
+        UseCollectorExpr c(uses_);
+        stmt.cond()->Accept(c);
+        stmt.body()->Accept(*this);
+    }
+    void Visit(const hir::IfStatement& stmt) {
+        UseCollectorExpr c(uses_);
+        stmt.cond()->Accept(c);
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(const hir::BlockStatement& stmt) {
+        for (const auto& stmt : stmt.stmts()) stmt->Accept(*this);
+    }
+
+private:
+    VariableUses& uses_;
+};
+
+// Folds statements of a function in order of execution, so that constants
+// assigned to locals are known before their uses.
+class FunctionFolder : public hir::StatementVisitorMut {
+public:
+    FunctionFolder(std::unordered_map<Symbol, Kind>&& kinds,
+                   VariableUses&& uses, std::unordered_set<Symbol>&& locals)
+        : kinds_(std::move(kinds)),
+          uses_(std::move(uses)),
+          locals_(std::move(locals)),
+          eliminated_(0),
+          store_stmt_(nullptr) {}
+    size_t eliminated() const { return eliminated_; }
+    const std::unordered_map<Symbol, Constant>& constants() const {
+        return constants_;
+    }
+    void Eliminate(size_t count) { eliminated_ += count; }
+    std::optional<Kind> KindOf(Symbol var) const {
+        auto it = kinds_.find(var);
+        if (it == kinds_.end()) return std::nullopt;
+        return it->second;
+    }
+
+    // Folds `expr`, replacing it with simpler one.
+    Folded Fold(std::unique_ptr<hir::Expression>& expr);
+
+    void Visit(hir::ExpressionStatement& stmt) {
+        auto folded = Fold(stmt.expr());
+        if (folded.stored) {
+            store_stmt_ = &stmt;
+            store_var_ = folded.variable.value();
+            store_ = folded.stored.value();
+            store_size_ = folded.size;
+        }
+    }
+    void Visit(hir::ReturnStatement& stmt) {
+        if (stmt.ret_value()) Fold(stmt.ret_value().value());
+    }
+    void Visit(hir::BreakStatement&) {}
+    void Visit(hir::ContinueStatement&) {}
+    void Visit(hir::WhileStatement& stmt) {
+        Fold(stmt.cond());
+        stmt.body()->Accept(*this);
+    }
+    void Visit(hir::IfStatement& stmt) {
+        Fold(stmt.cond());
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(hir::BlockStatement& stmt) {
+        auto& stmts = stmt.stmts();
+        for (size_t i = 0; i < stmts.size();) {
+            stmts[i]->Accept(*this);
+            if (store_stmt_ == stmts[i].get() && Propagate(stmts, i)) {
+                eliminated_ += store_size_;
+                stmts.erase(stmts.begin() + i);
+            } else {
+                i++;
+            }
+            store_stmt_ = nullptr;
+        }
+    }
+
+private:
+    // Returns true if the constant stored by `stmts[i]` can replace every
+    // read of the variable, and records it then. This is the case if the
+    // variable is a local written only there, and every read comes after it
+    // in the same block.
+    bool Propagate(const std::vector<std::unique_ptr<hir::Statement>>& stmts,
+                   size_t i) {
+        auto kind = KindOf(store_var_);
+        if (!locals_.count(store_var_) || !kind) return false;
+        if (uses_.writes[store_var_] != 1 ||
+            uses_.addressed.count(store_var_)) {
+            return false;
+        }
+        if (!IsConvertible(store_.kind, kind.value())) return false;
+
+        VariableUses after;
+        UseCollectorStmt c(after);
+        for (size_t j = i + 1; j < stmts.size(); j++) stmts[j]->Accept(c);
+        if (after.reads[store_var_] != uses_.reads[store_var_]) return false;
+
+        auto value = Convert(store_.value, store_.kind, kind.value());
+        constants_[store_var_] = {value, kind.value()};
+        return true;
+    }
+
+    std::unordered_map<Symbol, Kind> kinds_;
+    VariableUses uses_;
+    std::unordered_set<Symbol> locals_;
+    std::unordered_map<Symbol, Constant> constants_;
+    size_t eliminated_;
+
+    // The last statement storing a constant to a variable.
+    const hir::Statement* store_stmt_;
+    Symbol store_var_;
+    Constant store_;
+    size_t store_size_;
+};
+
+class ExprFolder : public hir::ExpressionVisitorMut {
+public:
+    ExprFolder(FunctionFolder& folder) : folder_(folder) {}
+    const Folded& result() const { return result_; }
+    std::unique_ptr<hir::Expression>& replacement() { return replacement_; }
+    void Visit(hir::UnaryExpression& expr) {
+        auto operand = folder_.Fold(expr.expr());
+        result_.size = operand.size + 1;
+        auto kind = operand.kind;
+        switch (expr.op().kind()) {
+            case hir::UnaryExpression::Op::Ref:
+            case hir::UnaryExpression::Op::Deref:
+                return;
+            case hir::UnaryExpression::Op::Minus:
+                if (!kind || !IsInteger(kind.value())) return;
+                result_.kind = ToSigned(kind.value());
+                if (operand.value) {
+                    result_.value =
+                        Truncate(-operand.value.value(), result_.kind.value());
+                }
+                break;
+            case hir::UnaryExpression::Op::Inv:
+                if (!kind || !IsInteger(kind.value())) return;
+                result_.kind = kind;
+                if (operand.value) {
+                    result_.value = Truncate(~operand.value.value(),
+                                             result_.kind.value());
+                }
+                break;
+            case hir::UnaryExpression::Op::Neg:
+                if (kind != hir::BuiltinType::Bool) return;
+                result_.kind = kind;
+                if (operand.value) result_.value = operand.value.value() ^ 1;
+                break;
+        }
+        result_.pure = operand.pure;
+    }
+    void Visit(hir::InfixExpression& expr) {
+        auto lhs = folder_.Fold(expr.lhs());
+        auto rhs = folder_.Fold(expr.rhs());
+        result_.size = lhs.size + rhs.size + 1;
+
+        auto op = expr.op().kind();
+        if (op == hir::InfixExpression::Op::Assign) {
+            result_.kind = lhs.kind;
+            if (lhs.variable && rhs.value) {
+                result_.variable = lhs.variable;
+                result_.stored = Constant{rhs.value.value(), rhs.kind.value()};
+            }
+            return;
+        }
+        result_.pure = lhs.pure && rhs.pure &&
+                       op != hir::InfixExpression::Op::Div &&
+                       op != hir::InfixExpression::Op::Mod;
+        if (!lhs.kind || !rhs.kind) return;
+
+        std::optional<Kind> merged;
+        if (op == hir::InfixExpression::Op::Or ||
+            op == hir::InfixExpression::Op::And) {
+            if (lhs.kind == hir::BuiltinType::Bool &&
+                rhs.kind == hir::BuiltinType::Bool) {
+                merged = hir::BuiltinType::Bool;
+            }
+            result_.kind = hir::BuiltinType::Bool;
+        } else if (op == hir::InfixExpression::Op::EQ ||
+                   op == hir::InfixExpression::Op::NE) {
+            merged = MergeKind(lhs.kind.value(), rhs.kind.value());
+            result_.kind = hir::BuiltinType::Bool;
+        } else if (op == hir::InfixExpression::Op::LT ||
+                   op == hir::InfixExpression::Op::LE ||
+                   op == hir::InfixExpression::Op::GT ||
+                   op == hir::InfixExpression::Op::GE) {
+            merged = MergeKind(lhs.kind.value(), rhs.kind.value());
+            if (merged && !IsInteger(merged.value())) merged.reset();
+            result_.kind = hir::BuiltinType::Bool;
+        } else {
+            merged = MergeKind(lhs.kind.value(), rhs.kind.value());
+            if (merged && !IsInteger(merged.value())) merged.reset();
+            result_.kind = merged;
+        }
+        if (!merged) return;
+
+        if (lhs.value && rhs.value) {
+            auto l = Convert(lhs.value.value(), lhs.kind.value(), *merged);
+            auto r = Convert(rhs.value.value(), rhs.kind.value(), *merged);
+            result_.value = Evaluate(op, l, r, *merged);
+            if (!result_.value) result_.pure = false;
+            return;
+        }
+        Simplify(expr, lhs, rhs, merged.value());
+    }
+    void Visit(hir::IndexExpression& expr) {
+        result_.size += folder_.Fold(expr.expr()).size;
+        result_.size += folder_.Fold(expr.index()).size;
+    }
+    void Visit(hir::CallExpression& expr) {
+        result_.size += folder_.Fold(expr.func()).size;
+        for (auto& arg : expr.args()) result_.size += folder_.Fold(arg).size;
+    }
+    void Visit(hir::AccessExpression& expr) {
+        result_.size += folder_.Fold(expr.expr()).size;
+    }
+    void Visit(hir::CastExpression& expr) {
+        auto operand = folder_.Fold(expr.expr());
+        result_.size = operand.size + 1;
+        result_.pure = operand.pure;
+
+        auto to = expr.cast_type()->ToBuiltin();
+        if (!to || to->kind() == hir::BuiltinType::Void) return;
+        result_.kind = to->kind();
+        if (!IsInteger(to->kind()) || !operand.value) return;
+        if (!IsInteger(operand.kind.value()) &&
+            operand.kind != hir::BuiltinType::Bool) {
+            return;
+        }
+
+        result_.value = Convert(operand.value.value(), operand.kind.value(),
+                                to->kind());
+        if (operand.integer && operand.value == result_.value) {
+            result_.literal = true;
+            result_.size = 1;
+        }
+    }
+    void Visit(hir::ESizeofExpression& expr) {
+        // The operand is not evaluated.
+        result_.size += folder_.Fold(expr.expr()).size;
+        result_.kind = hir::BuiltinType::USize;
+        result_.pure = true;
+    }
+    void Visit(hir::TSizeofExpression& expr) {
+        result_.kind = hir::BuiltinType::USize;
+        result_.value = SizeOfType(*expr.type());
+        result_.pure = true;
+    }
+    void Visit(hir::EnumSelectExpression&) { result_.pure = true; }
+    void Visit(hir::VariableExpression& expr) {
+        auto it = folder_.constants().find(expr.value());
+        if (it != folder_.constants().end()) {
+            result_.kind = it->second.kind;
+            result_.value = it->second.value;
+        } else {
+            result_.kind = folder_.KindOf(expr.value());
+            result_.variable = expr.value();
+        }
+        result_.pure = true;
+    }
+    void Visit(hir::IntegerExpression& expr) {
+        result_.kind = LiteralKind(expr.value());
+        result_.value = expr.value();
+        result_.pure = true;
+        result_.literal = true;
+        result_.integer = true;
+    }
+    void Visit(hir::StringExpression&) { result_.pure = true; }
+    void Visit(hir::CharExpression&) {
+        result_.kind = hir::BuiltinType::Char;
+        result_.pure = true;
+    }
+    void Visit(hir::BoolExpression& expr) {
+        result_.kind = hir::BuiltinType::Bool;
+        result_.value = expr.value();
+        result_.pure = true;
+        result_.literal = true;
+    }
+    void Visit(hir::NullPtrExpression&) { result_.pure = true; }
+    void Visit(hir::StructExpression& expr) {
+        for (auto& init : expr.inits()) {
+            result_.size += folder_.Fold(init.value()).size;
+        }
+    }
+    void Visit(hir::ArrayExpression& expr) {
+        for (auto& init : expr.inits()) result_.size += folder_.Fold(init).size;
+    }
+
+private:
+    // Simplifies `x + 0`, `x - 0`, `x * 1`, `x / 1` and `x * 0` of `merged`,
+    // where x is not a constant. The other operand is dropped only if x is
+    // already of `merged`, so that the type of this doesn't change.
+    void Simplify(hir::InfixExpression& expr, const Folded& lhs,
+                  const Folded& rhs, Kind merged) {
+        auto op = expr.op().kind();
+        auto is = [](const Folded& folded, uint64_t value) {
+            return folded.value == value;
+        };
+        bool additive = op == hir::InfixExpression::Op::Add ||
+                        op == hir::InfixExpression::Op::Sub;
+        bool mul = op == hir::InfixExpression::Op::Mul;
+        bool div = op == hir::InfixExpression::Op::Div;
+        if (lhs.kind == merged &&
+            ((additive && is(rhs, 0)) || ((mul || div) && is(rhs, 1)))) {
+            ReplaceWith(expr.lhs(), lhs);
+        } else if (rhs.kind == merged && op == hir::InfixExpression::Op::Add &&
+                   is(lhs, 0)) {
+            ReplaceWith(expr.rhs(), rhs);
+        } else if (rhs.kind == merged && mul && is(lhs, 1)) {
+            ReplaceWith(expr.rhs(), rhs);
+        } else if (mul && ((is(rhs, 0) && lhs.pure) ||
+                           (is(lhs, 0) && rhs.pure))) {
+            result_.value = 0;
+        }
+    }
+
+    // Replaces this with `operand`, which has the same value and type.
+    void ReplaceWith(std::unique_ptr<hir::Expression>& operand,
+                     const Folded& folded) {
+        folder_.Eliminate(result_.size - folded.size);
+        replacement_ = std::move(operand);
+        result_ = folded;
+    }
+
+    FunctionFolder& folder_;
+    Folded result_;
+    std::unique_ptr<hir::Expression> replacement_;
+};
+
+Folded FunctionFolder::Fold(std::unique_ptr<hir::Expression>& expr) {
+    ExprFolder fold(*this);
+    expr->Accept(fold);
+    auto result = fold.result();
+    if (fold.replacement()) {
+        expr = std::move(fold.replacement());
+    } else if (result.value && !result.literal) {
+        eliminated_ += result.size - 1;
+        expr = MakeLiteral(result.value.value(), result.kind.value(),
+                           expr->span());
+        result.pure = true;
+        result.literal = true;
+        result.integer = result.kind != hir::BuiltinType::Bool &&
+                         LiteralKind(result.value.value()) == result.kind;
+        result.size = 1;
+        result.variable.reset();
+    }
+    return result;
+}
+
+class ConstantFolder : public hir::DeclarationVisitorMut {
+public:
+    ConstantFolder(Context& ctx) : ctx_(ctx) {}
+    void Visit(hir::StructDeclaration&) {}
+    void Visit(hir::EnumDeclaration&) {}
+    void Visit(hir::FunctionDeclaration& decl) {
+        if (!decl.body()) return;
+
+        std::unordered_map<Symbol, Kind> kinds;
+        std::unordered_set<Symbol> locals;
+        for (const auto& param : decl.params()) {
+            if (param.type()->IsBuiltin()) {
+                kinds[param.name().value()] = param.type()->ToBuiltin()->kind();
+            }
+        }
+        for (const auto& var : decl.decls()) {
+            if (var.type()->IsBuiltin()) {
+                kinds[var.name().value()] = var.type()->ToBuiltin()->kind();
+                locals.insert(var.name().value());
+            }
+        }
+        for (const auto& param : decl.params()) {
+            locals.erase(param.name().value());
+        }
+
+        VariableUses uses;
+        UseCollectorStmt c(uses);
+        decl.body()->Accept(c);
+
+        FunctionFolder fold(std::move(kinds), std::move(uses),
+                            std::move(locals));
+        decl.body()->Accept(fold);
+        ctx_.opt_stats().folded_nodes += fold.eliminated();
+
+        // Propagated variables are neither read nor written anymore.
+        auto& constants = fold.constants();
+        for (auto it = decl.decls().begin(); it != decl.decls().end();) {
+            if (constants.count(it->name().value())) {
+                it = decl.decls().erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+private:
+    Context& ctx_;
+};
+
+}  // namespace
+
+void FoldConstants(Context& ctx, hir::Root& root) {
+    for (auto& decl : root.decls()) {
+        ConstantFolder fold(ctx);
+        decl->Accept(fold);
+    }
+}
+
+}  // namespace hiropt
+
+}  // namespace mini
@@ -0,0 +1,24 @@
+#ifndef MINI_HIROPT_FOLD_H_
+#define MINI_HIROPT_FOLD_H_
+
+#include "../context.h"
+#include "../hir/root.h"
+
+namespace mini {
+
+namespace hiropt {
+
+// Replaces expressions whose value is known at compile time with literals,
+// propagating locals assigned once from constants, and simplifies `x + 0`,
+// `x * 1` and `x * 0`. Folded expressions keep the type they had, so the same
+// code is generated as if these were computed at runtime.
+//
+// The number of removed nodes is added to the stats of `ctx`, where a
+// literal with a cast counts as one node.
+void FoldConstants(Context& ctx, hir::Root& root);
+
+}  // namespace hiropt
+
+}  // namespace mini
+
+#endif  // MINI_HIROPT_FOLD_H_
@@ -1,5 +1,8 @@
 #include "hiropt.h"
 
+#include "dce.h"
+#include "fold.h"
+#include "inline.h"
 #include "unused.h"
 
 namespace mini {
@@ -7,7 +10,22 @@ namespace mini {
 namespace hiropt {
 
 void OptimizeHirRoot(Context &ctx, hir::Root &root) {
-    RemoveUnusedVariable(ctx, root);
+    {
+        PassScope pass(ctx.pass_timer(), "hiropt.unused");
+        RemoveUnusedVariable(ctx, root);
+    }
+    {
+        // Inlined bodies are folded along with the caller.
+        PassScope pass(ctx.pass_timer(), "hiropt.inline");
+        InlineFunctions(ctx, root);
+    }
+    {
+        PassScope pass(ctx.pass_timer(), "hiropt.fold");
+        FoldConstants(ctx, root);
+    }
+    // Conditions folded to `true` or `false` decide branches here.
+    PassScope pass(ctx.pass_timer(), "hiropt.dce");
+    EliminateDeadCode(ctx, root);
 }
 
 }  // namespace hiropt
@@ -0,0 +1,855 @@
+#include "inline.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace mini {
+
+namespace hiropt {
+
+namespace {
+
+// Callees with at most this many nodes are inlined everywhere, and ones
+// called only once with at most `single_call_limit` nodes.
+constexpr size_t small_limit = 16;
+constexpr size_t single_call_limit = 64;
+
+// Callers stop growing at this many nodes, except by callees marked `inline`.
+constexpr size_t caller_limit = 2000;
+
+using Statements = std::vector<std::unique_ptr<hir::Statement>>;
+using Renames = std::unordered_map<Symbol, Symbol>;
+
+// The statement as each kind, null unless it's the kind.
+struct StatementKind : public hir::StatementVisitorMut {
+    hir::ExpressionStatement* expr = nullptr;
+    hir::ReturnStatement* ret = nullptr;
+    hir::WhileStatement* while_ = nullptr;
+    hir::IfStatement* if_ = nullptr;
+    hir::BlockStatement* block = nullptr;
+    void Visit(hir::ExpressionStatement& stmt) { expr = &stmt; }
+    void Visit(hir::ReturnStatement& stmt) { ret = &stmt; }
+    void Visit(hir::BreakStatement&) {}
+    void Visit(hir::ContinueStatement&) {}
+    void Visit(hir::WhileStatement& stmt) { while_ = &stmt; }
+    void Visit(hir::IfStatement& stmt) { if_ = &stmt; }
+    void Visit(hir::BlockStatement& stmt) { block = &stmt; }
+};
+
+// The expression as each kind, null unless it's the kind.
+struct ExpressionKind : public hir::ExpressionVisitorMut {
+    hir::InfixExpression* infix = nullptr;
+    hir::CallExpression* call = nullptr;
+    hir::VariableExpression* variable = nullptr;
+    void Visit(hir::UnaryExpression&) {}
+    void Visit(hir::InfixExpression& expr) { infix = &expr; }
+    void Visit(hir::IndexExpression&) {}
+    void Visit(hir::CallExpression& expr) { call = &expr; }
+    void Visit(hir::AccessExpression&) {}
+    void Visit(hir::CastExpression&) {}
+    void Visit(hir::ESizeofExpression&) {}
+    void Visit(hir::TSizeofExpression&) {}
+    void Visit(hir::EnumSelectExpression&) {}
+    void Visit(hir::VariableExpression& expr) { variable = &expr; }
+    void Visit(hir::IntegerExpression&) {}
+    void Visit(hir::StringExpression&) {}
+    void Visit(hir::CharExpression&) {}
+    void Visit(hir::BoolExpression&) {}
+    void Visit(hir::NullPtrExpression&) {}
+    void Visit(hir::StructExpression&) {}
+    void Visit(hir::ArrayExpression&) {}
+};
+
+ExpressionKind KindOf(std::unique_ptr<hir::Expression>& expr) {
+    ExpressionKind kind;
+    expr->Accept(kind);
+    return kind;
+}
+
+// Returns the name of the function `expr` calls directly.
+std::optional<Symbol> CalleeOf(const hir::CallExpression& expr) {
+    ExpressionKind kind;
+    expr.func()->Accept(kind);
+    if (!kind.variable) return std::nullopt;
+    return kind.variable->value();
+}
+
+// Size of a function body and functions called from there.
+struct BodyInfo {
+    size_t size = 0;  // Statements and expressions in it.
+    std::unordered_map<Symbol, size_t> calls;
+};
+
+class BodyInfoCollectorExpr : public hir::ExpressionVisitor {
+public:
+    BodyInfoCollectorExpr(BodyInfo& info) : info_(info) {}
+    void Visit(const hir::UnaryExpression& expr) {
+        info_.size++;
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::InfixExpression& expr) {
+        info_.size++;
+        expr.lhs()->Accept(*this);
+        expr.rhs()->Accept(*this);
+    }
+    void Visit(const hir::IndexExpression& expr) {
+        info_.size++;
+        expr.expr()->Accept(*this);
+        expr.index()->Accept(*this);
+    }
+    void Visit(const hir::CallExpression& expr) {
+        info_.size++;
+        if (auto callee = CalleeOf(expr)) info_.calls[callee.value()]++;
+        expr.func()->Accept(*this);
+        for (const auto& arg : expr.args()) arg->Accept(*this);
+    }
+    void Visit(const hir::AccessExpression& expr) {
+        info_.size++;
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::CastExpression& expr) {
+        info_.size++;
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::ESizeofExpression& expr) {
+        info_.size++;
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::TSizeofExpression&) { info_.size++; }
+    void Visit(const hir::EnumSelectExpression&) { info_.size++; }
+    void Visit(const hir::VariableExpression&) { info_.size++; }
+    void Visit(const hir::IntegerExpression&) { info_.size++; }
+    void Visit(const hir::StringExpression&) { info_.size++; }
+    void Visit(const hir::CharExpression&) { info_.size++; }
+    void Visit(const hir::BoolExpression&) { info_.size++; }
+    void Visit(const hir::NullPtrExpression&) { info_.size++; }
+    void Visit(const hir::StructExpression& expr) {
+        info_.size++;
+        for (const auto& init : expr.inits()) init.value()->Accept(*this);
+    }
+    void Visit(const hir::ArrayExpression& expr) {
+        info_.size++;
+        for (const auto& init : expr.inits()) init->Accept(*this);
+    }
+
+private:
+    BodyInfo& info_;
+};
+
+class BodyInfoCollectorStmt : public hir::StatementVisitor {
+public:
+    BodyInfoCollectorStmt(BodyInfo& info) : info_(info) {}
+    void Visit(const hir::ExpressionStatement& stmt) {
+        info_.size++;
+        BodyInfoCollectorExpr c(info_);
+        stmt.expr()->Accept(c);
+    }
+    void Visit(const hir::ReturnStatement& stmt) {
+        info_.size++;
+        if (!stmt.ret_value()) return;
+        BodyInfoCollectorExpr c(info_);
+        stmt.ret_value().value()->Accept(c);
+    }
+    void Visit(const hir::BreakStatement&) { info_.size++; }
+    void Visit(const hir::ContinueStatement&) { info_.size++; }
+    void Visit(const hir::WhileStatement& stmt) {
+        info_.size++;
+        BodyInfoCollectorExpr c(info_);
+        stmt.cond()->Accept(c);
+        stmt.body()->Accept(*this);
+    }
+    void Visit(const hir::IfStatement& stmt) {
+        info_.size++;
+        BodyInfoCollectorExpr c(info_);
+        stmt.cond()->Accept(c);
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(const hir::BlockStatement& stmt) {
+        info_.size++;
+        for (const auto& stmt : stmt.stmts()) stmt->Accept(*this);
+    }
+
+private:
+    BodyInfo& info_;
+};
+
+BodyInfo CollectBodyInfo(const hir::FunctionDeclaration& decl) {
+    BodyInfo info;
+    BodyInfoCollectorStmt c(info);
+    if (decl.body()) decl.body()->Accept(c);
+    return info;
+}
+
+// Collects calls in an expression, in the order they're evaluated.
+class CallFinder : public hir::ExpressionVisitor {
+public:
+    std::vector<const hir::CallExpression*>& calls() { return calls_; }
+    void Visit(const hir::UnaryExpression& expr) { expr.expr()->Accept(*this); }
+    void Visit(const hir::InfixExpression& expr) {
+        expr.lhs()->Accept(*this);
+        expr.rhs()->Accept(*this);
+    }
+    void Visit(const hir::IndexExpression& expr) {
+        expr.expr()->Accept(*this);
+        expr.index()->Accept(*this);
+    }
+    void Visit(const hir::CallExpression& expr) {
+        expr.func()->Accept(*this);
+        for (const auto& arg : expr.args()) arg->Accept(*this);
+        calls_.push_back(&expr);
+    }
+    void Visit(const hir::AccessExpression& expr) {
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::CastExpression& expr) { expr.expr()->Accept(*this); }
+    void Visit(const hir::ESizeofExpression&) {}
+    void Visit(const hir::TSizeofExpression&) {}
+    void Visit(const hir::EnumSelectExpression&) {}
+    void Visit(const hir::VariableExpression&) {}
+    void Visit(const hir::IntegerExpression&) {}
+    void Visit(const hir::StringExpression&) {}
+    void Visit(const hir::CharExpression&) {}
+    void Visit(const hir::BoolExpression&) {}
+    void Visit(const hir::NullPtrExpression&) {}
+    void Visit(const hir::StructExpression& expr) {
+        for (const auto& init : expr.inits()) init.value()->Accept(*this);
+    }
+    void Visit(const hir::ArrayExpression& expr) {
+        for (const auto& init : expr.inits()) init->Accept(*this);
+    }
+
+private:
+    std::vector<const hir::CallExpression*> calls_;
+};
+
+// Returns calls in expressions of `stmt` itself, not in statements in it.
+std::vector<const hir::CallExpression*> CallsIn(const hir::Statement& stmt) {
+    struct Helper : public hir::StatementVisitor {
+        CallFinder finder;
+        void Visit(const hir::ExpressionStatement& stmt) {
+            stmt.expr()->Accept(finder);
+        }
+        void Visit(const hir::ReturnStatement& stmt) {
+            if (stmt.ret_value()) stmt.ret_value().value()->Accept(finder);
+        }
+        void Visit(const hir::BreakStatement&) {}
+        void Visit(const hir::ContinueStatement&) {}
+        void Visit(const hir::WhileStatement& stmt) {
+            stmt.cond()->Accept(finder);
+        }
+        void Visit(const hir::IfStatement& stmt) {
+            stmt.cond()->Accept(finder);
+        }
+        void Visit(const hir::BlockStatement&) {}
+    };
+    Helper helper;
+    stmt.Accept(helper);
+    return std::move(helper.finder.calls());
+}
+
+// Copies expressions and statements, renaming variables by `renames`.
+class ExprCloner : public hir::ExpressionVisitor {
+public:
+    ExprCloner(const Renames& renames) : renames_(renames) {}
+    std::unique_ptr<hir::Expression>& result() { return result_; }
+    void Visit(const hir::UnaryExpression& expr) {
+        result_ = std::make_unique<hir::UnaryExpression>(
+            expr.op(), Clone(expr.expr()), expr.span());
+    }
+    void Visit(const hir::InfixExpression& expr) {
+        result_ = std::make_unique<hir::InfixExpression>(
+            Clone(expr.lhs()), expr.op(), Clone(expr.rhs()), expr.span());
+    }
+    void Visit(const hir::IndexExpression& expr) {
+        result_ = std::make_unique<hir::IndexExpression>(
+            Clone(expr.expr()), Clone(expr.index()), expr.span());
+    }
+    void Visit(const hir::CallExpression& expr) {
+        std::vector<std::unique_ptr<hir::Expression>> args;
+        for (const auto& arg : expr.args()) args.push_back(Clone(arg));
+        result_ = std::make_unique<hir::CallExpression>(
+            Clone(expr.func()), std::move(args), expr.span());
+    }
+    void Visit(const hir::AccessExpression& expr) {
+        auto field = expr.field();
+        result_ = std::make_unique<hir::AccessExpression>(
+            Clone(expr.expr()), std::move(field), expr.span());
+    }
+    void Visit(const hir::CastExpression& expr) {
+        result_ = std::make_unique<hir::CastExpression>(
+            Clone(expr.expr()), expr.cast_type(), expr.span());
+    }
+    void Visit(const hir::ESizeofExpression& expr) {
+        result_ = std::make_unique<hir::ESizeofExpression>(Clone(expr.expr()),
+                                                           expr.span());
+    }
+    void Visit(const hir::TSizeofExpression& expr) {
+        result_ = std::make_unique<hir::TSizeofExpression>(expr.type(),
+                                                           expr.span());
+    }
+    void Visit(const hir::EnumSelectExpression& expr) {
+        auto src = expr.src();
+        auto dst = expr.dst();
+        result_ = std::make_unique<hir::EnumSelectExpression>(
+            std::move(src), std::move(dst), expr.span());
+    }
+    void Visit(const hir::VariableExpression& expr) {
+        auto it = renames_.find(expr.value());
+        auto value = it == renames_.end() ? expr.value() : it->second;
+        result_ = std::make_unique<hir::VariableExpression>(value, expr.span());
+    }
+    void Visit(const hir::IntegerExpression& expr) {
+        result_ = std::make_unique<hir::IntegerExpression>(expr.value(),
+                                                           expr.span());
+    }
+    void Visit(const hir::StringExpression& expr) {
+        std::string value = expr.value();
+        result_ = std::make_unique<hir::StringExpression>(std::move(value),
+                                                          expr.span());
+    }
+    void Visit(const hir::CharExpression& expr) {
+        result_ =
+            std::make_unique<hir::CharExpression>(expr.value(), expr.span());
+    }
+    void Visit(const hir::BoolExpression& expr) {
+        result_ =
+            std::make_unique<hir::BoolExpression>(expr.value(), expr.span());
+    }
+    void Visit(const hir::NullPtrExpression& expr) {
+        result_ = std::make_unique<hir::NullPtrExpression>(expr.span());
+    }
+    void Visit(const hir::StructExpression& expr) {
+        std::vector<hir::StructExpressionInit> inits;
+        for (const auto& init : expr.inits()) {
+            auto name = init.name();
+            inits.emplace_back(std::move(name), Clone(init.value()));
+        }
+        auto name = expr.name();
+        result_ = std::make_unique<hir::StructExpression>(
+            std::move(name), std::move(inits), expr.span());
+    }
+    void Visit(const hir::ArrayExpression& expr) {
+        std::vector<std::unique_ptr<hir::Expression>> inits;
+        for (const auto& init : expr.inits()) inits.push_back(Clone(init));
+        result_ = std::make_unique<hir::ArrayExpression>(std::move(inits),
+                                                         expr.span());
+    }
+
+private:
+    std::unique_ptr<hir::Expression> Clone(
+        const std::unique_ptr<hir::Expression>& expr) {
+        ExprCloner c(renames_);
+        expr->Accept(c);
+        return std::move(c.result_);
+    }
+
+    const Renames& renames_;
+    std::unique_ptr<hir::Expression> result_;
+};
+
+class StmtCloner : public hir::StatementVisitor {
+public:
+    StmtCloner(const Renames& renames) : renames_(renames) {}
+    std::unique_ptr<hir::Statement>& result() { return result_; }
+    void Visit(const hir::ExpressionStatement& stmt) {
+        result_ = std::make_unique<hir::ExpressionStatement>(
+            Clone(stmt.expr()), stmt.span());
+    }
+    void Visit(const hir::ReturnStatement& stmt) {
+        std::optional<std::unique_ptr<hir::Expression>> ret_value;
+        if (stmt.ret_value()) ret_value = Clone(stmt.ret_value().value());
+        result_ = std::make_unique<hir::ReturnStatement>(std::move(ret_value),
+                                                         stmt.span());
+    }
+    void Visit(const hir::BreakStatement& stmt) {
+        result_ = std::make_unique<hir::BreakStatement>(stmt.span());
+    }
+    void Visit(const hir::ContinueStatement& stmt) {
+        result_ = std::make_unique<hir::ContinueStatement>(stmt.span());
+    }
+    void Visit(const hir::WhileStatement& stmt) {
+        result_ = std::make_unique<hir::WhileStatement>(
+            Clone(stmt.cond()), Clone(stmt.body()), stmt.span());
+    }
+    void Visit(const hir::IfStatement& stmt) {
+        std::optional<std::unique_ptr<hir::Statement>> else_body;
+        if (stmt.else_body()) else_body = Clone(stmt.else_body().value());
+        result_ = std::make_unique<hir::IfStatement>(
+            Clone(stmt.cond()), Clone(stmt.then_body()), std::move(else_body),
+            stmt.span());
+    }
+    void Visit(const hir::BlockStatement& stmt) {
+        result_ = std::make_unique<hir::BlockStatement>(CloneAll(stmt.stmts()),
+                                                        stmt.span());
+    }
+
+    Statements CloneAll(const Statements& stmts) {
+        Statements result;
+        for (const auto& stmt : stmts) result.push_back(Clone(stmt));
+        return result;
+    }
+
+private:
+    std::unique_ptr<hir::Expression> Clone(
+        const std::unique_ptr<hir::Expression>& expr) {
+        ExprCloner c(renames_);
+        expr->Accept(c);
+        return std::move(c.result());
+    }
+    std::unique_ptr<hir::Statement> Clone(
+        const std::unique_ptr<hir::Statement>& stmt) {
+        StmtCloner c(renames_);
+        stmt->Accept(c);
+        return std::move(c.result_);
+    }
+
+    const Renames& renames_;
+    std::unique_ptr<hir::Statement> result_;
+};
+
+class ReturnFinder : public hir::StatementVisitor {
+public:
+    explicit operator bool() const { return found_; }
+    void Visit(const hir::ExpressionStatement&) {}
+    void Visit(const hir::ReturnStatement&) { found_ = true; }
+    void Visit(const hir::BreakStatement&) {}
+    void Visit(const hir::ContinueStatement&) {}
+    void Visit(const hir::WhileStatement& stmt) { stmt.body()->Accept(*this); }
+    void Visit(const hir::IfStatement& stmt) {
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(const hir::BlockStatement& stmt) {
+        for (const auto& stmt : stmt.stmts()) stmt->Accept(*this);
+    }
+
+private:
+    bool found_ = false;
+};
+
+bool ContainsReturn(const hir::Statement& stmt) {
+    ReturnFinder finder;
+    stmt.Accept(finder);
+    return (bool)finder;
+}
+
+// Returns true if every path through `stmt` ends with return.
+bool AlwaysReturns(const hir::Statement& stmt) {
+    struct Helper : public hir::StatementVisitor {
+        bool returns = false;
+        void Visit(const hir::ExpressionStatement&) {}
+        void Visit(const hir::ReturnStatement&) { returns = true; }
+        void Visit(const hir::BreakStatement&) {}
+        void Visit(const hir::ContinueStatement&) {}
+        void Visit(const hir::WhileStatement&) {}
+        void Visit(const hir::IfStatement& stmt) {
+            returns = stmt.else_body() && AlwaysReturns(*stmt.then_body()) &&
+                      AlwaysReturns(*stmt.else_body().value());
+        }
+        void Visit(const hir::BlockStatement& stmt) {
+            returns = std::any_of(
+                stmt.stmts().begin(), stmt.stmts().end(),
+                [](const auto& stmt) { return AlwaysReturns(*stmt); });
+        }
+    };
+    Helper helper;
+    stmt.Accept(helper);
+    return helper.returns;
+}
+
+std::unique_ptr<hir::Statement> MakeAssign(
+    std::unique_ptr<hir::Expression>&& lhs,
+    std::unique_ptr<hir::Expression>&& rhs, Span span) {
+    hir::InfixExpression::Op op(hir::InfixExpression::Op::Assign, span);
+    auto expr = std::make_unique<hir::InfixExpression>(std::move(lhs), op,
+                                                       std::move(rhs), span);
+    return std::make_unique<hir::ExpressionStatement>(std::move(expr), span);
+}
+
+std::unique_ptr<hir::Statement> MakeAssign(
+    Symbol var, std::unique_ptr<hir::Expression>&& rhs, Span span) {
+    return MakeAssign(std::make_unique<hir::VariableExpression>(var, span),
+                      std::move(rhs), span);
+}
+
+// Returns `stmt` as a block, wrapping it if it's not.
+hir::BlockStatement& AsBlock(std::unique_ptr<hir::Statement>& stmt) {
+    StatementKind kind;
+    stmt->Accept(kind);
+    if (kind.block) return *kind.block;
+
+    auto span = stmt->span();
+    Statements stmts;
+    stmts.push_back(std::move(stmt));
+    auto block = std::make_unique<hir::BlockStatement>(std::move(stmts), span);
+    auto& result = *block;
+    stmt = std::move(block);
+    return result;
+}
+
+// Rewrites `return e;` in `stmts`, after which nothing runs, into `ret = e;`.
+// Statements after `if` which returns in a branch are moved into the other
+// branch, so that no statement follows a rewritten return. Returns false if a
+// return can't be rewritten so, like the one in a loop.
+bool RewriteReturns(Statements& stmts, std::optional<Symbol> ret) {
+    for (size_t i = 0; i < stmts.size();) {
+        StatementKind kind;
+        stmts[i]->Accept(kind);
+        if (kind.ret) {
+            auto& value = kind.ret->ret_value();
+            if (value.has_value() != ret.has_value()) return false;
+
+            // Statements after return are unreachable.
+            if (value) {
+                auto span = stmts[i]->span();
+                stmts[i] = MakeAssign(ret.value(), std::move(value.value()),
+                                      span);
+                stmts.resize(i + 1);
+            } else {
+                stmts.resize(i);
+            }
+            return true;
+        } else if (kind.block && ContainsReturn(*stmts[i])) {
+            // Blocks have no scope in hir, so statements can be spliced.
+            auto inner = std::move(kind.block->stmts());
+            stmts.erase(stmts.begin() + i);
+            stmts.insert(stmts.begin() + i,
+                         std::make_move_iterator(inner.begin()),
+                         std::make_move_iterator(inner.end()));
+            continue;
+        } else if (kind.while_ && ContainsReturn(*stmts[i])) {
+            return false;
+        } else if (kind.if_ && ContainsReturn(*stmts[i])) {
+            auto& stmt = *kind.if_;
+            Statements rest(std::make_move_iterator(stmts.begin() + i + 1),
+                            std::make_move_iterator(stmts.end()));
+            stmts.resize(i + 1);
+
+            bool then_falls = !AlwaysReturns(*stmt.then_body());
+            bool else_falls = !stmt.else_body() ||
+                              !AlwaysReturns(*stmt.else_body().value());
+            if (!rest.empty() && then_falls && else_falls) return false;
+
+            auto& then_body = AsBlock(stmt.then_body());
+            if (then_falls) {
+                std::move(rest.begin(), rest.end(),
+                          std::back_inserter(then_body.stmts()));
+            } else if (else_falls && !stmt.else_body()) {
+                auto span = stmt.span();
+                stmt.else_body() = std::make_unique<hir::BlockStatement>(
+                    std::move(rest), span);
+            } else if (else_falls) {
+                auto& else_body = AsBlock(stmt.else_body().value());
+                std::move(rest.begin(), rest.end(),
+                          std::back_inserter(else_body.stmts()));
+            }
+
+            if (!RewriteReturns(then_body.stmts(), ret)) return false;
+            if (!stmt.else_body()) return true;
+            return RewriteReturns(AsBlock(stmt.else_body().value()).stmts(),
+                                  ret);
+        }
+        i++;
+    }
+    return true;
+}
+
+bool IsVoid(const hir::Type& type) {
+    return type.IsBuiltin() &&
+           type.ToBuiltin()->kind() == hir::BuiltinType::Void;
+}
+
+// A statement calling a function, which is one of `f(args);`, `x = f(args);`
+// or `return f(args);`.
+struct CallSite {
+    hir::CallExpression* call = nullptr;
+    hir::InfixExpression* assign = nullptr;
+    hir::ReturnStatement* ret = nullptr;
+};
+
+std::optional<CallSite> MatchCallSite(hir::Statement& stmt) {
+    StatementKind kind;
+    stmt.Accept(kind);
+
+    CallSite site;
+    if (kind.expr) {
+        auto expr = KindOf(kind.expr->expr());
+        if (expr.infix &&
+            expr.infix->op().kind() == hir::InfixExpression::Op::Assign &&
+            KindOf(expr.infix->lhs()).variable) {
+            site.assign = expr.infix;
+            expr = KindOf(expr.infix->rhs());
+        }
+        site.call = expr.call;
+    } else if (kind.ret && kind.ret->ret_value()) {
+        site.ret = kind.ret;
+        site.call = KindOf(kind.ret->ret_value().value()).call;
+    }
+    if (!site.call || !CalleeOf(*site.call)) return std::nullopt;
+    return site;
+}
+
+// Inlines calls in the body of a function.
+class FunctionInliner : public hir::StatementVisitorMut {
+public:
+    FunctionInliner(
+        Context& ctx, hir::FunctionDeclaration& caller,
+        const std::unordered_map<Symbol, hir::FunctionDeclaration*>& funcs,
+        const std::unordered_map<Symbol, size_t>& call_counts)
+        : ctx_(ctx),
+          caller_(caller),
+          funcs_(funcs),
+          call_counts_(call_counts),
+          caller_size_(CollectBodyInfo(caller).size),
+          next_id_(0) {
+        // Continue numbering of locals from ones the caller has.
+        auto update = [&](Symbol name) {
+            const std::string& s = name.str();
+            if (s.size() < 2 || s[0] != '_') return;
+            if (!std::all_of(s.begin() + 1, s.end(),
+                             [](char c) { return '0' <= c && c <= '9'; })) {
+                return;
+            }
+            next_id_ = std::max<size_t>(next_id_, std::stoull(s.substr(1)) + 1);
+        };
+        for (const auto& param : caller.params()) update(param.name().value());
+        for (const auto& decl : caller.decls()) update(decl.name().value());
+    }
+    void Visit(hir::ExpressionStatement&) {}
+    void Visit(hir::ReturnStatement&) {}
+    void Visit(hir::BreakStatement&) {}
+    void Visit(hir::ContinueStatement&) {}
+    void Visit(hir::WhileStatement& stmt) { Inline(stmt.body()); }
+    void Visit(hir::IfStatement& stmt) {
+        Inline(stmt.then_body());
+        if (stmt.else_body()) Inline(stmt.else_body().value());
+    }
+    void Visit(hir::BlockStatement& stmt) {
+        for (auto& stmt : stmt.stmts()) Inline(stmt);
+    }
+
+private:
+    // Replaces `stmt` with the body of the function it calls if it's a call
+    // site to inline, or inlines calls in `stmt` otherwise. Inlined bodies
+    // are not visited again, so recursion inlines only once.
+    void Inline(std::unique_ptr<hir::Statement>& stmt) {
+        auto site = MatchCallSite(*stmt);
+        auto it = site ? funcs_.find(CalleeOf(*site->call).value())
+                       : funcs_.end();
+        // Arguments are moved into the inlined body, so calls in them are
+        // recorded first.
+        RecordNestedCalls(*stmt, site ? site->call : nullptr);
+        if (it == funcs_.end()) {
+            stmt->Accept(*this);
+            return;
+        }
+
+        auto& callee = *it->second;
+        auto span = site->call->span();
+        std::string reason;
+        auto body = InlinedBody(callee, *site, reason);
+        if (!body) {
+            Record(span, callee, "not inlined", reason);
+            return;
+        }
+        Record(span, callee, "inlined", reason);
+        stmt = std::make_unique<hir::BlockStatement>(std::move(body.value()),
+                                                     stmt->span());
+    }
+
+    // Returns statements which do the same as the call site, or the reason
+    // why it's not inlined as `reason`. `reason` is also set for the reason
+    // why it's inlined.
+    std::optional<Statements> InlinedBody(
+        const hir::FunctionDeclaration& callee, CallSite& site,
+        std::string& reason) {
+        if (&callee == &caller_) {
+            reason = "recursive call";
+            return std::nullopt;
+        }
+        const auto& attr = callee.inline_attr();
+        if (attr && attr->kind() == hir::FunctionDeclarationInline::NoInline) {
+            reason = "marked noinline";
+            return std::nullopt;
+        }
+        if (!callee.body()) {
+            reason = "no body";
+            return std::nullopt;
+        }
+        if (callee.variadic() ||
+            callee.params().size() != site.call->args().size()) {
+            reason = "variadic or mismatched arguments";
+            return std::nullopt;
+        }
+        bool has_array = callee.ret()->IsArray();
+        for (const auto& param : callee.params()) {
+            has_array |= param.type()->IsArray();
+        }
+        if (has_array) {
+            reason = "array parameter or return value";
+            return std::nullopt;
+        }
+        bool is_void = IsVoid(*callee.ret());
+        if (is_void && site.assign) {
+            reason = "no return value";
+            return std::nullopt;
+        }
+
+        auto info = CollectBodyInfo(callee);
+        if (info.calls.count(callee.name().value())) {
+            reason = "recursive function";
+            return std::nullopt;
+        }
+        auto calls = call_counts_.find(callee.name().value());
+        bool called_once =
+            calls != call_counts_.end() && calls->second == 1;
+        if (attr && attr->kind() == hir::FunctionDeclarationInline::Inline) {
+            reason = fmt::format("marked inline, {} nodes", info.size);
+        } else if (info.size > single_call_limit ||
+                   (info.size > small_limit && !called_once)) {
+            reason = fmt::format("too large, {} nodes", info.size);
+            return std::nullopt;
+        } else if (caller_size_ + info.size > caller_limit) {
+            reason = fmt::format("caller too large, {} nodes", caller_size_);
+            return std::nullopt;
+        } else if (info.size > small_limit) {
+            reason = fmt::format("called once, {} nodes", info.size);
+        } else {
+            reason = fmt::format("small, {} nodes", info.size);
+        }
+
+        // Parameters and locals of callee are renamed to new locals.
+        Renames renames;
+        std::vector<hir::VariableDeclaration> decls;
+        auto add_local = [&](const std::shared_ptr<hir::Type>& type,
+                             Span span) {
+            Symbol local(fmt::format("_{}", next_id_++));
+            decls.emplace_back(type, hir::VariableDeclarationName(local, span));
+            return local;
+        };
+        for (const auto& param : callee.params()) {
+            renames[param.name().value()] =
+                add_local(param.type(), param.name().span());
+        }
+        for (const auto& decl : callee.decls()) {
+            renames[decl.name().value()] =
+                add_local(decl.type(), decl.name().span());
+        }
+        std::optional<Symbol> ret;
+        if (!is_void) ret = add_local(callee.ret(), site.call->span());
+
+        StmtCloner c(renames);
+        auto body = c.CloneAll(callee.body()->stmts());
+        if (!RewriteReturns(body, ret)) {
+            reason = "return in loop or branch";
+            return std::nullopt;
+        }
+
+        // Arguments are assigned in order, as the call evaluates them.
+        auto span = site.call->span();
+        Statements stmts;
+        auto& args = site.call->args();
+        for (size_t i = 0; i < args.size(); i++) {
+            auto param = renames.at(callee.params().at(i).name().value());
+            stmts.push_back(MakeAssign(param, std::move(args[i]), span));
+        }
+        std::move(body.begin(), body.end(), std::back_inserter(stmts));
+        if (site.assign) {
+            stmts.push_back(MakeAssign(
+                std::move(site.assign->lhs()),
+                std::make_unique<hir::VariableExpression>(ret.value(), span),
+                span));
+        } else if (site.ret) {
+            std::optional<std::unique_ptr<hir::Expression>> value;
+            if (ret) {
+                value = std::make_unique<hir::VariableExpression>(ret.value(),
+                                                                  span);
+            }
+            stmts.push_back(std::make_unique<hir::ReturnStatement>(
+                std::move(value), site.ret->span()));
+        }
+
+        auto& caller_decls = caller_.decls();
+        caller_decls.insert(caller_decls.end(), decls.begin(), decls.end());
+        caller_size_ += info.size;
+        return stmts;
+    }
+
+    // Records calls in expressions of `stmt` other than `site`, which are
+    // never inlined.
+    void RecordNestedCalls(const hir::Statement& stmt,
+                           const hir::CallExpression* site) {
+        for (const auto* call : CallsIn(stmt)) {
+            if (call == site) continue;
+            auto name = CalleeOf(*call);
+            auto it = name ? funcs_.find(name.value()) : funcs_.end();
+            if (it == funcs_.end()) continue;
+            Record(call->span(), *it->second, "not inlined",
+                   "call inside an expression");
+        }
+    }
+
+    void Record(Span span, const hir::FunctionDeclaration& callee,
+                std::string_view decision, const std::string& reason) {
+        ctx_.opt_stats().inline_report.push_back(fmt::format(
+            "{}:{}: {} `{}` into `{}` ({})", span.start().row() + 1,
+            span.start().offset() + 1, decision, callee.name().value(),
+            caller_.name().value(), reason));
+    }
+
+    Context& ctx_;
+    hir::FunctionDeclaration& caller_;
+    const std::unordered_map<Symbol, hir::FunctionDeclaration*>& funcs_;
+    const std::unordered_map<Symbol, size_t>& call_counts_;
+    size_t caller_size_;
+    size_t next_id_;
+};
+
+class FunctionCollector : public hir::DeclarationVisitorMut {
+public:
+    std::vector<hir::FunctionDeclaration*>& funcs() { return funcs_; }
+    void Visit(hir::StructDeclaration&) {}
+    void Visit(hir::EnumDeclaration&) {}
+    void Visit(hir::FunctionDeclaration& decl) { funcs_.push_back(&decl); }
+
+private:
+    std::vector<hir::FunctionDeclaration*> funcs_;
+};
+
+}  // namespace
+
+void InlineFunctions(Context& ctx, hir::Root& root) {
+    FunctionCollector collect;
+    for (auto& decl : root.decls()) decl->Accept(collect);
+
+    std::unordered_map<Symbol, hir::FunctionDeclaration*> funcs;
+    std::unordered_map<Symbol, size_t> call_counts;
+    for (auto* func : collect.funcs()) {
+        funcs[func->name().value()] = func;
+        for (const auto& [callee, count] : CollectBodyInfo(*func).calls) {
+            call_counts[callee] += count;
+        }
+    }
+
+    // Callers are visited in order of declarations, so a callee declared
+    // before its caller has its calls inlined before it's inlined.
+    for (auto* func : collect.funcs()) {
+        if (!func->body()) continue;
+        FunctionInliner inliner(ctx, *func, funcs, call_counts);
+        func->body()->Accept(inliner);
+    }
+}
+
+}  // namespace hiropt
+
+}  // namespace mini
@@ -0,0 +1,25 @@
+#ifndef MINI_HIROPT_INLINE_H_
+#define MINI_HIROPT_INLINE_H_
+
+#include "../context.h"
+#include "../hir/root.h"
+
+namespace mini {
+
+namespace hiropt {
+
+// Replaces statements `f(args);`, `x = f(args);` and `return f(args);` with
+// the body of `f` if it's small, called only once or marked `inline`, and
+// isn't marked `noinline`. Parameters and locals of `f` become new locals of
+// the caller, named `_N` after the ones it has like `NameTranslator` does,
+// and the body assigns its return value to one of them.
+//
+// Every decision is recorded to the stats of `ctx` as a line of report,
+// including calls inside larger expressions, which are never inlined.
+void InlineFunctions(Context& ctx, hir::Root& root);
+
+}  // namespace hiropt
+
+}  // namespace mini
+
+#endif  // MINI_HIROPT_INLINE_H_
@@ -1,6 +1,6 @@
 #include "unused.h"
 
-#include <set>
+#include <unordered_set>
 
 #include "../context.h"
 #include "../report.h"
@@ -38,7 +38,7 @@ bool IsVariableExpression(const std::unique_ptr<hir::Expression>& expr) {
 class UsedVariableCollectorExpr : public hir::ExpressionVisitor {
 public:
     UsedVariableCollectorExpr(bool full = false) : full_(full), used_vars_() {}
-    const std::set<std::string>& used_vars() { return used_vars_; }
+    const std::unordered_set<Symbol>& used_vars() { return used_vars_; }
     void Visit(const hir::UnaryExpression& expr) {
         UsedVariableCollectorExpr c;
         expr.expr()->Accept(c);
@@ -117,13 +117,13 @@ public:
 
 private:
     bool full_;  // if false, lhs in assign expression is considered as unused.
-    std::set<std::string> used_vars_;
+    std::unordered_set<Symbol> used_vars_;
 };
 
 class UsedVariableCollectorStmt : public hir::StatementVisitor {
 public:
     UsedVariableCollectorStmt() : used_vars_() {}
-    const std::set<std::string>& used_vars() { return used_vars_; }
+    const std::unordered_set<Symbol>& used_vars() { return used_vars_; }
     void Visit(const hir::ExpressionStatement& stmt) {
         UsedVariableCollectorExpr c;
         stmt.expr()->Accept(c);
@@ -171,13 +171,13 @@ public:
     }
 
 private:
-    std::set<std::string> used_vars_;
+    std::unordered_set<Symbol> used_vars_;
 };
 
 // Remove statement that contains unused variable
 class StatementRemover : public hir::StatementVisitorMut {
 public:
-    StatementRemover(const std::set<std::string>& used_vars)
+    StatementRemover(const std::unordered_set<Symbol>& used_vars)
         : should_remove_(false), used_vars_(used_vars) {}
     void Visit(hir::ExpressionStatement& stmt) {
         UsedVariableCollectorExpr c(true);
@@ -229,7 +229,7 @@ public:
 
 private:
     bool should_remove_;
-    std::set<std::string> used_vars_;
+    std::unordered_set<Symbol> used_vars_;
 };
 
 class UnusedVariableRemover : public hir::DeclarationVisitorMut {
@@ -248,13 +248,7 @@ public:
 
         // Remove unused variable declaration
         for (auto it = decl.decls().begin(); it != decl.decls().end();) {
-            bool exists = false;
-            for (auto& name : c.used_vars()) {
-                if (it->name().value() == name) {
-                    exists = true;
-                    break;
-                }
-            }
+            bool exists = c.used_vars().count(it->name().value()) != 0;
             if (!exists) {
                 ReportInfo info(it->span(), "unused variable", "");
                 Report(ctx_, ReportLevel::Warn, info);
@@ -271,13 +265,7 @@ public:
 
         // Report unused parameter
         for (auto& param : decl.params()) {
-            bool exists = false;
-            for (auto& name : c.used_vars()) {
-                if (param.name().value() == name) {
-                    exists = true;
-                    break;
-                }
-            }
+            bool exists = c.used_vars().count(param.name().value()) != 0;
             if (!exists) {
                 ReportInfo info(param.span(), "unused parameter", "");
                 Report(ctx_, ReportLevel::Warn, info);
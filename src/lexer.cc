@@ -1,11 +1,9 @@
 #include "lexer.h"
 
-#include <cctype>
+#include <array>
 #include <cstdint>
-#include <iterator>
-#include <map>
-#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "context.h"
@@ -16,51 +14,150 @@
 
 namespace mini {
 
-class LineStream {
+namespace {
+
+// Class of each character, used to decide what kind of token starts with it.
+enum CharClass : uint8_t {
+    CC_Other,
+    CC_Space,
+    CC_Alpha,
+    CC_Digit,
+    CC_Underscore,
+    CC_Punct,
+    CC_DQuote,
+    CC_SQuote,
+};
+
+constexpr std::string_view punct_chars = "+-*/%|&^=!<>~.{}()[];,:";
+
+constexpr std::array<uint8_t, 256> BuildCharClassTable() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 'a'; c <= 'z'; c++) table[c] = CC_Alpha;
+    for (int c = 'A'; c <= 'Z'; c++) table[c] = CC_Alpha;
+    for (int c = '0'; c <= '9'; c++) table[c] = CC_Digit;
+    for (char c : std::string_view(" \t\n\v\f\r")) table[(uint8_t)c] = CC_Space;
+    for (char c : punct_chars) table[(uint8_t)c] = CC_Punct;
+    table['_'] = CC_Underscore;
+    table['"'] = CC_DQuote;
+    table['\''] = CC_SQuote;
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> char_class = BuildCharClassTable();
+
+inline uint8_t ClassOf(char c) { return char_class[(uint8_t)c]; }
+
+inline bool IsIdentChar(char c) {
+    auto cc = ClassOf(c);
+    return cc == CC_Alpha || cc == CC_Digit || cc == CC_Underscore;
+}
+
+struct PunctEntry {
+    std::string_view pat;
+    PunctTokenKind kind;
+};
+
+constexpr PunctEntry puncts[] = {
+    {"+",   PunctTokenKind::Plus       },
+    {"->",  PunctTokenKind::Arrow      },
+    {"-",   PunctTokenKind::Minus      },
+    {"*",   PunctTokenKind::Star       },
+    {"/",   PunctTokenKind::Slash      },
+    {"%",   PunctTokenKind::Percent    },
+    {"||",  PunctTokenKind::Or         },
+    {"|",   PunctTokenKind::Vertical   },
+    {"&&",  PunctTokenKind::And        },
+    {"&",   PunctTokenKind::Ampersand  },
+    {"^",   PunctTokenKind::Hat        },
+    {"==",  PunctTokenKind::EQ         },
+    {"!=",  PunctTokenKind::NE         },
+    {"=",   PunctTokenKind::Assign     },
+    {"<=",  PunctTokenKind::LE         },
+    {"<<",  PunctTokenKind::LShift     },
+    {"<",   PunctTokenKind::LT         },
+    {">=",  PunctTokenKind::GE         },
+    {">>",  PunctTokenKind::RShift     },
+    {">",   PunctTokenKind::GT         },
+    {"~",   PunctTokenKind::Tilde      },
+    {"!",   PunctTokenKind::Exclamation},
+    {"...", PunctTokenKind::DotDotDot  },
+    {".",   PunctTokenKind::Dot        },
+    {"{",   PunctTokenKind::LCurly     },
+    {"(",   PunctTokenKind::LParen     },
+    {"[",   PunctTokenKind::LSquare    },
+    {"}",   PunctTokenKind::RCurly     },
+    {")",   PunctTokenKind::RParen     },
+    {"]",   PunctTokenKind::RSquare    },
+    {";",   PunctTokenKind::Semicolon  },
+    {",",   PunctTokenKind::Comma      },
+    {"::",  PunctTokenKind::ColonColon },
+    {":",   PunctTokenKind::Colon      },
+};
+
+// A DFA recognizing punctuators, generated at compile time from `puncts`.
+//
+// Input characters are first compressed into an index into `punct_chars`, so
+// the transition table only has a column for each character that may appear
+// in a punctuator. State 0 is the start state.
+class PunctDfa {
 public:
-    LineStream(size_t row, const std::string &line)
-        : offset_(0), row_(row), line_(line) {}
-    explicit operator bool() { return offset_ < line_.size(); }
-    void Advance() { offset_++; }
-    char Char() const { return line_[offset_]; }
-    Position Pos() const { return Position(row_, offset_); }
-    bool Accept(const std::string &pat, Position &pos) {
-        size_t offset_save = offset_;
-        Position pos_save = pos;
-        for (char c : pat) {
-            if (!*this || c != Char()) {
-                offset_ = offset_save;
-                pos = pos_save;
-                return false;
-            } else {
-                pos = this->Pos();
-                Advance();
+    static constexpr int max_states = 64;
+    static constexpr int num_chars = punct_chars.size();
+
+    constexpr PunctDfa() : column_{}, next_{}, accept_{}, num_states_(1) {
+        for (auto &c : column_) c = -1;
+        for (int i = 0; i < num_chars; i++) column_[(uint8_t)punct_chars[i]] = i;
+        for (auto &row : next_)
+            for (auto &n : row) n = -1;
+        for (auto &a : accept_) a = -1;
+        for (const auto &punct : puncts) {
+            int state = 0;
+            for (char c : punct.pat) {
+                int col = column_[(uint8_t)c];
+                if (col < 0) throw "punctuator contains unknown character";
+                if (next_[state][col] < 0) {
+                    if (num_states_ >= max_states) throw "too many states";
+                    next_[state][col] = num_states_++;
+                }
+                state = next_[state][col];
             }
-        }
-        return true;
-    }
-    bool Accept(char pat, Position &pos) {
-        if (!*this || pat != Char()) {
-            return false;
-        } else {
-            pos = this->Pos();
-            Advance();
-            return true;
+            accept_[state] = static_cast<int8_t>(punct.kind);
         }
     }
-    void SkipSpaces() {
-        while (*this && std::isspace(Char())) {
-            Advance();
+
+    // Returns the length of the longest punctuator at the start of `s`, or 0
+    // if there is no such punctuator.
+    size_t Match(std::string_view s, PunctTokenKind &kind) const {
+        size_t len = 0;
+        int state = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            int col = column_[(uint8_t)s[i]];
+            if (col < 0) break;
+            state = next_[state][col];
+            if (state < 0) break;
+            if (accept_[state] >= 0) {
+                kind = static_cast<PunctTokenKind>(accept_[state]);
+                len = i + 1;
+            }
         }
+        return len;
     }
 
 private:
-    size_t offset_;
-    const size_t row_;
-    const std::string &line_;
+    int8_t column_[256];
+    int8_t next_[max_states][num_chars];
+    int8_t accept_[max_states];
+    int num_states_;
 };
 
-static const std::map<std::string, KeywordTokenKind> keywords = {
+constexpr PunctDfa punct_dfa;
+
+struct KeywordEntry {
+    std::string_view name;
+    KeywordTokenKind kind;
+};
+
+constexpr KeywordEntry keywords[] = {
     {"as",       KeywordTokenKind::As      },
     {"bool",     KeywordTokenKind::Bool    },
     {"break",    KeywordTokenKind::Break   },
@@ -72,7 +169,9 @@ static const std::map<std::string, KeywordTokenKind> keywords = {
     {"false",    KeywordTokenKind::False   },
     {"function", KeywordTokenKind::Function},
     {"if",       KeywordTokenKind::If      },
+    {"inline",   KeywordTokenKind::Inline  },
     {"let",      KeywordTokenKind::Let     },
+    {"noinline", KeywordTokenKind::NoInline},
     {"return",   KeywordTokenKind::Return  },
     {"struct",   KeywordTokenKind::Struct  },
     {"tsizeof",  KeywordTokenKind::TSizeof },
@@ -92,41 +191,77 @@ static const std::map<std::string, KeywordTokenKind> keywords = {
     {"nullptr",  KeywordTokenKind::NullPtr },
 };
 
-static const std::vector<std::pair<std::string, PunctTokenKind>> puncts = {
-    {"+",   PunctTokenKind::Plus       },
-    {"->",  PunctTokenKind::Arrow      },
-    {"-",   PunctTokenKind::Minus      },
-    {"*",   PunctTokenKind::Star       },
-    {"/",   PunctTokenKind::Slash      },
-    {"%",   PunctTokenKind::Percent    },
-    {"||",  PunctTokenKind::Or         },
-    {"|",   PunctTokenKind::Vertical   },
-    {"&&",  PunctTokenKind::And        },
-    {"&",   PunctTokenKind::Ampersand  },
-    {"^",   PunctTokenKind::Hat        },
-    {"==",  PunctTokenKind::EQ         },
-    {"!=",  PunctTokenKind::NE         },
-    {"=",   PunctTokenKind::Assign     },
-    {"<=",  PunctTokenKind::LE         },
-    {"<<",  PunctTokenKind::LShift     },
-    {"<",   PunctTokenKind::LT         },
-    {">=",  PunctTokenKind::GE         },
-    {">>",  PunctTokenKind::RShift     },
-    {">",   PunctTokenKind::GT         },
-    {"~",   PunctTokenKind::Tilde      },
-    {"!",   PunctTokenKind::Exclamation},
-    {"...", PunctTokenKind::DotDotDot  },
-    {".",   PunctTokenKind::Dot        },
-    {"{",   PunctTokenKind::LCurly     },
-    {"(",   PunctTokenKind::LParen     },
-    {"[",   PunctTokenKind::LSquare    },
-    {"}",   PunctTokenKind::RCurly     },
-    {")",   PunctTokenKind::RParen     },
-    {"]",   PunctTokenKind::RSquare    },
-    {";",   PunctTokenKind::Semicolon  },
-    {",",   PunctTokenKind::Comma      },
-    {"::",  PunctTokenKind::ColonColon },
-    {":",   PunctTokenKind::Colon      },
+// Perfect hash over `keywords`. The multipliers were chosen so that no two
+// keywords share a slot, which is checked when the table is built.
+constexpr size_t keyword_table_size = 64;
+
+constexpr size_t KeywordHash(std::string_view s) {
+    return (s.size() * 19 + (uint8_t)s.front() * 6 + (uint8_t)s.back() * 13 +
+            (uint8_t)s[s.size() / 2]) %
+           keyword_table_size;
+}
+
+class KeywordTable {
+public:
+    constexpr KeywordTable() : slots_{} {
+        for (auto &slot : slots_) slot = -1;
+        for (size_t i = 0; i < std::size(keywords); i++) {
+            auto h = KeywordHash(keywords[i].name);
+            if (slots_[h] >= 0) throw "keyword hash collision";
+            slots_[h] = i;
+        }
+    }
+
+    bool Find(std::string_view s, KeywordTokenKind &kind) const {
+        auto slot = slots_[KeywordHash(s)];
+        if (slot < 0 || keywords[slot].name != s) return false;
+        kind = keywords[slot].kind;
+        return true;
+    }
+
+private:
+    int8_t slots_[keyword_table_size];
+};
+
+constexpr KeywordTable keyword_table;
+
+}  // namespace
+
+class LineStream {
+public:
+    LineStream(size_t row, std::string_view line)
+        : offset_(0), row_(row), line_(line) {}
+    explicit operator bool() { return offset_ < line_.size(); }
+    void Advance() { offset_++; }
+    void Advance(size_t n) { offset_ += n; }
+    char Char() const { return line_[offset_]; }
+    std::string_view Rest() const { return line_.substr(offset_); }
+    Position Pos() const { return Position(row_, offset_); }
+    bool Accept(std::string_view pat, Position &pos) {
+        if (Rest().substr(0, pat.size()) != pat) return false;
+        Advance(pat.size());
+        pos = Position(row_, offset_ - 1);
+        return true;
+    }
+    bool Accept(char pat, Position &pos) {
+        if (!*this || pat != Char()) {
+            return false;
+        } else {
+            pos = this->Pos();
+            Advance();
+            return true;
+        }
+    }
+    void SkipSpaces() {
+        while (*this && ClassOf(Char()) == CC_Space) {
+            Advance();
+        }
+    }
+
+private:
+    size_t offset_;
+    const size_t row_;
+    const std::string_view line_;
 };
 
 class LexContext {
@@ -148,11 +283,53 @@ private:
     uint64_t multiline_comment_depth_;
 };
 
-static LexResult lex_line(LexContext &ctx, size_t id, size_t row,
-                          const std::string &line) {
+// Converts the character after backslash to the escaped one.
+static bool escape_char(char c, char &value) {
+    switch (c) {
+        case 'a':
+            value = '\a';
+            return true;
+        case 'b':
+            value = '\b';
+            return true;
+        case 'f':
+            value = '\f';
+            return true;
+        case 'n':
+            value = '\n';
+            return true;
+        case 'r':
+            value = '\r';
+            return true;
+        case 't':
+            value = '\t';
+            return true;
+        case 'v':
+            value = '\v';
+            return true;
+        case '\'':
+            value = '\'';
+            return true;
+        case '"':
+            value = '\"';
+            return true;
+        case '\\':
+            value = '\\';
+            return true;
+        case '0':
+            value = '\0';
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Lexes `line` starting at `line_offset` in the source, and appends tokens to
+// `res`. Returns false if any error happens.
+static bool lex_line(LexContext &ctx, TokenList &res, size_t id, size_t row,
+                     size_t line_offset, std::string_view line) {
     LineStream stream(row, line);
     bool success = true;
-    std::vector<std::unique_ptr<Token>> res;
     while (true) {
         Position tmp(0, 0);
         while (stream && ctx.InsideOfMultilineComment()) {
@@ -172,6 +349,8 @@ static LexResult lex_line(LexContext &ctx, size_t id, size_t row,
 
         Position start = stream.Pos();
         Position end = start;
+        const size_t offset = line_offset + start.offset();
+        auto len = [&]() { return end.offset() - start.offset() + 1; };
 
         if (stream.Accept("//", end)) {
             break;
@@ -180,181 +359,144 @@ static LexResult lex_line(LexContext &ctx, size_t id, size_t row,
             continue;
         }
 
-        bool found = false;
-        for (const auto &punct : puncts) {
-            if (stream.Accept(punct.first, end)) {
-                res.push_back(std::make_unique<PunctToken>(
-                    punct.second, Span(id, start, end)));
-                found = true;
+        switch (ClassOf(stream.Char())) {
+            case CC_Punct: {
+                PunctTokenKind kind = PunctTokenKind::Plus;
+                auto punct_len = punct_dfa.Match(stream.Rest(), kind);
+                stream.Advance(punct_len);
+                res.PushPunct(kind, offset, punct_len);
                 break;
             }
-        }
-        if (found) continue;
-
-        if (stream.Accept('"', end)) {
-            std::string value;
-            while (true) {
-                if (!stream) {
-                    ReportInfo info(Span(id, start, end),
-                                    "unclosing string literal", "");
-                    Report(ctx.ctx(), ReportLevel::Error, info);
-                    return std::nullopt;
-                } else if (stream.Accept('"', end)) {
-                    break;
-                } else if (stream.Accept('\\', end)) {
-                    if (stream.Accept('a', end)) {
-                        value.push_back('\a');
-                    } else if (stream.Accept('b', end)) {
-                        value.push_back('\b');
-                    } else if (stream.Accept('f', end)) {
-                        value.push_back('\f');
-                    } else if (stream.Accept('n', end)) {
-                        value.push_back('\n');
-                    } else if (stream.Accept('r', end)) {
-                        value.push_back('\r');
-                    } else if (stream.Accept('t', end)) {
-                        value.push_back('\t');
-                    } else if (stream.Accept('v', end)) {
-                        value.push_back('\v');
-                    } else if (stream.Accept('\'', end)) {
-                        value.push_back('\'');
+            case CC_DQuote: {
+                stream.Advance();
+                std::string value;
+                while (true) {
+                    if (!stream) {
+                        ReportInfo info(Span(id, start, end),
+                                        "unclosing string literal", "");
+                        Report(ctx.ctx(), ReportLevel::Error, info);
+                        return false;
                     } else if (stream.Accept('"', end)) {
-                        value.push_back('\"');
+                        break;
                     } else if (stream.Accept('\\', end)) {
-                        value.push_back('\\');
-                    } else if (stream.Accept('0', end)) {
-                        value.push_back('\0');
+                        char c;
+                        if (!stream || !escape_char(stream.Char(), c)) {
+                            ReportInfo info(Span(id, end, end),
+                                            "unexpected escape sequence", "");
+                            Report(ctx.ctx(), ReportLevel::Error, info);
+                            return false;
+                        }
+                        value.push_back(c);
+                        end = stream.Pos();
+                        stream.Advance();
                     } else {
+                        value.push_back(stream.Char());
+                        stream.Advance();
+                    }
+                }
+                res.PushString(std::move(value), offset, len());
+                break;
+            }
+            case CC_SQuote: {
+                stream.Advance();
+                char value;
+                if (stream.Accept('\\', end)) {
+                    if (!stream || !escape_char(stream.Char(), value)) {
                         ReportInfo info(Span(id, end, end),
                                         "unexpected escape sequence", "");
                         Report(ctx.ctx(), ReportLevel::Error, info);
-                        return std::nullopt;
+                        return false;
                     }
-                } else {
-                    value.push_back(stream.Char());
+                    end = stream.Pos();
+                    stream.Advance();
+                } else if (stream) {
+                    value = stream.Char();
+                    end = stream.Pos();
                     stream.Advance();
-                }
-            }
-            res.push_back(std::make_unique<StringToken>(std::move(value),
-                                                        Span(id, start, end)));
-        } else if (stream.Accept('\'', end)) {
-            char value;
-            if (stream.Accept('\\', end)) {
-                if (stream.Accept('a', end)) {
-                    value = '\a';
-                } else if (stream.Accept('b', end)) {
-                    value = '\b';
-                } else if (stream.Accept('f', end)) {
-                    value = '\f';
-                } else if (stream.Accept('n', end)) {
-                    value = '\n';
-                } else if (stream.Accept('r', end)) {
-                    value = '\r';
-                } else if (stream.Accept('t', end)) {
-                    value = '\t';
-                } else if (stream.Accept('v', end)) {
-                    value = '\v';
-                } else if (stream.Accept('\'', end)) {
-                    value = '\'';
-                } else if (stream.Accept('"', end)) {
-                    value = '\"';
-                } else if (stream.Accept('\\', end)) {
-                    value = '\\';
-                } else if (stream.Accept('0', end)) {
-                    value = '\0';
                 } else {
                     ReportInfo info(Span(id, end, end),
-                                    "unexpected escape sequence", "");
+                                    "unclosing character literal", "");
                     Report(ctx.ctx(), ReportLevel::Error, info);
-                    return std::nullopt;
+                    return false;
                 }
-            } else if (stream) {
-                value = stream.Char();
-                end = stream.Pos();
-                stream.Advance();
-            } else {
-                ReportInfo info(Span(id, end, end),
-                                "unclosing character literal", "");
-                Report(ctx.ctx(), ReportLevel::Error, info);
-                return std::nullopt;
-            }
 
-            if (!stream.Accept('\'', end)) {
-                ReportInfo info(Span(id, end, end),
-                                "unclosing character literal", "");
-                Report(ctx.ctx(), ReportLevel::Error, info);
-                return std::nullopt;
+                if (!stream.Accept('\'', end)) {
+                    ReportInfo info(Span(id, end, end),
+                                    "unclosing character literal", "");
+                    Report(ctx.ctx(), ReportLevel::Error, info);
+                    return false;
+                }
+
+                res.PushChar(value, offset, len());
+                break;
             }
+            case CC_Alpha: {
+                auto rest = stream.Rest();
+                size_t ident_len = 1;
+                while (ident_len < rest.size() && IsIdentChar(rest[ident_len]))
+                    ident_len++;
+                auto value = rest.substr(0, ident_len);
+                stream.Advance(ident_len);
 
-            res.push_back(
-                std::make_unique<CharToken>(value, Span(id, start, end)));
-        } else if (std::isalpha(stream.Char())) {
-            std::string value;
-            while (stream) {
-                if (std::isalnum(stream.Char()) || stream.Char() == '_') {
-                    value.push_back(stream.Char());
-                    end = stream.Pos();
-                    stream.Advance();
+                KeywordTokenKind kind;
+                if (keyword_table.Find(value, kind)) {
+                    res.PushKeyword(kind, offset, ident_len);
                 } else {
-                    break;
+                    res.PushIdent(value, offset, ident_len);
                 }
+                break;
             }
-            if (keywords.find(value) != keywords.end()) {
-                res.push_back(std::make_unique<KeywordToken>(
-                    keywords.at(value), Span(id, start, end)));
-            } else {
-                res.push_back(std::make_unique<IdentToken>(
-                    std::move(value), Span(id, start, end)));
-            }
-        } else if (std::isdigit(stream.Char())) {
-            std::string buf;
-            while (stream) {
-                if (std::isdigit(stream.Char())) {
-                    buf.push_back(stream.Char());
+            case CC_Digit: {
+                uint64_t value = 0;
+                bool overflow = false;
+                while (stream && ClassOf(stream.Char()) == CC_Digit) {
+                    uint64_t digit = stream.Char() - '0';
+                    if (value > (UINT64_MAX - digit) / 10) overflow = true;
+                    value = value * 10 + digit;
                     end = stream.Pos();
                     stream.Advance();
+                }
+                if (overflow) {
+                    success = false;
+                    ReportInfo info(Span(id, start, end),
+                                    "integer convertion failed", "");
+                    Report(ctx.ctx(), ReportLevel::Error, info);
                 } else {
-                    break;
+                    res.PushInt(value, offset, len());
                 }
+                break;
             }
-            try {
-                res.push_back(std::make_unique<IntToken>(std::stoull(buf),
-                                                         Span(id, start, end)));
-            } catch (std::exception &e) {
+            default: {
                 success = false;
-                ReportInfo info(Span(id, start, end),
-                                "integer convertion failed", "");
+                ReportInfo info(Span(id, start, end), "unexpected character",
+                                "");
                 Report(ctx.ctx(), ReportLevel::Error, info);
+                stream.Advance();
+                break;
             }
-        } else {
-            success = false;
-            ReportInfo info(Span(id, start, end), "unexpected character", "");
-            Report(ctx.ctx(), ReportLevel::Error, info);
-            stream.Advance();
         }
     }
-    if (success)
-        return res;
-    else
-        return std::nullopt;
+    return success;
 }
 
-LexResult LexFile(Context &ctx, const std::string &path) {
-    auto id = ctx.input_cache().Cache(path);
-    auto lines = ctx.input_cache().Fetch(id).lines();
+LexResult Lex(Context &ctx, size_t id) {
+    PassScope scope(ctx.pass_timer(), "lex");
+    const auto &entry = ctx.input_cache().Fetch(id);
+    auto contents = entry.contents();
 
     bool success = true;
-    std::vector<std::unique_ptr<Token>> res;
+    TokenList res(id, entry);
     LexContext lex_ctx(ctx);
-    for (size_t row = 0; row < lines.size(); row++) {
-        auto line = lex_line(lex_ctx, id, row, lines.at(row));
-        if (!line) {
+    size_t row = 0;
+    size_t line_offset = 0;
+    while (line_offset < contents.size()) {
+        auto nl = contents.find('\n', line_offset);
+        if (nl == std::string_view::npos) nl = contents.size();
+        auto line = contents.substr(line_offset, nl - line_offset);
+        if (!lex_line(lex_ctx, res, id, row++, line_offset, line)) {
             success = false;
-            continue;
         }
-        auto begin = std::make_move_iterator(line->begin());
-        auto end = std::make_move_iterator(line->end());
-        res.insert(res.end(), begin, end);
+        line_offset = nl + 1;
     }
     if (success)
         return res;
@@ -362,4 +504,8 @@ LexResult LexFile(Context &ctx, const std::string &path) {
         return std::nullopt;
 }
 
+LexResult LexFile(Context &ctx, const std::string &path) {
+    return Lex(ctx, ctx.input_cache().Cache(path));
+}
+
 };  // namespace mini
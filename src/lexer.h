@@ -1,16 +1,18 @@
 #ifndef MINI_LEXER_H_
 #define MINI_LEXER_H_
 
-#include <memory>
 #include <optional>
-#include <vector>
+#include <string>
 
 #include "context.h"
 #include "token.h"
 
 namespace mini {
 
-using LexResult = std::optional<std::vector<std::unique_ptr<Token>>>;
+using LexResult = std::optional<TokenList>;
+
+// Lexes the source cached as `id` in the input cache.
+LexResult Lex(Context& ctx, size_t id);
 
 LexResult LexFile(Context& ctx, const std::string& path);
 
@@ -1,19 +1,39 @@
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
+#include "assembler/assembler.h"
+#include "assembler/elf.h"
+#include "cache.h"
 #include "codegen/codegen.h"
+#include "codegen/peephole.h"
 #include "context.h"
 #include "fmt/format.h"
 #include "hirgen/hirgen.h"
 #include "panic.h"
 
+enum class TimePasses {
+    None,
+    Table,
+    Json,
+};
+
 enum class UsageKind {
     Normal,
     DuplicatedInput,
@@ -22,11 +42,49 @@ enum class UsageKind {
 };
 
 [[noreturn]] static void usage(std::ostream &os, UsageKind kind) {
-    os << "Usage: mini <FILENAME> [ -o <OUTPUT> ]" << std::endl;
+    os << "Usage: mini <FILENAME>... [ -o <OUTPUT> ]" << std::endl;
     os << "  -o filename Output to specified file" << std::endl;
     os << "  -c          Output object file" << std::endl;
     os << "  -S          Output assembly code" << std::endl;
     os << "  --emit-hir  Output internal representation" << std::endl;
+    os << "  --emit-mir  Output mid-level representation of each function"
+       << std::endl;
+    os << "  -j jobs     Compile files in parallel up to jobs at once"
+       << std::endl;
+    os << "  --stats     Print memory usage of compilation" << std::endl;
+    os << "  --no-cache  Always compile, without the object cache"
+       << std::endl;
+    os << "  --cache-dir=DIR" << std::endl;
+    os << "              Store cached objects in DIR" << std::endl;
+    os << "  --cache-max-size=SIZE[K|M|G]" << std::endl;
+    os << "              Limit total size of cached objects" << std::endl;
+    os << "  --cache-stats" << std::endl;
+    os << "              Print hits, misses and size of the object cache"
+       << std::endl;
+    os << "  --dce-stats" << std::endl;
+    os << "              Print how many dead statements and functions removed"
+       << std::endl;
+    os << "  --fold-stats" << std::endl;
+    os << "              Print how many nodes constant folding removed"
+       << std::endl;
+    os << "  --gvn-stats" << std::endl;
+    os << "              Print how many redundant computations removed"
+       << std::endl;
+    os << "  --inline-report" << std::endl;
+    os << "              Print whether each call is inlined and why"
+       << std::endl;
+    os << "  --licm-stats" << std::endl;
+    os << "              Print how many instructions moved out of loops"
+       << std::endl;
+    os << "  --peephole-stats" << std::endl;
+    os << "              Print how many times each peephole rule applied"
+       << std::endl;
+    os << "  --tail-call-report" << std::endl;
+    os << "              Print whether each call in tail position is converted"
+       << std::endl;
+    os << "  --time-passes[=json]" << std::endl;
+    os << "              Print time and memory spent in each pass"
+       << std::endl;
     os << "  -h          Print this help" << std::endl;
     if (kind == UsageKind::DuplicatedInput) {
         mini::FatalError("duplicated input");
@@ -58,30 +116,72 @@ static std::string replace_suffix(const std::string &s,
     return result;
 }
 
+// Parses size in bytes, optionally suffixed with K, M or G.
+static bool parse_size(const std::string &s, uint64_t &size) {
+    char *end = nullptr;
+    size = std::strtoull(s.c_str(), &end, 10);
+    if (end == s.c_str()) return false;
+    std::string_view suffix(end);
+    if (suffix == "K") {
+        size <<= 10;
+    } else if (suffix == "M") {
+        size <<= 20;
+    } else if (suffix == "G") {
+        size <<= 30;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    return true;
+}
+
 class Arguments {
 public:
     Arguments(int argc, char *argv[]) {
         std::optional<std::string> output;
-        std::optional<std::string> input;
+        std::vector<std::string> inputs;
+        size_t jobs = std::max(std::thread::hardware_concurrency(), 1u);
         bool emit_hir = false;
+        bool emit_mir = false;
         bool emit_asm = false;
         bool emit_obj = false;
         bool print_help = false;
+        bool stats = false;
+        bool use_cache = true;
+        std::string cache_dir = mini::ObjectCache::DefaultDir();
+        uint64_t cache_max_size = uint64_t(256) << 20;
+        bool cache_stats = false;
+        bool dce_stats = false;
+        bool fold_stats = false;
+        bool gvn_stats = false;
+        bool inline_report = false;
+        bool licm_stats = false;
+        bool peephole_stats = false;
+        bool tail_call_report = false;
+        TimePasses time_passes = TimePasses::None;
         for (int i = 1; i < argc; i++) {
             std::string arg = argv[i];
             if (arg == "--emit-hir") {
-                if (emit_asm || emit_obj) {
-                    mini::FatalError("cannot use --emit-hir with -S and -c");
+                if (emit_mir || emit_asm || emit_obj) {
+                    mini::FatalError(
+                        "cannot use --emit-hir with --emit-mir, -S and -c");
                 }
                 emit_hir = true;
+            } else if (arg == "--emit-mir") {
+                if (emit_hir || emit_asm || emit_obj) {
+                    mini::FatalError(
+                        "cannot use --emit-mir with --emit-hir, -S and -c");
+                }
+                emit_mir = true;
             } else if (arg == "-S") {
-                if (emit_hir || emit_obj) {
-                    mini::FatalError("cannot use -S with --emit-hir and -c");
+                if (emit_hir || emit_mir || emit_obj) {
+                    mini::FatalError(
+                        "cannot use -S with --emit-hir, --emit-mir and -c");
                 }
                 emit_asm = true;
             } else if (arg == "-c") {
-                if (emit_asm || emit_asm) {
-                    mini::FatalError("cannot use -c with --emit-hir and -S");
+                if (emit_hir || emit_mir || emit_asm) {
+                    mini::FatalError(
+                        "cannot use -c with --emit-hir, --emit-mir and -S");
                 }
                 emit_obj = true;
             } else if (arg == "-o") {
@@ -90,163 +190,476 @@ public:
                 } else {
                     mini::FatalError("expect output filename after -o");
                 }
+            } else if (arg == "-j") {
+                char *end = nullptr;
+                if (i < argc - 1) jobs = std::strtoull(argv[++i], &end, 10);
+                if (!end || *end != '\0' || jobs == 0) {
+                    mini::FatalError("expect number of jobs after -j");
+                }
             } else if (arg == "-h") {
                 print_help = true;
+            } else if (arg == "--stats") {
+                stats = true;
+            } else if (arg == "--no-cache") {
+                use_cache = false;
+            } else if (startwith("--cache-dir=", arg)) {
+                cache_dir = arg.substr(std::string("--cache-dir=").size());
+                if (cache_dir.empty()) {
+                    mini::FatalError("expect directory after --cache-dir=");
+                }
+            } else if (startwith("--cache-max-size=", arg)) {
+                if (!parse_size(
+                        arg.substr(std::string("--cache-max-size=").size()),
+                        cache_max_size)) {
+                    mini::FatalError("expect size after --cache-max-size=");
+                }
+            } else if (arg == "--cache-stats") {
+                cache_stats = true;
+            } else if (arg == "--dce-stats") {
+                dce_stats = true;
+            } else if (arg == "--fold-stats") {
+                fold_stats = true;
+            } else if (arg == "--gvn-stats") {
+                gvn_stats = true;
+            } else if (arg == "--inline-report") {
+                inline_report = true;
+            } else if (arg == "--licm-stats") {
+                licm_stats = true;
+            } else if (arg == "--peephole-stats") {
+                peephole_stats = true;
+            } else if (arg == "--tail-call-report") {
+                tail_call_report = true;
+            } else if (arg == "--time-passes") {
+                time_passes = TimePasses::Table;
+            } else if (arg == "--time-passes=json") {
+                time_passes = TimePasses::Json;
             } else if (startwith("--", arg) || startwith("-", arg)) {
                 usage(std::cerr, UsageKind::UnknownOption);
             } else {
-                if (input) {
+                if (std::find(inputs.begin(), inputs.end(), arg) !=
+                    inputs.end()) {
                     usage(std::cerr, UsageKind::DuplicatedInput);
-                } else {
-                    input.emplace(argv[i]);
                 }
+                inputs.push_back(arg);
             }
         }
-        if (!input && !print_help) {
+        if (inputs.empty() && !print_help && !cache_stats) {
             usage(std::cerr, UsageKind::NoInputFile);
+        } else if (inputs.size() > 1 && output &&
+                   (emit_hir || emit_mir || emit_asm || emit_obj)) {
+            mini::FatalError(
+                "cannot use -o with multiple inputs and --emit-hir, "
+                "--emit-mir, -S or -c");
         } else {
-            input_ = input ? input.value() : "";
+            inputs_ = std::move(inputs);
+            jobs_ = jobs;
             output_ = output;
             emit_hir_ = emit_hir;
+            emit_mir_ = emit_mir;
             emit_asm_ = emit_asm;
             emit_obj_ = emit_obj;
             print_help_ = print_help;
+            stats_ = stats;
+            use_cache_ = use_cache;
+            cache_dir_ = std::move(cache_dir);
+            cache_max_size_ = cache_max_size;
+            cache_stats_ = cache_stats;
+            dce_stats_ = dce_stats;
+            fold_stats_ = fold_stats;
+            gvn_stats_ = gvn_stats;
+            inline_report_ = inline_report;
+            licm_stats_ = licm_stats;
+            peephole_stats_ = peephole_stats;
+            tail_call_report_ = tail_call_report;
+            time_passes_ = time_passes;
         }
     }
-    const std::string &input() const { return input_; }
+    const std::vector<std::string> &inputs() const { return inputs_; }
+    size_t jobs() const { return jobs_; }
     const std::optional<std::string> &output() const { return output_; }
     bool emit_hir() const { return emit_hir_; }
+    bool emit_mir() const { return emit_mir_; }
     bool emit_asm() const { return emit_asm_; }
     bool emit_obj() const { return emit_obj_; }
     bool print_help() const { return print_help_; }
+    bool stats() const { return stats_; }
+    bool use_cache() const { return use_cache_; }
+    const std::string &cache_dir() const { return cache_dir_; }
+    uint64_t cache_max_size() const { return cache_max_size_; }
+    bool cache_stats() const { return cache_stats_; }
+    bool dce_stats() const { return dce_stats_; }
+    bool fold_stats() const { return fold_stats_; }
+    bool gvn_stats() const { return gvn_stats_; }
+    bool inline_report() const { return inline_report_; }
+    bool licm_stats() const { return licm_stats_; }
+    bool peephole_stats() const { return peephole_stats_; }
+    bool tail_call_report() const { return tail_call_report_; }
+    TimePasses time_passes() const { return time_passes_; }
 
 private:
-    std::string input_;
+    std::vector<std::string> inputs_;
+    size_t jobs_;
     std::optional<std::string> output_;
     bool emit_hir_;
+    bool emit_mir_;
     bool emit_asm_;
     bool emit_obj_;
     bool print_help_;
+    bool stats_;
+    bool use_cache_;
+    std::string cache_dir_;
+    uint64_t cache_max_size_;
+    bool cache_stats_;
+    bool dce_stats_;
+    bool fold_stats_;
+    bool gvn_stats_;
+    bool inline_report_;
+    bool licm_stats_;
+    bool peephole_stats_;
+    bool tail_call_report_;
+    TimePasses time_passes_;
 };
 
-static void gen_hir(const std::string &input, const std::string &output) {
-    mini::Context ctx;
+static void print_stats(mini::Context &ctx, const std::string &prefix) {
+    for (const mini::Arena *arena : {&ctx.ast_arena(), &ctx.hir_arena()}) {
+        std::cerr << prefix
+                  << fmt::format(
+                         "{} arena: {} bytes allocated, {} bytes reserved in "
+                         "{} blocks",
+                         arena->name(), arena->bytes_allocated(),
+                         arena->bytes_reserved(), arena->block_count())
+                  << std::endl;
+    }
+}
+
+static void print_cache_stats(const Arguments &args) {
+    mini::ObjectCache cache(std::string(args.cache_dir()),
+                            args.cache_max_size());
+    auto stats = cache.TotalStats();
+    size_t objects;
+    uint64_t bytes;
+    cache.Usage(objects, bytes);
+    std::cout << fmt::format("cache directory: {}", cache.dir()) << std::endl;
+    std::cout << fmt::format("hits: {}, misses: {}", stats.hits, stats.misses)
+              << std::endl;
+    std::cout << fmt::format("objects: {}, {} bytes of {} bytes", objects,
+                             bytes, cache.max_size())
+              << std::endl;
+}
+
+static size_t file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? st.st_size : 0;
+}
+
+static bool gen_hir(mini::Context &ctx, const std::string &input,
+                    const std::string &output) {
     auto root = mini::HirGenFile(ctx, input);
-    if (!root) std::exit(EXIT_FAILURE);
+    if (!root) return false;
 
     std::ofstream ofs(output);
     if (ofs.bad()) mini::FatalError("failed to open output file");
 
     mini::hir::PrintableContext pctx(ofs, 4);
     root->PrintLn(pctx);
+    return true;
 }
 
-static void gen_asm(const std::string &input, const std::string &output) {
+static bool gen_mir(mini::Context &ctx, const std::string &input,
+                    const std::string &output) {
     std::ofstream ofs(output);
     if (ofs.bad()) mini::FatalError("failed to open output file");
 
+    return mini::EmitMirFile(ctx, ofs, input);
+}
+
+static bool gen_asm(mini::Context &ctx, const std::string &input,
+                    const std::string &output) {
+    std::ofstream ofs(output);
+    if (ofs.bad()) mini::FatalError("failed to open output file");
+
+    return mini::CodeGenFile(ctx, ofs, input);
+}
+
+// Runs a program found in PATH with `args`, without shell, and waits for it.
+// Returns nonzero if it couldn't run or failed.
+static int run(const std::vector<std::string> &args) {
+    std::vector<char *> argv;
+    for (const auto &arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ)) {
+        return -1;
+    }
+    int status;
+    if (waitpid(pid, &status, 0) == -1) return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Entry point of executables, which exits with the result of main.
+static constexpr std::string_view start_asm =
+    "    .text\n"
+    "    .global _start\n"
+    "_start:\n"
+    "    callq main\n"
+    "    movq %rax, %rdi\n"
+    "    movq $60, %rax\n"
+    "    syscall\n";
+
+// Assembles `source` into an object file.
+static std::string assemble(mini::Context &ctx, std::string_view source) {
+    mini::PassScope pass(ctx.pass_timer(), "assemble");
+    auto obj = mini::assembler::Assemble(source);
+
+    std::ostringstream os;
+    mini::assembler::WriteElf(obj, os);
+    pass.SetOutputBytes(os.tellp());
+    return std::move(os).str();
+}
+
+static void write_file(const std::string &output, std::string_view contents) {
+    std::ofstream ofs(output, std::ios::binary);
+    if (ofs.bad()) mini::FatalError("failed to open output file");
+    ofs.write(contents.data(), contents.size());
+}
+
+// Creates an in-memory file, and returns the path to it. Child processes can
+// open it with the same path, as they inherit the descriptor.
+static std::string memory_file(const char *name, std::vector<int> &fds) {
+    int fd = memfd_create(name, 0);
+    if (fd == -1) mini::FatalError("failed to create temporary file");
+    fds.push_back(fd);
+    return fmt::format("/proc/self/fd/{}", fd);
+}
+
+// An input file compiled on its own, with its own context.
+struct Unit {
+    std::string input;
+    std::string output;
     mini::Context ctx;
-    auto success = mini::CodeGenFile(ctx, ofs, input);
-    if (!success) std::exit(EXIT_FAILURE);
+    std::ostringstream diagnostics;
+    bool success = false;
+};
+
+// Compiles a unit to an object, or takes it from `cache` if not null. Cached
+// objects are hardlinked to `output` if `link`.
+static bool gen_obj(Unit &unit, mini::ObjectCache *cache, bool link) {
+    size_t id = unit.ctx.input_cache().Cache(unit.input);
+    std::string key;
+    if (cache) {
+        mini::PassScope pass(unit.ctx.pass_timer(), "cache");
+        // No option changes generated code but whether the unit is the whole
+        // program, whose object has fewer functions and symbols. The compiler
+        // itself is a part of every key.
+        key = cache->Key(unit.ctx.input_cache().Fetch(id).contents(),
+                         unit.ctx.whole_program() ? "whole-program" : "");
+        if (cache->Fetch(key, unit.output, link)) return true;
+    }
+
+    std::ostringstream os;
+    if (!mini::CodeGen(unit.ctx, os, id)) return false;
+    auto obj = assemble(unit.ctx, os.str());
+    // Output may be a hardlink to a cached object, which must not change.
+    if (link) unlink(unit.output.c_str());
+    write_file(unit.output, obj);
+
+    // Warnings are not reproduced from cached objects, so such units are
+    // compiled every time.
+    if (cache && unit.diagnostics.tellp() == 0) cache->Store(key, obj);
+    return true;
+}
+
+// Runs `compile` on each unit, using up to `jobs` threads. Diagnostics of each
+// unit are buffered so that they don't interleave.
+template <typename F>
+static void compile_all(std::vector<std::unique_ptr<Unit>> &units, size_t jobs,
+                        F compile) {
+    std::atomic<size_t> next = 0;
+    auto worker = [&] {
+        for (size_t i; (i = next++) < units.size();) {
+            auto &unit = *units[i];
+            unit.ctx.SetReportStream(unit.diagnostics);
+            unit.success = compile(unit);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(jobs, units.size()); i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) thread.join();
 }
 
 int main(int argc, char *argv[]) {
     Arguments args(argc, argv);
-    if (args.print_help()) {
-        usage(std::cout, UsageKind::Normal);
-    } else if (args.emit_hir()) {
-        std::string output = args.output()
-                                 ? args.output().value()
-                                 : replace_suffix(args.input(), "hir");
-        gen_hir(args.input(), output);
-    } else if (args.emit_asm()) {
-        std::string output = args.output() ? args.output().value()
-                                           : replace_suffix(args.input(), "s");
-        gen_asm(args.input(), output);
-    } else {
-        char asm_file[] = "/tmp/mini-XXXXXX.s";
-        char obj_file[] = "/tmp/mini-XXXXXX.o";
-        std::string output;
-        if (args.output()) {
-            output = args.output().value();
-        } else if (args.emit_obj()) {
-            output = replace_suffix(args.input(), "o");
+    if (args.print_help()) usage(std::cout, UsageKind::Normal);
+    if (args.cache_stats()) {
+        print_cache_stats(args);
+        return EXIT_SUCCESS;
+    }
+
+    // Passes of each unit are summed up into this context.
+    mini::Context ctx;
+    bool time_passes = args.time_passes() != TimePasses::None;
+    if (time_passes) ctx.pass_timer().Enable();
+
+    bool link = !args.emit_hir() && !args.emit_mir() && !args.emit_asm() &&
+                !args.emit_obj();
+    std::vector<int> fds;
+    std::vector<std::unique_ptr<Unit>> units;
+    for (const auto &input : args.inputs()) {
+        auto unit = std::make_unique<Unit>();
+        unit->input = input;
+        if (time_passes) unit->ctx.pass_timer().Enable();
+        if (link && args.inputs().size() == 1) unit->ctx.SetWholeProgram();
+        if (link) {
+            // Objects only live in memory until linked.
+            unit->output = memory_file("mini.o", fds);
+        } else if (args.output()) {
+            unit->output = args.output().value();
+        } else if (args.emit_hir()) {
+            unit->output = replace_suffix(input, "hir");
+        } else if (args.emit_mir()) {
+            unit->output = replace_suffix(input, "mir");
+        } else if (args.emit_asm()) {
+            unit->output = replace_suffix(input, "s");
         } else {
-            output = "a.out";
+            unit->output = replace_suffix(input, "o");
         }
+        units.push_back(std::move(unit));
+    }
 
-        int asm_fd = mkstemps(asm_file, 2);
-        if (asm_fd == -1) mini::FatalError("failed to create temporary file");
+    // Only objects are cached, and optimizations are counted only when
+    // compiled.
+    std::optional<mini::ObjectCache> cache;
+    if (args.use_cache() && !args.dce_stats() && !args.fold_stats() &&
+        !args.gvn_stats() && !args.inline_report() && !args.licm_stats() &&
+        !args.peephole_stats() && !args.tail_call_report() &&
+        !args.emit_hir() && !args.emit_mir() && !args.emit_asm()) {
+        cache.emplace(std::string(args.cache_dir()), args.cache_max_size());
+    }
 
-        int obj_fd = mkstemps(obj_file, 2);
-        if (obj_fd == -1) mini::FatalError("failed to create temporary file");
+    compile_all(units, args.jobs(), [&](Unit &unit) {
+        if (args.emit_hir()) {
+            return gen_hir(unit.ctx, unit.input, unit.output);
+        } else if (args.emit_mir()) {
+            return gen_mir(unit.ctx, unit.input, unit.output);
+        } else if (args.emit_asm()) {
+            return gen_asm(unit.ctx, unit.input, unit.output);
+        } else {
+            // Memory files of link mode cannot be hardlinked.
+            return gen_obj(unit, cache ? &*cache : nullptr, !link);
+        }
+    });
+    if (cache) cache->Finish();
 
-        gen_asm(args.input(), asm_file);
+    bool success = true;
+    for (const auto &unit : units) {
+        std::cerr << unit->diagnostics.str();
+        success &= unit->success;
+        ctx.pass_timer().Merge(unit->ctx.pass_timer());
+    }
+    if (!success) std::exit(EXIT_FAILURE);
 
-        if (args.emit_obj()) {
-            int as_result =
-                system(fmt::format("as {} -o {}", asm_file, output).c_str());
-            if (as_result) {
-                close(asm_fd);
-                close(obj_fd);
-                mini::FatalError("as failed");
-            }
-        } else {
-            char start_asm_file[] = "/tmp/mini-XXXXXX.s";
-            char start_obj_file[] = "/tmp/mini-XXXXXX.o";
-            int start_asm_fd = mkstemps(start_asm_file, 2);
-            if (start_asm_fd == -1)
-                mini::FatalError("failed to create temporary file");
-            int start_obj_fd = mkstemps(start_obj_file, 2);
-            if (start_obj_fd == -1)
-                mini::FatalError("failed to create temporary file");
-
-            std::ofstream start(start_asm_file);
-            start << "    .text" << std::endl;
-            start << "    .global _start" << std::endl;
-            start << "_start:" << std::endl;
-            start << "    callq main" << std::endl;
-            start << "    movq %rax, %rdi" << std::endl;
-            start << "    movq $60, %rax" << std::endl;
-            start << "    syscall" << std::endl;
-
-            int as_result = system(
-                fmt::format("as {} -o {}", start_asm_file, start_obj_file)
-                    .c_str());
-            if (as_result) {
-                close(asm_fd);
-                close(obj_fd);
-                close(start_asm_fd);
-                close(start_obj_fd);
-                mini::FatalError("as failed");
-            }
+    if (link) {
+        std::string output = args.output() ? args.output().value() : "a.out";
+        std::string start_file = memory_file("start.o", fds);
+        write_file(start_file, assemble(ctx, start_asm));
 
-            as_result =
-                system(fmt::format("as {} -o {}", asm_file, obj_file).c_str());
-            if (as_result) {
-                close(asm_fd);
-                close(obj_fd);
-                close(start_asm_fd);
-                close(start_obj_fd);
-                mini::FatalError("as failed");
-            }
+        mini::PassScope pass(ctx.pass_timer(), "link");
+        std::vector<std::string> ld_args = {
+            "ld", "-dynamic-linker", "/lib64/ld-linux-x86-64.so.2", "-lc"};
+        for (const auto &unit : units) ld_args.push_back(unit->output);
+        ld_args.insert(ld_args.end(), {start_file, "-o", output});
+        int ld_result = run(ld_args);
+        for (int fd : fds) close(fd);
+        if (ld_result) mini::FatalError("ld failed");
+        pass.SetOutputBytes(file_size(output.c_str()));
+    }
 
-            int ld_result = system(
-                fmt::format("ld -dynamic-linker "
-                            "/lib64/ld-linux-x86-64.so.2 -lc {} {} -o {}",
-                            obj_file, start_obj_file, output)
-                    .c_str());
-
-            close(start_asm_fd);
-            close(start_obj_fd);
-            if (ld_result) {
-                close(asm_fd);
-                close(obj_fd);
-                mini::FatalError("ld failed");
+    if (args.stats()) {
+        if (cache) {
+            auto stats = cache->stats();
+            std::cerr << fmt::format("object cache: {} hits, {} misses",
+                                     stats.hits, stats.misses)
+                      << std::endl;
+        }
+        for (const auto &unit : units) {
+            print_stats(unit->ctx,
+                        units.size() > 1 ? unit->input + ": " : "");
+        }
+    }
+    if (args.dce_stats()) {
+        for (const auto &unit : units) {
+            const auto &stats = unit->ctx.opt_stats();
+            std::cerr << (units.size() > 1 ? unit->input + ": " : "")
+                      << fmt::format(
+                             "dead code: {} statements, {} functions removed",
+                             stats.dead_statements, stats.dead_functions)
+                      << std::endl;
+        }
+    }
+    if (args.fold_stats()) {
+        for (const auto &unit : units) {
+            std::cerr << (units.size() > 1 ? unit->input + ": " : "")
+                      << fmt::format("constant folding: {} nodes eliminated",
+                                     unit->ctx.opt_stats().folded_nodes)
+                      << std::endl;
+        }
+    }
+    if (args.gvn_stats()) {
+        for (const auto &unit : units) {
+            std::cerr << (units.size() > 1 ? unit->input + ": " : "")
+                      << fmt::format("gvn: {} instructions replaced",
+                                     unit->ctx.opt_stats().replaced_insts)
+                      << std::endl;
+        }
+    }
+    if (args.inline_report()) {
+        for (const auto &unit : units) {
+            for (const auto &line : unit->ctx.opt_stats().inline_report) {
+                std::cerr << (units.size() > 1 ? unit->input + ": " : "")
+                          << line << std::endl;
             }
         }
-
-        close(asm_fd);
-        close(obj_fd);
+    }
+    if (args.licm_stats()) {
+        for (const auto &unit : units) {
+            std::cerr << (units.size() > 1 ? unit->input + ": " : "")
+                      << fmt::format("licm: {} instructions hoisted",
+                                     unit->ctx.opt_stats().hoisted_insts)
+                      << std::endl;
+        }
+    }
+    if (args.peephole_stats()) {
+        for (const auto &unit : units) {
+            auto counts = unit->ctx.opt_stats().peephole_rewrites;
+            counts.resize(mini::peephole_rule_count, 0);
+            for (size_t i = 0; i < counts.size(); i++) {
+                auto rule = static_cast<mini::PeepholeRule>(i);
+                std::cerr << (units.size() > 1 ? unit->input + ": " : "")
+                          << fmt::format("peephole {}: {} rewrites",
+                                         mini::PeepholeRuleName(rule),
+                                         counts[i])
+                          << std::endl;
+            }
+        }
+    }
+    if (args.tail_call_report()) {
+        for (const auto &unit : units) {
+            for (const auto &line : unit->ctx.opt_stats().tail_call_report) {
+                std::cerr << (units.size() > 1 ? unit->input + ": " : "")
+                          << line << std::endl;
+            }
+        }
+    }
+    if (args.time_passes() == TimePasses::Table) {
+        ctx.pass_timer().PrintTable(std::cerr);
+    } else if (args.time_passes() == TimePasses::Json) {
+        ctx.pass_timer().PrintJson(std::cerr);
     }
 }
@@ -0,0 +1,315 @@
+#include "builder.h"
+
+#include <utility>
+
+#include "../panic.h"
+
+namespace mini {
+
+namespace mir {
+
+Builder::Builder(Function &func) : func_(func) {
+    curr_ = NewBlock();
+    Seal(curr_);
+}
+
+BlockId Builder::NewBlock() {
+    auto block = func_.NewBlock();
+    sealed_.push_back(false);
+    preds_.emplace_back();
+    incomplete_phis_.emplace_back();
+    return block;
+}
+
+BlockId Builder::NewUnreachableBlock() {
+    auto block = NewBlock();
+    Seal(block);
+    return block;
+}
+
+void Builder::Seal(BlockId block) {
+    if (sealed_[block]) return;
+    // Incomplete phis may grow while reading operands of others.
+    for (size_t i = 0; i < incomplete_phis_[block].size(); i++) {
+        AddPhiOperands(phis_[incomplete_phis_[block][i]]);
+    }
+    incomplete_phis_[block].clear();
+    sealed_[block] = true;
+}
+
+Builder::Variable Builder::NewVariable(Type type) {
+    var_types_.push_back(type);
+    defs_.emplace_back();
+    return var_types_.size() - 1;
+}
+
+void Builder::WriteVariable(Variable var, Value value) {
+    defs_[var][curr_] = value;
+}
+
+Value Builder::ReadVariable(Variable var) { return ReadVariable(var, curr_); }
+
+Value Builder::ReadVariable(Variable var, BlockId block) {
+    if (auto it = defs_[var].find(block); it != defs_[var].end()) {
+        return it->second;
+    }
+
+    Value value;
+    if (!sealed_[block]) {
+        value = NewPhi(var, block);
+        incomplete_phis_[block].push_back(phis_.size() - 1);
+    } else if (preds_[block].empty()) {
+        value = Undefined(var_types_[var]);
+    } else if (preds_[block].size() == 1) {
+        value = ReadVariable(var, preds_[block][0]);
+    } else {
+        // Written before reading operands to break cycles of loops.
+        value = NewPhi(var, block);
+        defs_[var][block] = value;
+        AddPhiOperands(phis_.back());
+    }
+    defs_[var][block] = value;
+    return value;
+}
+
+Value Builder::NewPhi(Variable var, BlockId block) {
+    auto dst = func_.NewValue(var_types_[var]);
+    phis_.push_back({dst, block, var, {}, {}});
+    return dst;
+}
+
+void Builder::AddPhiOperands(Phi &phi) {
+    // `phi` may be moved as reading operands creates phis.
+    auto index = &phi - phis_.data();
+    auto preds = preds_[phi.block];
+    for (auto pred : preds) {
+        auto value = ReadVariable(phis_[index].var, pred);
+        phis_[index].args.push_back(value);
+        phis_[index].preds.push_back(pred);
+    }
+}
+
+// Defined at the beginning of the entry block so that it dominates any use.
+Value Builder::Undefined(Type type) {
+    Instruction inst{Opcode::Const, type, func_.NewValue(type)};
+    auto &insts = func_.blocks()[0].insts;
+    auto pos = insts.begin();
+    while (pos != insts.end() && pos->op == Opcode::Arg) pos++;
+    insts.insert(pos, inst);
+    return inst.dst;
+}
+
+Value Builder::Emit(Instruction &&inst) {
+    auto &insts = func_.blocks()[curr_].insts;
+    if (!insts.empty() && IsTerminator(insts.back().op)) {
+        FatalError("instruction after terminator in bb{}", curr_);
+    }
+    auto dst = inst.dst;
+    insts.push_back(std::move(inst));
+    return dst;
+}
+
+void Builder::AddEdge(BlockId from, BlockId to) {
+    if (sealed_[to]) FatalError("edge to sealed block bb{}", to);
+    preds_[to].push_back(from);
+}
+
+Value Builder::Const(Type type, int64_t value) {
+    Instruction inst{Opcode::Const, type, func_.NewValue(type)};
+    inst.imm = value;
+    consts_.emplace(inst.dst, value);
+    return Emit(std::move(inst));
+}
+
+Value Builder::Arg(Type type, int64_t index) {
+    Instruction inst{Opcode::Arg, type, func_.NewValue(type)};
+    inst.imm = index;
+    return Emit(std::move(inst));
+}
+
+Value Builder::SlotAddr(uint32_t slot) {
+    Instruction inst{Opcode::SlotAddr, Type::I64, func_.NewValue(Type::I64)};
+    inst.imm = slot;
+    return Emit(std::move(inst));
+}
+
+Value Builder::StrAddr(Symbol symbol) {
+    Instruction inst{Opcode::StrAddr, Type::I64, func_.NewValue(Type::I64)};
+    inst.symbol = symbol;
+    return Emit(std::move(inst));
+}
+
+Value Builder::Binary(Opcode op, Value lhs, Value rhs) {
+    auto type = func_.TypeOf(lhs);
+    Instruction inst{op, type, func_.NewValue(type)};
+    inst.args = {lhs, rhs};
+    return Emit(std::move(inst));
+}
+
+Value Builder::Unary(Opcode op, Value value) {
+    auto type = func_.TypeOf(value);
+    Instruction inst{op, type, func_.NewValue(type)};
+    inst.args = {value};
+    return Emit(std::move(inst));
+}
+
+Value Builder::Compare(Opcode op, Value lhs, Value rhs) {
+    Instruction inst{op, Type::I8, func_.NewValue(Type::I8)};
+    inst.args = {lhs, rhs};
+    return Emit(std::move(inst));
+}
+
+Value Builder::Convert(Value value, Type type, bool is_signed) {
+    auto from = func_.TypeOf(value);
+    if (from == type) return value;
+
+    if (auto it = consts_.find(value); it != consts_.end()) {
+        auto shift = 64 - SizeOf(from) * 8;
+        auto imm = static_cast<uint64_t>(it->second) << shift;
+        imm = is_signed ? static_cast<int64_t>(imm) >> shift : imm >> shift;
+        if (SizeOf(type) < 8) imm &= (uint64_t(1) << SizeOf(type) * 8) - 1;
+        return Const(type, imm);
+    }
+
+    Opcode op;
+    if (SizeOf(from) > SizeOf(type)) {
+        op = Opcode::Trunc;
+    } else {
+        op = is_signed ? Opcode::SExt : Opcode::ZExt;
+    }
+    Instruction inst{op, type, func_.NewValue(type)};
+    inst.args = {value};
+    return Emit(std::move(inst));
+}
+
+Value Builder::Load(Type type, Value addr) {
+    Instruction inst{Opcode::Load, type, func_.NewValue(type)};
+    inst.args = {addr};
+    return Emit(std::move(inst));
+}
+
+void Builder::Store(Value addr, Value value) {
+    Instruction inst{Opcode::Store, func_.TypeOf(value)};
+    inst.args = {addr, value};
+    Emit(std::move(inst));
+}
+
+void Builder::MemCopy(Value dst, Value src, uint64_t size) {
+    Instruction inst{Opcode::MemCopy};
+    inst.args = {dst, src};
+    inst.imm = size;
+    Emit(std::move(inst));
+}
+
+Value Builder::Call(Symbol callee, bool outer, std::vector<Value> &&args,
+                    std::optional<Type> ret) {
+    Instruction inst{Opcode::Call};
+    if (ret) {
+        inst.type = *ret;
+        inst.dst = func_.NewValue(*ret);
+    }
+    inst.args = std::move(args);
+    inst.symbol = callee;
+    inst.outer = outer;
+    return Emit(std::move(inst));
+}
+
+void Builder::Jump(BlockId target) {
+    Instruction inst{Opcode::Jump};
+    inst.targets = {target};
+    Emit(std::move(inst));
+    AddEdge(curr_, target);
+}
+
+void Builder::Branch(Value cond, BlockId then_block, BlockId else_block) {
+    Instruction inst{Opcode::Branch};
+    inst.args = {cond};
+    inst.targets = {then_block, else_block};
+    Emit(std::move(inst));
+    AddEdge(curr_, then_block);
+    AddEdge(curr_, else_block);
+}
+
+void Builder::Return(std::optional<Value> value) {
+    Instruction inst{Opcode::Return};
+    if (value) inst.args = {*value};
+    Emit(std::move(inst));
+}
+
+void Builder::Finish() {
+    auto &blocks = func_.blocks();
+    for (BlockId id = 0; id < blocks.size(); id++) Seal(id);
+
+    // Place phis before other instructions, in the order of creation.
+    std::vector<std::vector<Instruction>> phis(blocks.size());
+    for (auto &phi : phis_) {
+        Instruction inst{Opcode::Phi, var_types_[phi.var], phi.dst};
+        inst.args = std::move(phi.args);
+        inst.targets = std::move(phi.preds);
+        phis[phi.block].push_back(std::move(inst));
+    }
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        auto &insts = blocks[id].insts;
+        insts.insert(insts.begin(), std::make_move_iterator(phis[id].begin()),
+                     std::make_move_iterator(phis[id].end()));
+        blocks[id].preds = std::move(preds_[id]);
+    }
+    phis_.clear();
+
+    RemoveUnreachableBlocks(func_);
+    RemoveTrivialPhis();
+
+    for (auto &block : blocks) {
+        for (auto &inst : block.insts) {
+            for (auto &arg : inst.args) arg = Resolve(arg);
+        }
+    }
+}
+
+Value Builder::Resolve(Value value) {
+    auto it = aliases_.find(value);
+    if (it == aliases_.end()) return value;
+    auto resolved = Resolve(it->second);
+    it->second = resolved;
+    return resolved;
+}
+
+// A phi is trivial if it merges only one value besides itself. Removing it
+// may make phis using it trivial, so this runs until nothing changes.
+void Builder::RemoveTrivialPhis() {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto &block : func_.blocks()) {
+            auto &insts = block.insts;
+            size_t kept = 0, i = 0;
+            for (; i < insts.size() && insts[i].op == Opcode::Phi; i++) {
+                auto &phi = insts[i];
+                auto same = no_value;
+                bool trivial = true;
+                for (auto &arg : phi.args) {
+                    arg = Resolve(arg);
+                    if (arg == same || arg == phi.dst) continue;
+                    if (same != no_value) {
+                        trivial = false;
+                        break;
+                    }
+                    same = arg;
+                }
+                if (trivial) {
+                    aliases_[phi.dst] =
+                        same == no_value ? Undefined(phi.type) : same;
+                    changed = true;
+                } else {
+                    if (kept != i) insts[kept] = std::move(phi);
+                    kept++;
+                }
+            }
+            insts.erase(insts.begin() + kept, insts.begin() + i);
+        }
+    }
+}
+
+}  // namespace mir
+
+}  // namespace mini
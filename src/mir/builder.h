@@ -0,0 +1,117 @@
+#ifndef MINI_MIR_BUILDER_H_
+#define MINI_MIR_BUILDER_H_
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "mir.h"
+
+namespace mini {
+
+namespace mir {
+
+// Appends instructions to a function, and constructs SSA form from reads and
+// writes of variables while doing it, as in "Simple and Efficient
+// Construction of Static Single Assignment Form" by Braun et al.
+//
+// A block must be sealed once all of its predecessors are known. Reading a
+// variable in an unsealed block places an incomplete phi, which is completed
+// when the block is sealed. Reading a variable never written gives 0.
+class Builder {
+public:
+    using Variable = uint32_t;
+
+    explicit Builder(Function &func);
+
+    inline Function &func() { return func_; }
+
+    // Creates a block, which must be sealed later.
+    BlockId NewBlock();
+
+    // Creates a block with no predecessor to place unreachable code, such as
+    // statements after `return`.
+    BlockId NewUnreachableBlock();
+
+    // Appends instructions to `block` from now.
+    inline void SwitchTo(BlockId block) { curr_ = block; }
+    inline BlockId curr() const { return curr_; }
+
+    // Declares that no predecessor is added to `block` anymore.
+    void Seal(BlockId block);
+
+    Variable NewVariable(Type type);
+    void WriteVariable(Variable var, Value value);
+    Value ReadVariable(Variable var);
+
+    Value Const(Type type, int64_t value);
+    Value Arg(Type type, int64_t index);
+    Value SlotAddr(uint32_t slot);
+    Value StrAddr(Symbol symbol);
+    Value Binary(Opcode op, Value lhs, Value rhs);
+    Value Unary(Opcode op, Value value);
+    Value Compare(Opcode op, Value lhs, Value rhs);
+
+    // Converts `value` to `type` by sign or zero extension, or truncation.
+    // Returns `value` itself if it already has `type`, and a new constant if
+    // `value` is a constant.
+    Value Convert(Value value, Type type, bool is_signed);
+
+    Value Load(Type type, Value addr);
+    void Store(Value addr, Value value);
+    void MemCopy(Value dst, Value src, uint64_t size);
+    Value Call(Symbol callee, bool outer, std::vector<Value> &&args,
+               std::optional<Type> ret);
+
+    void Jump(BlockId target);
+    void Branch(Value cond, BlockId then_block, BlockId else_block);
+    void Return(std::optional<Value> value);
+
+    // Places phis into blocks, removes unreachable blocks and phis whose
+    // incoming values are all the same, and replaces uses of removed phis.
+    // No instructions can be added after this.
+    void Finish();
+
+private:
+    struct Phi {
+        Value dst;
+        BlockId block;
+        Variable var;
+        std::vector<Value> args;
+        std::vector<BlockId> preds;
+    };
+
+    Value Emit(Instruction &&inst);
+    void AddEdge(BlockId from, BlockId to);
+    Value ReadVariable(Variable var, BlockId block);
+    Value NewPhi(Variable var, BlockId block);
+    void AddPhiOperands(Phi &phi);
+    Value Undefined(Type type);
+    Value Resolve(Value value);
+    void RemoveTrivialPhis();
+
+    Function &func_;
+    BlockId curr_;
+    std::vector<bool> sealed_;
+    std::vector<std::vector<BlockId>> preds_;
+    std::vector<Type> var_types_;
+
+    // Definition of each variable at the end of each block.
+    std::vector<std::unordered_map<BlockId, Value>> defs_;
+
+    std::vector<Phi> phis_;
+    std::vector<std::vector<size_t>> incomplete_phis_;  // For each block.
+
+    // Removed phis and the value which replaces them.
+    std::unordered_map<Value, Value> aliases_;
+
+    // Values of constants, to convert them without instructions.
+    std::unordered_map<Value, int64_t> consts_;
+};
+
+}  // namespace mir
+
+}  // namespace mini
+
+#endif  // MINI_MIR_BUILDER_H_
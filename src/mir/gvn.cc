@@ -0,0 +1,255 @@
+#include "gvn.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mini {
+
+namespace mir {
+
+namespace {
+
+// What an instruction computes. Instructions with equal keys compute the same
+// value.
+struct Key {
+    Opcode op;
+    Type type;
+    int64_t imm;
+    Symbol symbol;
+    std::vector<Value> args;
+
+    // For loads, which stores and calls happened before it.
+    uint64_t memory;
+
+    bool operator==(const Key &rhs) const {
+        return op == rhs.op && type == rhs.type && imm == rhs.imm &&
+               symbol == rhs.symbol && args == rhs.args &&
+               memory == rhs.memory;
+    }
+};
+
+struct KeyHash {
+    size_t operator()(const Key &key) const {
+        size_t h = std::hash<uint64_t>()(static_cast<uint64_t>(key.op) << 8 |
+                                         static_cast<uint64_t>(key.type));
+        auto mix = [&](uint64_t v) {
+            h ^= std::hash<uint64_t>()(v) + 0x9e3779b97f4a7c15 + (h << 6) +
+                 (h >> 2);
+        };
+        mix(key.imm);
+        mix(std::hash<Symbol>()(key.symbol));
+        for (auto arg : key.args) mix(arg);
+        mix(key.memory);
+        return h;
+    }
+};
+
+bool IsCommutative(Opcode op) {
+    switch (op) {
+        case Opcode::Add:
+        case Opcode::Mul:
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::Xor:
+        case Opcode::Eq:
+        case Opcode::Ne:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Whether the instruction only computes its result from operands, so that it
+// can be numbered, and removed if unused.
+bool IsPure(Opcode op) {
+    return op == Opcode::Const || op == Opcode::SlotAddr ||
+           op == Opcode::StrAddr || IsBinary(op) || IsUnary(op) ||
+           IsCompare(op) || IsConversion(op);
+}
+
+// Instructions without operands are not replaced, as using an earlier one
+// keeps it in a register for longer, but still numbered so that their users
+// are.
+bool IsCheap(Opcode op) {
+    return op == Opcode::Const || op == Opcode::SlotAddr ||
+           op == Opcode::StrAddr;
+}
+
+class ValueNumbering {
+public:
+    ValueNumbering(Function &func)
+        : func_(func),
+          numbers_(func.ValueCount()),
+          memory_(0),
+          replaced_(0) {
+        for (Value value = 0; value < numbers_.size(); value++) {
+            numbers_[value] = value;
+        }
+    }
+
+    size_t Run() {
+        auto idoms = ComputeIdoms(func_);
+        auto order = ReversePostorder(func_);
+        std::vector<std::vector<BlockId>> children(func_.blocks().size());
+        for (auto id : order) {
+            if (id != 0) children[idoms[id]].push_back(id);
+        }
+
+        // Walk the dominator tree, forgetting values of a subtree when
+        // leaving it. An entry with `leave` set marks the end of a subtree.
+        struct Entry {
+            BlockId id;
+            bool leave;
+            size_t scope;
+        };
+        std::vector<Key> scope;
+        std::vector<Entry> stack{{0, false, 0}};
+        while (!stack.empty()) {
+            auto entry = stack.back();
+            stack.pop_back();
+            if (entry.leave) {
+                while (scope.size() > entry.scope) {
+                    table_.erase(scope.back());
+                    scope.pop_back();
+                }
+                continue;
+            }
+
+            stack.push_back({entry.id, true, scope.size()});
+            NumberBlock(entry.id, scope);
+            const auto &succs = children[entry.id];
+            for (auto it = succs.rbegin(); it != succs.rend(); ++it) {
+                stack.push_back({*it, false, 0});
+            }
+        }
+
+        // Phis may use values of blocks visited after them.
+        for (auto &block : func_.blocks()) {
+            for (auto &inst : block.insts) {
+                for (auto &arg : inst.args) arg = numbers_[arg];
+            }
+        }
+        RemoveUnused();
+        return replaced_;
+    }
+
+private:
+    void NumberBlock(BlockId id, std::vector<Key> &scope) {
+        // Loads are not reused across blocks, as another path to this block
+        // may store.
+        memory_++;
+
+        auto &insts = func_.blocks()[id].insts;
+        size_t kept = 0;
+        for (size_t i = 0; i < insts.size(); i++) {
+            auto &inst = insts[i];
+            if (inst.op != Opcode::Phi) {
+                for (auto &arg : inst.args) arg = numbers_[arg];
+            }
+            if (inst.op == Opcode::Store || inst.op == Opcode::MemCopy ||
+                inst.op == Opcode::Call) {
+                memory_++;
+            }
+
+            if (IsPure(inst.op) || inst.op == Opcode::Load) {
+                // Users of cheap instructions are compared by the first one.
+                Key key{inst.op,     inst.type, inst.imm,
+                        inst.symbol, inst.args, 0};
+                for (auto &arg : key.args) arg = Canonical(arg);
+                if (IsCommutative(inst.op)) {
+                    std::sort(key.args.begin(), key.args.end());
+                }
+                if (inst.op == Opcode::Load) key.memory = memory_;
+
+                auto it = table_.find(key);
+                if (it == table_.end()) {
+                    table_.emplace(key, inst.dst);
+                    scope.push_back(std::move(key));
+                } else if (IsCheap(inst.op)) {
+                    canonical_.emplace(inst.dst, it->second);
+                } else {
+                    numbers_[inst.dst] = it->second;
+                    replaced_++;
+                    continue;
+                }
+            }
+
+            if (kept != i) insts[kept] = std::move(inst);
+            kept++;
+        }
+        insts.erase(insts.begin() + kept, insts.end());
+    }
+
+    Value Canonical(Value value) const {
+        auto it = canonical_.find(value);
+        return it == canonical_.end() ? value : it->second;
+    }
+
+    void RemoveUnused() {
+        auto &blocks = func_.blocks();
+        std::vector<uint32_t> use_counts(func_.ValueCount(), 0);
+        for (const auto &block : blocks) {
+            for (const auto &inst : block.insts) {
+                for (auto arg : inst.args) use_counts[arg]++;
+            }
+        }
+
+        // Removing an instruction may leave its operands unused, which are
+        // defined earlier, so blocks are swept backward until nothing
+        // changes.
+        std::vector<bool> removed(func_.ValueCount(), false);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+                const auto &insts = it->insts;
+                for (auto inst = insts.rbegin(); inst != insts.rend(); ++inst) {
+                    if (inst->dst == no_value || removed[inst->dst] ||
+                        use_counts[inst->dst] ||
+                        !(IsPure(inst->op) || inst->op == Opcode::Load)) {
+                        continue;
+                    }
+                    for (auto arg : inst->args) use_counts[arg]--;
+                    removed[inst->dst] = true;
+                    changed = true;
+                }
+            }
+        }
+
+        for (auto &block : blocks) {
+            auto &insts = block.insts;
+            insts.erase(std::remove_if(insts.begin(), insts.end(),
+                                       [&](const Instruction &inst) {
+                                           return inst.dst != no_value &&
+                                                  removed[inst.dst];
+                                       }),
+                        insts.end());
+        }
+    }
+
+    Function &func_;
+
+    // The value each value is replaced with, which is itself if it's kept.
+    std::vector<Value> numbers_;
+
+    // The first of cheap instructions computing the same value.
+    std::unordered_map<Value, Value> canonical_;
+
+    std::unordered_map<Key, Value, KeyHash> table_;
+    uint64_t memory_;
+    size_t replaced_;
+};
+
+}  // namespace
+
+size_t NumberValues(Function &func) {
+    ValueNumbering gvn(func);
+    return gvn.Run();
+}
+
+}  // namespace mir
+
+}  // namespace mini
@@ -0,0 +1,28 @@
+#ifndef MINI_MIR_GVN_H_
+#define MINI_MIR_GVN_H_
+
+#include <cstddef>
+
+#include "mir.h"
+
+namespace mini {
+
+namespace mir {
+
+// Replaces instructions which compute the same value as one in a dominating
+// block with it, walking the dominator tree so that a value is reused
+// wherever it's available.
+//
+// Operands of commutative operations are ordered before comparing. A load is
+// reused only in the same block, and only if nothing is stored and no
+// function is called in between. Instructions left unused afterwards are
+// removed.
+//
+// Returns the number of replaced instructions.
+size_t NumberValues(Function &func);
+
+}  // namespace mir
+
+}  // namespace mini
+
+#endif  // MINI_MIR_GVN_H_
@@ -0,0 +1,255 @@
+#include "licm.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mini {
+
+namespace mir {
+
+namespace {
+
+// A natural loop, made of the header and blocks which reach a back edge to it
+// without going through the header.
+struct Loop {
+    BlockId header;
+    std::vector<bool> blocks;
+    size_t size;
+};
+
+class LoopInvariantMotion {
+public:
+    LoopInvariantMotion(Function &func)
+        : func_(func),
+          idoms_(ComputeIdoms(func)),
+          order_(ReversePostorder(func)),
+          def_blocks_(func.ValueCount(), no_block),
+          consts_(func.ValueCount()),
+          moved_(0) {
+        const auto &blocks = func_.blocks();
+        for (BlockId id = 0; id < blocks.size(); id++) {
+            for (const auto &inst : blocks[id].insts) {
+                if (inst.dst == no_value) continue;
+                def_blocks_[inst.dst] = id;
+                if (inst.op == Opcode::Const) consts_[inst.dst] = inst.imm;
+                if (IsCheap(inst.op)) cheap_.emplace(inst.dst, inst);
+            }
+        }
+    }
+
+    size_t Run() {
+        auto loops = FindLoops();
+
+        // Inner loops are smaller than loops containing them.
+        std::stable_sort(loops.begin(), loops.end(),
+                         [](const Loop &l1, const Loop &l2) {
+                             return l1.size < l2.size;
+                         });
+        for (const auto &loop : loops) Hoist(loop);
+        return moved_;
+    }
+
+private:
+    // Instructions without operands, which are as cheap to recompute as to
+    // keep in a register.
+    static bool IsCheap(Opcode op) {
+        return op == Opcode::Const || op == Opcode::SlotAddr ||
+               op == Opcode::StrAddr;
+    }
+
+    bool Dominates(BlockId b1, BlockId b2) const {
+        while (b1 != b2) {
+            if (b2 == 0 || idoms_[b2] == no_block) return false;
+            b2 = idoms_[b2];
+        }
+        return true;
+    }
+
+    std::vector<Loop> FindLoops() const {
+        const auto &blocks = func_.blocks();
+        std::vector<Loop> loops;
+        for (auto id : order_) {
+            for (auto succ : Successors(blocks[id])) {
+                if (!Dominates(succ, id)) continue;
+
+                // Loops sharing a header, such as by `continue`, are one.
+                auto it = std::find_if(
+                    loops.begin(), loops.end(),
+                    [&](const Loop &loop) { return loop.header == succ; });
+                if (it == loops.end()) {
+                    loops.push_back(
+                        {succ, std::vector<bool>(blocks.size(), false), 1});
+                    it = loops.end() - 1;
+                    it->blocks[succ] = true;
+                }
+
+                std::vector<BlockId> worklist{id};
+                while (!worklist.empty()) {
+                    auto block = worklist.back();
+                    worklist.pop_back();
+                    if (it->blocks[block]) continue;
+                    it->blocks[block] = true;
+                    it->size++;
+                    for (auto pred : blocks[block].preds) {
+                        worklist.push_back(pred);
+                    }
+                }
+            }
+        }
+        return loops;
+    }
+
+    // Returns the only block out of the loop which jumps to the header, if
+    // it jumps nowhere else.
+    std::optional<BlockId> Preheader(const Loop &loop) const {
+        std::optional<BlockId> preheader;
+        for (auto pred : func_.blocks()[loop.header].preds) {
+            if (loop.blocks[pred]) continue;
+            if (preheader) return std::nullopt;
+            preheader = pred;
+        }
+        if (!preheader ||
+            func_.blocks()[*preheader].terminator().op != Opcode::Jump) {
+            return std::nullopt;
+        }
+        return preheader;
+    }
+
+    // Whether dividing by `value` never faults, that is it's a constant other
+    // than 0 and -1.
+    bool IsSafeDivisor(Value value, Type type) const {
+        if (!consts_[value]) return false;
+        auto bits = SizeOf(type) * 8;
+        auto mask = bits == 64 ? UINT64_MAX : (uint64_t(1) << bits) - 1;
+        auto divisor = static_cast<uint64_t>(*consts_[value]) & mask;
+        return divisor != 0 && divisor != mask;
+    }
+
+    void Hoist(const Loop &loop) {
+        auto preheader = Preheader(loop);
+        if (!preheader) return;
+        auto &blocks = func_.blocks();
+
+        bool writes = false, calls = false;
+        std::vector<BlockId> exits;
+        for (auto id : order_) {
+            if (!loop.blocks[id]) continue;
+            for (const auto &inst : blocks[id].insts) {
+                if (inst.op == Opcode::Call) calls = true;
+                if (inst.op == Opcode::Store || inst.op == Opcode::MemCopy) {
+                    writes = true;
+                }
+            }
+            const auto &term = blocks[id].terminator();
+            bool exits_loop = term.op == Opcode::Return;
+            for (auto succ : term.targets) {
+                if (!loop.blocks[succ]) exits_loop = true;
+            }
+            if (exits_loop) exits.push_back(id);
+        }
+
+        // Whether `id` runs whenever the loop is entered. Any block of a loop
+        // never exited may not run, but the header.
+        auto always_runs = [&](BlockId id) {
+            if (id == loop.header) return true;
+            if (exits.empty()) return false;
+            for (auto exit : exits) {
+                if (!Dominates(id, exit)) return false;
+            }
+            return true;
+        };
+
+        // Cheap operands are not moved but copied, as these are still used in
+        // the loop.
+        std::vector<Instruction> hoisted;
+        std::unordered_map<Value, Value> copies;
+        auto copy_of = [&](Value value) {
+            auto it = copies.find(value);
+            if (it != copies.end()) return it->second;
+            auto inst = cheap_.at(value);
+            inst.dst = func_.NewValue(inst.type);
+            def_blocks_.push_back(*preheader);
+            consts_.push_back(consts_[value]);
+            hoisted.push_back(inst);
+            copies.emplace(value, inst.dst);
+            return inst.dst;
+        };
+
+        for (auto id : order_) {
+            if (!loop.blocks[id]) continue;
+
+            // A call may not return, so nothing which may fault moves above
+            // it.
+            bool faulting_ok = always_runs(id) && !calls;
+            auto &insts = blocks[id].insts;
+            size_t kept = 0;
+            for (size_t i = 0; i < insts.size(); i++) {
+                auto &inst = insts[i];
+                if (IsInvariant(loop, inst, faulting_ok, writes)) {
+                    for (auto &arg : inst.args) {
+                        if (loop.blocks[def_blocks_[arg]]) arg = copy_of(arg);
+                    }
+                    def_blocks_[inst.dst] = *preheader;
+                    hoisted.push_back(std::move(inst));
+                    moved_++;
+                } else {
+                    if (kept != i) insts[kept] = std::move(inst);
+                    kept++;
+                }
+            }
+            insts.erase(insts.begin() + kept, insts.end());
+        }
+
+        auto &insts = blocks[*preheader].insts;
+        insts.insert(insts.end() - 1, std::make_move_iterator(hoisted.begin()),
+                     std::make_move_iterator(hoisted.end()));
+    }
+
+    bool IsInvariant(const Loop &loop, const Instruction &inst, bool faulting_ok,
+                     bool writes) const {
+        if (IsCheap(inst.op)) return false;
+        for (auto arg : inst.args) {
+            if (loop.blocks[def_blocks_[arg]] && !cheap_.count(arg)) {
+                return false;
+            }
+        }
+
+        switch (inst.op) {
+            case Opcode::SDiv:
+            case Opcode::UDiv:
+            case Opcode::SRem:
+            case Opcode::URem:
+                return faulting_ok || IsSafeDivisor(inst.args[1], inst.type);
+            case Opcode::Load:
+                return faulting_ok && !writes;
+            default:
+                return IsBinary(inst.op) || IsUnary(inst.op) ||
+                       IsCompare(inst.op) || IsConversion(inst.op);
+        }
+    }
+
+    Function &func_;
+    std::vector<BlockId> idoms_;
+    std::vector<BlockId> order_;
+
+    // The block defining each value, which is updated as it moves.
+    std::vector<BlockId> def_blocks_;
+    std::vector<std::optional<int64_t>> consts_;
+    std::unordered_map<Value, Instruction> cheap_;
+    size_t moved_;
+};
+
+}  // namespace
+
+size_t HoistLoopInvariants(Function &func) {
+    LoopInvariantMotion licm(func);
+    return licm.Run();
+}
+
+}  // namespace mir
+
+}  // namespace mini
@@ -0,0 +1,32 @@
+#ifndef MINI_MIR_LICM_H_
+#define MINI_MIR_LICM_H_
+
+#include <cstddef>
+
+#include "mir.h"
+
+namespace mini {
+
+namespace mir {
+
+// Moves computations whose operands don't change in a loop to the block
+// which jumps to its header, so that these run once before the loop.
+//
+// Arithmetic is always moved, and instructions which may fault, that is loads
+// and divisions by a value which may be 0 or -1, only if they run whenever
+// the loop is entered. Loads are also kept if the loop stores to memory or
+// calls a function. Inner loops are processed first, so that a computation
+// may move out of several loops.
+//
+// Constants and addresses of slots and strings are copied rather than moved
+// when a moved instruction uses them, as recomputing them in the loop is as
+// cheap as keeping them in registers.
+//
+// Returns the number of moved instructions, not counting such copies.
+size_t HoistLoopInvariants(Function &func);
+
+}  // namespace mir
+
+}  // namespace mini
+
+#endif  // MINI_MIR_LICM_H_
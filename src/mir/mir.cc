@@ -0,0 +1,303 @@
+#include "mir.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "../panic.h"
+#include "fmt/format.h"
+
+namespace mini {
+
+namespace mir {
+
+uint8_t SizeOf(Type type) {
+    switch (type) {
+        case Type::I8:
+            return 1;
+        case Type::I16:
+            return 2;
+        case Type::I32:
+            return 4;
+        case Type::I64:
+            return 8;
+    }
+    FatalError("unreachable");
+}
+
+Type TypeOfSize(uint64_t size) {
+    switch (size) {
+        case 1:
+            return Type::I8;
+        case 2:
+            return Type::I16;
+        case 4:
+            return Type::I32;
+        case 8:
+            return Type::I64;
+        default:
+            FatalError("no mir type of size {}", size);
+    }
+}
+
+std::string_view ToString(Type type) {
+    static constexpr std::string_view names[] = {"i8", "i16", "i32", "i64"};
+    return names[static_cast<uint8_t>(type)];
+}
+
+std::string_view ToString(Opcode op) {
+    static constexpr std::string_view names[] = {
+        "const", "arg",  "slot", "str",  "add",     "sub",  "mul",
+        "sdiv",  "udiv", "srem", "urem", "and",     "or",   "xor",
+        "shl",   "lshr", "ashr", "neg",  "not",     "eq",   "ne",
+        "slt",   "sle",  "sgt",  "sge",  "ult",     "ule",  "ugt",
+        "uge",   "sext", "zext", "trunc", "load",   "store", "memcopy",
+        "call",  "phi",  "jmp",  "br",   "ret",
+    };
+    return names[static_cast<uint8_t>(op)];
+}
+
+const std::vector<BlockId> &Successors(const Block &block) {
+    if (block.insts.empty() || !IsTerminator(block.terminator().op)) {
+        FatalError("block is not terminated");
+    }
+    return block.terminator().targets;
+}
+
+void ComputePreds(Function &func) {
+    auto &blocks = func.blocks();
+    for (auto &block : blocks) block.preds.clear();
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        for (auto succ : Successors(blocks[id])) {
+            blocks[succ].preds.push_back(id);
+        }
+    }
+}
+
+std::vector<BlockId> ReversePostorder(const Function &func) {
+    const auto &blocks = func.blocks();
+    std::vector<BlockId> order;
+    if (blocks.empty()) return order;
+
+    // Iterative depth first search, as functions may have many blocks.
+    std::vector<bool> visited(blocks.size(), false);
+    std::vector<std::pair<BlockId, size_t>> stack;
+    stack.emplace_back(0, 0);
+    visited[0] = true;
+    while (!stack.empty()) {
+        auto &[id, next] = stack.back();
+        const auto &succs = Successors(blocks[id]);
+        if (next < succs.size()) {
+            // Visit from the last successor so that the first one, such as
+            // the body of a loop, follows its predecessor in the order.
+            auto succ = succs[succs.size() - ++next];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.emplace_back(succ, 0);
+            }
+        } else {
+            order.push_back(id);
+            stack.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// "A Simple, Fast Dominance Algorithm" by Cooper, Harvey and Kennedy.
+std::vector<BlockId> ComputeIdoms(const Function &func) {
+    const auto &blocks = func.blocks();
+    auto order = ReversePostorder(func);
+    std::vector<uint32_t> index(blocks.size(), UINT32_MAX);
+    for (uint32_t i = 0; i < order.size(); i++) index[order[i]] = i;
+
+    std::vector<BlockId> idoms(blocks.size(), no_block);
+    if (order.empty()) return idoms;
+    idoms[0] = 0;
+
+    auto intersect = [&](BlockId b1, BlockId b2) {
+        while (b1 != b2) {
+            while (index[b1] > index[b2]) b1 = idoms[b1];
+            while (index[b2] > index[b1]) b2 = idoms[b2];
+        }
+        return b1;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < order.size(); i++) {
+            auto id = order[i];
+            auto idom = no_block;
+            for (auto pred : blocks[id].preds) {
+                if (idoms[pred] == no_block) continue;
+                idom = idom == no_block ? pred : intersect(pred, idom);
+            }
+            if (idoms[id] != idom) {
+                idoms[id] = idom;
+                changed = true;
+            }
+        }
+    }
+    return idoms;
+}
+
+void RemoveUnreachableBlocks(Function &func) {
+    auto &blocks = func.blocks();
+    std::vector<bool> reachable(blocks.size(), false);
+    for (auto id : ReversePostorder(func)) reachable[id] = true;
+
+    std::vector<BlockId> renumber(blocks.size(), no_block);
+    BlockId next = 0;
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        if (reachable[id]) renumber[id] = next++;
+    }
+    if (next == blocks.size()) return;
+
+    std::vector<Block> kept;
+    kept.reserve(next);
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        if (!reachable[id]) continue;
+        auto &block = blocks[id];
+        for (auto &inst : block.insts) {
+            if (inst.op == Opcode::Phi) {
+                // Drop incoming values from removed blocks.
+                size_t j = 0;
+                for (size_t i = 0; i < inst.targets.size(); i++) {
+                    if (!reachable[inst.targets[i]]) continue;
+                    inst.args[j] = inst.args[i];
+                    inst.targets[j] = renumber[inst.targets[i]];
+                    j++;
+                }
+                inst.args.resize(j);
+                inst.targets.resize(j);
+            } else if (IsTerminator(inst.op)) {
+                for (auto &target : inst.targets) target = renumber[target];
+            }
+        }
+        kept.push_back(std::move(block));
+    }
+    blocks = std::move(kept);
+    ComputePreds(func);
+}
+
+void SplitCriticalEdges(Function &func) {
+    auto &blocks = func.blocks();
+    auto count = blocks.size();
+    for (BlockId from = 0; from < count; from++) {
+        if (blocks[from].terminator().targets.size() < 2) continue;
+        for (size_t i = 0; i < blocks[from].terminator().targets.size(); i++) {
+            auto to = blocks[from].terminator().targets[i];
+            if (blocks[to].preds.size() < 2) continue;
+
+            auto mid = func.NewBlock();
+            Instruction jump{Opcode::Jump};
+            jump.targets.push_back(to);
+            blocks[mid].insts.push_back(std::move(jump));
+            blocks[mid].preds.push_back(from);
+            blocks[from].terminator().targets[i] = mid;
+
+            // Only one edge is redirected even if `from` jumps to `to` twice.
+            auto &preds = blocks[to].preds;
+            *std::find(preds.begin(), preds.end(), from) = mid;
+            for (auto &inst : blocks[to].insts) {
+                if (inst.op != Opcode::Phi) break;
+                *std::find(inst.targets.begin(), inst.targets.end(), from) =
+                    mid;
+            }
+        }
+    }
+}
+
+namespace {
+
+void PrintInstruction(std::string &out, const Instruction &inst) {
+    auto it = std::back_inserter(out);
+    out += "    ";
+    if (inst.dst != no_value) {
+        fmt::format_to(it, "%{}:{} = ", inst.dst, ToString(inst.type));
+    }
+    if (inst.tail) out += "tail ";
+    out += ToString(inst.op);
+
+    switch (inst.op) {
+        case Opcode::Const:
+        case Opcode::Arg:
+        case Opcode::SlotAddr:
+            fmt::format_to(it, " {}", inst.imm);
+            break;
+        case Opcode::StrAddr:
+            fmt::format_to(it, " .L.{}", inst.symbol);
+            break;
+        case Opcode::Store:
+            fmt::format_to(it, ".{} %{}, %{}", ToString(inst.type),
+                           inst.args[0], inst.args[1]);
+            break;
+        case Opcode::MemCopy:
+            fmt::format_to(it, " %{}, %{}, {}", inst.args[0], inst.args[1],
+                           inst.imm);
+            break;
+        case Opcode::Call:
+            fmt::format_to(it, " {}{}(", inst.symbol, inst.outer ? "@PLT" : "");
+            for (size_t i = 0; i < inst.args.size(); i++) {
+                fmt::format_to(it, "{}%{}", i ? ", " : "", inst.args[i]);
+            }
+            out += ")";
+            break;
+        case Opcode::Phi:
+            for (size_t i = 0; i < inst.args.size(); i++) {
+                fmt::format_to(it, "{} [%{}, bb{}]", i ? "," : "",
+                               inst.args[i], inst.targets[i]);
+            }
+            break;
+        case Opcode::Jump:
+            fmt::format_to(it, " bb{}", inst.targets[0]);
+            break;
+        case Opcode::Branch:
+            fmt::format_to(it, " %{}, bb{}, bb{}", inst.args[0],
+                           inst.targets[0], inst.targets[1]);
+            break;
+        default:
+            for (size_t i = 0; i < inst.args.size(); i++) {
+                fmt::format_to(it, "{} %{}", i ? "," : "", inst.args[i]);
+            }
+            break;
+    }
+    out += '\n';
+}
+
+}  // namespace
+
+void Print(std::ostream &os, const Function &func) {
+    std::string out;
+    auto it = std::back_inserter(out);
+
+    fmt::format_to(it, "function {}(", func.name());
+    for (size_t i = 0; i < func.params().size(); i++) {
+        fmt::format_to(it, "{}{}", i ? ", " : "", ToString(func.params()[i]));
+    }
+    fmt::format_to(it, ") -> {} {{\n",
+                   func.ret() ? ToString(*func.ret()) : "void");
+    for (size_t i = 0; i < func.slots().size(); i++) {
+        const auto &slot = func.slots()[i];
+        fmt::format_to(it, "    slot {}: size {}, align {}\n", i, slot.size,
+                       slot.align);
+    }
+
+    for (BlockId id = 0; id < func.blocks().size(); id++) {
+        const auto &block = func.blocks()[id];
+        fmt::format_to(it, "bb{}:", id);
+        if (!block.preds.empty()) {
+            out += "  ; preds:";
+            for (auto pred : block.preds) fmt::format_to(it, " bb{}", pred);
+        }
+        out += '\n';
+        for (const auto &inst : block.insts) PrintInstruction(out, inst);
+    }
+    out += "}\n";
+
+    os.write(out.data(), out.size());
+}
+
+}  // namespace mir
+
+}  // namespace mini
@@ -0,0 +1,223 @@
+#ifndef MINI_MIR_MIR_H_
+#define MINI_MIR_MIR_H_
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../symbol.h"
+
+namespace mini {
+
+namespace mir {
+
+// Type of a virtual register. Pointers are `I64`, and bool and char are `I8`.
+enum class Type : uint8_t {
+    I8,
+    I16,
+    I32,
+    I64,
+};
+
+// Returns the size of `type` in bytes.
+uint8_t SizeOf(Type type);
+
+// Returns the type whose size is `size`, which must be 1, 2, 4 or 8.
+Type TypeOfSize(uint64_t size);
+
+std::string_view ToString(Type type);
+
+// A virtual register, which is assigned exactly once in a function.
+using Value = uint32_t;
+constexpr Value no_value = UINT32_MAX;
+
+// Index of a basic block in `Function::blocks`.
+using BlockId = uint32_t;
+
+enum class Opcode : uint8_t {
+    // dst = imm
+    Const,
+    // dst = imm-th argument. Only at the beginning of the entry block.
+    Arg,
+    // dst = address of imm-th stack slot.
+    SlotAddr,
+    // dst = address of string literal `symbol`.
+    StrAddr,
+
+    // dst = args[0] op args[1], all of `type`.
+    Add,
+    Sub,
+    Mul,
+    SDiv,
+    UDiv,
+    SRem,
+    URem,
+    And,
+    Or,
+    Xor,
+    Shl,
+    LShr,
+    AShr,
+
+    // dst = op args[0]
+    Neg,
+    Not,
+
+    // dst = args[0] op args[1], where dst is `I8` and is 1 if true, 0 if
+    // false. Operands have the same type.
+    Eq,
+    Ne,
+    SLt,
+    SLe,
+    SGt,
+    SGe,
+    ULt,
+    ULe,
+    UGt,
+    UGe,
+
+    // dst = args[0] converted to `type`.
+    SExt,
+    ZExt,
+    Trunc,
+
+    // dst = *args[0]
+    Load,
+    // *args[0] = args[1], where `type` is of args[1].
+    Store,
+    // Copies imm bytes from args[1] to args[0].
+    MemCopy,
+
+    // dst = symbol(args...). dst is `no_value` if the function returns void.
+    Call,
+
+    // dst = args[i] if control comes from targets[i].
+    Phi,
+
+    // Terminators, one at the end of each block.
+    // Jump to targets[0].
+    Jump,
+    // Jump to targets[0] if args[0] is not 0, otherwise to targets[1].
+    Branch,
+    // Return args[0], or nothing if args is empty.
+    Return,
+};
+
+std::string_view ToString(Opcode op);
+
+inline bool IsBinary(Opcode op) {
+    return Opcode::Add <= op && op <= Opcode::AShr;
+}
+inline bool IsUnary(Opcode op) { return op == Opcode::Neg || op == Opcode::Not; }
+inline bool IsCompare(Opcode op) { return Opcode::Eq <= op && op <= Opcode::UGe; }
+inline bool IsConversion(Opcode op) {
+    return Opcode::SExt <= op && op <= Opcode::Trunc;
+}
+inline bool IsTerminator(Opcode op) { return Opcode::Jump <= op; }
+
+struct Instruction {
+    Instruction(Opcode op, Type type = Type::I64, Value dst = no_value)
+        : op(op), type(type), dst(dst) {}
+
+    Opcode op;
+    Type type;  // Of `dst`, or of the stored value of Store.
+    Value dst;
+    std::vector<Value> args;
+    std::vector<BlockId> targets;  // Successors, or incoming blocks of Phi.
+    int64_t imm = 0;
+    Symbol symbol;
+    bool outer = false;  // Call of a function defined in another object.
+
+    // Call followed by Return of its result, which jumps to the callee so
+    // that it returns to the caller of this function.
+    bool tail = false;
+};
+
+struct Block {
+    std::vector<Instruction> insts;  // Phis first, a terminator last.
+    std::vector<BlockId> preds;
+
+    inline const Instruction &terminator() const { return insts.back(); }
+    inline Instruction &terminator() { return insts.back(); }
+};
+
+// Memory in the stack frame, whose address is taken by SlotAddr.
+struct Slot {
+    uint64_t size;
+    uint64_t align;
+};
+
+// A function in SSA form. The first block is the entry.
+class Function {
+public:
+    Function(Symbol name, std::vector<Type> &&params, std::optional<Type> ret)
+        : name_(name), params_(std::move(params)), ret_(ret) {}
+
+    inline Symbol name() const { return name_; }
+    inline const std::vector<Type> &params() const { return params_; }
+    inline const std::optional<Type> &ret() const { return ret_; }
+
+    inline std::vector<Block> &blocks() { return blocks_; }
+    inline const std::vector<Block> &blocks() const { return blocks_; }
+    inline std::vector<Slot> &slots() { return slots_; }
+    inline const std::vector<Slot> &slots() const { return slots_; }
+
+    // Number of values, which are numbered from 0.
+    inline size_t ValueCount() const { return value_types_.size(); }
+    inline Type TypeOf(Value value) const { return value_types_.at(value); }
+    inline Value NewValue(Type type) {
+        value_types_.push_back(type);
+        return value_types_.size() - 1;
+    }
+    inline BlockId NewBlock() {
+        blocks_.emplace_back();
+        return blocks_.size() - 1;
+    }
+    inline uint32_t NewSlot(uint64_t size, uint64_t align) {
+        slots_.push_back({size, align});
+        return slots_.size() - 1;
+    }
+
+private:
+    Symbol name_;
+    std::vector<Type> params_;
+    std::optional<Type> ret_;
+    std::vector<Block> blocks_;
+    std::vector<Slot> slots_;
+    std::vector<Type> value_types_;
+};
+
+// Returns successors of `block`, which must be terminated.
+const std::vector<BlockId> &Successors(const Block &block);
+
+// Recomputes predecessors of every block from terminators.
+void ComputePreds(Function &func);
+
+// Returns blocks reachable from the entry in reverse postorder, where the
+// first successor of a block follows it if nothing else must come between.
+std::vector<BlockId> ReversePostorder(const Function &func);
+
+// Returns the immediate dominator of each block, or the block itself for the
+// entry. Unreachable blocks have `no_block`.
+constexpr BlockId no_block = UINT32_MAX;
+std::vector<BlockId> ComputeIdoms(const Function &func);
+
+// Removes blocks unreachable from the entry, and incoming values of phis from
+// them.
+void RemoveUnreachableBlocks(Function &func);
+
+// Splits edges from a block with several successors to a block with several
+// predecessors, so that copies for phis can be placed on each edge.
+void SplitCriticalEdges(Function &func);
+
+// Writes `func` in text.
+void Print(std::ostream &os, const Function &func);
+
+}  // namespace mir
+
+}  // namespace mini
+
+#endif  // MINI_MIR_MIR_H_
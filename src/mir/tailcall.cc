@@ -0,0 +1,152 @@
+#include "tailcall.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "fmt/format.h"
+
+namespace mini {
+
+namespace mir {
+
+namespace {
+
+// Arguments after the sixth are passed on the stack.
+size_t StackArgs(size_t args) { return args > 6 ? args - 6 : 0; }
+
+// Moves everything but arguments of the entry block to a new block, which
+// recursive calls jump to with arguments as incoming values of its phis.
+// Returns the new block and the phis, indexed by parameter.
+std::pair<BlockId, std::vector<Value>> SplitEntry(Function &func) {
+    auto header = func.NewBlock();
+    auto &blocks = func.blocks();
+    auto &entry = blocks[0].insts;
+
+    // Incoming values from the entry now come from the header.
+    for (auto &block : blocks) {
+        for (auto &inst : block.insts) {
+            if (inst.op != Opcode::Phi) break;
+            std::replace(inst.targets.begin(), inst.targets.end(), BlockId(0),
+                         header);
+        }
+    }
+
+    // Every argument is needed by the header, even if unused so far.
+    size_t arg_count = 0;
+    std::vector<Value> args(func.params().size(), no_value);
+    for (const auto &inst : entry) {
+        if (inst.op != Opcode::Arg) break;
+        args[inst.imm] = inst.dst;
+        arg_count++;
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] != no_value) continue;
+        auto type = func.params()[i];
+        Instruction arg{Opcode::Arg, type, func.NewValue(type)};
+        arg.imm = i;
+        args[i] = arg.dst;
+        entry.insert(entry.begin() + arg_count++, std::move(arg));
+    }
+
+    // Uses of arguments are replaced with phis merging them with arguments
+    // of recursive calls.
+    std::vector<Value> phis;
+    std::vector<Instruction> insts;
+    for (size_t i = 0; i < args.size(); i++) {
+        auto type = func.params()[i];
+        Instruction phi{Opcode::Phi, type, func.NewValue(type)};
+        phi.args.push_back(args[i]);
+        phi.targets.push_back(0);
+        phis.push_back(phi.dst);
+        insts.push_back(std::move(phi));
+    }
+    auto first = entry.begin() + arg_count;
+    insts.insert(insts.end(), std::make_move_iterator(first),
+                 std::make_move_iterator(entry.end()));
+    entry.erase(first, entry.end());
+
+    Instruction jump{Opcode::Jump};
+    jump.targets.push_back(header);
+    entry.push_back(std::move(jump));
+
+    std::vector<Value> renames(func.ValueCount());
+    for (Value value = 0; value < renames.size(); value++) {
+        renames[value] = value;
+    }
+    for (size_t i = 0; i < args.size(); i++) renames[args[i]] = phis[i];
+    for (size_t i = args.size(); i < insts.size(); i++) {
+        for (auto &arg : insts[i].args) arg = renames[arg];
+    }
+    for (BlockId id = 1; id < header; id++) {
+        for (auto &inst : blocks[id].insts) {
+            for (auto &arg : inst.args) arg = renames[arg];
+        }
+    }
+    blocks[header].insts = std::move(insts);
+    return {header, std::move(phis)};
+}
+
+}  // namespace
+
+void OptimizeTailCalls(Function &func, std::vector<std::string> &report) {
+    auto record = [&](const Instruction &call, std::string_view result) {
+        report.push_back(fmt::format("tail call to `{}` in `{}`: {}",
+                                     call.symbol, func.name(), result));
+    };
+
+    // Blocks ending with a recursive call in tail position.
+    std::vector<BlockId> recursions;
+    auto &blocks = func.blocks();
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        auto &insts = blocks[id].insts;
+        if (insts.size() < 2) continue;
+        auto &call = insts[insts.size() - 2];
+        const auto &ret = insts.back();
+        if (call.op != Opcode::Call || ret.op != Opcode::Return ||
+            (!ret.args.empty() && ret.args[0] != call.dst)) {
+            continue;
+        }
+
+        if (!func.slots().empty()) {
+            record(call, "not converted (locals live in the frame)");
+        } else if (call.symbol == func.name() && !call.outer &&
+                   call.args.size() == func.params().size()) {
+            record(call, "converted to a loop");
+            recursions.push_back(id);
+        } else if (StackArgs(call.args.size()) >
+                   StackArgs(func.params().size())) {
+            record(call, fmt::format("not converted (stack arguments: {} "
+                                     "passed, {} received)",
+                                     StackArgs(call.args.size()),
+                                     StackArgs(func.params().size())));
+        } else {
+            record(call, "converted to a jump");
+            call.tail = true;
+        }
+    }
+    if (recursions.empty()) return;
+
+    auto [header, phis] = SplitEntry(func);
+    for (auto id : recursions) {
+        // The call is in the header if it was in the entry.
+        if (id == 0) id = header;
+        auto &insts = func.blocks()[id].insts;
+        const auto &call = insts[insts.size() - 2];
+        auto &header_insts = func.blocks()[header].insts;
+        for (size_t i = 0; i < phis.size(); i++) {
+            header_insts[i].args.push_back(call.args[i]);
+            header_insts[i].targets.push_back(id);
+        }
+
+        insts.erase(insts.end() - 2, insts.end());
+        Instruction jump{Opcode::Jump};
+        jump.targets.push_back(header);
+        insts.push_back(std::move(jump));
+    }
+    ComputePreds(func);
+}
+
+}  // namespace mir
+
+}  // namespace mini
@@ -0,0 +1,29 @@
+#ifndef MINI_MIR_TAILCALL_H_
+#define MINI_MIR_TAILCALL_H_
+
+#include <string>
+#include <vector>
+
+#include "mir.h"
+
+namespace mini {
+
+namespace mir {
+
+// Converts calls in tail position, that is ones followed by a return of their
+// result. Calls of the function itself become jumps back to its beginning, so
+// that recursion is a loop, and calls of other functions are marked `tail`.
+//
+// Calls are kept if the function has slots, whose addresses the callee may
+// be passed, or if more arguments are passed on the stack than the function
+// itself received there.
+//
+// Appends a line to `report` for each call in tail position, saying whether
+// it's converted and why.
+void OptimizeTailCalls(Function &func, std::vector<std::string> &report);
+
+}  // namespace mir
+
+}  // namespace mini
+
+#endif  // MINI_MIR_TAILCALL_H_
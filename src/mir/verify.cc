@@ -0,0 +1,297 @@
+#include "verify.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace mini {
+
+namespace mir {
+
+namespace {
+
+class Verifier {
+public:
+    explicit Verifier(const Function &func) : func_(func) {}
+    std::optional<std::string> Run();
+
+private:
+    std::optional<std::string> CheckCfg();
+    std::optional<std::string> CheckDefs();
+    std::optional<std::string> CheckTypes(BlockId id, const Instruction &inst);
+
+    // Returns true if `def`, an instruction at `index` in `block`, is
+    // available at `index` in `use`.
+    bool Dominates(BlockId def, size_t def_index, BlockId use,
+                   size_t use_index) const;
+
+    const Function &func_;
+    std::vector<BlockId> idoms_;
+    std::vector<BlockId> def_block_;
+    std::vector<size_t> def_index_;
+};
+
+template <typename... T>
+std::optional<std::string> Error(BlockId id, fmt::format_string<T...> fmt,
+                                 T &&...args) {
+    return fmt::format("bb{}: {}", id,
+                       fmt::format(fmt, std::forward<T>(args)...));
+}
+
+std::optional<std::string> Verifier::Run() {
+    if (func_.blocks().empty()) return "no entry block";
+    if (auto error = CheckCfg()) return error;
+    idoms_ = ComputeIdoms(func_);
+    if (auto error = CheckDefs()) return error;
+
+    const auto &blocks = func_.blocks();
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        for (const auto &inst : blocks[id].insts) {
+            if (auto error = CheckTypes(id, inst)) return error;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> Verifier::CheckCfg() {
+    const auto &blocks = func_.blocks();
+    std::vector<std::vector<BlockId>> preds(blocks.size());
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        const auto &insts = blocks[id].insts;
+        if (insts.empty() || !IsTerminator(insts.back().op)) {
+            return Error(id, "not terminated");
+        }
+
+        bool phi_allowed = true;
+        for (size_t i = 0; i < insts.size(); i++) {
+            const auto &inst = insts[i];
+            if (IsTerminator(inst.op) && i + 1 != insts.size()) {
+                return Error(id, "{} in the middle of block",
+                             ToString(inst.op));
+            }
+            if (inst.op == Opcode::Phi && !phi_allowed) {
+                return Error(id, "phi after non-phi instruction");
+            }
+            if (inst.op == Opcode::Call && inst.tail &&
+                (i + 2 != insts.size() || insts.back().op != Opcode::Return ||
+                 (!insts.back().args.empty() &&
+                  insts.back().args[0] != inst.dst))) {
+                return Error(id, "tail call not followed by its ret");
+            }
+            if (inst.op == Opcode::Arg && (id != 0 || !phi_allowed)) {
+                return Error(id, "arg after other instruction");
+            }
+            phi_allowed = phi_allowed && (inst.op == Opcode::Phi ||
+                                          inst.op == Opcode::Arg);
+        }
+
+        const auto &term = insts.back();
+        size_t expected = term.op == Opcode::Jump     ? 1
+                          : term.op == Opcode::Branch ? 2
+                                                      : 0;
+        if (term.targets.size() != expected) {
+            return Error(id, "{} with {} targets", ToString(term.op),
+                         term.targets.size());
+        }
+        for (auto target : term.targets) {
+            if (target >= blocks.size()) {
+                return Error(id, "jump to invalid block bb{}", target);
+            }
+            if (target == 0) return Error(id, "jump to the entry block");
+            preds[target].push_back(id);
+        }
+    }
+
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        auto expected = preds[id];
+        std::sort(expected.begin(), expected.end());
+        auto actual = blocks[id].preds;
+        std::sort(actual.begin(), actual.end());
+        if (expected != actual) return Error(id, "incorrect predecessors");
+
+        for (const auto &inst : blocks[id].insts) {
+            if (inst.op != Opcode::Phi) break;
+            auto incoming = inst.targets;
+            std::sort(incoming.begin(), incoming.end());
+            if (incoming != expected || inst.args.size() != incoming.size()) {
+                return Error(id, "phi %{} doesn't match predecessors",
+                             inst.dst);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> Verifier::CheckDefs() {
+    const auto &blocks = func_.blocks();
+    def_block_.assign(func_.ValueCount(), no_block);
+    def_index_.assign(func_.ValueCount(), 0);
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        const auto &insts = blocks[id].insts;
+        for (size_t i = 0; i < insts.size(); i++) {
+            auto dst = insts[i].dst;
+            if (dst == no_value) continue;
+            if (dst >= func_.ValueCount()) {
+                return Error(id, "unknown value %{}", dst);
+            }
+            if (def_block_[dst] != no_block) {
+                return Error(id, "%{} is defined twice", dst);
+            }
+            if (func_.TypeOf(dst) != insts[i].type) {
+                return Error(id, "%{} has inconsistent type", dst);
+            }
+            def_block_[dst] = id;
+            def_index_[dst] = i;
+        }
+    }
+
+    for (BlockId id = 0; id < blocks.size(); id++) {
+        if (idoms_[id] == no_block) continue;
+        const auto &insts = blocks[id].insts;
+        for (size_t i = 0; i < insts.size(); i++) {
+            const auto &inst = insts[i];
+            for (size_t j = 0; j < inst.args.size(); j++) {
+                auto arg = inst.args[j];
+                if (arg >= func_.ValueCount() ||
+                    def_block_[arg] == no_block) {
+                    return Error(id, "use of undefined %{}", arg);
+                }
+
+                // Incoming values of phi are used at the end of the
+                // predecessor.
+                bool dominated =
+                    inst.op == Opcode::Phi
+                        ? Dominates(def_block_[arg], def_index_[arg],
+                                    inst.targets[j], SIZE_MAX)
+                        : Dominates(def_block_[arg], def_index_[arg], id, i);
+                if (!dominated) {
+                    return Error(id, "%{} doesn't dominate its use", arg);
+                }
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+bool Verifier::Dominates(BlockId def, size_t def_index, BlockId use,
+                         size_t use_index) const {
+    if (idoms_[use] == no_block) return true;
+    if (def == use) return def_index < use_index;
+    while (use != 0) {
+        use = idoms_[use];
+        if (use == def) return true;
+    }
+    return false;
+}
+
+std::optional<std::string> Verifier::CheckTypes(BlockId id,
+                                                const Instruction &inst) {
+    auto type_of = [&](size_t i) { return func_.TypeOf(inst.args.at(i)); };
+    auto arity = [&](size_t n) { return inst.args.size() == n; };
+    auto has_dst = inst.dst != no_value;
+    auto name = ToString(inst.op);
+
+    if (IsBinary(inst.op)) {
+        if (!arity(2) || !has_dst || type_of(0) != inst.type ||
+            type_of(1) != inst.type) {
+            return Error(id, "ill-typed {}", name);
+        }
+    } else if (IsUnary(inst.op)) {
+        if (!arity(1) || !has_dst || type_of(0) != inst.type) {
+            return Error(id, "ill-typed {}", name);
+        }
+    } else if (IsCompare(inst.op)) {
+        if (!arity(2) || !has_dst || inst.type != Type::I8 ||
+            type_of(0) != type_of(1)) {
+            return Error(id, "ill-typed {}", name);
+        }
+    } else if (IsConversion(inst.op)) {
+        if (!arity(1) || !has_dst) return Error(id, "ill-formed {}", name);
+        auto from = SizeOf(type_of(0));
+        auto to = SizeOf(inst.type);
+        if (inst.op == Opcode::Trunc ? from <= to : from >= to) {
+            return Error(id, "{} from {} to {}", name, ToString(type_of(0)),
+                         ToString(inst.type));
+        }
+    } else {
+        switch (inst.op) {
+            case Opcode::Const:
+                if (!arity(0) || !has_dst) return Error(id, "ill-formed const");
+                break;
+            case Opcode::Arg:
+                if (!arity(0) || !has_dst || inst.imm < 0 ||
+                    static_cast<size_t>(inst.imm) >= func_.params().size() ||
+                    func_.params()[inst.imm] != inst.type) {
+                    return Error(id, "invalid arg {}", inst.imm);
+                }
+                break;
+            case Opcode::SlotAddr:
+                if (!arity(0) || inst.type != Type::I64 || inst.imm < 0 ||
+                    static_cast<size_t>(inst.imm) >= func_.slots().size()) {
+                    return Error(id, "invalid slot {}", inst.imm);
+                }
+                break;
+            case Opcode::StrAddr:
+                if (!arity(0) || inst.type != Type::I64 ||
+                    inst.symbol.empty()) {
+                    return Error(id, "ill-formed str");
+                }
+                break;
+            case Opcode::Load:
+                if (!arity(1) || !has_dst || type_of(0) != Type::I64) {
+                    return Error(id, "ill-typed load");
+                }
+                break;
+            case Opcode::Store:
+                if (!arity(2) || has_dst || type_of(0) != Type::I64 ||
+                    type_of(1) != inst.type) {
+                    return Error(id, "ill-typed store");
+                }
+                break;
+            case Opcode::MemCopy:
+                if (!arity(2) || has_dst || type_of(0) != Type::I64 ||
+                    type_of(1) != Type::I64 || inst.imm <= 0) {
+                    return Error(id, "ill-typed memcopy");
+                }
+                break;
+            case Opcode::Call:
+                if (inst.symbol.empty()) return Error(id, "call of nothing");
+                break;
+            case Opcode::Phi:
+                for (size_t i = 0; i < inst.args.size(); i++) {
+                    if (type_of(i) != inst.type) {
+                        return Error(id, "ill-typed phi %{}", inst.dst);
+                    }
+                }
+                break;
+            case Opcode::Jump:
+                if (!arity(0)) return Error(id, "ill-formed jmp");
+                break;
+            case Opcode::Branch:
+                if (!arity(1) || type_of(0) != Type::I8) {
+                    return Error(id, "ill-typed br");
+                }
+                break;
+            case Opcode::Return:
+                if (func_.ret() ? !arity(1) || type_of(0) != *func_.ret()
+                                : !arity(0)) {
+                    return Error(id, "ret doesn't match return type");
+                }
+                break;
+            default:
+                return Error(id, "unknown instruction");
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<std::string> Verify(const Function &func) {
+    return Verifier(func).Run();
+}
+
+}  // namespace mir
+
+}  // namespace mini
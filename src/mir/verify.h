@@ -0,0 +1,26 @@
+#ifndef MINI_MIR_VERIFY_H_
+#define MINI_MIR_VERIFY_H_
+
+#include <optional>
+#include <string>
+
+#include "mir.h"
+
+namespace mini {
+
+namespace mir {
+
+// Checks that `func` is well-formed: every block ends with its only
+// terminator, phis are at the beginning of blocks and have one incoming value
+// for each predecessor, every value is defined once before it's used in the
+// dominator tree, operands have the types the instructions expect, and tail
+// calls are followed by a return of their result.
+//
+// Returns the description of the first violation found, or nullopt if none.
+std::optional<std::string> Verify(const Function &func);
+
+}  // namespace mir
+
+}  // namespace mini
+
+#endif  // MINI_MIR_VERIFY_H_
@@ -0,0 +1,33 @@
+#include "context.h"
+
+#include "../codegen/expr.h"
+#include "../codegen/type.h"
+
+namespace mini {
+
+std::optional<mir::Type> MirTypeOf(CodeGenContext &ctx,
+                                   const std::shared_ptr<hir::Type> &type) {
+    if (IsFatObject(ctx, type)) return std::nullopt;
+
+    TypeSizeCalc size(ctx);
+    type->Accept(size);
+    if (!size) return std::nullopt;
+
+    auto n = size.size();
+    if (n != 1 && n != 2 && n != 4 && n != 8) return std::nullopt;
+    return mir::TypeOfSize(n);
+}
+
+bool IsSignedType(CodeGenContext &ctx, const std::shared_ptr<hir::Type> &type) {
+    if (type->IsBuiltin()) {
+        return type->ToBuiltin()->IsSigned();
+    } else if (type->IsName() && ctx.enum_table().Exists(type->ToName()->value())) {
+        auto &base_type =
+            ctx.enum_table().Query(type->ToName()->value()).base_type();
+        return IsSignedType(ctx, base_type);
+    } else {
+        return false;
+    }
+}
+
+}  // namespace mini
@@ -0,0 +1,97 @@
+#ifndef MINI_MIRGEN_CONTEXT_H_
+#define MINI_MIRGEN_CONTEXT_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../codegen/context.h"
+#include "../hir/type.h"
+#include "../mir/builder.h"
+#include "../symbol.h"
+
+namespace mini {
+
+// Where a local variable lives in mir.
+class MirVariable {
+public:
+    enum Kind {
+        // The variable is a scalar whose address is never taken, so its
+        // value is held in ssa values.
+        Ssa,
+
+        // The variable is in a stack slot.
+        Slot,
+    };
+
+    MirVariable(Kind kind, uint32_t id, const std::shared_ptr<hir::Type> &type)
+        : kind_(kind), id_(id), type_(type) {}
+    inline Kind kind() const { return kind_; }
+    inline const std::shared_ptr<hir::Type> &type() const { return type_; }
+
+    // The variable of mir::Builder if kind is Ssa, or the slot otherwise.
+    inline uint32_t id() const { return id_; }
+
+private:
+    Kind kind_;
+    uint32_t id_;
+    std::shared_ptr<hir::Type> type_;
+};
+
+class MirGenContext {
+public:
+    MirGenContext(CodeGenContext &ctx, mir::Builder &builder,
+                  const std::shared_ptr<hir::Type> &ret_type)
+        : ctx_(ctx), builder_(builder), ret_type_(ret_type) {}
+    inline CodeGenContext &ctx() { return ctx_; }
+    inline mir::Builder &builder() { return builder_; }
+    inline const std::shared_ptr<hir::Type> &ret_type() const {
+        return ret_type_;
+    }
+
+    inline bool VarExists(Symbol name) const {
+        return vars_.find(name) != vars_.end();
+    }
+    inline void InsertVar(Symbol name, MirVariable &&var) {
+        vars_.insert(std::make_pair(name, std::move(var)));
+    }
+    inline const MirVariable &QueryVar(Symbol name) const {
+        auto it = vars_.find(name);
+        if (it == vars_.end()) FatalError("no such variable exists: {}", name);
+        return it->second;
+    }
+
+    // Blocks which `continue` and `break` jump to.
+    struct Loop {
+        mir::BlockId header;
+        mir::BlockId exit;
+    };
+    inline bool IsInLoop() const { return !loops_.empty(); }
+    inline void EnterLoop(mir::BlockId header, mir::BlockId exit) {
+        loops_.push_back({header, exit});
+    }
+    inline void LeaveLoop() { loops_.pop_back(); }
+    inline const Loop &CurrLoop() const { return loops_.back(); }
+
+private:
+    CodeGenContext &ctx_;
+    mir::Builder &builder_;
+    std::shared_ptr<hir::Type> ret_type_;
+    std::unordered_map<Symbol, MirVariable> vars_;
+    std::vector<Loop> loops_;
+};
+
+// Returns the mir type of the value of `type`, or nullopt if the value is not
+// a scalar: fat objects, void and unknown types.
+std::optional<mir::Type> MirTypeOf(CodeGenContext &ctx,
+                                   const std::shared_ptr<hir::Type> &type);
+
+// Returns true if the value of `type` should be extended by its sign.
+bool IsSignedType(CodeGenContext &ctx, const std::shared_ptr<hir::Type> &type);
+
+}  // namespace mini
+
+#endif  // MINI_MIRGEN_CONTEXT_H_
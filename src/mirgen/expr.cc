@@ -0,0 +1,910 @@
+#include "expr.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "../codegen/expr.h"
+#include "../codegen/type.h"
+
+namespace mini {
+
+static bool IsIntegerType(const std::shared_ptr<hir::Type> &type) {
+    return type->IsBuiltin() && type->ToBuiltin()->IsInteger();
+}
+
+static bool IsVoidType(const std::shared_ptr<hir::Type> &type) {
+    return type->IsBuiltin() &&
+           type->ToBuiltin()->kind() == hir::BuiltinType::Void;
+}
+
+static hir::BuiltinType::Kind ToSigned(hir::BuiltinType::Kind kind) {
+    switch (kind) {
+        case hir::BuiltinType::UInt8:
+            return hir::BuiltinType::Int8;
+        case hir::BuiltinType::UInt16:
+            return hir::BuiltinType::Int16;
+        case hir::BuiltinType::UInt32:
+            return hir::BuiltinType::Int32;
+        case hir::BuiltinType::UInt64:
+            return hir::BuiltinType::Int64;
+        case hir::BuiltinType::USize:
+            return hir::BuiltinType::ISize;
+        default:
+            return kind;
+    }
+}
+
+// Returns the variable if `expr` is a variable held in ssa values.
+static const MirVariable *IsSsaVariable(
+    MirGenContext &ctx, const std::unique_ptr<hir::Expression> &expr) {
+    class IsVariable : public hir::ExpressionVisitor {
+    public:
+        std::optional<Symbol> value;
+        void Visit(const hir::UnaryExpression &) override {}
+        void Visit(const hir::InfixExpression &) override {}
+        void Visit(const hir::IndexExpression &) override {}
+        void Visit(const hir::CallExpression &) override {}
+        void Visit(const hir::AccessExpression &) override {}
+        void Visit(const hir::CastExpression &) override {}
+        void Visit(const hir::ESizeofExpression &) override {}
+        void Visit(const hir::TSizeofExpression &) override {}
+        void Visit(const hir::EnumSelectExpression &) override {}
+        void Visit(const hir::VariableExpression &expr) override {
+            value = expr.value();
+        }
+        void Visit(const hir::IntegerExpression &) override {}
+        void Visit(const hir::StringExpression &) override {}
+        void Visit(const hir::CharExpression &) override {}
+        void Visit(const hir::BoolExpression &) override {}
+        void Visit(const hir::NullPtrExpression &) override {}
+        void Visit(const hir::StructExpression &) override {}
+        void Visit(const hir::ArrayExpression &) override {}
+    };
+
+    IsVariable check;
+    expr->Accept(check);
+    if (!check.value || !ctx.VarExists(*check.value)) return nullptr;
+    auto &var = ctx.QueryVar(*check.value);
+    return var.kind() == MirVariable::Ssa ? &var : nullptr;
+}
+
+// Returns `base + offset`, or `base` itself if offset is 0.
+static mir::Value OffsetAddr(MirGenContext &ctx, mir::Value base,
+                             uint64_t offset) {
+    if (offset == 0) return base;
+    auto &builder = ctx.builder();
+    return builder.Binary(mir::Opcode::Add, base,
+                          builder.Const(mir::Type::I64, offset));
+}
+
+// Writes `value` of `type` to `addr`, copying the object if it's fat.
+static bool StoreValue(MirGenContext &ctx, mir::Value addr, mir::Value value,
+                       const std::shared_ptr<hir::Type> &type) {
+    if (IsFatObject(ctx.ctx(), type)) {
+        TypeSizeCalc size(ctx.ctx());
+        type->Accept(size);
+        if (!size) return false;
+        if (size.size() != 0) ctx.builder().MemCopy(addr, value, size.size());
+    } else {
+        if (!MirTypeOf(ctx.ctx(), type)) return false;
+        ctx.builder().Store(addr, value);
+    }
+    return true;
+}
+
+// Reads the value of `type` at `addr`. Fat objects are not read, as its value
+// is the address.
+static std::optional<mir::Value> LoadValue(
+    MirGenContext &ctx, mir::Value addr,
+    const std::shared_ptr<hir::Type> &type) {
+    if (IsFatObject(ctx.ctx(), type)) return addr;
+    auto mir_type = MirTypeOf(ctx.ctx(), type);
+    if (!mir_type) return std::nullopt;
+    return ctx.builder().Load(*mir_type, addr);
+}
+
+void ExprMirGen::Visit(const hir::UnaryExpression &expr) {
+    auto &builder = ctx_.builder();
+    if (expr.op().kind() == hir::UnaryExpression::Op::Ref) {
+        ExprAddrMirGen gen(ctx_);
+        expr.expr()->Accept(gen);
+        if (!gen) return;
+
+        value_ = gen.value();
+        inferred_ =
+            hir::MakeType<hir::PointerType>(gen.inferred(), expr.span());
+        success_ = true;
+        return;
+    }
+
+    ExprMirGen gen(ctx_);
+    expr.expr()->Accept(gen);
+    if (!gen) return;
+    auto &type = gen.inferred();
+
+    if (expr.op().kind() == hir::UnaryExpression::Op::Deref) {
+        if (!type->IsPointer()) return;
+        auto &of = type->ToPointer()->of();
+        auto value = LoadValue(ctx_, gen.value(), of);
+        if (!value) return;
+        value_ = *value;
+        inferred_ = of;
+    } else if (expr.op().kind() == hir::UnaryExpression::Op::Minus) {
+        if (!IsIntegerType(type)) return;
+        value_ = builder.Unary(mir::Opcode::Neg, gen.value());
+        inferred_ = hir::MakeType<hir::BuiltinType>(
+            ToSigned(type->ToBuiltin()->kind()), expr.span());
+    } else if (expr.op().kind() == hir::UnaryExpression::Op::Inv) {
+        if (!IsIntegerType(type)) return;
+        value_ = builder.Unary(mir::Opcode::Not, gen.value());
+        inferred_ = hir::MakeType<hir::BuiltinType>(type->ToBuiltin()->kind(),
+                                                    expr.span());
+    } else {
+        if (!type->IsBuiltin() ||
+            type->ToBuiltin()->kind() != hir::BuiltinType::Bool) {
+            return;
+        }
+        value_ = builder.Binary(mir::Opcode::Xor, gen.value(),
+                                builder.Const(mir::Type::I8, 1));
+        inferred_ =
+            hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool, expr.span());
+    }
+    success_ = true;
+}
+
+static bool GenAssignExpr(MirGenContext &ctx, mir::Value &value,
+                          std::shared_ptr<hir::Type> &inferred,
+                          const std::unique_ptr<hir::Expression> &lhs,
+                          const std::unique_ptr<hir::Expression> &rhs) {
+    auto base_type_of = [](const std::shared_ptr<hir::Type> &type) {
+        std::optional<std::shared_ptr<hir::Type>> of;
+        if (type->IsPointer()) {
+            of = type->ToPointer()->of();
+        } else if (type->IsArray()) {
+            of = type->ToArray()->of();
+        }
+        return of;
+    };
+
+    // Variables in ssa values have no address, so just define new value.
+    if (auto var = IsSsaVariable(ctx, lhs)) {
+        ExprMirGen gen_rhs(ctx, base_type_of(var->type()));
+        rhs->Accept(gen_rhs);
+        if (!gen_rhs) return false;
+
+        value = gen_rhs.value();
+        if (!ImplicitlyConvertValue(ctx, value, gen_rhs.inferred(),
+                                    var->type())) {
+            return false;
+        }
+        ctx.builder().WriteVariable(var->id(), value);
+        inferred = var->type();
+        return true;
+    }
+
+    ExprAddrMirGen gen_addr(ctx);
+    lhs->Accept(gen_addr);
+    if (!gen_addr) return false;
+
+    ExprMirGen gen_rhs(ctx, base_type_of(gen_addr.inferred()));
+    rhs->Accept(gen_rhs);
+    if (!gen_rhs) return false;
+
+    value = gen_rhs.value();
+    if (!ImplicitlyConvertValue(ctx, value, gen_rhs.inferred(),
+                                gen_addr.inferred())) {
+        return false;
+    }
+    if (!StoreValue(ctx, gen_addr.value(), value, gen_addr.inferred())) {
+        return false;
+    }
+
+    inferred = gen_addr.inferred();
+    return true;
+}
+
+// Converts generated operands to the type which two integer types are merged
+// into.
+static bool MergeIntegerOperands(MirGenContext &ctx, mir::Value &lhs,
+                                 mir::Value &rhs,
+                                 std::shared_ptr<hir::Type> &merged,
+                                 const ExprMirGen &gen_lhs,
+                                 const ExprMirGen &gen_rhs) {
+    if (!gen_lhs.inferred()->IsBuiltin() || !gen_rhs.inferred()->IsBuiltin()) {
+        return false;
+    }
+    auto type = ImplicitlyMergeTwoType(ctx.ctx(), gen_lhs.inferred(),
+                                       gen_rhs.inferred());
+    if (!type || !IsIntegerType(type.value())) return false;
+
+    rhs = gen_rhs.value();
+    if (!ImplicitlyConvertValue(ctx, rhs, gen_rhs.inferred(), type.value())) {
+        return false;
+    }
+    lhs = gen_lhs.value();
+    if (!ImplicitlyConvertValue(ctx, lhs, gen_lhs.inferred(), type.value())) {
+        return false;
+    }
+    merged = type.value();
+    return true;
+}
+
+// Generates both sides of `expr`, and converts them to the type which two
+// integer types are merged into.
+static bool GenIntegerOperands(MirGenContext &ctx, mir::Value &lhs,
+                               mir::Value &rhs,
+                               std::shared_ptr<hir::Type> &merged,
+                               const hir::InfixExpression &expr) {
+    ExprMirGen gen_lhs(ctx);
+    expr.lhs()->Accept(gen_lhs);
+    if (!gen_lhs) return false;
+
+    ExprMirGen gen_rhs(ctx);
+    expr.rhs()->Accept(gen_rhs);
+    if (!gen_rhs) return false;
+
+    return MergeIntegerOperands(ctx, lhs, rhs, merged, gen_lhs, gen_rhs);
+}
+
+static bool GenAdditiveExpr(MirGenContext &ctx, mir::Value &value,
+                            std::shared_ptr<hir::Type> &inferred,
+                            const hir::InfixExpression &expr) {
+    auto &builder = ctx.builder();
+    auto op = expr.op().kind() == hir::InfixExpression::Op::Add
+                  ? mir::Opcode::Add
+                  : mir::Opcode::Sub;
+
+    // Each operand is generated once, whether it's pointer arithmetic or not.
+    ExprMirGen gen_lhs(ctx);
+    expr.lhs()->Accept(gen_lhs);
+    if (!gen_lhs) return false;
+
+    ExprMirGen gen_rhs(ctx);
+    expr.rhs()->Accept(gen_rhs);
+    if (!gen_rhs) return false;
+
+    if (!gen_lhs.inferred()->IsPointer()) {
+        mir::Value lhs, rhs;
+        if (!MergeIntegerOperands(ctx, lhs, rhs, inferred, gen_lhs, gen_rhs)) {
+            return false;
+        }
+        value = builder.Binary(op, lhs, rhs);
+        return true;
+    }
+
+    auto to = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
+                                              expr.lhs()->span());
+    auto rhs = gen_rhs.value();
+    if (!ImplicitlyConvertValue(ctx, rhs, gen_rhs.inferred(), to)) {
+        return false;
+    }
+
+    TypeSizeCalc size(ctx.ctx());
+    gen_lhs.inferred()->ToPointer()->of()->Accept(size);
+    if (!size) return false;
+
+    // Calculate how much to add/sub to pointer.
+    auto offset = builder.Binary(mir::Opcode::Mul, rhs,
+                                 builder.Const(mir::Type::I64, size.size()));
+    value = builder.Binary(op, gen_lhs.value(), offset);
+    inferred = gen_lhs.inferred();
+    return true;
+}
+
+void ExprMirGen::Visit(const hir::InfixExpression &expr) {
+    auto &builder = ctx_.builder();
+    auto kind = expr.op().kind();
+    if (kind == hir::InfixExpression::Op::Assign) {
+        success_ = GenAssignExpr(ctx_, value_, inferred_, expr.lhs(),
+                                 expr.rhs());
+        return;
+    } else if (kind == hir::InfixExpression::Op::Add ||
+               kind == hir::InfixExpression::Op::Sub) {
+        success_ = GenAdditiveExpr(ctx_, value_, inferred_, expr);
+        return;
+    } else if (kind == hir::InfixExpression::Op::Or ||
+               kind == hir::InfixExpression::Op::And) {
+        ExprMirGen gen_lhs(ctx_);
+        expr.lhs()->Accept(gen_lhs);
+        if (!gen_lhs) return;
+
+        ExprMirGen gen_rhs(ctx_);
+        expr.rhs()->Accept(gen_rhs);
+        if (!gen_rhs) return;
+
+        auto to = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool,
+                                                  expr.span());
+        if (!gen_lhs.inferred()->IsBuiltin() ||
+            !gen_rhs.inferred()->IsBuiltin()) {
+            return;
+        }
+        auto rhs = gen_rhs.value();
+        if (!ImplicitlyConvertValue(ctx_, rhs, gen_rhs.inferred(), to)) {
+            return;
+        }
+        auto lhs = gen_lhs.value();
+        if (!ImplicitlyConvertValue(ctx_, lhs, gen_lhs.inferred(), to)) {
+            return;
+        }
+
+        // Both sides are always evaluated, as ExprRValGen does.
+        auto op = kind == hir::InfixExpression::Op::Or ? mir::Opcode::Or
+                                                        : mir::Opcode::And;
+        value_ = builder.Binary(op, lhs, rhs);
+        inferred_ = to;
+        success_ = true;
+        return;
+    } else if (kind == hir::InfixExpression::Op::EQ ||
+               kind == hir::InfixExpression::Op::NE ||
+               kind == hir::InfixExpression::Op::LT ||
+               kind == hir::InfixExpression::Op::LE ||
+               kind == hir::InfixExpression::Op::GT ||
+               kind == hir::InfixExpression::Op::GE) {
+        ExprMirGen gen_lhs(ctx_);
+        expr.lhs()->Accept(gen_lhs);
+        if (!gen_lhs) return;
+
+        ExprMirGen gen_rhs(ctx_);
+        expr.rhs()->Accept(gen_rhs);
+        if (!gen_rhs) return;
+
+        auto &lhs_type = gen_lhs.inferred();
+        auto &rhs_type = gen_rhs.inferred();
+        if (!(lhs_type->IsBuiltin() && rhs_type->IsBuiltin()) &&
+            !(lhs_type->IsPointer() && rhs_type->IsPointer()) &&
+            !(lhs_type->IsName() && rhs_type->IsName())) {
+            return;
+        }
+        auto merged = ImplicitlyMergeTwoType(ctx_.ctx(), lhs_type, rhs_type);
+        if (!merged || IsVoidType(merged.value())) return;
+
+        // Relational operator cannot be used for non-integer type, and
+        // structs are not comparable in mir.
+        bool equality = kind == hir::InfixExpression::Op::EQ ||
+                        kind == hir::InfixExpression::Op::NE;
+        if (merged.value()->IsPointer() ||
+            (merged.value()->IsBuiltin() && !IsIntegerType(merged.value()))) {
+            if (!equality) return;
+        }
+        if (!MirTypeOf(ctx_.ctx(), merged.value())) return;
+
+        auto rhs = gen_rhs.value();
+        if (!ImplicitlyConvertValue(ctx_, rhs, rhs_type, merged.value())) {
+            return;
+        }
+        auto lhs = gen_lhs.value();
+        if (!ImplicitlyConvertValue(ctx_, lhs, lhs_type, merged.value())) {
+            return;
+        }
+
+        auto is_signed = IsSignedType(ctx_.ctx(), merged.value());
+        mir::Opcode op;
+        switch (kind) {
+            case hir::InfixExpression::Op::EQ:
+                op = mir::Opcode::Eq;
+                break;
+            case hir::InfixExpression::Op::NE:
+                op = mir::Opcode::Ne;
+                break;
+            case hir::InfixExpression::Op::LT:
+                op = is_signed ? mir::Opcode::SLt : mir::Opcode::ULt;
+                break;
+            case hir::InfixExpression::Op::LE:
+                op = is_signed ? mir::Opcode::SLe : mir::Opcode::ULe;
+                break;
+            case hir::InfixExpression::Op::GT:
+                op = is_signed ? mir::Opcode::SGt : mir::Opcode::UGt;
+                break;
+            default:
+                op = is_signed ? mir::Opcode::SGe : mir::Opcode::UGe;
+                break;
+        }
+        value_ = builder.Compare(op, lhs, rhs);
+        inferred_ =
+            hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool, expr.span());
+        success_ = true;
+        return;
+    }
+
+    // Others are operators of two integers.
+    mir::Value lhs, rhs;
+    if (!GenIntegerOperands(ctx_, lhs, rhs, inferred_, expr)) return;
+    auto is_signed = inferred_->ToBuiltin()->IsSigned();
+
+    mir::Opcode op;
+    switch (kind) {
+        case hir::InfixExpression::Op::Mul:
+            op = mir::Opcode::Mul;
+            break;
+        case hir::InfixExpression::Op::Div:
+            op = is_signed ? mir::Opcode::SDiv : mir::Opcode::UDiv;
+            break;
+        case hir::InfixExpression::Op::Mod:
+            op = is_signed ? mir::Opcode::SRem : mir::Opcode::URem;
+            break;
+        case hir::InfixExpression::Op::BitOr:
+            op = mir::Opcode::Or;
+            break;
+        case hir::InfixExpression::Op::BitAnd:
+            op = mir::Opcode::And;
+            break;
+        case hir::InfixExpression::Op::BitXor:
+            op = mir::Opcode::Xor;
+            break;
+        case hir::InfixExpression::Op::LShift:
+            op = mir::Opcode::Shl;
+            break;
+        case hir::InfixExpression::Op::RShift:
+            op = is_signed ? mir::Opcode::AShr : mir::Opcode::LShr;
+            break;
+        default:
+            FatalError("unreachable");
+    }
+    value_ = builder.Binary(op, lhs, rhs);
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::IndexExpression &expr) {
+    ExprAddrMirGen gen_addr(ctx_);
+    expr.Accept(gen_addr);
+    if (!gen_addr) return;
+
+    auto value = LoadValue(ctx_, gen_addr.value(), gen_addr.inferred());
+    if (!value) return;
+
+    value_ = *value;
+    inferred_ = gen_addr.inferred();
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::CallExpression &expr) {
+    class IsVariable : public hir::ExpressionVisitor {
+    public:
+        std::optional<Symbol> value;
+        void Visit(const hir::UnaryExpression &) override {}
+        void Visit(const hir::InfixExpression &) override {}
+        void Visit(const hir::IndexExpression &) override {}
+        void Visit(const hir::CallExpression &) override {}
+        void Visit(const hir::AccessExpression &) override {}
+        void Visit(const hir::CastExpression &) override {}
+        void Visit(const hir::ESizeofExpression &) override {}
+        void Visit(const hir::TSizeofExpression &) override {}
+        void Visit(const hir::EnumSelectExpression &) override {}
+        void Visit(const hir::VariableExpression &expr) override {
+            value = expr.value();
+        }
+        void Visit(const hir::IntegerExpression &) override {}
+        void Visit(const hir::StringExpression &) override {}
+        void Visit(const hir::CharExpression &) override {}
+        void Visit(const hir::BoolExpression &) override {}
+        void Visit(const hir::NullPtrExpression &) override {}
+        void Visit(const hir::StructExpression &) override {}
+        void Visit(const hir::ArrayExpression &) override {}
+    };
+
+    IsVariable var;
+    expr.func()->Accept(var);
+    if (!var.value || !ctx_.ctx().func_info_table().Exists(*var.value)) {
+        return;
+    }
+    auto &callee = ctx_.ctx().func_info_table().Query(*var.value);
+
+    if (!callee.has_variadic() &&
+        callee.params().size() != expr.args().size()) {
+        return;
+    }
+
+    // Fat objects are passed and returned in memory, which is not supported.
+    std::optional<mir::Type> ret;
+    if (!IsVoidType(callee.ret_type())) {
+        ret = MirTypeOf(ctx_.ctx(), callee.ret_type());
+        if (!ret) return;
+    }
+
+    std::vector<mir::Value> args;
+    for (size_t i = 0; i < expr.args().size(); i++) {
+        auto &arg = expr.args().at(i);
+
+        ExprMirGen gen(ctx_);
+        arg->Accept(gen);
+        if (!gen) return;
+
+        // If it's variadic, infer expected type from inferred type.
+        std::shared_ptr<hir::Type> expect_type =
+            i < callee.params().size() ? callee.params().at(i).second
+                                       : ConvertTypeAtVariadic(gen.inferred());
+        if (!MirTypeOf(ctx_.ctx(), expect_type)) return;
+
+        auto value = gen.value();
+        if (!ImplicitlyConvertValue(ctx_, value, gen.inferred(),
+                                    expect_type)) {
+            return;
+        }
+        args.push_back(value);
+    }
+
+    value_ = ctx_.builder().Call(*var.value, callee.is_outer(),
+                                 std::move(args), ret);
+    inferred_ = callee.ret_type();
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::AccessExpression &expr) {
+    ExprAddrMirGen gen_addr(ctx_);
+    expr.Accept(gen_addr);
+    if (!gen_addr) return;
+
+    auto value = LoadValue(ctx_, gen_addr.value(), gen_addr.inferred());
+    if (!value) return;
+
+    value_ = *value;
+    inferred_ = gen_addr.inferred();
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::CastExpression &expr) {
+    ExprMirGen gen(ctx_);
+    expr.expr()->Accept(gen);
+    if (!gen) return;
+
+    auto &from = gen.inferred();
+    auto &to = expr.cast_type();
+    if (from->IsPointer() && to->IsPointer()) {
+        value_ = gen.value();
+    } else if (from->IsBuiltin() && !IsVoidType(from) &&
+               (to->IsPointer() || (to->IsBuiltin() && !IsVoidType(to)))) {
+        auto type = MirTypeOf(ctx_.ctx(), to);
+        if (!type) return;
+        value_ = ctx_.builder().Convert(gen.value(), *type,
+                                        from->ToBuiltin()->IsSigned());
+    } else {
+        // ExprRValGen reports it.
+        return;
+    }
+
+    inferred_ = to;
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::ESizeofExpression &expr) {
+    // The operand is not evaluated, so its type must be known beforehand.
+    auto &type = expr.expr()->inferred_type();
+    if (!type) return;
+
+    TypeSizeCalc size(ctx_.ctx());
+    type->Accept(size);
+    if (!size) return;
+
+    value_ = ctx_.builder().Const(mir::Type::I64, size.size());
+    inferred_ =
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize, expr.span());
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::TSizeofExpression &expr) {
+    TypeSizeCalc size(ctx_.ctx());
+    expr.type()->Accept(size);
+    if (!size) return;
+
+    value_ = ctx_.builder().Const(mir::Type::I64, size.size());
+    inferred_ =
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize, expr.span());
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::EnumSelectExpression &expr) {
+    auto &enum_table = ctx_.ctx().enum_table();
+    if (!enum_table.Exists(expr.src().value())) return;
+    auto &entry = enum_table.Query(expr.src().value());
+    if (!entry.Exists(expr.dst().value())) return;
+
+    auto type = MirTypeOf(ctx_.ctx(), entry.base_type());
+    if (!type) return;
+
+    value_ = ctx_.builder().Const(*type, entry.Query(expr.dst().value()));
+    inferred_ = hir::MakeType<hir::NameType>(expr.src().value(), expr.span());
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::VariableExpression &expr) {
+    if (!ctx_.VarExists(expr.value())) return;
+    auto &var = ctx_.QueryVar(expr.value());
+
+    if (var.kind() == MirVariable::Ssa) {
+        value_ = ctx_.builder().ReadVariable(var.id());
+    } else {
+        auto addr = ctx_.builder().SlotAddr(var.id());
+        auto value = LoadValue(ctx_, addr, var.type());
+        if (!value) return;
+        value_ = *value;
+    }
+
+    inferred_ = var.type();
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::IntegerExpression &expr) {
+    hir::BuiltinType::Kind kind;
+    mir::Type type;
+    if (expr.value() <= UINT8_MAX) {
+        kind = hir::BuiltinType::UInt8;
+        type = mir::Type::I8;
+    } else if (expr.value() <= UINT16_MAX) {
+        kind = hir::BuiltinType::UInt16;
+        type = mir::Type::I16;
+    } else if (expr.value() <= UINT32_MAX) {
+        kind = hir::BuiltinType::UInt32;
+        type = mir::Type::I32;
+    } else {
+        kind = hir::BuiltinType::UInt64;
+        type = mir::Type::I64;
+    }
+
+    value_ = ctx_.builder().Const(type, expr.value());
+    inferred_ = hir::MakeType<hir::BuiltinType>(kind, expr.span());
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::StringExpression &expr) {
+    auto &symbol = ctx_.ctx().string_table().QuerySymbol(expr.value());
+    value_ = ctx_.builder().StrAddr(Symbol(symbol));
+
+    auto of =
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Char, expr.span());
+    inferred_ = hir::MakeType<hir::ArrayType>(of, expr.value().size() + 1,
+                                              expr.span());
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::CharExpression &expr) {
+    value_ = ctx_.builder().Const(mir::Type::I8, expr.value());
+    inferred_ =
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Char, expr.span());
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::BoolExpression &expr) {
+    value_ = ctx_.builder().Const(mir::Type::I8, expr.value() ? 1 : 0);
+    inferred_ =
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool, expr.span());
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::NullPtrExpression &expr) {
+    value_ = ctx_.builder().Const(mir::Type::I64, 0);
+
+    auto of =
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Void, expr.span());
+    inferred_ = hir::MakeType<hir::PointerType>(of, expr.span());
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::StructExpression &expr) {
+    auto type = hir::MakeType<hir::NameType>(expr.name().value(), expr.span());
+
+    if (!ctx_.ctx().struct_table().Exists(expr.name().value())) return;
+    auto &entry = ctx_.ctx().struct_table().Query(expr.name().value());
+
+    TypeSizeCalc size(ctx_.ctx());
+    type->Accept(size);
+    if (!size) return;
+
+    TypeAlignCalc align(ctx_.ctx());
+    type->Accept(align);
+    if (!align) return;
+
+    // The object lives in its own slot.
+    auto &builder = ctx_.builder();
+    auto slot = builder.func().NewSlot(size.size(), align.align());
+    auto base = builder.SlotAddr(slot);
+
+    for (const auto &init : expr.inits()) {
+        if (!entry.Exists(init.name().value())) return;
+        auto &field = entry.Query(init.name().value());
+
+        ExprMirGen gen(ctx_);
+        init.value()->Accept(gen);
+        if (!gen) return;
+
+        auto value = gen.value();
+        if (!ImplicitlyConvertValue(ctx_, value, gen.inferred(),
+                                    field.type())) {
+            return;
+        }
+        auto addr = OffsetAddr(ctx_, base, field.Offset());
+        if (!StoreValue(ctx_, addr, value, field.type())) return;
+    }
+
+    value_ = base;
+    inferred_ = type;
+    success_ = true;
+}
+
+void ExprMirGen::Visit(const hir::ArrayExpression &expr) {
+    if (!array_base_type_) return;
+    auto &base_type = array_base_type_.value();
+
+    TypeSizeCalc base_size(ctx_.ctx());
+    base_type->Accept(base_size);
+    if (!base_size) return;
+
+    TypeAlignCalc base_align(ctx_.ctx());
+    base_type->Accept(base_align);
+    if (!base_align) return;
+
+    // The object lives in its own slot.
+    auto &builder = ctx_.builder();
+    auto slot = builder.func().NewSlot(base_size.size() * expr.inits().size(),
+                                       base_align.align());
+    auto base = builder.SlotAddr(slot);
+
+    std::optional<std::shared_ptr<hir::Type>> of;
+    if (base_type->IsArray()) of = base_type->ToArray()->of();
+
+    for (size_t i = 0; i < expr.inits().size(); i++) {
+        ExprMirGen gen(ctx_, of);
+        expr.inits().at(i)->Accept(gen);
+        if (!gen) return;
+
+        auto value = gen.value();
+        if (!ImplicitlyConvertValue(ctx_, value, gen.inferred(), base_type)) {
+            return;
+        }
+        auto addr = OffsetAddr(ctx_, base, i * base_size.size());
+        if (!StoreValue(ctx_, addr, value, base_type)) return;
+    }
+
+    value_ = base;
+    inferred_ = hir::MakeType<hir::ArrayType>(base_type, expr.inits().size(),
+                                              expr.span());
+    success_ = true;
+}
+
+void ExprAddrMirGen::Visit(const hir::UnaryExpression &expr) {
+    if (expr.op().kind() != hir::UnaryExpression::Op::Deref) return;
+
+    ExprMirGen gen(ctx_);
+    expr.expr()->Accept(gen);
+    if (!gen) return;
+    if (!gen.inferred()->IsPointer()) return;
+
+    value_ = gen.value();
+    inferred_ = gen.inferred()->ToPointer()->of();
+    success_ = true;
+}
+
+void ExprAddrMirGen::Visit(const hir::IndexExpression &expr) {
+    // Both of array and pointer are generated as address.
+    ExprMirGen gen_addr(ctx_);
+    expr.expr()->Accept(gen_addr);
+    if (!gen_addr) return;
+
+    std::shared_ptr<hir::Type> of;
+    if (gen_addr.inferred()->IsArray()) {
+        of = gen_addr.inferred()->ToArray()->of();
+    } else if (gen_addr.inferred()->IsPointer()) {
+        of = gen_addr.inferred()->ToPointer()->of();
+    } else {
+        return;
+    }
+
+    TypeSizeCalc of_size(ctx_.ctx());
+    of->Accept(of_size);
+    if (!of_size) return;
+
+    ExprMirGen gen_index(ctx_);
+    expr.index()->Accept(gen_index);
+    if (!gen_index) return;
+
+    auto to = hir::MakeType<hir::BuiltinType>(hir::BuiltinType::USize,
+                                              expr.index()->span());
+    auto index = gen_index.value();
+    if (!ImplicitlyConvertValue(ctx_, index, gen_index.inferred(), to)) {
+        return;
+    }
+
+    auto &builder = ctx_.builder();
+    auto offset = builder.Binary(mir::Opcode::Mul, index,
+                                 builder.Const(mir::Type::I64, of_size.size()));
+    value_ = builder.Binary(mir::Opcode::Add, gen_addr.value(), offset);
+    inferred_ = of;
+    success_ = true;
+}
+
+void ExprAddrMirGen::Visit(const hir::AccessExpression &expr) {
+    // Both of struct and pointer to struct are generated as address.
+    ExprMirGen gen_addr(ctx_);
+    expr.expr()->Accept(gen_addr);
+    if (!gen_addr) return;
+
+    auto type = gen_addr.inferred();
+    if (type->IsPointer()) type = type->ToPointer()->of();
+    if (!type->IsName()) return;
+
+    auto name = type->ToName()->value();
+    if (!ctx_.ctx().struct_table().Exists(name)) return;
+    auto &entry = ctx_.ctx().struct_table().Query(name);
+
+    if (!entry.SizeAndOffsetCalculated()) {
+        if (!CalculateStructSizeAndOffset(ctx_.ctx(), name, expr.span())) {
+            return;
+        }
+    }
+
+    if (!entry.Exists(expr.field().value())) return;
+    auto &field = entry.Query(expr.field().value());
+
+    value_ = OffsetAddr(ctx_, gen_addr.value(), field.Offset());
+    inferred_ = field.type();
+    success_ = true;
+}
+
+void ExprAddrMirGen::Visit(const hir::VariableExpression &expr) {
+    if (!ctx_.VarExists(expr.value())) return;
+    auto &var = ctx_.QueryVar(expr.value());
+    if (var.kind() != MirVariable::Slot) return;
+
+    value_ = ctx_.builder().SlotAddr(var.id());
+    inferred_ = var.type();
+    success_ = true;
+}
+
+bool ImplicitlyConvertValue(MirGenContext &ctx, mir::Value &value,
+                            const std::shared_ptr<hir::Type> &from,
+                            const std::shared_ptr<hir::Type> &to) {
+    if (from->IsBuiltin()) {
+        if (!to->IsBuiltin()) return false;
+
+        auto from_builtin = from->ToBuiltin();
+        auto to_builtin = to->ToBuiltin();
+        if (from_builtin->kind() == to_builtin->kind()) return true;
+        if (!from_builtin->IsInteger() || !to_builtin->IsInteger()) {
+            return false;
+        }
+
+        // Integers are implicitly converted only if no value is lost: to
+        // larger integer, but not from signed to unsigned. isize and usize
+        // are the same as int64 and uint64.
+        if (from_builtin->IsSigned() && to_builtin->IsUnsigned()) return false;
+        auto from_type = MirTypeOf(ctx.ctx(), from);
+        auto to_type = MirTypeOf(ctx.ctx(), to);
+        if (!from_type || !to_type) return false;
+        if (from_type == to_type) {
+            return from_builtin->IsSigned() == to_builtin->IsSigned() &&
+                   *to_type == mir::Type::I64;
+        }
+        if (mir::SizeOf(*from_type) > mir::SizeOf(*to_type)) return false;
+
+        value = ctx.builder().Convert(value, *to_type,
+                                      from_builtin->IsSigned());
+        return true;
+    } else if (from->IsPointer()) {
+        if (!to->IsPointer()) return false;
+        auto &from_of = from->ToPointer()->of();
+        auto &to_of = to->ToPointer()->of();
+        return IsVoidType(from_of) || IsVoidType(to_of) || *from_of == *to_of;
+    } else if (from->IsName()) {
+        if (*from == *to) return true;
+        auto name = from->ToName()->value();
+        if (!ctx.ctx().enum_table().Exists(name)) return false;
+        auto &base_type = ctx.ctx().enum_table().Query(name).base_type();
+        return ImplicitlyConvertValue(ctx, value, base_type, to);
+    } else if (from->IsArray()) {
+        // The value of array is its address, which is also the pointer to
+        // its first element.
+        if (to->IsArray()) {
+            return *from == *to;
+        } else if (to->IsPointer()) {
+            return *from->ToArray()->of() == *to->ToPointer()->of();
+        } else {
+            return false;
+        }
+    } else {
+        FatalError("unreachable");
+    }
+}
+
+}  // namespace mini
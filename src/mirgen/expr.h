@@ -0,0 +1,105 @@
+#ifndef MINI_MIRGEN_EXPR_H_
+#define MINI_MIRGEN_EXPR_H_
+
+#include <memory>
+#include <optional>
+
+#include "../hir/expr.h"
+#include "../mir/mir.h"
+#include "context.h"
+
+namespace mini {
+
+// Evaluate expression as rvalue. The value of fat object is its address, and
+// the value of void is `mir::no_value`.
+//
+// Nothing is reported: expressions which fails here are generated again by
+// ExprRValGen to report errors.
+class ExprMirGen : public hir::ExpressionVisitor {
+public:
+    ExprMirGen(MirGenContext &ctx)
+        : success_(false),
+          array_base_type_(std::nullopt),
+          value_(mir::no_value),
+          ctx_(ctx) {}
+    ExprMirGen(MirGenContext &ctx,
+               const std::optional<std::shared_ptr<hir::Type>> &array_base_type)
+        : success_(false),
+          array_base_type_(array_base_type),
+          value_(mir::no_value),
+          ctx_(ctx) {}
+    explicit operator bool() const { return success_; }
+    mir::Value value() const { return value_; }
+    const std::shared_ptr<hir::Type> &inferred() const { return inferred_; }
+    void Visit(const hir::UnaryExpression &expr) override;
+    void Visit(const hir::InfixExpression &expr) override;
+    void Visit(const hir::IndexExpression &expr) override;
+    void Visit(const hir::CallExpression &expr) override;
+    void Visit(const hir::AccessExpression &expr) override;
+    void Visit(const hir::CastExpression &expr) override;
+    void Visit(const hir::ESizeofExpression &expr) override;
+    void Visit(const hir::TSizeofExpression &expr) override;
+    void Visit(const hir::EnumSelectExpression &expr) override;
+    void Visit(const hir::VariableExpression &expr) override;
+    void Visit(const hir::IntegerExpression &expr) override;
+    void Visit(const hir::StringExpression &expr) override;
+    void Visit(const hir::CharExpression &expr) override;
+    void Visit(const hir::BoolExpression &expr) override;
+    void Visit(const hir::NullPtrExpression &expr) override;
+    void Visit(const hir::StructExpression &expr) override;
+    void Visit(const hir::ArrayExpression &expr) override;
+
+private:
+    bool success_;
+
+    // What the base type of array is expected.
+    // Only used for generate expression of hir::ArrayExpression
+    std::optional<std::shared_ptr<hir::Type>> array_base_type_;
+
+    mir::Value value_;
+    std::shared_ptr<hir::Type> inferred_;
+    MirGenContext &ctx_;
+};
+
+// Evaluate expression as lvalue: the value is the address of the object.
+class ExprAddrMirGen : public hir::ExpressionVisitor {
+public:
+    ExprAddrMirGen(MirGenContext &ctx)
+        : success_(false), value_(mir::no_value), ctx_(ctx) {}
+    explicit operator bool() const { return success_; }
+    mir::Value value() const { return value_; }
+    const std::shared_ptr<hir::Type> &inferred() const { return inferred_; }
+    void Visit(const hir::UnaryExpression &expr) override;
+    void Visit(const hir::InfixExpression &) override {}
+    void Visit(const hir::IndexExpression &expr) override;
+    void Visit(const hir::CallExpression &) override {}
+    void Visit(const hir::AccessExpression &expr) override;
+    void Visit(const hir::CastExpression &) override {}
+    void Visit(const hir::ESizeofExpression &) override {}
+    void Visit(const hir::TSizeofExpression &) override {}
+    void Visit(const hir::EnumSelectExpression &) override {}
+    void Visit(const hir::VariableExpression &expr) override;
+    void Visit(const hir::IntegerExpression &) override {}
+    void Visit(const hir::StringExpression &) override {}
+    void Visit(const hir::CharExpression &) override {}
+    void Visit(const hir::BoolExpression &) override {}
+    void Visit(const hir::NullPtrExpression &) override {}
+    void Visit(const hir::StructExpression &) override {}
+    void Visit(const hir::ArrayExpression &) override {}
+
+private:
+    bool success_;
+    mir::Value value_;
+    std::shared_ptr<hir::Type> inferred_;
+    MirGenContext &ctx_;
+};
+
+// Implicitly convert `value` of type `from` to type `to`, following the same
+// rules as ImplicitlyConvertValueInStack.
+bool ImplicitlyConvertValue(MirGenContext &ctx, mir::Value &value,
+                            const std::shared_ptr<hir::Type> &from,
+                            const std::shared_ptr<hir::Type> &to);
+
+}  // namespace mini
+
+#endif  // MINI_MIRGEN_EXPR_H_
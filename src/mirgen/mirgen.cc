@@ -0,0 +1,196 @@
+#include "mirgen.h"
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../codegen/expr.h"
+#include "../codegen/type.h"
+#include "../mir/builder.h"
+#include "../mir/verify.h"
+#include "../panic.h"
+#include "context.h"
+#include "stmt.h"
+
+namespace mini {
+
+// Collects variables whose address is taken by `&`, which must live in
+// memory.
+class AddrTakenCollect : public hir::StatementVisitor,
+                         public hir::ExpressionVisitor {
+public:
+    const std::unordered_set<Symbol> &vars() const { return vars_; }
+    void Visit(const hir::ExpressionStatement &stmt) override {
+        stmt.expr()->Accept(*this);
+    }
+    void Visit(const hir::ReturnStatement &stmt) override {
+        if (stmt.ret_value()) stmt.ret_value().value()->Accept(*this);
+    }
+    void Visit(const hir::BreakStatement &) override {}
+    void Visit(const hir::ContinueStatement &) override {}
+    void Visit(const hir::WhileStatement &stmt) override {
+        stmt.cond()->Accept(*this);
+        stmt.body()->Accept(*this);
+    }
+    void Visit(const hir::IfStatement &stmt) override {
+        stmt.cond()->Accept(*this);
+        stmt.then_body()->Accept(*this);
+        if (stmt.else_body()) stmt.else_body().value()->Accept(*this);
+    }
+    void Visit(const hir::BlockStatement &stmt) override {
+        for (const auto &stmt : stmt.stmts()) stmt->Accept(*this);
+    }
+    void Visit(const hir::UnaryExpression &expr) override {
+        if (expr.op().kind() == hir::UnaryExpression::Op::Ref) {
+            referred_ = true;
+            expr.expr()->Accept(*this);
+            referred_ = false;
+        } else {
+            expr.expr()->Accept(*this);
+        }
+    }
+    void Visit(const hir::InfixExpression &expr) override {
+        referred_ = false;
+        expr.lhs()->Accept(*this);
+        expr.rhs()->Accept(*this);
+    }
+    void Visit(const hir::IndexExpression &expr) override {
+        referred_ = false;
+        expr.expr()->Accept(*this);
+        expr.index()->Accept(*this);
+    }
+    void Visit(const hir::CallExpression &expr) override {
+        referred_ = false;
+        expr.func()->Accept(*this);
+        for (const auto &arg : expr.args()) arg->Accept(*this);
+    }
+    void Visit(const hir::AccessExpression &expr) override {
+        referred_ = false;
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::CastExpression &expr) override {
+        referred_ = false;
+        expr.expr()->Accept(*this);
+    }
+    void Visit(const hir::ESizeofExpression &) override {}
+    void Visit(const hir::TSizeofExpression &) override {}
+    void Visit(const hir::EnumSelectExpression &) override {}
+    void Visit(const hir::VariableExpression &expr) override {
+        if (referred_) vars_.insert(expr.value());
+    }
+    void Visit(const hir::IntegerExpression &) override {}
+    void Visit(const hir::StringExpression &) override {}
+    void Visit(const hir::CharExpression &) override {}
+    void Visit(const hir::BoolExpression &) override {}
+    void Visit(const hir::NullPtrExpression &) override {}
+    void Visit(const hir::StructExpression &expr) override {
+        referred_ = false;
+        for (const auto &init : expr.inits()) init.value()->Accept(*this);
+    }
+    void Visit(const hir::ArrayExpression &expr) override {
+        referred_ = false;
+        for (const auto &init : expr.inits()) init->Accept(*this);
+    }
+
+private:
+    bool referred_ = false;
+    std::unordered_set<Symbol> vars_;
+};
+
+// Declares `name` as a ssa variable, or in a slot if it must be in memory.
+static bool DeclareVar(MirGenContext &ctx, Symbol name,
+                       const std::shared_ptr<hir::Type> &type,
+                       bool addr_taken) {
+    auto &builder = ctx.builder();
+    auto mir_type = MirTypeOf(ctx.ctx(), type);
+    if (mir_type && !addr_taken) {
+        auto var = builder.NewVariable(*mir_type);
+        ctx.InsertVar(name, MirVariable(MirVariable::Ssa, var, type));
+        return true;
+    }
+
+    TypeSizeCalc size(ctx.ctx());
+    type->Accept(size);
+    if (!size || size.size() == 0) return false;
+
+    TypeAlignCalc align(ctx.ctx());
+    type->Accept(align);
+    if (!align) return false;
+
+    auto slot = builder.func().NewSlot(size.size(), align.align());
+    ctx.InsertVar(name, MirVariable(MirVariable::Slot, slot, type));
+    return true;
+}
+
+MirGenResult MirGen(CodeGenContext &ctx, const hir::FunctionDeclaration &decl) {
+    if (!decl.body() || decl.variadic()) return std::nullopt;
+
+    std::optional<mir::Type> ret;
+    if (!decl.ret()->IsBuiltin() ||
+        decl.ret()->ToBuiltin()->kind() != hir::BuiltinType::Void) {
+        ret = MirTypeOf(ctx, decl.ret());
+        if (!ret) return std::nullopt;
+    }
+
+    std::vector<mir::Type> params;
+    for (const auto &param : decl.params()) {
+        auto type = MirTypeOf(ctx, param.type());
+        if (!type) return std::nullopt;
+        params.push_back(*type);
+    }
+
+    mir::Function func(decl.name().value(), std::move(params), ret);
+    mir::Builder builder(func);
+    MirGenContext mir_ctx(ctx, builder, decl.ret());
+
+    AddrTakenCollect collect;
+    decl.body()->Accept(collect);
+    auto addr_taken = [&](Symbol name) {
+        return collect.vars().find(name) != collect.vars().end();
+    };
+
+    std::vector<mir::Value> args;
+    for (size_t i = 0; i < decl.params().size(); i++) {
+        args.push_back(builder.Arg(func.params().at(i), i));
+    }
+
+    for (size_t i = 0; i < decl.params().size(); i++) {
+        auto &param = decl.params().at(i);
+        auto name = param.name().value();
+        if (!DeclareVar(mir_ctx, name, param.type(), addr_taken(name))) {
+            return std::nullopt;
+        }
+
+        auto &var = mir_ctx.QueryVar(name);
+        if (var.kind() == MirVariable::Ssa) {
+            builder.WriteVariable(var.id(), args.at(i));
+        } else {
+            builder.Store(builder.SlotAddr(var.id()), args.at(i));
+        }
+    }
+    for (const auto &var : decl.decls()) {
+        auto name = var.name().value();
+        if (!DeclareVar(mir_ctx, name, var.type(), addr_taken(name))) {
+            return std::nullopt;
+        }
+    }
+
+    StmtMirGen gen(mir_ctx);
+    decl.body()->Accept(gen);
+    if (!gen) return std::nullopt;
+
+    // Falling off the end returns 0, as the value is unspecified.
+    if (ret) {
+        builder.Return(builder.Const(*ret, 0));
+    } else {
+        builder.Return(std::nullopt);
+    }
+    builder.Finish();
+
+    if (auto error = mir::Verify(func)) {
+        FatalError("invalid mir of {}: {}", decl.name().value(), *error);
+    }
+    return func;
+}
+
+}  // namespace mini
@@ -0,0 +1,21 @@
+#ifndef MINI_MIRGEN_MIRGEN_H_
+#define MINI_MIRGEN_MIRGEN_H_
+
+#include <optional>
+
+#include "../codegen/context.h"
+#include "../hir/decl.h"
+#include "../mir/mir.h"
+
+namespace mini {
+
+using MirGenResult = std::optional<mir::Function>;
+
+// Translates the function to mir. Nothing is reported, and nullopt is
+// returned if the function uses something mir doesn't support, such as fat
+// parameters or return value, or if it has errors.
+MirGenResult MirGen(CodeGenContext &ctx, const hir::FunctionDeclaration &decl);
+
+}  // namespace mini
+
+#endif  // MINI_MIRGEN_MIRGEN_H_
@@ -0,0 +1,149 @@
+#include "stmt.h"
+
+#include <optional>
+
+#include "expr.h"
+
+namespace mini {
+
+// Generates `cond` and converts it to bool.
+static std::optional<mir::Value> GenCond(
+    MirGenContext &ctx, const std::unique_ptr<hir::Expression> &cond) {
+    ExprMirGen gen(ctx);
+    cond->Accept(gen);
+    if (!gen) return std::nullopt;
+
+    auto to =
+        hir::MakeType<hir::BuiltinType>(hir::BuiltinType::Bool, cond->span());
+    auto value = gen.value();
+    if (!ImplicitlyConvertValue(ctx, value, gen.inferred(), to)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+void StmtMirGen::Visit(const hir::ExpressionStatement &stmt) {
+    ExprMirGen gen(ctx_);
+    stmt.expr()->Accept(gen);
+    if (!gen) return;
+    success_ = true;
+}
+
+void StmtMirGen::Visit(const hir::ReturnStatement &stmt) {
+    auto &builder = ctx_.builder();
+    auto &ret_type = ctx_.ret_type();
+    auto is_void = ret_type->IsBuiltin() &&
+                   ret_type->ToBuiltin()->kind() == hir::BuiltinType::Void;
+
+    if (!stmt.ret_value()) {
+        if (!is_void) return;
+        builder.Return(std::nullopt);
+    } else {
+        ExprMirGen gen(ctx_);
+        stmt.ret_value().value()->Accept(gen);
+        if (!gen) return;
+
+        auto value = gen.value();
+        if (!ImplicitlyConvertValue(ctx_, value, gen.inferred(), ret_type)) {
+            return;
+        }
+        if (is_void) {
+            builder.Return(std::nullopt);
+        } else {
+            builder.Return(value);
+        }
+    }
+
+    // Statements after this are never executed.
+    builder.SwitchTo(builder.NewUnreachableBlock());
+    success_ = true;
+}
+
+void StmtMirGen::Visit(const hir::BreakStatement &) {
+    if (!ctx_.IsInLoop()) return;
+
+    auto &builder = ctx_.builder();
+    builder.Jump(ctx_.CurrLoop().exit);
+    builder.SwitchTo(builder.NewUnreachableBlock());
+    success_ = true;
+}
+
+void StmtMirGen::Visit(const hir::ContinueStatement &) {
+    if (!ctx_.IsInLoop()) return;
+
+    auto &builder = ctx_.builder();
+    builder.Jump(ctx_.CurrLoop().header);
+    builder.SwitchTo(builder.NewUnreachableBlock());
+    success_ = true;
+}
+
+void StmtMirGen::Visit(const hir::WhileStatement &stmt) {
+    auto &builder = ctx_.builder();
+    auto header = builder.NewBlock();
+    auto body = builder.NewBlock();
+    auto exit = builder.NewBlock();
+
+    // The header is sealed after the body, as `continue` and the end of the
+    // body jump to it.
+    builder.Jump(header);
+    builder.SwitchTo(header);
+    auto cond = GenCond(ctx_, stmt.cond());
+    if (!cond) return;
+    builder.Branch(*cond, body, exit);
+    builder.Seal(body);
+
+    builder.SwitchTo(body);
+    ctx_.EnterLoop(header, exit);
+    StmtMirGen body_gen(ctx_);
+    stmt.body()->Accept(body_gen);
+    ctx_.LeaveLoop();
+    if (!body_gen) return;
+    builder.Jump(header);
+
+    builder.Seal(header);
+    builder.Seal(exit);
+    builder.SwitchTo(exit);
+    success_ = true;
+}
+
+void StmtMirGen::Visit(const hir::IfStatement &stmt) {
+    auto &builder = ctx_.builder();
+    auto then_block = builder.NewBlock();
+    auto else_block = builder.NewBlock();
+    auto end_block = builder.NewBlock();
+
+    auto cond = GenCond(ctx_, stmt.cond());
+    if (!cond) return;
+    builder.Branch(*cond, then_block, else_block);
+    builder.Seal(then_block);
+    builder.Seal(else_block);
+
+    builder.SwitchTo(then_block);
+    StmtMirGen then_gen(ctx_);
+    stmt.then_body()->Accept(then_gen);
+    if (!then_gen) return;
+    builder.Jump(end_block);
+
+    builder.SwitchTo(else_block);
+    if (stmt.else_body()) {
+        StmtMirGen else_gen(ctx_);
+        stmt.else_body().value()->Accept(else_gen);
+        if (!else_gen) return;
+    }
+    builder.Jump(end_block);
+
+    builder.Seal(end_block);
+    builder.SwitchTo(end_block);
+    success_ = true;
+}
+
+void StmtMirGen::Visit(const hir::BlockStatement &stmt) {
+    for (const auto &stmt : stmt.stmts()) {
+        StmtMirGen gen(ctx_);
+        stmt->Accept(gen);
+        if (!gen) return;
+    }
+    success_ = true;
+}
+
+}  // namespace mini
@@ -10,14 +10,16 @@ namespace mini {
 
 std::optional<std::unique_ptr<ast::Declaration>> ParseDecl(Context &ctx,
                                                            TokenStream &ts) {
-    if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::Function)) {
+    if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::Function) ||
+        ts.CurrToken().IsKeywordOf(KeywordTokenKind::Inline) ||
+        ts.CurrToken().IsKeywordOf(KeywordTokenKind::NoInline)) {
         return ParseFuncDecl(ctx, ts);
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::Struct)) {
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::Struct)) {
         return ParseStructDecl(ctx, ts);
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::Enum)) {
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::Enum)) {
         return ParseEnumDecl(ctx, ts);
     } else {
-        ReportInfo info(ts.CurrToken()->span(),
+        ReportInfo info(ts.CurrToken().span(),
                         "expected one of `function`, `struct` or `enum`", "");
         Report(ctx, ReportLevel::Error, info);
         return std::nullopt;
@@ -26,33 +28,44 @@ std::optional<std::unique_ptr<ast::Declaration>> ParseDecl(Context &ctx,
 
 std::optional<std::unique_ptr<ast::FunctionDeclaration>> ParseFuncDecl(
     Context &ctx, TokenStream &ts) {
+    std::optional<ast::FunctionDeclarationInline> inline_attr;
+    if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::Inline)) {
+        inline_attr.emplace(ast::FunctionDeclarationInline::Inline,
+                            ts.CurrToken().span());
+        ts.Advance();
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::NoInline)) {
+        inline_attr.emplace(ast::FunctionDeclarationInline::NoInline,
+                            ts.CurrToken().span());
+        ts.Advance();
+    }
+
     TRY(check_keyword(ctx, ts, KeywordTokenKind::Function));
-    ast::Function function_kw(ts.CurrToken()->span());
+    ast::Function function_kw(ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_ident(ctx, ts));
-    std::string value = ts.CurrToken()->IdentValue();
-    ast::FunctionDeclarationName name(std::move(value), ts.CurrToken()->span());
+    Symbol value = ts.CurrToken().IdentValue();
+    ast::FunctionDeclarationName name(std::move(value), ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_punct(ctx, ts, PunctTokenKind::LParen));
-    ast::LParen lparen(ts.CurrToken()->span());
+    ast::LParen lparen(ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_eos(ctx, ts));
     std::vector<ast::FunctionDeclarationParam> params;
     std::optional<ast::FunctionDeclarationVariadic> variadic;
-    if (!ts.CurrToken()->IsPunctOf(PunctTokenKind::RParen)) {
+    if (!ts.CurrToken().IsPunctOf(PunctTokenKind::RParen)) {
         while (true) {
             TRY(check_eos(ctx, ts));
-            if (ts.CurrToken()->IsIdent()) {
-                std::string value = ts.CurrToken()->IdentValue();
+            if (ts.CurrToken().IsIdent()) {
+                Symbol value = ts.CurrToken().IdentValue();
                 ast::FunctionDeclarationParamName name(std::move(value),
-                                                       ts.CurrToken()->span());
+                                                       ts.CurrToken().span());
                 ts.Advance();
 
                 TRY(check_punct(ctx, ts, PunctTokenKind::Colon));
-                ast::Colon colon(ts.CurrToken()->span());
+                ast::Colon colon(ts.CurrToken().span());
                 ts.Advance();
 
                 auto type = ParseType(ctx, ts);
@@ -61,21 +74,21 @@ std::optional<std::unique_ptr<ast::FunctionDeclaration>> ParseFuncDecl(
                 params.emplace_back(std::move(name), colon, std::move(*type));
 
                 TRY(check_eos(ctx, ts));
-                if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RParen)) {
+                if (ts.CurrToken().IsPunctOf(PunctTokenKind::RParen)) {
                     break;
-                } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Comma)) {
+                } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::Comma)) {
                     ts.Advance();
                 }
-            } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::DotDotDot)) {
-                ast::DotDotDot dot3(ts.CurrToken()->span());
+            } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::DotDotDot)) {
+                ast::DotDotDot dot3(ts.CurrToken().span());
                 variadic.emplace(dot3);
                 ts.Advance();
                 break;
-            } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RParen) &&
+            } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::RParen) &&
                        params.empty()) {
                 break;
             } else {
-                ReportInfo info(ts.CurrToken()->span(),
+                ReportInfo info(ts.CurrToken().span(),
                                 "unexpected token found",
                                 "expected identifier or `)`");
                 Report(ctx, ReportLevel::Error, info);
@@ -85,12 +98,12 @@ std::optional<std::unique_ptr<ast::FunctionDeclaration>> ParseFuncDecl(
     }
 
     TRY(check_punct(ctx, ts, PunctTokenKind::RParen));
-    ast::RParen rparen(ts.CurrToken()->span());
+    ast::RParen rparen(ts.CurrToken().span());
     ts.Advance();
 
     std::optional<ast::FunctionDeclarationReturn> ret;
-    if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::Arrow)) {
-        ast::Arrow arrow(ts.CurrToken()->span());
+    if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Arrow)) {
+        ast::Arrow arrow(ts.CurrToken().span());
         ts.Advance();
 
         auto type = ParseType(ctx, ts);
@@ -99,49 +112,50 @@ std::optional<std::unique_ptr<ast::FunctionDeclaration>> ParseFuncDecl(
         ret.emplace(arrow, std::move(*type));
     }
 
-    if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::Semicolon)) {
-        ast::Semicolon semicolon(ts.CurrToken()->span());
+    if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Semicolon)) {
+        ast::Semicolon semicolon(ts.CurrToken().span());
         ts.Advance();
 
         return std::make_unique<ast::FunctionDeclaration>(
-            function_kw, std::move(name), lparen, std::move(params), variadic,
-            rparen, std::move(ret), semicolon);
+            inline_attr, function_kw, std::move(name), lparen,
+            std::move(params), variadic, rparen, std::move(ret), semicolon);
     } else {
         auto body = ParseBlockStmt(ctx, ts);
         if (!body) return std::nullopt;
 
         return std::make_unique<ast::FunctionDeclaration>(
-            function_kw, std::move(name), lparen, std::move(params), variadic,
-            rparen, std::move(ret), std::move(*body));
+            inline_attr, function_kw, std::move(name), lparen,
+            std::move(params), variadic, rparen, std::move(ret),
+            std::move(*body));
     }
 }
 
 std::optional<std::unique_ptr<ast::StructDeclaration>> ParseStructDecl(
     Context &ctx, TokenStream &ts) {
     TRY(check_keyword(ctx, ts, KeywordTokenKind::Struct));
-    ast::Struct struct_kw(ts.CurrToken()->span());
+    ast::Struct struct_kw(ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_ident(ctx, ts));
-    std::string value = ts.CurrToken()->IdentValue();
-    ast::StructDeclarationName name(std::move(value), ts.CurrToken()->span());
+    Symbol value = ts.CurrToken().IdentValue();
+    ast::StructDeclarationName name(std::move(value), ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_punct(ctx, ts, PunctTokenKind::LCurly));
-    ast::LCurly lcurly(ts.CurrToken()->span());
+    ast::LCurly lcurly(ts.CurrToken().span());
     ts.Advance();
 
     std::vector<ast::StructDeclarationField> fields;
     while (true) {
         TRY(check_eos(ctx, ts));
-        if (ts.CurrToken()->IsIdent()) {
-            std::string value = ts.CurrToken()->IdentValue();
+        if (ts.CurrToken().IsIdent()) {
+            Symbol value = ts.CurrToken().IdentValue();
             ast::StructDeclarationFieldName name(std::move(value),
-                                                 ts.CurrToken()->span());
+                                                 ts.CurrToken().span());
             ts.Advance();
 
             TRY(check_punct(ctx, ts, PunctTokenKind::Colon));
-            ast::Colon colon(ts.CurrToken()->span());
+            ast::Colon colon(ts.CurrToken().span());
             ts.Advance();
 
             auto type = ParseType(ctx, ts);
@@ -149,21 +163,21 @@ std::optional<std::unique_ptr<ast::StructDeclaration>> ParseStructDecl(
 
             fields.emplace_back(std::move(name), colon, std::move(*type));
 
-            if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::Comma)) {
+            if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Comma)) {
                 ts.Advance();
             } else {
                 break;
             }
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RCurly)) {
+        } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::RCurly)) {
             break;
         } else {
             if (ts.HasPrev()) {
-                ReportInfo info(ts.PrevToken()->span(), "unexpected token",
+                ReportInfo info(ts.PrevToken().span(), "unexpected token",
                                 "expected identifier or `}` after this");
                 Report(ctx, ReportLevel::Error, info);
                 return std::nullopt;
             } else {
-                ReportInfo info(ts.CurrToken()->span(), "unexpected token",
+                ReportInfo info(ts.CurrToken().span(), "unexpected token",
                                 "expected this to be identifier or `}`");
                 Report(ctx, ReportLevel::Error, info);
                 return std::nullopt;
@@ -172,7 +186,7 @@ std::optional<std::unique_ptr<ast::StructDeclaration>> ParseStructDecl(
     }
 
     TRY(check_punct(ctx, ts, PunctTokenKind::RCurly));
-    ast::RCurly rcurly(ts.CurrToken()->span());
+    ast::RCurly rcurly(ts.CurrToken().span());
     ts.Advance();
 
     return std::make_unique<ast::StructDeclaration>(
@@ -182,17 +196,17 @@ std::optional<std::unique_ptr<ast::StructDeclaration>> ParseStructDecl(
 std::optional<std::unique_ptr<ast::EnumDeclaration>> ParseEnumDecl(
     Context &ctx, TokenStream &ts) {
     TRY(check_keyword(ctx, ts, KeywordTokenKind::Enum));
-    ast::Enum enum_kw(ts.CurrToken()->span());
+    ast::Enum enum_kw(ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_ident(ctx, ts));
-    std::string value = ts.CurrToken()->IdentValue();
-    ast::EnumDeclarationName name(std::move(value), ts.CurrToken()->span());
+    Symbol value = ts.CurrToken().IdentValue();
+    ast::EnumDeclarationName name(std::move(value), ts.CurrToken().span());
     ts.Advance();
 
     std::optional<ast::EnumBaseType> base_type;
-    if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::Colon)) {
-        ast::Colon colon(ts.CurrToken()->span());
+    if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Colon)) {
+        ast::Colon colon(ts.CurrToken().span());
         ts.Advance();
 
         auto type = ParseType(ctx, ts);
@@ -201,21 +215,20 @@ std::optional<std::unique_ptr<ast::EnumDeclaration>> ParseEnumDecl(
     }
 
     TRY(check_punct(ctx, ts, PunctTokenKind::LCurly));
-    ast::LCurly lcurly(ts.CurrToken()->span());
+    ast::LCurly lcurly(ts.CurrToken().span());
     ts.Advance();
 
     std::vector<ast::EnumDeclarationField> fields;
     while (true) {
         TRY(check_eos(ctx, ts));
-        if (ts.CurrToken()->IsIdent()) {
+        if (ts.CurrToken().IsIdent()) {
             ast::EnumDeclarationFieldName name(
-                std::string(ts.CurrToken()->IdentValue()),
-                ts.CurrToken()->span());
+                ts.CurrToken().IdentValue(), ts.CurrToken().span());
             ts.Advance();
 
             std::optional<ast::EnumDeclarationFieldInit> init;
-            if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::Assign)) {
-                ast::Assign assign(ts.CurrToken()->span());
+            if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Assign)) {
+                ast::Assign assign(ts.CurrToken().span());
                 ts.Advance();
 
                 auto value = ParseLogicalOrExpr(ctx, ts);
@@ -226,21 +239,21 @@ std::optional<std::unique_ptr<ast::EnumDeclaration>> ParseEnumDecl(
 
             fields.emplace_back(std::move(name), std::move(init));
 
-            if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::Comma)) {
+            if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Comma)) {
                 ts.Advance();
             } else {
                 break;
             }
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RCurly)) {
+        } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::RCurly)) {
             break;
         } else {
             if (ts.HasPrev()) {
-                ReportInfo info(ts.PrevToken()->span(), "unexpected token",
+                ReportInfo info(ts.PrevToken().span(), "unexpected token",
                                 "expected identifier or `}` after this");
                 Report(ctx, ReportLevel::Error, info);
                 return std::nullopt;
             } else {
-                ReportInfo info(ts.CurrToken()->span(), "unexpected token",
+                ReportInfo info(ts.CurrToken().span(), "unexpected token",
                                 "expected this to be identifier or `}`");
                 Report(ctx, ReportLevel::Error, info);
                 return std::nullopt;
@@ -249,7 +262,7 @@ std::optional<std::unique_ptr<ast::EnumDeclaration>> ParseEnumDecl(
     }
 
     TRY(check_punct(ctx, ts, PunctTokenKind::RCurly));
-    ast::RCurly rcurly(ts.CurrToken()->span());
+    ast::RCurly rcurly(ts.CurrToken().span());
     ts.Advance();
 
     return std::make_unique<ast::EnumDeclaration>(enum_kw, std::move(name),
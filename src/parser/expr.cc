@@ -1,375 +1,207 @@
 #include "expr.h"
 
+#include <array>
+#include <cstdint>
+
 #include "../report.h"
 #include "type.h"
 #include "utils.h"
 
 namespace mini {
 
-std::optional<std::unique_ptr<ast::Expression>> ParseExpr(Context &ctx,
-                                                          TokenStream &ts) {
-    auto state = ts.State();
-    ctx.SuppressReport();
-
-    auto lhs = ParseUnaryExpr(ctx, ts);
-    if (!lhs) {
-        ts.SetState(state);
-        ctx.ActivateReport();
-        return ParseLogicalOrExpr(ctx, ts);
-    }
-
-    if (!ts || !ts.CurrToken()->IsPunctOf(PunctTokenKind::Assign)) {
-        ts.SetState(state);
-        ctx.ActivateReport();
-        return ParseLogicalOrExpr(ctx, ts);
-    }
-    ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::Assign,
-                                ts.CurrToken()->span());
-    ts.Advance();
+namespace {
+
+// How tightly a binary operator binds its operands. Larger binds tighter.
+enum Precedence : uint8_t {
+    NotBinary,
+    LogicalOr,
+    LogicalAnd,
+    InclusiveOr,
+    ExclusiveOr,
+    BitAnd,
+    Equality,
+    Relational,
+    Shift,
+    Additive,
+    Multiplicative,
+};
+
+struct BinaryOp {
+    Precedence prec;
+    ast::InfixExpression::Op::Kind kind;
+};
+
+constexpr size_t punct_count =
+    static_cast<size_t>(PunctTokenKind::DotDotDot) + 1;
+
+// Binary operators indexed by punctuator.
+constexpr std::array<BinaryOp, punct_count> binary_ops = [] {
+    using Kind = ast::InfixExpression::Op::Kind;
+    std::array<BinaryOp, punct_count> ops{};
+    auto set = [&ops](PunctTokenKind punct, Precedence prec, Kind kind) {
+        ops[static_cast<size_t>(punct)] = BinaryOp{prec, kind};
+    };
+    set(PunctTokenKind::Or, LogicalOr, Kind::Or);
+    set(PunctTokenKind::And, LogicalAnd, Kind::And);
+    set(PunctTokenKind::Vertical, InclusiveOr, Kind::BitOr);
+    set(PunctTokenKind::Hat, ExclusiveOr, Kind::BitXor);
+    set(PunctTokenKind::Ampersand, BitAnd, Kind::BitAnd);
+    set(PunctTokenKind::EQ, Equality, Kind::EQ);
+    set(PunctTokenKind::NE, Equality, Kind::NE);
+    set(PunctTokenKind::LT, Relational, Kind::LT);
+    set(PunctTokenKind::LE, Relational, Kind::LE);
+    set(PunctTokenKind::GT, Relational, Kind::GT);
+    set(PunctTokenKind::GE, Relational, Kind::GE);
+    set(PunctTokenKind::LShift, Shift, Kind::LShift);
+    set(PunctTokenKind::RShift, Shift, Kind::RShift);
+    set(PunctTokenKind::Plus, Additive, Kind::Add);
+    set(PunctTokenKind::Minus, Additive, Kind::Sub);
+    set(PunctTokenKind::Star, Multiplicative, Kind::Mul);
+    set(PunctTokenKind::Slash, Multiplicative, Kind::Div);
+    set(PunctTokenKind::Percent, Multiplicative, Kind::Mod);
+    return ops;
+}();
+
+// Returns the binary operator at the current token, with precedence
+// `NotBinary` if there is none.
+inline BinaryOp CurrBinaryOp(TokenStream &ts) {
+    if (!ts || !ts.CurrToken().IsPunct()) return BinaryOp{};
+    return binary_ops[static_cast<size_t>(ts.CurrToken().PunctValue())];
+}
 
-    ctx.ActivateReport();
-    auto rhs = ParseExpr(ctx, ts);
-    if (!rhs) return std::nullopt;
+// Applies trailing `as <type>` to `expr`.
+std::optional<std::unique_ptr<ast::Expression>> ParseCastSuffix(
+    Context &ctx, TokenStream &ts, std::unique_ptr<ast::Expression> &&expr) {
+    while (ts && ts.CurrToken().IsKeywordOf(KeywordTokenKind::As)) {
+        ast::As as_kw(ts.CurrToken().span());
+        ts.Advance();
 
-    return std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                  std::move(*rhs));
-}
+        auto type = ParseType(ctx, ts);
+        if (!type) return std::nullopt;
 
-std::optional<std::unique_ptr<ast::Expression>> ParseLogicalOrExpr(
-    Context &ctx, TokenStream &ts) {
-    auto lhs = ParseLogicalAndExpr(ctx, ts);
-    if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Or)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::Or,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseLogicalOrExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
+        expr = std::make_unique<ast::CastExpression>(std::move(expr), as_kw,
+                                                     std::move(*type));
     }
-    return lhs;
+    return std::move(expr);
 }
 
-std::optional<std::unique_ptr<ast::Expression>> ParseLogicalAndExpr(
-    Context &ctx, TokenStream &ts) {
-    auto lhs = ParseInclusiveOrExpr(ctx, ts);
-    if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::And)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::And,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseLogicalAndExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
-    }
-    return lhs;
-}
+// Parses binary operators following `lhs` whose precedence is at least
+// `min_prec`. Operators of the same precedence associate to the left.
+std::optional<std::unique_ptr<ast::Expression>> ParseBinaryRhs(
+    Context &ctx, TokenStream &ts, Precedence min_prec,
+    std::unique_ptr<ast::Expression> &&lhs) {
+    while (true) {
+        auto op = CurrBinaryOp(ts);
+        if (op.prec == NotBinary || op.prec < min_prec) break;
+        ast::InfixExpression::Op infix_op(op.kind, ts.CurrToken().span());
+        ts.Advance();
 
-std::optional<std::unique_ptr<ast::Expression>> ParseInclusiveOrExpr(
-    Context &ctx, TokenStream &ts) {
-    auto lhs = ParseExclusiveOrExpr(ctx, ts);
-    if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Vertical)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::BitOr,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseInclusiveOrExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
-    }
-    return lhs;
-}
+        auto rhs = ParseCastExpr(ctx, ts);
+        if (!rhs) return std::nullopt;
 
-std::optional<std::unique_ptr<ast::Expression>> ParseExclusiveOrExpr(
-    Context &ctx, TokenStream &ts) {
-    auto lhs = ParseAndExpr(ctx, ts);
-    if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Hat)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::BitXor,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseExclusiveOrExpr(ctx, ts);
+        // Let operators binding tighter take `rhs` as their lhs.
+        while (CurrBinaryOp(ts).prec > op.prec) {
+            rhs = ParseBinaryRhs(ctx, ts, static_cast<Precedence>(op.prec + 1),
+                                 std::move(*rhs));
             if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
         }
-    }
-    return lhs;
-}
 
-std::optional<std::unique_ptr<ast::Expression>> ParseAndExpr(Context &ctx,
-                                                             TokenStream &ts) {
-    auto lhs = ParseEqualityExpr(ctx, ts);
-    if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Ampersand)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::BitAnd,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseAndExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
+        lhs = std::make_unique<ast::InfixExpression>(infix_op, std::move(lhs),
+                                                     std::move(*rhs));
     }
-    return lhs;
+    return std::move(lhs);
 }
 
-std::optional<std::unique_ptr<ast::Expression>> ParseEqualityExpr(
-    Context &ctx, TokenStream &ts) {
-    auto lhs = ParseRelationalExpr(ctx, ts);
-    if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::EQ)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::EQ,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseEqualityExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::NE)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::NE,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseEqualityExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
-    }
-    return lhs;
-}
+}  // namespace
 
-std::optional<std::unique_ptr<ast::Expression>> ParseRelationalExpr(
-    Context &ctx, TokenStream &ts) {
-    auto lhs = ParseShiftExpr(ctx, ts);
+std::optional<std::unique_ptr<ast::Expression>> ParseExpr(Context &ctx,
+                                                          TokenStream &ts) {
+    auto lhs = ParseUnaryExpr(ctx, ts);
     if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::LT)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::LT,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseRelationalExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::LE)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::LE,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseRelationalExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::GT)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::GT,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseRelationalExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::GE)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::GE,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseRelationalExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
-    }
-    return lhs;
-}
 
-std::optional<std::unique_ptr<ast::Expression>> ParseShiftExpr(
-    Context &ctx, TokenStream &ts) {
-    auto lhs = ParseAdditiveExpr(ctx, ts);
-    if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::LShift)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::LShift,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseShiftExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RShift)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::RShift,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseShiftExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
+    // Assignment has the lowest precedence and associates to the right. Its
+    // lhs must be an unary expression.
+    if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Assign)) {
+        ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::Assign,
+                                    ts.CurrToken().span());
+        ts.Advance();
+
+        auto rhs = ParseExpr(ctx, ts);
+        if (!rhs) return std::nullopt;
+
+        return std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
+                                                      std::move(*rhs));
     }
-    return lhs;
-}
 
-std::optional<std::unique_ptr<ast::Expression>> ParseAdditiveExpr(
-    Context &ctx, TokenStream &ts) {
-    auto lhs = ParseMultiplicativeExpr(ctx, ts);
+    lhs = ParseCastSuffix(ctx, ts, std::move(*lhs));
     if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Plus)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::Add,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseAdditiveExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Minus)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::Sub,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseAdditiveExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
-    }
-    return lhs;
+    return ParseBinaryRhs(ctx, ts, LogicalOr, std::move(*lhs));
 }
 
-std::optional<std::unique_ptr<ast::Expression>> ParseMultiplicativeExpr(
+std::optional<std::unique_ptr<ast::Expression>> ParseLogicalOrExpr(
     Context &ctx, TokenStream &ts) {
     auto lhs = ParseCastExpr(ctx, ts);
     if (!lhs) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Star)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::Mul,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseMultiplicativeExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Slash)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::Div,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseMultiplicativeExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Percent)) {
-            ast::InfixExpression::Op op(ast::InfixExpression::Op::Kind::Mod,
-                                        ts.CurrToken()->span());
-            ts.Advance();
-            auto rhs = ParseMultiplicativeExpr(ctx, ts);
-            if (!rhs) return std::nullopt;
-            lhs = std::make_unique<ast::InfixExpression>(op, std::move(*lhs),
-                                                         std::move(*rhs));
-        } else {
-            break;
-        }
-    }
-    return lhs;
+    return ParseBinaryRhs(ctx, ts, LogicalOr, std::move(*lhs));
 }
 
 std::optional<std::unique_ptr<ast::Expression>> ParseCastExpr(Context &ctx,
                                                               TokenStream &ts) {
     auto expr = ParseUnaryExpr(ctx, ts);
     if (!expr) return std::nullopt;
-    while (ts) {
-        if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::As)) {
-            ast::As as_kw(ts.CurrToken()->span());
-            ts.Advance();
-
-            auto type = ParseType(ctx, ts);
-            if (!type) return std::nullopt;
-
-            expr = std::make_unique<ast::CastExpression>(
-                std::move(*expr), as_kw, std::move(*type));
-        } else {
-            break;
-        }
-    }
-    return expr;
+    return ParseCastSuffix(ctx, ts, std::move(*expr));
 }
 
 std::optional<std::unique_ptr<ast::Expression>> ParseUnaryExpr(
     Context &ctx, TokenStream &ts) {
     TRY(check_eos(ctx, ts));
-    if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Ampersand)) {
+    if (ts.CurrToken().IsPunctOf(PunctTokenKind::Ampersand)) {
         ast::UnaryExpression::Op op(ast::UnaryExpression::Op::Kind::Ref,
-                                    ts.CurrToken()->span());
+                                    ts.CurrToken().span());
         ts.Advance();
 
         auto expr = ParseUnaryExpr(ctx, ts);
         if (!expr) return std::nullopt;
 
         return std::make_unique<ast::UnaryExpression>(op, std::move(*expr));
-    } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Star)) {
+    } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::Star)) {
         ast::UnaryExpression::Op op(ast::UnaryExpression::Op::Kind::Deref,
-                                    ts.CurrToken()->span());
+                                    ts.CurrToken().span());
         ts.Advance();
 
         auto expr = ParseUnaryExpr(ctx, ts);
         if (!expr) return std::nullopt;
 
         return std::make_unique<ast::UnaryExpression>(op, std::move(*expr));
-    } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Minus)) {
+    } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::Minus)) {
         ast::UnaryExpression::Op op(ast::UnaryExpression::Op::Kind::Minus,
-                                    ts.CurrToken()->span());
+                                    ts.CurrToken().span());
         ts.Advance();
 
         auto expr = ParseUnaryExpr(ctx, ts);
         if (!expr) return std::nullopt;
 
         return std::make_unique<ast::UnaryExpression>(op, std::move(*expr));
-    } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Tilde)) {
+    } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::Tilde)) {
         ast::UnaryExpression::Op op(ast::UnaryExpression::Op::Kind::Inv,
-                                    ts.CurrToken()->span());
+                                    ts.CurrToken().span());
         ts.Advance();
 
         auto expr = ParseUnaryExpr(ctx, ts);
         if (!expr) return std::nullopt;
 
         return std::make_unique<ast::UnaryExpression>(op, std::move(*expr));
-    } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Exclamation)) {
+    } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::Exclamation)) {
         ast::UnaryExpression::Op op(ast::UnaryExpression::Op::Kind::Neg,
-                                    ts.CurrToken()->span());
+                                    ts.CurrToken().span());
         ts.Advance();
 
         auto expr = ParseUnaryExpr(ctx, ts);
         if (!expr) return std::nullopt;
 
         return std::make_unique<ast::UnaryExpression>(op, std::move(*expr));
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::ESizeof)) {
-        ast::ESizeof esizeof_kw(ts.CurrToken()->span());
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::ESizeof)) {
+        ast::ESizeof esizeof_kw(ts.CurrToken().span());
         ts.Advance();
 
         auto expr = ParseUnaryExpr(ctx, ts);
@@ -377,8 +209,8 @@ std::optional<std::unique_ptr<ast::Expression>> ParseUnaryExpr(
 
         return std::make_unique<ast::ESizeofExpression>(esizeof_kw,
                                                         std::move(*expr));
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::TSizeof)) {
-        ast::TSizeof tsizeof_kw(ts.CurrToken()->span());
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::TSizeof)) {
+        ast::TSizeof tsizeof_kw(ts.CurrToken().span());
         ts.Advance();
 
         auto type = ParseType(ctx, ts);
@@ -396,29 +228,29 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePostfixExpr(
     auto expr = ParsePrimaryExpr(ctx, ts);
     if (!expr) return std::nullopt;
     while (ts) {
-        if (ts.CurrToken()->IsPunctOf(PunctTokenKind::LSquare)) {
-            ast::LSquare lsquare(ts.CurrToken()->span());
+        if (ts.CurrToken().IsPunctOf(PunctTokenKind::LSquare)) {
+            ast::LSquare lsquare(ts.CurrToken().span());
             ts.Advance();
 
             auto index = ParseExpr(ctx, ts);
             if (!index) return std::nullopt;
 
             TRY(check_punct(ctx, ts, PunctTokenKind::RSquare));
-            ast::RSquare rsquare(ts.CurrToken()->span());
+            ast::RSquare rsquare(ts.CurrToken().span());
             ts.Advance();
 
             expr = std::make_unique<ast::IndexExpression>(
                 std::move(*expr), lsquare, std::move(*index), rsquare);
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::LParen)) {
-            ast::LParen lparen(ts.CurrToken()->span());
+        } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::LParen)) {
+            ast::LParen lparen(ts.CurrToken().span());
             ts.Advance();
 
             std::vector<std::unique_ptr<ast::Expression>> args;
             while (true) {
                 TRY(check_eos(ctx, ts));
-                if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RParen) &&
+                if (ts.CurrToken().IsPunctOf(PunctTokenKind::RParen) &&
                     args.empty()) {
-                    ast::RParen rparen(ts.CurrToken()->span());
+                    ast::RParen rparen(ts.CurrToken().span());
                     ts.Advance();
 
                     expr = std::make_unique<ast::CallExpression>(
@@ -430,19 +262,19 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePostfixExpr(
 
                     args.emplace_back(std::move(*arg));
 
-                    if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RParen)) {
-                        ast::RParen rparen(ts.CurrToken()->span());
+                    if (ts.CurrToken().IsPunctOf(PunctTokenKind::RParen)) {
+                        ast::RParen rparen(ts.CurrToken().span());
                         ts.Advance();
 
                         expr = std::make_unique<ast::CallExpression>(
                             std::move(*expr), lparen, std::move(args), rparen);
                         break;
-                    } else if (ts.CurrToken()->IsPunctOf(
+                    } else if (ts.CurrToken().IsPunctOf(
                                    PunctTokenKind::Comma)) {
                         ts.Advance();
                         continue;
                     } else {
-                        ReportInfo info(ts.CurrToken()->span(),
+                        ReportInfo info(ts.CurrToken().span(),
                                         "unexpected token",
                                         "expected `)` or `,`");
                         Report(ctx, ReportLevel::Error, info);
@@ -450,14 +282,14 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePostfixExpr(
                     }
                 }
             }
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Dot)) {
-            ast::Dot dot(ts.CurrToken()->span());
+        } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::Dot)) {
+            ast::Dot dot(ts.CurrToken().span());
             ts.Advance();
 
             TRY(check_ident(ctx, ts));
-            std::string value = ts.CurrToken()->IdentValue();
+            Symbol value = ts.CurrToken().IdentValue();
             ast::AccessExpressionField field(std::move(value),
-                                             ts.CurrToken()->span());
+                                             ts.CurrToken().span());
             ts.Advance();
 
             expr = std::make_unique<ast::AccessExpression>(
@@ -472,41 +304,40 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePostfixExpr(
 std::optional<std::unique_ptr<ast::Expression>> ParsePrimaryExpr(
     Context &ctx, TokenStream &ts) {
     TRY(check_eos(ctx, ts));
-    if (ts.CurrToken()->IsIdent()) {
-        std::string value1 = ts.CurrToken()->IdentValue();
-        auto span1 = ts.CurrToken()->span();
+    if (ts.CurrToken().IsIdent()) {
+        Symbol value1 = ts.CurrToken().IdentValue();
+        auto span1 = ts.CurrToken().span();
         ts.Advance();
 
-        if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::ColonColon)) {
-            ast::ColonColon colon_colon(ts.CurrToken()->span());
+        if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::ColonColon)) {
+            ast::ColonColon colon_colon(ts.CurrToken().span());
             ts.Advance();
 
             TRY(check_ident(ctx, ts));
-            std::string value2 = ts.CurrToken()->IdentValue();
-            auto span2 = ts.CurrToken()->span();
+            Symbol value2 = ts.CurrToken().IdentValue();
+            auto span2 = ts.CurrToken().span();
             ts.Advance();
 
             ast::EnumSelectExpressionSrc src(std::move(value1), span1);
             ast::EnumSelectExpressionDst dst(std::move(value2), span2);
             return std::make_unique<ast::EnumSelectExpression>(
                 std::move(dst), colon_colon, std::move(src));
-        } else if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::LCurly)) {
-            ast::LCurly lcurly(ts.CurrToken()->span());
+        } else if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::LCurly)) {
+            ast::LCurly lcurly(ts.CurrToken().span());
             ts.Advance();
 
             std::vector<ast::StructExpressionInit> inits;
             while (true) {
                 TRY(check_eos(ctx, ts));
-                if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RCurly)) {
+                if (ts.CurrToken().IsPunctOf(PunctTokenKind::RCurly)) {
                     break;
-                } else if (ts.CurrToken()->IsIdent()) {
+                } else if (ts.CurrToken().IsIdent()) {
                     ast::StructExpressionInitName name(
-                        std::string(ts.CurrToken()->IdentValue()),
-                        ts.CurrToken()->span());
+                        ts.CurrToken().IdentValue(), ts.CurrToken().span());
                     ts.Advance();
 
                     TRY(check_punct(ctx, ts, PunctTokenKind::Colon));
-                    ast::Colon colon(ts.CurrToken()->span());
+                    ast::Colon colon(ts.CurrToken().span());
                     ts.Advance();
 
                     auto value = ParseExpr(ctx, ts);
@@ -516,13 +347,13 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePrimaryExpr(
                                        std::move(*value));
 
                     if (ts &&
-                        ts.CurrToken()->IsPunctOf(PunctTokenKind::Comma)) {
+                        ts.CurrToken().IsPunctOf(PunctTokenKind::Comma)) {
                         ts.Advance();
                     } else {
                         break;
                     }
                 } else {
-                    ReportInfo info(ts.CurrToken()->span(),
+                    ReportInfo info(ts.CurrToken().span(),
                                     "expected identifier or }", "");
                     Report(ctx, ReportLevel::Error, info);
                     return std::nullopt;
@@ -530,7 +361,7 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePrimaryExpr(
             }
 
             TRY(check_punct(ctx, ts, PunctTokenKind::RCurly));
-            ast::RCurly rcurly(ts.CurrToken()->span());
+            ast::RCurly rcurly(ts.CurrToken().span());
             ts.Advance();
 
             ast::StructExpressionName name(std::move(value1), span1);
@@ -540,14 +371,14 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePrimaryExpr(
             return std::make_unique<ast::VariableExpression>(std::move(value1),
                                                              span1);
         }
-    } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::LCurly)) {
-        ast::LCurly lcurly(ts.CurrToken()->span());
+    } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::LCurly)) {
+        ast::LCurly lcurly(ts.CurrToken().span());
         ts.Advance();
 
         std::vector<std::unique_ptr<ast::Expression>> inits;
         while (true) {
             TRY(check_eos(ctx, ts));
-            if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RCurly)) {
+            if (ts.CurrToken().IsPunctOf(PunctTokenKind::RCurly)) {
                 break;
             } else {
                 auto value = ParseExpr(ctx, ts);
@@ -555,7 +386,7 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePrimaryExpr(
 
                 inits.emplace_back(std::move(*value));
 
-                if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::Comma)) {
+                if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Comma)) {
                     ts.Advance();
                 } else {
                     break;
@@ -564,30 +395,30 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePrimaryExpr(
         }
 
         TRY(check_punct(ctx, ts, PunctTokenKind::RCurly));
-        ast::RCurly rcurly(ts.CurrToken()->span());
+        ast::RCurly rcurly(ts.CurrToken().span());
         ts.Advance();
 
         return std::make_unique<ast::ArrayExpression>(lcurly, std::move(inits),
                                                       rcurly);
-    } else if (ts.CurrToken()->IsInt()) {
-        uint64_t value = ts.CurrToken()->IntValue();
-        auto span = ts.CurrToken()->span();
+    } else if (ts.CurrToken().IsInt()) {
+        uint64_t value = ts.CurrToken().IntValue();
+        auto span = ts.CurrToken().span();
         ts.Advance();
 
         return std::make_unique<ast::IntegerExpression>(value, span);
-    } else if (ts.CurrToken()->IsString()) {
-        std::string value = ts.CurrToken()->StringValue();
-        auto span = ts.CurrToken()->span();
+    } else if (ts.CurrToken().IsString()) {
+        std::string value = ts.CurrToken().StringValue();
+        auto span = ts.CurrToken().span();
         ts.Advance();
 
         return std::make_unique<ast::StringExpression>(std::move(value), span);
-    } else if (ts.CurrToken()->IsChar()) {
-        char value = ts.CurrToken()->CharValue();
-        auto span = ts.CurrToken()->span();
+    } else if (ts.CurrToken().IsChar()) {
+        char value = ts.CurrToken().CharValue();
+        auto span = ts.CurrToken().span();
         ts.Advance();
 
         return std::make_unique<ast::CharExpression>(value, span);
-    } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::LParen)) {
+    } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::LParen)) {
         ts.Advance();
         auto expr = ParseExpr(ctx, ts);
         if (!expr) return std::nullopt;
@@ -596,23 +427,23 @@ std::optional<std::unique_ptr<ast::Expression>> ParsePrimaryExpr(
         ts.Advance();
 
         return expr;
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::True)) {
-        auto span = ts.CurrToken()->span();
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::True)) {
+        auto span = ts.CurrToken().span();
         ts.Advance();
 
         return std::make_unique<ast::BoolExpression>(true, span);
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::False)) {
-        auto span = ts.CurrToken()->span();
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::False)) {
+        auto span = ts.CurrToken().span();
         ts.Advance();
 
         return std::make_unique<ast::BoolExpression>(false, span);
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::NullPtr)) {
-        auto span = ts.CurrToken()->span();
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::NullPtr)) {
+        auto span = ts.CurrToken().span();
         ts.Advance();
 
         return std::make_unique<ast::NullPtrExpression>(span);
     } else {
-        ReportInfo info(ts.CurrToken()->span(), "unexpected token found",
+        ReportInfo info(ts.CurrToken().span(), "unexpected token found",
                         "expected identifier, integer or `(`");
         Report(ctx, ReportLevel::Error, info);
         return std::nullopt;
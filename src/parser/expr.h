@@ -9,28 +9,12 @@
 
 namespace mini {
 
+// Parses an expression including assignment.
 std::optional<std::unique_ptr<ast::Expression>> ParseExpr(Context& ctx,
                                                           TokenStream& ts);
+// Parses an expression without assignment.
 std::optional<std::unique_ptr<ast::Expression>> ParseLogicalOrExpr(
     Context& ctx, TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseLogicalAndExpr(
-    Context& ctx, TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseInclusiveOrExpr(
-    Context& ctx, TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseExclusiveOrExpr(
-    Context& ctx, TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseAndExpr(Context& ctx,
-                                                             TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseEqualityExpr(
-    Context& ctx, TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseRelationalExpr(
-    Context& ctx, TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseShiftExpr(Context& ctx,
-                                                               TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseAdditiveExpr(
-    Context& ctx, TokenStream& ts);
-std::optional<std::unique_ptr<ast::Expression>> ParseMultiplicativeExpr(
-    Context& ctx, TokenStream& ts);
 std::optional<std::unique_ptr<ast::Expression>> ParseCastExpr(Context& ctx,
                                                               TokenStream& ts);
 std::optional<std::unique_ptr<ast::Expression>> ParseUnaryExpr(Context& ctx,
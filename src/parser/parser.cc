@@ -6,10 +6,12 @@
 
 namespace mini {
 
-ParserResult ParseFile(Context &ctx, const std::string &path) {
-    auto tokens = LexFile(ctx, path);
+ParserResult Parse(Context &ctx, size_t id) {
+    auto tokens = Lex(ctx, id);
     if (!tokens) return std::nullopt;
     TokenStream ts(std::move(*tokens));
+    ArenaScope scope(ArenaKind::Ast, ctx.ast_arena());
+    PassScope pass(ctx.pass_timer(), "parse");
 
     std::vector<std::unique_ptr<ast::Declaration>> res;
     while (ts) {
@@ -20,4 +22,8 @@ ParserResult ParseFile(Context &ctx, const std::string &path) {
     return res;
 }
 
+ParserResult ParseFile(Context &ctx, const std::string &path) {
+    return Parse(ctx, ctx.input_cache().Cache(path));
+}
+
 };  // namespace mini
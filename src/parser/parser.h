@@ -13,6 +13,9 @@ namespace mini {
 using ParserResult =
     std::optional<std::vector<std::unique_ptr<ast::Declaration>>>;
 
+// Parses the source cached as `id` in the input cache.
+ParserResult Parse(Context& ctx, size_t id);
+
 ParserResult ParseFile(Context& ctx, const std::string& path);
 
 };  // namespace mini
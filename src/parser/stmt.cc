@@ -9,17 +9,17 @@ namespace mini {
 std::optional<std::unique_ptr<ast::Statement>> ParseStmt(Context &ctx,
                                                          TokenStream &ts) {
     TRY(check_eos(ctx, ts));
-    if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::Return)) {
+    if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::Return)) {
         return ParseReturnStmt(ctx, ts);
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::Break)) {
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::Break)) {
         return ParseBreakStmt(ctx, ts);
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::Continue)) {
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::Continue)) {
         return ParseContinueStmt(ctx, ts);
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::While)) {
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::While)) {
         return ParseWhileStmt(ctx, ts);
-    } else if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::If)) {
+    } else if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::If)) {
         return ParseIfStmt(ctx, ts);
-    } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::LCurly)) {
+    } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::LCurly)) {
         return ParseBlockStmt(ctx, ts);
     } else {
         return ParseExprStmt(ctx, ts);
@@ -32,7 +32,7 @@ std::optional<std::unique_ptr<ast::ExpressionStatement>> ParseExprStmt(
     if (!expr) return std::nullopt;
 
     TRY(check_punct(ctx, ts, PunctTokenKind::Semicolon));
-    ast::Semicolon semicolon(ts.CurrToken()->span());
+    ast::Semicolon semicolon(ts.CurrToken().span());
     ts.Advance();
 
     return std::make_unique<ast::ExpressionStatement>(std::move(*expr),
@@ -42,18 +42,18 @@ std::optional<std::unique_ptr<ast::ExpressionStatement>> ParseExprStmt(
 std::optional<std::unique_ptr<ast::ReturnStatement>> ParseReturnStmt(
     Context &ctx, TokenStream &ts) {
     TRY(check_keyword(ctx, ts, KeywordTokenKind::Return));
-    ast::Return return_kw(ts.CurrToken()->span());
+    ast::Return return_kw(ts.CurrToken().span());
     ts.Advance();
 
     std::optional<std::unique_ptr<ast::Expression>> expr;
     TRY(check_eos(ctx, ts));
-    if (!ts.CurrToken()->IsPunctOf(PunctTokenKind::Semicolon)) {
+    if (!ts.CurrToken().IsPunctOf(PunctTokenKind::Semicolon)) {
         expr = ParseExpr(ctx, ts);
         if (!expr) return std::nullopt;
     }
 
     TRY(check_punct(ctx, ts, PunctTokenKind::Semicolon));
-    ast::Semicolon semicolon(ts.CurrToken()->span());
+    ast::Semicolon semicolon(ts.CurrToken().span());
     ts.Advance();
 
     return std::make_unique<ast::ReturnStatement>(return_kw, std::move(expr),
@@ -63,11 +63,11 @@ std::optional<std::unique_ptr<ast::ReturnStatement>> ParseReturnStmt(
 std::optional<std::unique_ptr<ast::BreakStatement>> ParseBreakStmt(
     Context &ctx, TokenStream &ts) {
     TRY(check_keyword(ctx, ts, KeywordTokenKind::Break));
-    ast::Break break_kw(ts.CurrToken()->span());
+    ast::Break break_kw(ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_punct(ctx, ts, PunctTokenKind::Semicolon));
-    ast::Semicolon semicolon(ts.CurrToken()->span());
+    ast::Semicolon semicolon(ts.CurrToken().span());
     ts.Advance();
 
     return std::make_unique<ast::BreakStatement>(break_kw, semicolon);
@@ -76,11 +76,11 @@ std::optional<std::unique_ptr<ast::BreakStatement>> ParseBreakStmt(
 std::optional<std::unique_ptr<ast::ContinueStatement>> ParseContinueStmt(
     Context &ctx, TokenStream &ts) {
     TRY(check_keyword(ctx, ts, KeywordTokenKind::Continue));
-    ast::Continue continue_kw(ts.CurrToken()->span());
+    ast::Continue continue_kw(ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_punct(ctx, ts, PunctTokenKind::Semicolon));
-    ast::Semicolon semicolon(ts.CurrToken()->span());
+    ast::Semicolon semicolon(ts.CurrToken().span());
     ts.Advance();
 
     return std::make_unique<ast::ContinueStatement>(continue_kw, semicolon);
@@ -89,18 +89,18 @@ std::optional<std::unique_ptr<ast::ContinueStatement>> ParseContinueStmt(
 std::optional<std::unique_ptr<ast::WhileStatement>> ParseWhileStmt(
     Context &ctx, TokenStream &ts) {
     TRY(check_keyword(ctx, ts, KeywordTokenKind::While));
-    ast::While while_kw(ts.CurrToken()->span());
+    ast::While while_kw(ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_punct(ctx, ts, PunctTokenKind::LParen));
-    ast::LParen lparen(ts.CurrToken()->span());
+    ast::LParen lparen(ts.CurrToken().span());
     ts.Advance();
 
     auto cond = ParseExpr(ctx, ts);
     if (!cond) return std::nullopt;
 
     TRY(check_punct(ctx, ts, PunctTokenKind::RParen));
-    ast::RParen rparen(ts.CurrToken()->span());
+    ast::RParen rparen(ts.CurrToken().span());
     ts.Advance();
 
     auto body = ParseStmt(ctx, ts);
@@ -113,26 +113,26 @@ std::optional<std::unique_ptr<ast::WhileStatement>> ParseWhileStmt(
 std::optional<std::unique_ptr<ast::IfStatement>> ParseIfStmt(Context &ctx,
                                                              TokenStream &ts) {
     TRY(check_keyword(ctx, ts, KeywordTokenKind::If));
-    ast::If if_kw(ts.CurrToken()->span());
+    ast::If if_kw(ts.CurrToken().span());
     ts.Advance();
 
     TRY(check_punct(ctx, ts, PunctTokenKind::LParen));
-    ast::LParen lparen(ts.CurrToken()->span());
+    ast::LParen lparen(ts.CurrToken().span());
     ts.Advance();
 
     auto cond = ParseExpr(ctx, ts);
     if (!cond) return std::nullopt;
 
     TRY(check_punct(ctx, ts, PunctTokenKind::RParen));
-    ast::RParen rparen(ts.CurrToken()->span());
+    ast::RParen rparen(ts.CurrToken().span());
     ts.Advance();
 
     auto body = ParseStmt(ctx, ts);
     if (!body) return std::nullopt;
 
     std::optional<ast::IfStatementElseClause> else_clause;
-    if (ts && ts.CurrToken()->IsKeywordOf(KeywordTokenKind::Else)) {
-        ast::Else else_kw(ts.CurrToken()->span());
+    if (ts && ts.CurrToken().IsKeywordOf(KeywordTokenKind::Else)) {
+        ast::Else else_kw(ts.CurrToken().span());
         ts.Advance();
 
         auto else_body = ParseStmt(ctx, ts);
@@ -149,34 +149,34 @@ std::optional<std::unique_ptr<ast::IfStatement>> ParseIfStmt(Context &ctx,
 std::optional<std::unique_ptr<ast::BlockStatement>> ParseBlockStmt(
     Context &ctx, TokenStream &ts) {
     TRY(check_punct(ctx, ts, PunctTokenKind::LCurly));
-    ast::LCurly lcurly(ts.CurrToken()->span());
+    ast::LCurly lcurly(ts.CurrToken().span());
     ts.Advance();
 
     std::vector<ast::BlockStatementItem> items;
     while (true) {
         TRY(check_eos(ctx, ts));
-        if (ts.CurrToken()->IsKeywordOf(KeywordTokenKind::Let)) {
-            ast::Let let_kw(ts.CurrToken()->span());
+        if (ts.CurrToken().IsKeywordOf(KeywordTokenKind::Let)) {
+            ast::Let let_kw(ts.CurrToken().span());
             ts.Advance();
 
             std::vector<ast::VariableDeclarationBody> names;
             while (true) {
                 TRY(check_ident(ctx, ts));
-                std::string value = ts.CurrToken()->IdentValue();
+                Symbol value = ts.CurrToken().IdentValue();
                 ast::VariableName name(std::move(value),
-                                       ts.CurrToken()->span());
+                                       ts.CurrToken().span());
                 ts.Advance();
 
                 TRY(check_punct(ctx, ts, PunctTokenKind::Colon));
-                ast::Colon colon(ts.CurrToken()->span());
+                ast::Colon colon(ts.CurrToken().span());
                 ts.Advance();
 
                 auto type = ParseType(ctx, ts);
                 if (!type) return std::nullopt;
 
                 std::optional<ast::VariableInit> init;
-                if (ts && ts.CurrToken()->IsPunctOf(PunctTokenKind::Assign)) {
-                    ast::Assign assign(ts.CurrToken()->span());
+                if (ts && ts.CurrToken().IsPunctOf(PunctTokenKind::Assign)) {
+                    ast::Assign assign(ts.CurrToken().span());
                     ts.Advance();
 
                     auto expr = ParseExpr(ctx, ts);
@@ -189,7 +189,7 @@ std::optional<std::unique_ptr<ast::BlockStatement>> ParseBlockStmt(
                                    std::move(init));
 
                 TRY(check_eos(ctx, ts));
-                if (ts.CurrToken()->IsPunctOf(PunctTokenKind::Comma)) {
+                if (ts.CurrToken().IsPunctOf(PunctTokenKind::Comma)) {
                     ts.Advance();
                 } else {
                     break;
@@ -197,13 +197,13 @@ std::optional<std::unique_ptr<ast::BlockStatement>> ParseBlockStmt(
             }
 
             TRY(check_punct(ctx, ts, PunctTokenKind::Semicolon));
-            ast::Semicolon semicolon(ts.CurrToken()->span());
+            ast::Semicolon semicolon(ts.CurrToken().span());
             ts.Advance();
 
             items.emplace_back(
                 ast::VariableDeclarations(let_kw, std::move(names), semicolon));
-        } else if (ts.CurrToken()->IsPunctOf(PunctTokenKind::RCurly)) {
-            ast::RCurly rcurly(ts.CurrToken()->span());
+        } else if (ts.CurrToken().IsPunctOf(PunctTokenKind::RCurly)) {
+            ast::RCurly rcurly(ts.CurrToken().span());
             ts.Advance();
             return std::make_unique<ast::BlockStatement>(
                 lcurly, std::move(items), rcurly);
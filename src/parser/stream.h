@@ -1,8 +1,7 @@
 #ifndef MINI_PARSER_STREAM_H_
 #define MINI_PARSER_STREAM_H_
 
-#include <memory>
-#include <vector>
+#include <utility>
 
 #include "../token.h"
 
@@ -12,26 +11,25 @@ using TokenStreamState = size_t;
 
 class TokenStream {
 public:
-    TokenStream(std::vector<std::unique_ptr<Token>>&& tokens)
-        : offset_(0), tokens_(std::move(tokens)) {}
+    TokenStream(TokenList&& tokens) : offset_(0), tokens_(std::move(tokens)) {}
     explicit operator bool() { return offset_ < tokens_.size(); }
     inline void Advance() { offset_++; }
-    inline const std::unique_ptr<Token>& CurrToken() const {
-        return tokens_.at(offset_);
-    }
+    inline TokenRef CurrToken() const { return At(offset_); }
     inline bool HasPrev() const { return offset_ > 0; }
-    inline const std::unique_ptr<Token>& PrevToken() const {
-        return tokens_.at(offset_ - 1);
-    }
-    inline const std::unique_ptr<Token>& Last() const {
-        return tokens_.at(tokens_.size() - 1);
-    }
+    inline TokenRef PrevToken() const { return At(offset_ - 1); }
+    inline TokenRef Last() const { return At(tokens_.size() - 1); }
     inline TokenStreamState State() const { return offset_; }
     inline void SetState(TokenStreamState state) { offset_ = state; }
 
 private:
+    inline TokenRef At(size_t i) const {
+        if (i >= tokens_.size())
+            throw std::out_of_range("token index out of range");
+        return TokenRef(tokens_, tokens_.at(i));
+    }
+
     size_t offset_;
-    std::vector<std::unique_ptr<Token>> tokens_;
+    TokenList tokens_;
 };
 
 }  // namespace mini
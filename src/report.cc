@@ -35,72 +35,73 @@ void Report(Context &ctx, ReportLevel level, const ReportInfo &info) {
         return;
     }
 
-    auto entry = ctx.input_cache().Fetch(info.span().id());
+    auto &os = ctx.report_stream();
+    const auto &entry = ctx.input_cache().Fetch(info.span().id());
     auto start = info.span().start();
     auto end = info.span().end();
 
     auto start_display_row = start.row() + 1;
     auto end_display_row = end.row() + 1;
 
-    std::cerr << entry.name() << ":" << start_display_row << ":"
+    os << entry.name() << ":" << start_display_row << ":"
               << start.offset() << ":";
-    start_color(std::cerr, level);
+    start_color(os, level);
     if (level == ReportLevel::Error) {
-        std::cerr << "error: ";
+        os << "error: ";
     } else if (level == ReportLevel::Warn) {
-        std::cerr << "warning: ";
+        os << "warning: ";
     } else {
-        std::cerr << "info: ";
+        os << "info: ";
     }
-    end_color(std::cerr);
-    std::cerr << info.what() << std::endl;
+    end_color(os);
+    os << info.what() << std::endl;
 
     int row_width = digits(start_display_row) > digits(end_display_row)
                         ? digits(start_display_row)
                         : digits(end_display_row);
     if (start.row() == end.row()) {
-        auto line = entry.lines().at(start.row());
-        std::cerr << "  " << start_display_row << "|" << line << std::endl;
-        for (int i = 0; i < 2 + row_width; i++) std::cerr << ' ';
-        std::cerr << "|";
-        for (size_t i = 0; i < start.offset(); i++) std::cerr << ' ';
-        start_color(std::cerr, level);
-        std::cerr << '^';
+        auto line = entry.Line(start.row());
+        os << "  " << start_display_row << "|" << line << std::endl;
+        for (int i = 0; i < 2 + row_width; i++) os << ' ';
+        os << "|";
+        for (size_t i = 0; i < start.offset(); i++) os << ' ';
+        start_color(os, level);
+        os << '^';
         for (size_t i = start.offset() + 1; i <= end.offset(); i++)
-            std::cerr << '~';
-        end_color(std::cerr);
-        std::cerr << " " << info.info() << std::endl;
+            os << '~';
+        end_color(os);
+        os << " " << info.info() << std::endl;
     } else {
-        auto sline = entry.lines().at(start.row());
-        std::cerr << "  ";
+        auto sline = entry.Line(start.row());
+        os << "  ";
         for (int i = 0; i < row_width - digits(start_display_row); i++)
-            std::cerr << '0';
-        std::cerr << start_display_row << "|" << sline << std::endl;
-        for (int i = 0; i < 2 + row_width; i++) std::cerr << ' ';
-        std::cerr << '|';
-        for (size_t i = 0; i < start.offset(); i++) std::cerr << ' ';
-        start_color(std::cerr, level);
-        std::cerr << '^';
+            os << '0';
+        os << start_display_row << "|" << sline << std::endl;
+        for (int i = 0; i < 2 + row_width; i++) os << ' ';
+        os << '|';
+        for (size_t i = 0; i < start.offset(); i++) os << ' ';
+        start_color(os, level);
+        os << '^';
         for (size_t i = start.offset() + 1; i < sline.size(); i++)
-            std::cerr << '~';
-        end_color(std::cerr);
-        std::cerr << std::endl;
+            os << '~';
+        end_color(os);
+        os << std::endl;
 
-        std::cerr << "  ";
-        for (int i = 0; i < row_width; i++) std::cerr << ' ';
-        std::cerr << ":" << std::endl;
+        os << "  ";
+        for (int i = 0; i < row_width; i++) os << ' ';
+        os << ":" << std::endl;
 
-        auto eline = entry.lines().at(end.row());
-        std::cerr << "  ";
+        auto eline = entry.Line(end.row());
+        os << "  ";
         for (int i = 0; i < row_width - digits(end_display_row); i++)
-            std::cerr << '0';
-        std::cerr << end_display_row << "|" << eline << std::endl;
-        for (int i = 0; i < 2 + row_width; i++) std::cerr << ' ';
-        std::cerr << '|';
-        start_color(std::cerr, level);
-        for (size_t i = 0; i <= end.offset(); i++) std::cerr << '~';
-        end_color(std::cerr);
-        std::cerr << " " << info.info() << std::endl;
+            os << '0';
+        os << end_display_row << "|" << eline << std::endl;
+        for (int i = 0; i < 2 + row_width; i++) os << ' ';
+        os << '|';
+        start_color(os, level);
+        for (size_t i = 0; i <= end.offset(); i++) os << '~';
+        end_color(os);
+        os << " " << info.info() << std::endl;
     }
 }
 
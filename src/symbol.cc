@@ -0,0 +1,69 @@
+#include "symbol.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "panic.h"
+
+namespace mini {
+
+namespace {
+
+// Spellings are stored in fixed size chunks so that looking up a spelling
+// never races with interning a new one.
+constexpr size_t chunk_bits = 12;
+constexpr size_t chunk_size = 1 << chunk_bits;
+constexpr size_t max_chunks = 1 << 16;
+
+class SymbolTable {
+public:
+    SymbolTable() : size_(0) { Insert(""); }
+
+    SymbolId Intern(std::string_view s) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(s);
+        if (it != ids_.end()) return it->second;
+        return Insert(s);
+    }
+
+    const std::string &Spelling(SymbolId id) const {
+        return chunks_[id >> chunk_bits][id & (chunk_size - 1)];
+    }
+
+private:
+    SymbolId Insert(std::string_view s) {
+        SymbolId id = size_++;
+        if ((id >> chunk_bits) >= max_chunks) FatalError("too many symbols");
+        auto &chunk = chunks_[id >> chunk_bits];
+        if (!chunk) chunk = std::make_unique<std::string[]>(chunk_size);
+        auto &spelling = chunk[id & (chunk_size - 1)];
+        spelling = s;
+        ids_.emplace(spelling, id);
+        return id;
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<std::string_view, SymbolId> ids_;
+    std::unique_ptr<std::string[]> chunks_[max_chunks];
+    size_t size_;
+};
+
+SymbolTable &symbol_table() {
+    static SymbolTable table;
+    return table;
+}
+
+}  // namespace
+
+const std::string &Symbol::str() const {
+    return symbol_table().Spelling(id_);
+}
+
+SymbolId Symbol::Intern(std::string_view s) {
+    return symbol_table().Intern(s);
+}
+
+}  // namespace mini
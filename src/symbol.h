@@ -0,0 +1,68 @@
+#ifndef MINI_SYMBOL_H_
+#define MINI_SYMBOL_H_
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "fmt/format.h"
+
+namespace mini {
+
+using SymbolId = uint32_t;
+
+// An identifier interned in the global symbol table.
+//
+// Two symbols are equal iff they have the same spelling, so comparison and
+// hashing only look at the 32-bit id. The spelling is kept alive until the
+// program exits.
+class Symbol {
+public:
+    // The empty symbol.
+    Symbol() : id_(0) {}
+    explicit Symbol(std::string_view s) : id_(Intern(s)) {}
+    explicit Symbol(const char *s) : id_(Intern(s)) {}
+    explicit Symbol(const std::string &s) : id_(Intern(s)) {}
+    static Symbol FromId(SymbolId id) {
+        Symbol sym;
+        sym.id_ = id;
+        return sym;
+    }
+    inline SymbolId id() const { return id_; }
+    inline bool empty() const { return id_ == 0; }
+    const std::string &str() const;
+    inline operator const std::string &() const { return str(); }
+    inline bool operator==(Symbol rhs) const { return id_ == rhs.id_; }
+    inline bool operator!=(Symbol rhs) const { return id_ != rhs.id_; }
+
+    // Ordered by id, which is the order of interning, not of spelling.
+    inline bool operator<(Symbol rhs) const { return id_ < rhs.id_; }
+
+    // Returns the id of `s`, interning it if not yet.
+    static SymbolId Intern(std::string_view s);
+
+private:
+    SymbolId id_;
+};
+
+inline std::ostream &operator<<(std::ostream &os, Symbol sym) {
+    return os << sym.str();
+}
+
+}  // namespace mini
+
+template <>
+struct std::hash<mini::Symbol> {
+    size_t operator()(mini::Symbol sym) const noexcept { return sym.id(); }
+};
+
+template <>
+struct fmt::formatter<mini::Symbol> : fmt::formatter<std::string_view> {
+    auto format(mini::Symbol sym, format_context &ctx) const {
+        return fmt::formatter<std::string_view>::format(sym.str(), ctx);
+    }
+};
+
+#endif  // MINI_SYMBOL_H_
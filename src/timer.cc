@@ -0,0 +1,181 @@
+#include "timer.h"
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "fmt/format.h"
+
+namespace {
+
+// Heap allocations made by this thread so far.
+thread_local size_t alloc_count = 0;
+thread_local size_t alloc_bytes = 0;
+
+void *CountedAlloc(size_t size) {
+    alloc_count++;
+    alloc_bytes += size;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+uint64_t ClockNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t TimevalNs(const struct timeval &tv) {
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000000 + tv.tv_usec * 1000;
+}
+
+// Peak resident set size of this process or any waited child, in KiB.
+size_t PeakRssKiB() {
+    struct rusage self, children;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    return std::max(self.ru_maxrss, children.ru_maxrss);
+}
+
+}  // namespace
+
+// Replace the global allocation functions to count allocations per pass.
+void *operator new(size_t size) { return CountedAlloc(size); }
+void *operator new[](size_t size) { return CountedAlloc(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+namespace mini {
+
+void PassTimer::Enable() {
+    enabled_ = true;
+    last_ = Now();
+}
+
+PassTimer::Snapshot PassTimer::Now() {
+    struct rusage children;
+    getrusage(RUSAGE_CHILDREN, &children);
+    uint64_t children_cpu =
+        TimevalNs(children.ru_utime) + TimevalNs(children.ru_stime);
+    return Snapshot{ClockNs(CLOCK_MONOTONIC),
+                    ClockNs(CLOCK_THREAD_CPUTIME_ID) + children_cpu,
+                    alloc_count, alloc_bytes};
+}
+
+void PassTimer::Charge() {
+    auto now = Now();
+    if (!stack_.empty()) {
+        auto &record = records_[stack_.back()];
+        record.wall_ns += now.wall_ns - last_.wall_ns;
+        record.cpu_ns += now.cpu_ns - last_.cpu_ns;
+        record.allocs += now.allocs - last_.allocs;
+        record.alloc_bytes += now.alloc_bytes - last_.alloc_bytes;
+        record.peak_rss_kib = std::max(record.peak_rss_kib, PeakRssKiB());
+    }
+    last_ = now;
+}
+
+void PassTimer::Start(const char *name) {
+    Charge();
+    auto it = std::find_if(
+        records_.begin(), records_.end(),
+        [name](const PassRecord &record) { return record.name == name; });
+    if (it == records_.end()) {
+        records_.emplace_back();
+        records_.back().name = name;
+        it = records_.end() - 1;
+    }
+    stack_.push_back(it - records_.begin());
+}
+
+void PassTimer::Stop() {
+    Charge();
+    stack_.pop_back();
+}
+
+void PassTimer::SetOutputBytes(size_t bytes) {
+    if (!stack_.empty()) records_[stack_.back()].output_bytes = bytes;
+}
+
+void PassTimer::Merge(const PassTimer &other) {
+    for (const auto &from : other.records_) {
+        auto it = std::find_if(records_.begin(), records_.end(),
+                               [&from](const PassRecord &record) {
+                                   return record.name == from.name;
+                               });
+        if (it == records_.end()) {
+            records_.push_back(from);
+            continue;
+        }
+        it->wall_ns += from.wall_ns;
+        it->cpu_ns += from.cpu_ns;
+        it->allocs += from.allocs;
+        it->alloc_bytes += from.alloc_bytes;
+        it->peak_rss_kib = std::max(it->peak_rss_kib, from.peak_rss_kib);
+        if (from.output_bytes) {
+            it->output_bytes = it->output_bytes.value_or(0) + *from.output_bytes;
+        }
+    }
+}
+
+PassRecord PassTimer::Total() const {
+    PassRecord total;
+    total.name = "total";
+    for (const auto &record : records_) {
+        total.wall_ns += record.wall_ns;
+        total.cpu_ns += record.cpu_ns;
+        total.allocs += record.allocs;
+        total.alloc_bytes += record.alloc_bytes;
+        total.peak_rss_kib = std::max(total.peak_rss_kib, record.peak_rss_kib);
+    }
+    return total;
+}
+
+void PassTimer::PrintTable(std::ostream &os) const {
+    auto print = [&os](const PassRecord &record) {
+        os << fmt::format(
+                  "{:<24} {:>10.3f} {:>10.3f} {:>10} {:>12} {:>10} {:>12}",
+                  record.name, record.wall_ns / 1e6, record.cpu_ns / 1e6,
+                  record.allocs, record.alloc_bytes, record.peak_rss_kib,
+                  record.output_bytes
+                      ? std::to_string(record.output_bytes.value())
+                      : "-")
+           << std::endl;
+    };
+    os << fmt::format("{:<24} {:>10} {:>10} {:>10} {:>12} {:>10} {:>12}",
+                      "pass", "wall ms", "cpu ms", "allocs", "alloc bytes",
+                      "rss KiB", "output bytes")
+       << std::endl;
+    for (const auto &record : records_) print(record);
+    print(Total());
+}
+
+void PassTimer::PrintJson(std::ostream &os) const {
+    auto print = [&os](const PassRecord &record) {
+        os << fmt::format(
+            "{{\"name\": \"{}\", \"wall_ms\": {:.3f}, \"cpu_ms\": {:.3f}, "
+            "\"allocs\": {}, \"alloc_bytes\": {}, \"peak_rss_kib\": {}",
+            record.name, record.wall_ns / 1e6, record.cpu_ns / 1e6,
+            record.allocs, record.alloc_bytes, record.peak_rss_kib);
+        if (record.output_bytes) {
+            os << fmt::format(", \"output_bytes\": {}",
+                              record.output_bytes.value());
+        }
+        os << "}";
+    };
+    os << "{\"passes\": [";
+    for (size_t i = 0; i < records_.size(); i++) {
+        if (i) os << ", ";
+        print(records_[i]);
+    }
+    os << "], \"total\": ";
+    print(Total());
+    os << "}" << std::endl;
+}
+
+}  // namespace mini
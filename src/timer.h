@@ -0,0 +1,86 @@
+#ifndef MINI_TIMER_H_
+#define MINI_TIMER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mini {
+
+// Resources consumed by one pass of the compiler.
+struct PassRecord {
+    std::string name;
+    uint64_t wall_ns = 0;
+    uint64_t cpu_ns = 0;  // Of this thread and child processes.
+    size_t allocs = 0;
+    size_t alloc_bytes = 0;
+    size_t peak_rss_kib = 0;
+    std::optional<size_t> output_bytes;
+};
+
+// Collects time and memory spent in each pass.
+//
+// Passes may nest; time spent in an inner pass is not charged to the outer
+// one, so the records add up to the total. A pass entered several times
+// accumulates into one record, in order of first entry.
+class PassTimer {
+public:
+    inline bool enabled() const { return enabled_; }
+    void Enable();
+
+    void Start(const char *name);
+    void Stop();
+
+    // Records the size of what the current pass produced.
+    void SetOutputBytes(size_t bytes);
+
+    // Adds records of `other`, such as of another unit compiled in parallel,
+    // to the records of the same pass.
+    void Merge(const PassTimer &other);
+
+    inline const std::vector<PassRecord> &records() const { return records_; }
+    void PrintTable(std::ostream &os) const;
+    void PrintJson(std::ostream &os) const;
+
+private:
+    struct Snapshot {
+        uint64_t wall_ns;
+        uint64_t cpu_ns;
+        size_t allocs;
+        size_t alloc_bytes;
+    };
+    static Snapshot Now();
+    void Charge();
+    PassRecord Total() const;
+
+    bool enabled_ = false;
+    std::vector<PassRecord> records_;
+    std::vector<size_t> stack_;
+    Snapshot last_{};
+};
+
+// Runs a pass named `name` while this object is alive.
+class PassScope {
+public:
+    PassScope(PassTimer &timer, const char *name) : timer_(timer) {
+        if (timer_.enabled()) timer_.Start(name);
+    }
+    PassScope(const PassScope &) = delete;
+    PassScope &operator=(const PassScope &) = delete;
+    ~PassScope() {
+        if (timer_.enabled()) timer_.Stop();
+    }
+    inline void SetOutputBytes(size_t bytes) {
+        if (timer_.enabled()) timer_.SetOutputBytes(bytes);
+    }
+
+private:
+    PassTimer &timer_;
+};
+
+}  // namespace mini
+
+#endif  // MINI_TIMER_H_
@@ -98,8 +98,12 @@ std::string ToString(KeywordTokenKind kind) {
         case KeywordTokenKind::If:
             return "if";
             return "int";
+        case KeywordTokenKind::Inline:
+            return "inline";
         case KeywordTokenKind::Let:
             return "let";
+        case KeywordTokenKind::NoInline:
+            return "noinline";
         case KeywordTokenKind::Return:
             return "return";
         case KeywordTokenKind::Struct:
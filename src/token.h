@@ -4,12 +4,17 @@
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
+#include "context.h"
 #include "span.h"
+#include "symbol.h"
 
 namespace mini {
 
-enum class PunctTokenKind {
+enum class PunctTokenKind : uint8_t {
     Plus,         // "+"
     Arrow,        // "->"
     Minus,        // "-"
@@ -46,7 +51,7 @@ enum class PunctTokenKind {
     DotDotDot,    // "..."
 };
 
-enum class KeywordTokenKind {
+enum class KeywordTokenKind : uint8_t {
     As,        // "as"
     Bool,      // "bool"
     Break,     // "break"
@@ -58,7 +63,9 @@ enum class KeywordTokenKind {
     False,     // "false"
     Function,  // "function"
     If,        // "if"
+    Inline,    // "inline"
     Let,       // "let"
+    NoInline,  // "noinline"
     Return,    // "return"
     Struct,    // "struct"
     TSizeof,   // "tsizeof"
@@ -81,100 +88,160 @@ enum class KeywordTokenKind {
 std::string ToString(PunctTokenKind kind);
 std::string ToString(KeywordTokenKind kind);
 
-class Token {
-public:
-    Token(Span span) : span_(span) {}
-    virtual ~Token() {}
-    Span span() const { return span_; }
-    virtual bool IsPunctOf(PunctTokenKind) const { return false; }
-    virtual bool IsKeywordOf(KeywordTokenKind) const { return false; }
-    virtual bool IsIdent() const { return false; }
-    virtual bool IsInt() const { return false; }
-    virtual bool IsString() const { return false; }
-    virtual bool IsChar() const { return false; }
-    virtual const std::string& IdentValue() const {
-        throw std::runtime_error(
-            "`IdentValue` called when `IsIdent` returns false");
-    }
-    virtual uint64_t IntValue() const {
-        throw std::runtime_error(
-            "`IntValue` called when `IsInt` returns false");
-    }
-    virtual const std::string& StringValue() const {
-        throw std::runtime_error(
-            "`StringValue` called when `IsString` returns false");
-    }
-    virtual char CharValue() const {
-        throw std::runtime_error(
-            "`CharValue` called when `IsChar` returns false");
-    }
-
-private:
-    Span span_;
+enum class TokenKind : uint8_t {
+    Punct,
+    Keyword,
+    Ident,
+    Int,
+    String,
+    Char,
 };
 
-class PunctToken : public Token {
-public:
-    PunctToken(PunctTokenKind kind, Span span) : Token(span), kind_(kind) {}
-    inline bool IsPunctOf(PunctTokenKind kind) const override {
-        return kind == kind_;
+// A token stored by value in `TokenList`.
+//
+// `payload` holds the kind of punctuator or keyword, the value of character,
+// the `SymbolId` of identifier, or an index into the side table of `TokenList`
+// for other tokens.
+struct Token {
+    TokenKind kind;
+    uint32_t offset;  // Offset of the first character in the source.
+    uint32_t len;
+    uint32_t payload;
+
+    inline bool IsPunctOf(PunctTokenKind k) const {
+        return kind == TokenKind::Punct &&
+               payload == static_cast<uint32_t>(k);
     }
-
-private:
-    PunctTokenKind kind_;
+    inline bool IsKeywordOf(KeywordTokenKind k) const {
+        return kind == TokenKind::Keyword &&
+               payload == static_cast<uint32_t>(k);
+    }
+    inline bool IsIdent() const { return kind == TokenKind::Ident; }
+    inline bool IsInt() const { return kind == TokenKind::Int; }
+    inline bool IsString() const { return kind == TokenKind::String; }
+    inline bool IsChar() const { return kind == TokenKind::Char; }
 };
 
-class KeywordToken : public Token {
+static_assert(sizeof(Token) == 16, "Token should be kept compact");
+
+// Tokens of a source file, with values of identifiers, integers and strings
+// kept in side tables.
+class TokenList {
 public:
-    KeywordToken(KeywordTokenKind kind, Span span) : Token(span), kind_(kind) {}
-    inline bool IsKeywordOf(KeywordTokenKind kind) const override {
-        return kind == kind_;
+    TokenList(size_t id, const InputCacheEntry& entry)
+        : id_(id), entry_(&entry) {}
+    inline size_t id() const { return id_; }
+    inline size_t size() const { return tokens_.size(); }
+    inline const Token& at(size_t i) const { return tokens_[i]; }
+
+    void PushPunct(PunctTokenKind kind, size_t offset, size_t len) {
+        Push(TokenKind::Punct, offset, len, static_cast<uint32_t>(kind));
+    }
+    void PushKeyword(KeywordTokenKind kind, size_t offset, size_t len) {
+        Push(TokenKind::Keyword, offset, len, static_cast<uint32_t>(kind));
+    }
+    void PushChar(char value, size_t offset, size_t len) {
+        Push(TokenKind::Char, offset, len, static_cast<uint8_t>(value));
+    }
+    void PushInt(uint64_t value, size_t offset, size_t len) {
+        Push(TokenKind::Int, offset, len, ints_.size());
+        ints_.push_back(value);
+    }
+    void PushString(std::string&& value, size_t offset, size_t len) {
+        Push(TokenKind::String, offset, len, strings_.size());
+        strings_.push_back(std::move(value));
     }
 
-private:
-    KeywordTokenKind kind_;
-};
-
-class IdentToken : public Token {
-public:
-    IdentToken(std::string&& value, Span span)
-        : Token(span), value_(std::move(value)) {}
-    inline bool IsIdent() const override { return true; }
-    inline const std::string& IdentValue() const override { return value_; }
+    // `value` must be a view into the source, as it is used as a key.
+    void PushIdent(std::string_view value, size_t offset, size_t len) {
+        auto it = ident_ids_.find(value);
+        if (it == ident_ids_.end()) {
+            it = ident_ids_.emplace(value, Symbol::Intern(value)).first;
+        }
+        Push(TokenKind::Ident, offset, len, it->second);
+    }
 
-private:
-    std::string value_;
-};
+    inline Symbol IdentValue(const Token& token) const {
+        if (!token.IsIdent())
+            throw std::runtime_error(
+                "`IdentValue` called when `IsIdent` returns false");
+        return Symbol::FromId(token.payload);
+    }
+    inline uint64_t IntValue(const Token& token) const {
+        if (!token.IsInt())
+            throw std::runtime_error(
+                "`IntValue` called when `IsInt` returns false");
+        return ints_[token.payload];
+    }
+    inline const std::string& StringValue(const Token& token) const {
+        if (!token.IsString())
+            throw std::runtime_error(
+                "`StringValue` called when `IsString` returns false");
+        return strings_[token.payload];
+    }
+    inline char CharValue(const Token& token) const {
+        if (!token.IsChar())
+            throw std::runtime_error(
+                "`CharValue` called when `IsChar` returns false");
+        return static_cast<char>(token.payload);
+    }
 
-class IntToken : public Token {
-public:
-    IntToken(uint64_t value, Span span) : Token(span), value_(value) {}
-    inline bool IsInt() const override { return true; }
-    inline uint64_t IntValue() const override { return value_; }
+    // Tokens never span multiple lines.
+    Span SpanOf(const Token& token) const {
+        auto start = entry_->PositionOf(token.offset);
+        Position end(start.row(), start.offset() + token.len - 1);
+        return Span(id_, start, end);
+    }
 
 private:
-    uint64_t value_;
-};
-
-class StringToken : public Token {
-public:
-    StringToken(std::string&& value, Span span)
-        : Token(span), value_(std::move(value)) {}
-    inline bool IsString() const override { return true; }
-    inline const std::string& StringValue() const override { return value_; }
+    void Push(TokenKind kind, size_t offset, size_t len, size_t payload) {
+        if (offset + len > UINT32_MAX)
+            throw std::runtime_error("source file too large");
+        tokens_.push_back(Token{kind, static_cast<uint32_t>(offset),
+                                static_cast<uint32_t>(len),
+                                static_cast<uint32_t>(payload)});
+    }
 
-private:
-    std::string value_;
+    size_t id_;
+    const InputCacheEntry *entry_;
+    std::vector<Token> tokens_;
+    // Cache of identifiers already interned, to avoid the global lock.
+    std::unordered_map<std::string_view, SymbolId> ident_ids_;
+    std::vector<uint64_t> ints_;
+    std::vector<std::string> strings_;
 };
 
-class CharToken : public Token {
+// A token in `TokenList` together with access to its values.
+class TokenRef {
 public:
-    CharToken(char value, Span span) : Token(span), value_(value) {}
-    inline bool IsChar() const override { return true; }
-    inline char CharValue() const override { return value_; }
+    TokenRef(const TokenList& list, const Token& token)
+        : list_(list), token_(token) {}
+    inline Span span() const { return list_.SpanOf(token_); }
+    inline bool IsPunctOf(PunctTokenKind kind) const {
+        return token_.IsPunctOf(kind);
+    }
+    inline bool IsKeywordOf(KeywordTokenKind kind) const {
+        return token_.IsKeywordOf(kind);
+    }
+    inline bool IsIdent() const { return token_.IsIdent(); }
+    inline bool IsPunct() const { return token_.kind == TokenKind::Punct; }
+    // Kind of this punctuator. Only meaningful if `IsPunct()` holds.
+    inline PunctTokenKind PunctValue() const {
+        return static_cast<PunctTokenKind>(token_.payload);
+    }
+    inline bool IsInt() const { return token_.IsInt(); }
+    inline bool IsString() const { return token_.IsString(); }
+    inline bool IsChar() const { return token_.IsChar(); }
+    inline Symbol IdentValue() const { return list_.IdentValue(token_); }
+    inline uint64_t IntValue() const { return list_.IntValue(token_); }
+    inline const std::string& StringValue() const {
+        return list_.StringValue(token_);
+    }
+    inline char CharValue() const { return list_.CharValue(token_); }
 
 private:
-    char value_;
+    const TokenList& list_;
+    const Token& token_;
 };
 
 };  // namespace mini
@@ -13,7 +13,8 @@ function run_test() {
     COMPILE=../build/mini
     ESC=$(printf "\033")
 
-    find -type f -name "*.mini" | while read file; do
+    find -type f -name "*.mini" -not -path "./multi/*" \
+        -not -path "./diagnostics/*" | while read file; do
         echo "testing $file"
 
         $COMPILE $file
@@ -27,6 +28,45 @@ function run_test() {
         fi
     done
 
+    CODE=$?
+    if [ $CODE -ne 0 ]; then
+        exit $CODE
+    fi
+
+    # Each directory in multi is a program of several files.
+    find multi -mindepth 1 -maxdepth 1 -type d | while read dir; do
+        echo "testing $dir"
+
+        $COMPILE $dir/*.mini
+        ./a.out
+        CODE=$?
+
+        rm a.out
+        if [ $CODE -ne 0 ]; then
+            echo "${ESC}[31m${ESC}[1merror: ${ESC}[mtest failed with code $CODE"
+            exit 1
+        fi
+    done
+
+    CODE=$?
+    if [ $CODE -ne 0 ]; then
+        exit $CODE
+    fi
+
+    # Each file in diagnostics fails to compile with the messages in the file
+    # of the same name with `.stderr`, without colors.
+    find diagnostics -type f -name "*.mini" | while read file; do
+        echo "testing $file"
+
+        $COMPILE $file 2>&1 | sed "s/${ESC}\[[0-9;]*m//g" |
+            diff -u ${file%.mini}.stderr -
+        STATUS=("${PIPESTATUS[@]}")
+        if [ ${STATUS[0]} -eq 0 ] || [ ${STATUS[2]} -ne 0 ]; then
+            echo "${ESC}[31m${ESC}[1merror: ${ESC}[mtest failed"
+            exit 1
+        fi
+    done
+
     CODE=$?
     if [ $CODE -eq 0 ]; then
         echo "${ESC}[32m${ESC}[1msuccess: ${ESC}[mall test passed"